@@ -35,6 +35,7 @@ typedef struct dspop_add
 	int			valColumn;
 	int			originOne;
 	int			destroyFile;
+	rangefile*	rf;				// (for op_add_range) the file being read
 	} dspop_add;
 
 
@@ -91,6 +92,7 @@ dspop* op_add_parse (char* name, int _argc, char** _argv)
 	op->filename    = NULL;
 	op->valColumn   = (int) get_named_global ("valColumn", 4-1);
 	op->originOne   = (int) get_named_global ("originOne", false);
+	op->rf          = NULL;
 	op->destroyFile = false;
 
 	// parse arguments
@@ -160,6 +162,14 @@ dspop* op_add_parse (char* name, int _argc, char** _argv)
 
 	if (op->filename == NULL) goto filename_missing;
 
+	note_interval_file (op->filename, op->valColumn);
+	if (!op->destroyFile)  // (a file to be destroyed is read in one pass)
+		op->common.atRandom = !interval_file_by_chromosome (op->filename);
+	else
+		declare_resource_use (resourceData, op->filename, useWrite);
+
+	declare_footprint (footprintPointwise, 0, 0);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -181,6 +191,7 @@ void op_add_free (dspop* _op)
 	{
 	dspop_add*	op = (dspop_add*) _op;
 
+	if (op->rf       != NULL) close_range_file (op->rf);
 	if (op->filename != NULL) free (op->filename);
 	free (op);
 	}
@@ -196,25 +207,28 @@ void op_add_apply
 	{
 	dspop_add*	op = (dspop_add*) _op;
 	char*		filename = op->filename;
-	FILE*		f;
-	char		lineBuffer[1001];
+	intervalfile* f;
 	char		prevChrom[1001];
 	valtype*	v = NULL;
 	char*		chrom;
 	spec*		chromSpec;
+	spec**		chroms;
+	spec*		oneChrom[2];
 	u32			start, end, o, adjStart, adjEnd;
 	valtype		val;
 	u32			ix, chromIx;
 	int			ok;
 
-	f = fopen (filename, "rt");
+	chroms = chromosomes_to_apply (vName, oneChrom);
+
+	f = open_interval_file (filename, op->valColumn, op->originOne, vName);
 	if (f == NULL) goto cant_open_file;
 
 	if (trackOperations)
 		{
-		for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+		for (chromIx=0 ; chroms[chromIx]!=NULL ; chromIx++)
 			{
-			chromSpec = chromsSorted[chromIx];
+			chromSpec = chroms[chromIx];
 			chromSpec->flag = false;
 			}
 		}
@@ -230,8 +244,7 @@ void op_add_apply
 	v = NULL;
 	while (true)
 		{
-		ok = read_interval (f, lineBuffer, sizeof(lineBuffer), op->valColumn,
-	                        &chrom, &start, &end, &val);
+		ok = next_interval (f, &chrom, &start, &end, &val);
 		if (!ok) break;
 		if (val == 0.0) continue;
 
@@ -245,7 +258,7 @@ void op_add_apply
 
 		if (chromSpec == NULL) continue;
 
-		if ((trackOperations) && (!chromSpec->flag))
+		if ((trackOperations) && (chroms == chromsSorted) && (!chromSpec->flag))
 			{
 			fprintf (stderr, "%s(%s)\n", op->common.name, chrom);
 			chromSpec->flag = true;
@@ -283,10 +296,7 @@ void op_add_apply
 
 	// success
 
-	fclose (f);
-
-	if (op->destroyFile)
-		remove (filename);
+	close_interval_file (f, op->destroyFile);
 
 	return;
 
@@ -305,6 +315,55 @@ chrom_too_short:
 	exit (EXIT_FAILURE);
 	}
 
+
+// op_add_range--
+//	(only used when the file can be read one chromosome at a time, which
+//	excludes a file that is to be destroyed)
+
+void op_add_range
+   (arg_dont_complain(dspop*	_op),
+	arg_dont_complain(char*		vName),
+	arg_dont_complain(u32		vLen),
+	arg_dont_complain(valtype*	v),
+	arg_dont_complain(u32		start),
+	arg_dont_complain(u32		end))
+	{
+	dspop_add*	op = (dspop_add*) _op;
+	u32			pieceStart, pieceEnd;
+	valtype		val;
+	u32			ix;
+
+	if (start == 0)
+		{
+		if (op->rf != NULL) close_range_file (op->rf);
+		op->rf = open_range_file (_op->name, op->filename, op->valColumn, op->originOne,
+		                          vName, /*skipZeros*/ true, /*disjoint*/ false);
+		if (op->rf == NULL) goto cant_open_file;
+		}
+
+	// read this subrange's intervals and values and add them
+
+	while (next_range_interval (op->rf, start, end, &pieceStart, &pieceEnd, &val))
+		{
+		for (ix=pieceStart ; ix<pieceEnd ; ix++)
+			v[ix] += val;
+		}
+
+	if (end == vLen)
+		{ close_range_file (op->rf);  op->rf = NULL; }
+
+	return;
+
+	//////////
+	// failure exits
+	//////////
+
+cant_open_file:
+	fprintf (stderr, "[%s] can't open \"%s\" for reading\n",
+	                 _op->name, op->filename);
+	exit (EXIT_FAILURE);
+	}
+
 //----------
 // [[-- a dsp operation function group, operating on the whole genome --]]
 //
@@ -328,6 +387,7 @@ typedef struct dspop_subtract
 	int			valColumn;
 	int			originOne;
 	int			destroyFile;
+	rangefile*	rf;				// (for op_subtract_range) the file being read
 	} dspop_subtract;
 
 
@@ -384,6 +444,7 @@ dspop* op_subtract_parse (char* name, int _argc, char** _argv)
 	op->filename    = NULL;
 	op->valColumn   = (int) get_named_global ("valColumn", 4-1);
 	op->originOne   = (int) get_named_global ("originOne", false);
+	op->rf          = NULL;
 	op->destroyFile = false;
 
 	// parse arguments
@@ -453,6 +514,14 @@ dspop* op_subtract_parse (char* name, int _argc, char** _argv)
 
 	if (op->filename == NULL) goto filename_missing;
 
+	note_interval_file (op->filename, op->valColumn);
+	if (!op->destroyFile)  // (a file to be destroyed is read in one pass)
+		op->common.atRandom = !interval_file_by_chromosome (op->filename);
+	else
+		declare_resource_use (resourceData, op->filename, useWrite);
+
+	declare_footprint (footprintPointwise, 0, 0);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -474,6 +543,7 @@ void op_subtract_free (dspop* _op)
 	{
 	dspop_subtract*	op = (dspop_subtract*) _op;
 
+	if (op->rf       != NULL) close_range_file (op->rf);
 	if (op->filename != NULL) free (op->filename);
 	free (op);
 	}
@@ -489,25 +559,28 @@ void op_subtract_apply
 	{
 	dspop_subtract*	op = (dspop_subtract*) _op;
 	char*			filename = op->filename;
-	FILE*			f;
-	char			lineBuffer[1001];
+	intervalfile*	f;
 	char			prevChrom[1001];
 	valtype*		v = NULL;
 	char*			chrom;
 	spec*			chromSpec;
+	spec**			chroms;
+	spec*			oneChrom[2];
 	u32				start, end, o, adjStart, adjEnd;
 	valtype			val;
 	u32				ix, chromIx;
 	int				ok;
 
-	f = fopen (filename, "rt");
+	chroms = chromosomes_to_apply (vName, oneChrom);
+
+	f = open_interval_file (filename, op->valColumn, op->originOne, vName);
 	if (f == NULL) goto cant_open_file;
 
 	if (trackOperations)
 		{
-		for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+		for (chromIx=0 ; chroms[chromIx]!=NULL ; chromIx++)
 			{
-			chromSpec = chromsSorted[chromIx];
+			chromSpec = chroms[chromIx];
 			chromSpec->flag = false;
 			}
 		}
@@ -523,8 +596,7 @@ void op_subtract_apply
 	v = NULL;
 	while (true)
 		{
-		ok = read_interval (f, lineBuffer, sizeof(lineBuffer), op->valColumn,
-	                        &chrom, &start, &end, &val);
+		ok = next_interval (f, &chrom, &start, &end, &val);
 		if (!ok) break;
 		if (val == 0.0) continue;
 
@@ -538,7 +610,7 @@ void op_subtract_apply
 
 		if (chromSpec == NULL) continue;
 
-		if ((trackOperations) && (!chromSpec->flag))
+		if ((trackOperations) && (chroms == chromsSorted) && (!chromSpec->flag))
 			{
 			fprintf (stderr, "%s(%s)\n", op->common.name, chrom);
 			chromSpec->flag = true;
@@ -576,10 +648,7 @@ void op_subtract_apply
 
 	// success
 
-	fclose (f);
-
-	if (op->destroyFile)
-		remove (filename);
+	close_interval_file (f, op->destroyFile);
 
 	return;
 
@@ -598,6 +667,55 @@ chrom_too_short:
 	exit (EXIT_FAILURE);
 	}
 
+
+// op_subtract_range--
+//	(only used when the file can be read one chromosome at a time, which
+//	excludes a file that is to be destroyed)
+
+void op_subtract_range
+   (arg_dont_complain(dspop*	_op),
+	arg_dont_complain(char*		vName),
+	arg_dont_complain(u32		vLen),
+	arg_dont_complain(valtype*	v),
+	arg_dont_complain(u32		start),
+	arg_dont_complain(u32		end))
+	{
+	dspop_subtract*	op = (dspop_subtract*) _op;
+	u32				pieceStart, pieceEnd;
+	valtype			val;
+	u32				ix;
+
+	if (start == 0)
+		{
+		if (op->rf != NULL) close_range_file (op->rf);
+		op->rf = open_range_file (_op->name, op->filename, op->valColumn, op->originOne,
+		                          vName, /*skipZeros*/ true, /*disjoint*/ false);
+		if (op->rf == NULL) goto cant_open_file;
+		}
+
+	// read this subrange's intervals and values and subtract them
+
+	while (next_range_interval (op->rf, start, end, &pieceStart, &pieceEnd, &val))
+		{
+		for (ix=pieceStart ; ix<pieceEnd ; ix++)
+			v[ix] -= val;
+		}
+
+	if (end == vLen)
+		{ close_range_file (op->rf);  op->rf = NULL; }
+
+	return;
+
+	//////////
+	// failure exits
+	//////////
+
+cant_open_file:
+	fprintf (stderr, "[%s] can't open \"%s\" for reading\n",
+	                 _op->name, op->filename);
+	exit (EXIT_FAILURE);
+	}
+
 //----------
 // [[-- a dsp operation function group, operating on a single chromosome --]]
 //
@@ -697,6 +815,8 @@ dspop* op_add_constant_parse (char* name, int _argc, char** _argv)
 
 	if (!haveVal) goto constant_missing;
 
+	declare_footprint (footprintPointwise, 0, 0);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -724,18 +844,32 @@ void op_add_constant_free (dspop* op)
 // op_add_constant_apply--
 
 void op_add_constant_apply
-   (arg_dont_complain(dspop*	_op),
+   (arg_dont_complain(dspop*	op),
 	arg_dont_complain(char*		vName),
 	arg_dont_complain(u32		vLen),
 	arg_dont_complain(valtype*	v))
 	{
+	op_add_constant_range (op, vName, vLen, v, 0, vLen);
+	}
+
+
+// op_add_constant_range--
+
+void op_add_constant_range
+   (arg_dont_complain(dspop*	_op),
+	arg_dont_complain(char*		vName),
+	arg_dont_complain(u32		vLen),
+	arg_dont_complain(valtype*	v),
+	u32							start,
+	u32							end)
+	{
 	dspop_addconst*	op = (dspop_addconst*) _op;
 	valtype			val = op->val;
 	u32				ix;
 
 	if (val == 0.0) return;
 
-	for (ix=0 ; ix<vLen ; ix++)
+	for (ix=start ; ix<end ; ix++)
 		v[ix] += val;
 
 	}
@@ -867,6 +1001,14 @@ dspop* op_invert_parse (char* name, int _argc, char** _argv)
 		continue;
 		}
 
+	// with a middle value, each chromosome can be inverted on its own;
+	// otherwise we need the whole genome's min and max first
+
+	op->common.atRandom = !op->haveMidVal;
+
+	if (op->haveMidVal) declare_footprint (footprintPointwise, 0, 0);
+	               else declare_footprint (footprintReduction, 0, 0);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -898,33 +1040,35 @@ void op_invert_apply
 	spec*			chromSpec;
 	u32				ix, chromIx;
 
-	// if the user didn't specify a middle value, derive one from the min and
-	// max;  the derived value is such that the min and max will be preserved
-	// in the output
+	// if the user specified a middle value, we're operating on one chromosome
 
 	if (op->haveMidVal)
-		midVal = op->midVal;
-	else
 		{
-		chromSpec = chromsSorted[0];
+		op_invert_range (_op, vName, vLen, v, 0, vLen);
+		return;
+		}
+
+	// otherwise, derive a middle value from the min and max;  the derived
+	// value is such that the min and max will be preserved in the output
+
+	chromSpec = chromsSorted[0];
+	v = chromSpec->valVector;
+	minVal = maxVal = v[0];
+
+	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+		{
+		chromSpec = chromsSorted[chromIx];
 		v = chromSpec->valVector;
-		minVal = maxVal = v[0];
 
-		for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+		for (ix=0 ; ix<chromSpec->length ; ix++)
 			{
-			chromSpec = chromsSorted[chromIx];
-			v = chromSpec->valVector;
-
-			for (ix=0 ; ix<chromSpec->length ; ix++)
-				{
-				if (v[ix] < minVal) minVal = v[ix];
-				if (v[ix] > maxVal) maxVal = v[ix];
-				}
+			if (v[ix] < minVal) minVal = v[ix];
+			if (v[ix] > maxVal) maxVal = v[ix];
 			}
-
-		midVal = (minVal + maxVal) / 2.0;
 		}
 
+	midVal = (minVal + maxVal) / 2.0;
+
 	// perform the inversion
 
 	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
@@ -938,6 +1082,26 @@ void op_invert_apply
 
 	}
 
+
+// op_invert_range--
+
+void op_invert_range
+   (arg_dont_complain(dspop*	_op),
+	arg_dont_complain(char*		vName),
+	arg_dont_complain(u32		vLen),
+	arg_dont_complain(valtype*	v),
+	u32							start,
+	u32							end)
+	{
+	dspop_invert*	op = (dspop_invert*) _op;
+	valtype			midVal = op->midVal;
+	u32				ix;
+
+	for (ix=start ; ix<end ; ix++)
+		v[ix] = 2*midVal - v[ix];
+
+	}
+
 //----------
 // [[-- a dsp operation function group, operating on a single chromosome --]]
 //
@@ -1015,6 +1179,8 @@ dspop* op_absolute_value_parse (char* name, int _argc, char** _argv)
 		continue;
 		}
 
+	declare_footprint (footprintPointwise, 0, 0);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -1041,9 +1207,23 @@ void op_absolute_value_apply
 	arg_dont_complain(u32		vLen),
 	arg_dont_complain(valtype*	v))
 	{
+	op_absolute_value_range (op, vName, vLen, v, 0, vLen);
+	}
+
+
+// op_absolute_value_range--
+
+void op_absolute_value_range
+   (arg_dont_complain(dspop*	op),
+	arg_dont_complain(char*		vName),
+	arg_dont_complain(u32		vLen),
+	arg_dont_complain(valtype*	v),
+	u32							start,
+	u32							end)
+	{
 	u32		ix;
 
-	for (ix=0 ; ix<vLen ; ix++)
+	for (ix=start ; ix<end ; ix++)
 		{ if (v[ix] < 0) v[ix] = -v[ix]; }
 
 	}
@@ -9,4 +9,10 @@ dspprototypes(op_add_constant)
 dspprototypes(op_invert)
 dspprototypes(op_absolute_value)
 
+dsprangeprototype(op_add)
+dsprangeprototype(op_subtract)
+dsprangeprototype(op_add_constant)
+dsprangeprototype(op_absolute_value)
+dsprangeprototype(op_invert)
+
 #endif // add_H
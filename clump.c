@@ -12,6 +12,48 @@
 #include "genodsp_interface.h"
 #include "clump.h"
 
+// sweep parameters, one for each additional (average, length) pair
+
+typedef struct clumpsweep
+	{
+	valtype		average;
+	u32			minLength;
+	double		relativeLength;	// ratio of minLength to chromosome length
+	char*		filename;		// file the pair's intervals are written to
+	FILE*		f;
+	} clumpsweep;
+
+// scratch space for clump_search;  minSums and minWhere are the stack of
+// running prefix minima, clumpStart and clumpEnd are the stack of intervals
+
+typedef struct clumpscratch
+	{
+	valtype*	minSums;
+	u32*		minWhere;
+	u32			minSize;		// number of entries minSums/minWhere have
+								// .. room for
+	u32*		clumpStart;
+	u32*		clumpEnd;
+	u32			clumpSize;		// number of entries clumpStart/clumpEnd have
+								// .. room for
+	} clumpscratch;
+
+// the state of the search for one (average, length) pair;  clump_find
+// advances the searches for all of a chromosome's pairs together
+
+typedef struct clumpsearch
+	{
+	valtype		targetAvg;
+	u32			minLength;
+	valtype		minSum;			// the lowest prefix sum so far
+	valtype		valSum;			// the current prefix sum
+	u32			numMinSums;		// number of entries on the prefix minima stack
+	u32			minScan;		// earliest prefix minimum <= valSum
+	u32			numClumps;		// number of entries on the interval stack
+	int			allMonotonic;	// true => the sum has decreased at every step
+	clumpscratch scratch;
+	} clumpsearch;
+
 // private dspop subtype, used by both operators in this module--
 
 typedef struct dspop_clump
@@ -23,6 +65,10 @@ typedef struct dspop_clump
 	double		relativeLength;	// ratio of minLength to chromosome length
 	valtype		oneVal;
 	valtype		zeroVal;
+	u32			numSweeps;		// number of additional (average, length) pairs
+	clumpsweep*	sweeps;			// .. and the pairs themselves
+	char*		sweepTemplate;	// filename template for the pairs' files
+	int			originOne;		// true => sweep files are origin-one, closed
 	int			debug;
 	int			debugDetail;
 	int			progress;
@@ -31,8 +77,21 @@ typedef struct dspop_clump
 // prototypes
 
 static void parse_min_length (char* name, char* arg, char*argVal, dspop_clump* op, int maxOk);
+static void parse_sweep (char* name, char* arg, char* argVal, dspop_clump* op);
+static char* sweep_filename (char* template, char* averageStr, char* lengthStr);
 static void clump_search (dspop* _op, char* vName, u32 vLen, valtype* v,
                           int aboveThresh);
+static void clump_find (dspop_clump* op, char* vName, u32 vLen, valtype* v,
+                        int aboveThresh, u32 numSearches, clumpsearch* searches);
+static u32  clump_trim (dspop_clump* op, valtype* v, valtype targetAvg,
+                        int aboveThresh, clumpscratch* scratch, u32 numClumps);
+static void grow_min_stack   (char* name, clumpscratch* scratch);
+static void grow_clump_stack (char* name, clumpscratch* scratch);
+
+#define clumpStackInitSize 1024	// initial number of entries in the stacks
+								// .. used by clump_search
+#define clumpBlockLen      4096	// number of positions clump_find advances
+								// .. each search over at a time
 
 //----------
 // [[-- a dsp operation function group, operating on a single chromosome --]]
@@ -122,6 +181,13 @@ static void op_clump_usage_args (char* name, FILE* f, char* indent)
 	fprintf (f, "%s                           (default is 1.0)\n",                                   indent);
 	fprintf (f, "%s  --zero=<value>           (Z=) zero value to fill non-qualifying intervals\n",   indent);
 	fprintf (f, "%s                           (default is 0.0)\n",                                   indent);
+	fprintf (f, "%s  --sweep=<list>           additional average and length pairs to search for,\n", indent);
+	fprintf (f, "%s                           as <T>:<L>[,<T>:<L>...];  the intervals for each\n",   indent);
+	fprintf (f, "%s                           pair are written to a separate file (the current\n",   indent);
+	fprintf (f, "%s                           data is only affected by <average> and --length)\n",   indent);
+	fprintf (f, "%s  --sweepfiles=<template>  filenames for --sweep;  {T} and {L} are replaced by\n", indent);
+	fprintf (f, "%s                           each pair's average and length\n",                     indent);
+	fprintf (f, "%s                           (default is <operator>_T{T}_L{L}.dat)\n",              indent);
 	}
 
 // op_clump_parse--
@@ -134,9 +200,15 @@ dspop* op_clump_parse (char* name, int _argc, char** _argv)
 	char*			arg, *argVal;
 	valtype			tempVal;
 	int				haveAverage;
+	clumpsweep*		sweep;
+	u32				sweepIx;
+	char			defaultTemplate[100];
+	char*			lengthStr, *filename;
 
 	// allocate and initialize our control record
 
+	sprintf (defaultTemplate, "%.80s_T{T}_L{L}.dat", name);
+
 	op = (dspop_clump*) malloc (sizeof(dspop_clump));
 	if (op == NULL) goto cant_allocate;
 
@@ -148,6 +220,10 @@ dspop* op_clump_parse (char* name, int _argc, char** _argv)
 	op->relativeLength = 0.0;
 	op->oneVal         = 1.0;
 	op->zeroVal        = 0.0;
+	op->numSweeps      = 0;
+	op->sweeps         = NULL;
+	op->sweepTemplate  = NULL;
+	op->originOne      = (int) get_named_global ("originOne", false);
 	op->debug          = false;
 	op->debugDetail    = false;
 	op->progress       = 0;
@@ -206,6 +282,23 @@ dspop* op_clump_parse (char* name, int _argc, char** _argv)
 			goto next_arg;
 			}
 
+		// --sweep=<average>:<length>[,<average>:<length>...]
+
+		if (strcmp_prefix (arg, "--sweep=") == 0)
+			{
+			parse_sweep (name, arg, argVal, op);
+			goto next_arg;
+			}
+
+		// --sweepfiles=<template>
+
+		if (strcmp_prefix (arg, "--sweepfiles=") == 0)
+			{
+			if (op->sweepTemplate != NULL) free (op->sweepTemplate);
+			op->sweepTemplate = copy_string (argVal);
+			goto next_arg;
+			}
+
 		// --debug arguments
 
 		if (strcmp (arg, "--debug") == 0)
@@ -243,6 +336,25 @@ dspop* op_clump_parse (char* name, int _argc, char** _argv)
 		continue;
 		}
 
+	// name the sweep files;  the filenames were saved as the average and
+	// length strings, separated by a zero;  the files aren't opened until the
+	// operator is applied (so that, e.g., --explain doesn't create them)
+
+	for (sweepIx=0 ; sweepIx<op->numSweeps ; sweepIx++)
+		{
+		sweep = &op->sweeps[sweepIx];
+		lengthStr = sweep->filename + strlen(sweep->filename) + 1;
+		filename = sweep_filename ((op->sweepTemplate != NULL)? op->sweepTemplate : defaultTemplate,
+		                           sweep->filename, lengthStr);
+		free (sweep->filename);
+		sweep->filename = filename;
+
+		declare_resource_use (resourceData, sweep->filename, useWrite);
+		}
+
+	if (op->averageVarName != NULL)
+		declare_resource_use (resourceVariable, op->averageVarName, useRead);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -264,7 +376,20 @@ void op_clump_free (dspop* _op)
 	{
 	dspop_clump*	op = (dspop_clump*) _op;
 
+	clumpsweep*		sweep;
+	u32				sweepIx;
+
 	if (op->averageVarName != NULL) free (op->averageVarName);
+
+	for (sweepIx=0 ; sweepIx<op->numSweeps ; sweepIx++)
+		{
+		sweep = &op->sweeps[sweepIx];
+		if (sweep->f        != NULL) fclose (sweep->f);
+		if (sweep->filename != NULL) free (sweep->filename);
+		}
+	if (op->sweeps        != NULL) free (op->sweeps);
+	if (op->sweepTemplate != NULL) free (op->sweepTemplate);
+
 	free (op);
 	}
 
@@ -337,7 +462,7 @@ dspop* op_skimp_parse (char* name, int _argc, char** _argv)
 
 void op_skimp_free (dspop* op)
 	{
-	free (op);
+	op_clump_free (op);
 	}
 
 
@@ -484,11 +609,142 @@ relative_length_too_large:
 	// (never reaches here)
 	}
 
+//----------
+//
+// parse_sweep--
+//	Parse a list of (average, length) pairs for a clump sweep, and append them
+//	to the operator's list.
+//
+//	Until the sweep files are opened, each pair's filename field holds a copy
+//	of the average and length strings (as given by the user), separated by a
+//	zero.
+//
+//----------
+
+static void parse_sweep
+   (char*			name,
+	char*			arg,
+	char*			argVal,
+	dspop_clump*	op)
+	{
+	char*			list, *pair, *nextPair, *lengthStr;
+	clumpsweep*		sweep;
+	dspop_clump		tempOp;
+	u32				numBytes;
+
+	list = copy_string (argVal);
+
+	for (pair=list ; pair!=NULL ; pair=nextPair)
+		{
+		nextPair = strchr (pair, ',');
+		if (nextPair != NULL) *(nextPair++) = 0;
+
+		lengthStr = strchr (pair, ':');
+		if (lengthStr == NULL) goto bad_pair;
+		*(lengthStr++) = 0;
+		if ((*pair == 0) || (*lengthStr == 0)) goto bad_pair;
+
+		numBytes  = (op->numSweeps+1) * sizeof(clumpsweep);
+		op->sweeps = (clumpsweep*) realloc (op->sweeps, numBytes);
+		if (op->sweeps == NULL) goto cant_allocate;
+		sweep = &op->sweeps[op->numSweeps++];
+
+		tempOp.minLength      = 0;
+		tempOp.relativeLength = 0.0;
+		parse_min_length (name, arg, lengthStr, &tempOp, /*maxOK*/true);
+
+		sweep->average        = string_to_valtype (pair);
+		sweep->minLength      = tempOp.minLength;
+		sweep->relativeLength = tempOp.relativeLength;
+		sweep->f              = NULL;
+		sweep->filename       = (char*) malloc (strlen(pair) + 1 + strlen(lengthStr) + 1);
+		if (sweep->filename == NULL) goto cant_allocate;
+		strcpy (sweep->filename, pair);
+		strcpy (sweep->filename + strlen(pair) + 1, lengthStr);
+		}
+
+	free (list);
+	return;
+
+bad_pair:
+	fprintf (stderr, "[%s] can't parse \"%s\" as <average>:<length> (at \"%s\")\n",
+	                 name, pair, arg);
+	exit(EXIT_FAILURE);
+
+cant_allocate:
+	fprintf (stderr, "[%s] failed to allocate sweep list (at \"%s\")\n",
+	                 name, arg);
+	exit(EXIT_FAILURE);
+	}
+
+//----------
+//
+// sweep_filename--
+//	Create the filename for one sweep pair, by replacing each {T} and {L} in a
+//	template with the pair's average and length strings.
+//
+//----------
+//
+// Arguments:
+//	char*	template:	The filename template.
+//	char*	averageStr:	The string to replace {T} with.
+//	char*	lengthStr:	The string to replace {L} with.
+//
+// Returns:
+//	A pointer to a newly allocated string;  the caller is responsible for
+//	deallocating this.
+//
+//----------
+
+static char* sweep_filename
+   (char*	template,
+	char*	averageStr,
+	char*	lengthStr)
+	{
+	char*	filename, *scan, *dst;
+	u32		numBytes;
+
+	numBytes = strlen(template) + 1;
+	for (scan=template ; *scan!=0 ; scan++)
+		{
+		if      (strcmp_prefix (scan, "{T}") == 0) numBytes += strlen(averageStr);
+		else if (strcmp_prefix (scan, "{L}") == 0) numBytes += strlen(lengthStr);
+		}
+
+	filename = (char*) malloc (numBytes);
+	if (filename == NULL) goto cant_allocate;
+
+	dst = filename;
+	for (scan=template ; *scan!=0 ; )
+		{
+		if (strcmp_prefix (scan, "{T}") == 0)
+			{ strcpy (dst, averageStr);  dst += strlen(averageStr);  scan += 3; }
+		else if (strcmp_prefix (scan, "{L}") == 0)
+			{ strcpy (dst, lengthStr);   dst += strlen(lengthStr);   scan += 3; }
+		else
+			*(dst++) = *(scan++);
+		}
+	*dst = 0;
+
+	return filename;
+
+cant_allocate:
+	fprintf (stderr, "failed to allocate sweep filename (%u bytes)\n", numBytes);
+	exit(EXIT_FAILURE);
+	return NULL; // (never reaches here)
+	}
+
 //----------
 //
 // clump_search--
 //	Perform the clump-finding.
 //
+//	The operator's own average and length, and any sweep pairs, are all
+//	searched for in a single pass over the vector (see clump_find).  Each
+//	sweep pair's intervals are then trimmed and written to its file, while the
+//	vector is still intact.  Finally the operator's own intervals are trimmed
+//	and written to the vector in place, by a write cursor that trails them.
+//
 //----------
 
 static void clump_search
@@ -503,15 +759,14 @@ static void clump_search
 	u32				minLength = op->minLength;
 	valtype			oneVal    = op->oneVal;
 	valtype			zeroVal   = op->zeroVal;
-	valtype*		s         = get_scratch_vector();
-	valtype*		minSums   = get_scratch_vector();
-	u32*			minWhere  = (u32*) get_scratch_ints();
+	clumpsearch*	searches, *search;
+	clumpscratch*	scratch;
+	u32				numSearches, searchIx;
+	clumpsweep*		sweep;
+	spec*			chromSpec;
 	int				ok;
-	u32				ix, iy, scanIx;
-	valtype			minSum, valSum, val;
-	u32				numMinSums, minScan, minIx;
-	u32				start, end, prevStart, prevEnd;
-	int				allMonotonic;
+	u32				ix, scanIx, o;
+	u32				numClumps, clumpIx, sweepIx;
 
 	if (op->relativeLength > 0.0)
 		{
@@ -523,154 +778,408 @@ static void clump_search
 
 	// if the threshold is a named variable, fetch it now;  note that we copy
 	// the value from the named variable, then destroy our reference to the
-	// named variable
+	// named variable (unless the variable has a separate value for each
+	// chromosome, in which case we fetch it anew for every chromosome)
 
 	if (op->averageVarName != NULL)
 		{
 		ok = named_global_exists (op->averageVarName, &targetAvg);
 		if (!ok) goto no_threshold;
-		op->average = targetAvg;
-		fprintf (stderr, "[%s] using %s = " valtypeFmt " as threshold\n",
-		                 _op->name, op->averageVarName, targetAvg);
-		free (op->averageVarName);
-		op->averageVarName = NULL;
+		if (named_global_per_chrom (op->averageVarName))
+			fprintf (stderr, "[%s] using %s = " valtypeFmt " as threshold for %s\n",
+			                 _op->name, op->averageVarName, targetAvg, vName);
+		else
+			{
+			op->average = targetAvg;
+			fprintf (stderr, "[%s] using %s = " valtypeFmt " as threshold\n",
+			                 _op->name, op->averageVarName, targetAvg);
+			free (op->averageVarName);
+			op->averageVarName = NULL;
+			}
 		}
 
-	// perform a pre-scan do determine whether the sum in the algorithm would
-	// be strictly decreasing over the entire vector;  this would cause the
-	// minSums and minWhere arrays to overflow;  instead, if this case happens
-	// we know there are no clump intervals and we can just erase the entire
-	// vector and quit
+	// set up a search for each sweep pair, followed by one for the operator's
+	// own parameters;  the stacks are allocated (and enlarged) as they are
+	// needed
+
+	numSearches = op->numSweeps + 1;
+	searches = (clumpsearch*) malloc (numSearches * sizeof(clumpsearch));
+	if (searches == NULL) goto cant_allocate;
 
-	allMonotonic = true;
-	for (ix=0 ; ix<vLen ; ix++)
+	for (searchIx=0 ; searchIx<numSearches ; searchIx++)
 		{
-		if (aboveThresh) val = v[ix] - targetAvg;
-		            else val = targetAvg - v[ix];
-		if (val >= 0.0)
-			{ allMonotonic = false;  break; }
+		search = &searches[searchIx];
+		if (searchIx == op->numSweeps)
+			{
+			search->targetAvg = targetAvg;
+			search->minLength = minLength;
+			}
+		else
+			{
+			sweep = &op->sweeps[searchIx];
+			search->targetAvg = sweep->average;
+			search->minLength = sweep->minLength;
+			if (sweep->relativeLength > 0.0)
+				{
+				u32 relLength = (u32) (sweep->relativeLength * vLen);
+				if (relLength > search->minLength) search->minLength = relLength;
+				}
+			}
+
+		scratch = &search->scratch;
+		scratch->minSize = scratch->clumpSize = 0;
+		scratch->minSums    = NULL;
+		scratch->minWhere   = NULL;
+		scratch->clumpStart = NULL;
+		scratch->clumpEnd   = NULL;
 		}
 
-	if (allMonotonic)
+	clump_find (op, vName, vLen, v, aboveThresh, numSearches, searches);
+
+	// write each sweep pair's intervals to the pair's file
+
+	if (op->numSweeps > 0)
 		{
-		if (op->debug)
+		chromSpec = find_chromosome_spec (vName);
+		if (op->originOne) o = 1;
+		              else o = 0;
+
+		for (sweepIx=0 ; sweepIx<op->numSweeps ; sweepIx++)
 			{
-			if (aboveThresh) fprintf (stderr, " all decreasing\n");
-			            else fprintf (stderr, " all increasing\n");
+			sweep  = &op->sweeps[sweepIx];
+			search = &searches[sweepIx];
+
+			if (sweep->f == NULL)
+				{
+				sweep->f = fopen (sweep->filename, "wt");
+				if (sweep->f == NULL) goto cant_open_sweep;
+				}
+
+			numClumps = clump_trim (op, v, search->targetAvg, aboveThresh,
+			                        &search->scratch, search->numClumps);
+
+			for (clumpIx=0 ; clumpIx<numClumps ; clumpIx++)
+				fprintf (sweep->f, "%s\t%u\t%u\n",
+				                   vName, chromSpec->start + search->scratch.clumpStart[clumpIx] + o,
+				                   chromSpec->start + search->scratch.clumpEnd[clumpIx] + 1);
 			}
+		}
 
-		for (ix=0 ; ix<vLen ; ix++)
+	// write the operator's own intervals to the vector;  scanIx is the write
+	// cursor, everything before it has already been written
+
+	search  = &searches[op->numSweeps];
+	scratch = &search->scratch;
+	numClumps = clump_trim (op, v, targetAvg, aboveThresh,
+	                        scratch, search->numClumps);
+
+	scanIx = 0;
+	for (clumpIx=0 ; clumpIx<numClumps ; clumpIx++)
+		{
+		for (ix=scanIx ; ix<scratch->clumpStart[clumpIx] ; ix++)
 			v[ix] = zeroVal;
-		goto release_memory;
+		for ( ; ix<=scratch->clumpEnd[clumpIx] ; ix++)
+			v[ix] = oneVal;
+		scanIx = ix;
 		}
 
-	// search for clumps, intervals for which the average is above (or at) the
-	// threshold;  this is equivalent to intervals in which the sum, minus the
-	// length times the average, is positive or zero
-	//
-	// nota bene: this algorithm can suffer from round off error in the sums,
-	//            which can make the reported intervals less precise than we'd
-	//            like
+	for (ix=scanIx ; ix<vLen ; ix++)
+		v[ix] = zeroVal;
 
-	minSum = valSum = 0.0;
+	for (searchIx=0 ; searchIx<numSearches ; searchIx++)
+		{
+		scratch = &searches[searchIx].scratch;
+		if (scratch->minSums    != NULL) free (scratch->minSums);
+		if (scratch->minWhere   != NULL) free (scratch->minWhere);
+		if (scratch->clumpStart != NULL) free (scratch->clumpStart);
+		if (scratch->clumpEnd   != NULL) free (scratch->clumpEnd);
+		}
+	free (searches);
 
-	minSums [0] = valSum;
-	minWhere[0] = (u32) -1;
-	numMinSums  = 1;
-	minScan     = 0;
+	// success
 
-	prevStart   = (u32) -1;
-	prevEnd     = (u32) -1;
+	return;
 
-	for (ix=0 ; ix<vLen ; ix++)
-		{
-		if ((op->progress != 0)
-		 && (ix % op->progress == 0))
-			fprintf (stderr, " progress %s %s/%s (%.1f%%)\n",
-			                 vName, ucommatize(ix), ucommatize(vLen),
-			                 (100.0 * ix)/vLen);
+	// failure
 
-		// invariant: minSums[minScan] <= valSum <  minSums[minScan-1]
-		// with the implied assumption that minSums[-1] == infinity
+no_threshold:
+	fprintf (stderr, "[%s] attempt to use %s as threshold failed (no such variable)\n",
+	                 _op->name, op->averageVarName);
+	exit(EXIT_FAILURE);
 
-		if (aboveThresh) val = v[ix] - targetAvg;
-		            else val = targetAvg - v[ix];
-		s[ix] = zeroVal;
+cant_allocate:
+	fprintf (stderr, "[%s] failed to allocate clump searches (%u pairs)\n",
+	                 _op->name, op->numSweeps + 1);
+	exit(EXIT_FAILURE);
 
-		valSum += val;
-		if (valSum < minSum)
-			{
-			minSum = valSum;
-			minSums [numMinSums] = valSum;
-			minWhere[numMinSums] = ix;
-			numMinSums++;
-			}
+cant_open_sweep:
+	fprintf (stderr, "[%s] can't open \"%s\" for writing\n",
+	                 _op->name, sweep->filename);
+	exit(EXIT_FAILURE);
+	}
 
-		// (re-establish the invariant)
-		if (val < 0)								// the sum has decreased
-			{ while (minSums[minScan] > valSum) minScan++; }
-		else if (val > 0)							// the sum has increased
-			{ while ((minScan > 0) && (minSums[minScan-1] <= valSum)) minScan--; }
+//----------
+//
+// clump_find--
+//	Search a vector for clumps (or for op_skimp, anti-clumps), without
+//	altering the vector.  Several (average, length) pairs are searched for
+//	at once, in a single pass over the vector.
+//
+//	Each search keeps two stacks, rather than any full-length scratch
+//	vectors.  The first holds the running prefix minima of the sum (strictly
+//	decreasing, along with where each occurred).  The second holds the clump
+//	intervals found so far, merged into disjoint runs;  a new clump always
+//	ends at the current position, so it can only merge with intervals at the
+//	top of the stack.  Both stacks grow as needed.
+//
+//----------
+//
+// Arguments:
+//	dspop_clump*	op:				The operator's control record.
+//	char*			vName:			The name of the vector (for progress
+//									.. reports).
+//	u32				vLen:			The length of the vector.
+//	valtype*		v:				The vector to search.
+//	int				aboveThresh:	true  => search for clumps
+//									false => search for anti-clumps
+//	u32				numSearches:	The number of searches.
+//	clumpsearch*	searches:		The searches;  the caller sets targetAvg
+//									.. and minLength, and provides empty
+//									.. stacks.  On return numClumps is the
+//									.. number of merged clump intervals, and
+//									.. scratch.clumpStart[] and clumpEnd[] hold
+//									.. them (origin-zero, closed).
+//
+// Returns:
+//	(nothing)
+//
+//----------
 
-		if (op->debugDetail)
-			fprintf (stderr, " [%u] " valtypeFmt " " valtypeFmt " %u..\n",
-			                 ix,val,valSum,minWhere[minScan]);
+static void clump_find
+   (dspop_clump*	op,
+	char*			vName,
+	u32				vLen,
+	valtype*		v,
+	int				aboveThresh,
+	u32				numSearches,
+	clumpsearch*	searches)
+	{
+	char*			name = op->common.name;
+	clumpsearch*	search;
+	clumpscratch*	scratch;
+	u32				searchIx;
+	u32				blockStart, blockEnd, ix;
+	valtype*		minSums;
+	u32*			minWhere;
+	u32*			clumpStart;
+	u32*			clumpEnd;
+	valtype			targetAvg, minSum, valSum, val;
+	u32				minLength, numMinSums, minScan, minIx;
+	u32				numClumps;
+	u32				start, end;
+	int				allMonotonic;
 
-		// minScan points at the earliest index with minSums[minScan] <= valSum,
-		// so the interval (minWhere[minScan]+1 to ix) has sum >= 0
+	// make sure the stacks have been allocated
 
-		minIx = minWhere[minScan];
-		if (ix - minIx < minLength) continue;
+	for (searchIx=0 ; searchIx<numSearches ; searchIx++)
+		{
+		search  = &searches[searchIx];
+		scratch = &search->scratch;
+		if (scratch->minSize   == 0) grow_min_stack   (name, scratch);
+		if (scratch->clumpSize == 0) grow_clump_stack (name, scratch);
+
+		search->minSum = search->valSum = 0.0;
+		scratch->minSums [0] = 0.0;
+		scratch->minWhere[0] = (u32) -1;
+		search->numMinSums   = 1;
+		search->minScan      = 0;
+		search->numClumps    = 0;
+		search->allMonotonic = true;
+		}
 
-		start = minIx+1;
-		end   = ix;
+	// search for clumps, intervals for which the average is above (or at) the
+	// threshold;  this is equivalent to intervals in which the sum, minus the
+	// length times the average, is positive or zero
+	//
+	// the vector is processed in blocks small enough to stay in cache, and
+	// every search is advanced over a block before moving on to the next, so
+	// the vector is only read from memory once;  within a block a search's
+	// state is kept in locals
+	//
+	// nota bene: this algorithm can suffer from round off error in the sums,
+	//            which can make the reported intervals less precise than we'd
+	//            like
 
-		if (op->debug)
-			fprintf (stderr, " setting %u..%u\n", start, end+1);
+	for (blockStart=0 ; blockStart<vLen ; blockStart=blockEnd)
+		{
+		blockEnd = (vLen - blockStart > clumpBlockLen)? blockStart + clumpBlockLen : vLen;
 
-		if ((prevStart == (u32) -1)
-		 || (start > prevEnd+1))
+		if (op->progress != 0)
 			{
-			// no overlap with previous interval (or no previous interval)
-			for (iy=start ; iy<=end ; iy++) s[iy] = oneVal;
-			prevStart = start;
-			prevEnd   = end;
+			for (ix=blockStart ; ix<blockEnd ; ix++)
+				{
+				if (ix % op->progress != 0) continue;
+				fprintf (stderr, " progress %s %s/%s (%.1f%%)\n",
+				                 vName, ucommatize(ix), ucommatize(vLen),
+				                 (100.0 * ix)/vLen);
+				}
 			}
-		else if (start >= prevStart)
+
+		for (searchIx=0 ; searchIx<numSearches ; searchIx++)
 			{
-			// new interval extends previous interval on right
-			for (iy=prevEnd+1 ; iy<=end ; iy++) s[iy] = oneVal;
-			prevEnd = end;
+			search  = &searches[searchIx];
+			scratch = &search->scratch;
+
+			targetAvg    = search->targetAvg;
+			minLength    = search->minLength;
+			minSum       = search->minSum;
+			valSum       = search->valSum;
+			numMinSums   = search->numMinSums;
+			minScan      = search->minScan;
+			numClumps    = search->numClumps;
+			allMonotonic = search->allMonotonic;
+			minSums      = scratch->minSums;
+			minWhere     = scratch->minWhere;
+			clumpStart   = scratch->clumpStart;
+			clumpEnd     = scratch->clumpEnd;
+
+			for (ix=blockStart ; ix<blockEnd ; ix++)
+				{
+				// invariant: minSums[minScan] <= valSum <  minSums[minScan-1]
+				// with the implied assumption that minSums[-1] == infinity
+
+				if (aboveThresh) val = v[ix] - targetAvg;
+				            else val = targetAvg - v[ix];
+				if (val >= 0.0) allMonotonic = false;
+
+				valSum += val;
+				if (valSum < minSum)
+					{
+					if (numMinSums >= scratch->minSize)
+						{
+						grow_min_stack (name, scratch);
+						minSums  = scratch->minSums;
+						minWhere = scratch->minWhere;
+						}
+					minSum = valSum;
+					minSums [numMinSums] = valSum;
+					minWhere[numMinSums] = ix;
+					numMinSums++;
+					}
+
+				// (re-establish the invariant)
+				if (val < 0)							// the sum has decreased
+					{ while (minSums[minScan] > valSum) minScan++; }
+				else if (val > 0)						// the sum has increased
+					{ while ((minScan > 0) && (minSums[minScan-1] <= valSum)) minScan--; }
+
+				if (op->debugDetail)
+					fprintf (stderr, " [%u] " valtypeFmt " " valtypeFmt " %u..\n",
+					                 ix,val,valSum,minWhere[minScan]);
+
+				// while the sum has decreased at every step, there are no
+				// clump intervals
+
+				if (allMonotonic) continue;
+
+				// minScan points at the earliest index with minSums[minScan] <= valSum,
+				// so the interval (minWhere[minScan]+1 to ix) has sum >= 0
+
+				minIx = minWhere[minScan];
+				if (ix - minIx < minLength) continue;
+
+				start = minIx+1;
+				end   = ix;
+
+				if (op->debug)
+					fprintf (stderr, " setting %u..%u\n", start, end+1);
+
+				// merge the new interval with any intervals it overlaps or
+				// abuts;  these are necessarily at the top of the stack
+
+				while ((numClumps > 0) && (clumpEnd[numClumps-1]+1 >= start))
+					{
+					numClumps--;
+					if (clumpStart[numClumps] < start) start = clumpStart[numClumps];
+					}
+
+				if (numClumps >= scratch->clumpSize)
+					{
+					grow_clump_stack (name, scratch);
+					clumpStart = scratch->clumpStart;
+					clumpEnd   = scratch->clumpEnd;
+					}
+				clumpStart[numClumps] = start;
+				clumpEnd  [numClumps] = end;
+				numClumps++;
+				}
+
+			search->minSum       = minSum;
+			search->valSum       = valSum;
+			search->numMinSums   = numMinSums;
+			search->minScan      = minScan;
+			search->numClumps    = numClumps;
+			search->allMonotonic = allMonotonic;
 			}
-		else
+		}
+
+	if (op->debug)
+		{
+		for (searchIx=0 ; searchIx<numSearches ; searchIx++)
 			{
-			// new interval extends previous interval on left and right
-			for (iy=start     ; iy<prevStart ; iy++) s[iy] = oneVal;
-			for (iy=prevEnd+1 ; iy<=end      ; iy++) s[iy] = oneVal;
-			prevStart = start;
-			prevEnd   = end;
+			if (!searches[searchIx].allMonotonic) continue;
+			if (aboveThresh) fprintf (stderr, " all decreasing\n");
+			            else fprintf (stderr, " all increasing\n");
 			}
-
 		}
+	}
 
-	// copy scratch array to vector, trimming any below-average ends off of
-	// the intervals
+//----------
+//
+// clump_trim--
+//	Trim any below-average ends (or for op_skimp, above-average ends) off of a
+//	list of merged clump intervals, without altering the vector.
+//
+//----------
+//
+// Arguments:
+//	dspop_clump*	op:				The operator's control record.
+//	valtype*		v:				The vector that was searched.
+//	valtype			targetAvg:		The average threshold.
+//	int				aboveThresh:	true  => the intervals are clumps
+//									false => the intervals are anti-clumps
+//	clumpscratch*	scratch:		The stacks;  clumpStart[] and clumpEnd[]
+//									.. hold the merged intervals, and on return
+//									.. hold the trimmed intervals.
+//	u32				numClumps:		The number of merged intervals.
+//
+// Returns:
+//	The number of trimmed intervals;  this may be fewer than numClumps, since
+//	an interval can be trimmed away entirely.
+//
+//----------
 
-	scanIx = 0;
-	while (true)
-		{
-		// find the start of the next non-zero scratch interval, clearing the
-		// vector as we go
+static u32 clump_trim
+   (dspop_clump*	op,
+	valtype*		v,
+	valtype			targetAvg,
+	int				aboveThresh,
+	clumpscratch*	scratch,
+	u32				numClumps)
+	{
+	u32*			clumpStart = scratch->clumpStart;
+	u32*			clumpEnd   = scratch->clumpEnd;
+	u32				ix, clumpIx, numTrimmed;
+	u32				start, end, intervalEnd;
 
-		for (start=scanIx ; start<vLen ; start++)
-			{
-			if (s[start] != zeroVal) break;
-			v[start] = zeroVal;
-			}
-		if (start >= vLen) break;
+	numTrimmed = 0;
+	for (clumpIx=0 ; clumpIx<numClumps ; clumpIx++)
+		{
+		start       = clumpStart[clumpIx];
+		intervalEnd = clumpEnd  [clumpIx];
 
-		// scan over the first part of the interval, clearing any below-average
-		// values in the vector
+		// scan over the first part of the interval, skipping any below-average
+		// values
 
 		if (op->debug)
 			{
@@ -678,28 +1187,24 @@ static void clump_search
 			            else fprintf (stderr, " skimp start %u\n", start);
 			}
 
-		for (ix=start ; ix<vLen ; ix++)
+		for (ix=start ; ix<=intervalEnd ; ix++)
 			{
-			if (s[ix] == zeroVal) break;
 			if (aboveThresh) { if (v[ix] >= targetAvg) break; }
 			            else { if (v[ix] <= targetAvg) break; }
-			v[ix] = zeroVal;
 			}
 
-		if ((ix >= vLen) || (s[ix] == zeroVal))
-			{ scanIx = ix;  continue; }
+		if (ix > intervalEnd) continue;
 
 		// scan over the middle and end parts of the interval, locating the
-		// last average-or-better value in the vector
+		// last average-or-better value
 
 		if (op->debug)
 			fprintf (stderr, "   start trimmed to %u\n", ix);
 
 		start = ix;
 		end   = ix++;
-		for ( ; ix<vLen ; ix++)
+		for ( ; ix<=intervalEnd ; ix++)
 			{
-			if (s[ix] == zeroVal) break;
 			if (aboveThresh) { if (v[ix] >= targetAvg) end = ix; }
 			            else { if (v[ix] <= targetAvg) end = ix; }
 			}
@@ -710,27 +1215,74 @@ static void clump_search
 			fprintf (stderr, "   end trimmed to %u\n", end+1);
 			}
 
-		for (iy=start ; iy<=end ; iy++)
-			v[iy] = oneVal;
-		for (iy=end+1 ; iy<ix ; iy++)
-			v[iy] = zeroVal;
-
-		scanIx = ix;
+		clumpStart[numTrimmed] = start;
+		clumpEnd  [numTrimmed] = end;
+		numTrimmed++;
 		}
 
-release_memory:
-	release_scratch_vector(s);
-	release_scratch_vector(minSums);
-	release_scratch_ints  ((s32*) minWhere);
+	return numTrimmed;
+	}
 
-	// success
+//----------
+//
+// grow_min_stack, grow_clump_stack--
+//	Allocate, or enlarge, one of the stacks used by clump_search.  Each stack
+//	is a pair of parallel arrays, which are enlarged together.
+//
+//----------
+//
+// Arguments:
+//	char*			name:		The operator's name (for error reporting).
+//	clumpscratch*	scratch:	The stacks.  If the stack's size is zero, it
+//								.. is newly allocated, otherwise its size is
+//								.. doubled.
+//
+// Returns:
+//	(nothing)
+//
+//----------
+
+static void grow_min_stack
+   (char*			name,
+	clumpscratch*	scratch)
+	{
+	u32				newSize;
+
+	if (scratch->minSize == 0) newSize = clumpStackInitSize;
+	                      else newSize = 2 * scratch->minSize;
+
+	scratch->minSums  = (valtype*) realloc (scratch->minSums,  ((size_t) newSize) * sizeof(valtype));
+	scratch->minWhere = (u32*)     realloc (scratch->minWhere, ((size_t) newSize) * sizeof(u32));
+	if ((scratch->minSums == NULL) || (scratch->minWhere == NULL)) goto cant_allocate;
+	scratch->minSize = newSize;
 
 	return;
 
-	// failure
+cant_allocate:
+	fprintf (stderr, "[%s] failed to allocate clump search stack (%s entries)\n",
+	                 name, ucommatize(newSize));
+	exit(EXIT_FAILURE);
+	}
 
-no_threshold:
-	fprintf (stderr, "[%s] attempt to use %s as threshold failed (no such variable)\n",
-	                 _op->name, op->averageVarName);
+
+static void grow_clump_stack
+   (char*			name,
+	clumpscratch*	scratch)
+	{
+	u32				newSize;
+
+	if (scratch->clumpSize == 0) newSize = clumpStackInitSize;
+	                        else newSize = 2 * scratch->clumpSize;
+
+	scratch->clumpStart = (u32*) realloc (scratch->clumpStart, ((size_t) newSize) * sizeof(u32));
+	scratch->clumpEnd   = (u32*) realloc (scratch->clumpEnd,   ((size_t) newSize) * sizeof(u32));
+	if ((scratch->clumpStart == NULL) || (scratch->clumpEnd == NULL)) goto cant_allocate;
+	scratch->clumpSize = newSize;
+
+	return;
+
+cant_allocate:
+	fprintf (stderr, "[%s] failed to allocate clump interval stack (%s entries)\n",
+	                 name, ucommatize(newSize));
 	exit(EXIT_FAILURE);
 	}
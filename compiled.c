@@ -0,0 +1,768 @@
+// compiled.c-- compiled (binary) interval files, for masks and secondary
+//              signals that are read by many runs
+
+#include <stdlib.h>
+#define  true  1
+#define  false 0
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "utilities.h"
+#include "genodsp_interface.h"
+#include "compiled.h"
+
+//----------
+//
+// file format--
+//
+// A compiled file is a header, followed by a table with one entry per
+// chromosome, a block of zero-terminated chromosome names, and then each
+// chromosome's interval data.  All numbers are in the byte order of the machine
+// that wrote the file (the header's byteOrder field lets a reader detect a
+// mismatch).
+//
+// Within a chromosome, intervals are sorted by start, then by end.  Each
+// interval is stored as two variable-length unsigned integers (7 bits per byte,
+// low bits first, high bit set on all but the last byte), the first being the
+// start minus the previous interval's start and the second being the end minus
+// the start, followed by the value (sizeof(valtype) bytes) if the file has
+// values.  Coordinates are stored exactly as they appear in the text file;  any
+// origin adjustment is left to the reader, as it is for text files.
+//
+//----------
+
+#define compiledMagic     "genodspI"
+#define compiledVersion   1
+#define compiledByteOrder 0x01020304
+
+#define cfHasValues       0x00000001
+
+typedef struct cfheader
+	{
+	char		magic[8];		// compiledMagic (not zero-terminated)
+	u32			version;		// compiledVersion
+	u32			byteOrder;		// compiledByteOrder
+	u32			flags;			// cfHasValues, etc.
+	u32			valSize;		// sizeof(valtype), as written
+	u32			numChroms;		// number of entries in the chromosome table
+	u32			namesBytes;		// size of the name block (a multiple of 8)
+	u64			numIntervals;	// total number of intervals in the file
+	} cfheader;
+
+typedef struct cfchrom
+	{
+	u64			dataOffset;		// position of the interval data in the file
+	u64			dataBytes;		// size of the interval data
+	u32			numIntervals;	// number of intervals on this chromosome
+	u32			nameOffset;		// position of the name in the name block
+	} cfchrom;
+
+// an open compiled file;  the whole file is mapped into memory, and intervals
+// are decoded directly from the mapping
+
+struct compiledfile
+	{
+	char*			filename;
+	int				valCol;		// -1 => the caller wants no values
+	unsigned char*	base;		// the file's contents, as mapped
+	size_t			size;
+	cfheader*		header;
+	cfchrom*		chroms;
+	char*			names;
+	u32				chromIx;	// the next chromosome to read, and the one
+	u32				chromEnd;	// .. to stop before
+	char*			chrom;		// the current chromosome, its remaining
+	u32				remaining;	// .. intervals, and the position of the next
+	unsigned char*	scan;		// .. one
+	unsigned char*	scanEnd;
+	u32				prevStart;
+	};
+
+// intervals collected during compilation
+
+typedef struct cinterval
+	{
+	u32			start;
+	u32			end;
+	valtype		val;
+	} cinterval;
+
+typedef struct cchrom
+	{
+	char*		name;
+	u32			numIntervals, intervalsSize;
+	cinterval*	intervals;
+	} cchrom;
+
+// prototypes for private functions
+
+static void     compile_usage     (char* message);
+static int      cinterval_compare (const void* _v1, const void* _v2);
+static cchrom*  compile_chrom     (cchrom** chroms, u32* numChroms,
+                                   u32* chromsSize, char* name);
+static u32      encode_u32        (unsigned char* buffer, u32 v);
+static u32      decode_u32        (compiledfile* cf);
+
+//----------
+//
+// compile_main--
+//	Compile a text interval file into the binary format, as the "genodsp
+//	compile" command.
+//
+//----------
+//
+// Arguments:
+//	int		argc:	The number of arguments, counting "compile" itself.
+//	char**	argv:	The arguments, beginning with "compile".
+//
+// Returns:
+//	The program's exit status;  failures result in program termination.
+//
+//----------
+
+static void compile_usage (char* message)
+	{
+	if (message != NULL) fprintf (stderr, "%s\n", message);
+
+	fprintf (stderr, "usage: genodsp compile [options] <input_file> <output_file>\n");
+	fprintf (stderr, "\n");
+	//                123456789-123456789-123456789-123456789-123456789-123456789-123456789-123456789
+	fprintf (stderr, "Convert a chromosome-start-end-value interval file to a compiled binary\n");
+	fprintf (stderr, "interval file.  Operators that read a secondary interval file (e.g. mask,\n");
+	fprintf (stderr, "add or minover) recognize compiled files and read them directly, skipping\n");
+	fprintf (stderr, "the text parsing.\n");
+	fprintf (stderr, "\n");
+	fprintf (stderr, "  --value=<col>  intervals contain a value in the specified column;  by\n");
+	fprintf (stderr, "                 default we assume this is in column 4\n");
+	fprintf (stderr, "  --novalue      intervals have no value;  the compiled file will only be\n");
+	fprintf (stderr, "                 usable by operators that don't need values (or with their\n");
+	fprintf (stderr, "                 --novalue option)\n");
+	fprintf (stderr, "\n");
+	fprintf (stderr, "Intervals are stored sorted.  Coordinates are stored as they appear in the\n");
+	fprintf (stderr, "input, so the compiled file can be used with either --origin setting.\n");
+
+	exit (EXIT_FAILURE);
+	}
+
+
+int compile_main
+   (int				_argc,
+	char**			_argv)
+	{
+	int				argc;
+	char**			argv;
+	char*			arg, *argVal;
+	char*			inFilename  = NULL;
+	char*			outFilename = NULL;
+	int				valCol = 4-1;
+	FILE*			inF, *outF;
+	char			lineBuffer[1001];
+	cchrom*			chroms = NULL;
+	u32				numChroms = 0, chromsSize = 0;
+	cchrom*			c = NULL;
+	cinterval*		ci;
+	char*			chrom;
+	u32				start, end;
+	valtype			val;
+	cfheader		header;
+	cfchrom*		table = NULL;
+	char*			names = NULL;
+	unsigned char*	data = NULL;
+	u64				dataSize = 0, dataLen, dataOffset;
+	u64				numIntervals;
+	u32				namesBytes, chromIx, ix, prevStart;
+	size_t			numBytes;
+	int				ok;
+
+	// parse arguments
+
+	argv = _argv+1;  argc = _argc - 1;
+
+	for ( ; argc>0 ; argc--,argv++)
+		{
+		arg    = argv[0];
+		argVal = strchr(arg,'=');
+		if (argVal != NULL) argVal++;
+
+		if ((strcmp (arg, "--novalue")    == 0)
+		 || (strcmp (arg, "--novalues")   == 0)
+		 || (strcmp (arg, "--value=none") == 0))
+			{ valCol = -1;  continue; }
+
+		if (strcmp_prefix (arg, "--value=") == 0)
+			{
+			valCol = string_to_int (argVal) - 1;
+			if (valCol < 3)
+				{
+				fprintf (stderr, "value column can't be less than 4 (\"%s\")\n", arg);
+				compile_usage (NULL);
+				}
+			continue;
+			}
+
+		if ((strcmp (arg, "--help") == 0) || (strcmp (arg, "-h") == 0))
+			compile_usage (NULL);
+
+		if (strcmp_prefix (arg, "--") == 0)
+			{
+			fprintf (stderr, "unrecognized option: \"%s\"\n", arg);
+			compile_usage (NULL);
+			}
+
+		if      (inFilename  == NULL) inFilename  = arg;
+		else if (outFilename == NULL) outFilename = arg;
+		else
+			{
+			fprintf (stderr, "unrecognized argument: \"%s\"\n", arg);
+			compile_usage (NULL);
+			}
+		}
+
+	if (outFilename == NULL)
+		compile_usage ("compile needs an input and an output file");
+
+	// read the intervals, collecting them by chromosome
+
+	inF = fopen (inFilename, "rt");
+	if (inF == NULL) goto cant_open_input;
+
+	numIntervals = 0;
+	while (true)
+		{
+		ok = read_interval (inF, lineBuffer, sizeof(lineBuffer), valCol,
+		                    &chrom, &start, &end, &val);
+		if (!ok) break;
+
+		if ((c == NULL) || (strcmp (c->name, chrom) != 0))
+			c = compile_chrom (&chroms, &numChroms, &chromsSize, chrom);
+
+		if (c->numIntervals >= c->intervalsSize)
+			{
+			c->intervalsSize = (c->intervalsSize == 0)? 1000 : 2*c->intervalsSize;
+			numBytes = c->intervalsSize * sizeof(cinterval);
+			c->intervals = (cinterval*) realloc (c->intervals, numBytes);
+			if (c->intervals == NULL) goto cant_allocate;
+			}
+
+		ci = &c->intervals[c->numIntervals++];
+		ci->start = start;
+		ci->end   = end;
+		ci->val   = val;
+		numIntervals++;
+		}
+
+	fclose (inF);
+
+	// build the chromosome table and name block
+
+	numBytes = (numChroms == 0)? 1 : numChroms * sizeof(cfchrom);
+	table = (cfchrom*) calloc (1, numBytes);
+	if (table == NULL) goto cant_allocate;
+
+	namesBytes = 0;
+	for (chromIx=0 ; chromIx<numChroms ; chromIx++)
+		{
+		table[chromIx].nameOffset   = namesBytes;
+		table[chromIx].numIntervals = chroms[chromIx].numIntervals;
+		namesBytes += strlen(chroms[chromIx].name) + 1;
+		}
+	namesBytes = (namesBytes + 7) & ~7;
+
+	numBytes = (namesBytes == 0)? 1 : namesBytes;
+	names = (char*) calloc (1, numBytes);
+	if (names == NULL) goto cant_allocate;
+	for (chromIx=0 ; chromIx<numChroms ; chromIx++)
+		strcpy (names + table[chromIx].nameOffset, chroms[chromIx].name);
+
+	// encode each chromosome's intervals, sorted;  each interval takes at most
+	// two 5-byte integers plus its value
+
+	dataOffset = sizeof(cfheader) + numChroms*sizeof(cfchrom) + namesBytes;
+	for (chromIx=0 ; chromIx<numChroms ; chromIx++)
+		{
+		c = &chroms[chromIx];
+		qsort (c->intervals, c->numIntervals, sizeof(cinterval), cinterval_compare);
+
+		if (c->numIntervals * (10 + sizeof(valtype)) > dataSize)
+			{
+			dataSize = c->numIntervals * (10 + sizeof(valtype));
+			data = (unsigned char*) realloc (data, dataSize);
+			if (data == NULL) { numBytes = dataSize;  goto cant_allocate; }
+			}
+
+		dataLen   = 0;
+		prevStart = 0;
+		for (ix=0 ; ix<c->numIntervals ; ix++)
+			{
+			ci = &c->intervals[ix];
+			dataLen += encode_u32 (data+dataLen, ci->start - prevStart);
+			dataLen += encode_u32 (data+dataLen, ci->end   - ci->start);
+			if (valCol != -1)
+				{
+				memcpy (data+dataLen, &ci->val, sizeof(valtype));
+				dataLen += sizeof(valtype);
+				}
+			prevStart = ci->start;
+			}
+
+		table[chromIx].dataOffset = dataOffset;
+		table[chromIx].dataBytes  = dataLen;
+		dataOffset += dataLen;
+
+		// stash the encoded data in place of the intervals, to be written
+		// after the table
+
+		free (c->intervals);
+		c->intervals = (cinterval*) malloc ((dataLen == 0)? 1 : dataLen);
+		if (c->intervals == NULL) { numBytes = dataLen;  goto cant_allocate; }
+		memcpy (c->intervals, data, dataLen);
+		}
+
+	// write the file
+
+	memset (&header, 0, sizeof(header));
+	memcpy (header.magic, compiledMagic, sizeof(header.magic));
+	header.version      = compiledVersion;
+	header.byteOrder    = compiledByteOrder;
+	header.flags        = (valCol == -1)? 0 : cfHasValues;
+	header.valSize      = sizeof(valtype);
+	header.numChroms    = numChroms;
+	header.namesBytes   = namesBytes;
+	header.numIntervals = numIntervals;
+
+	outF = fopen (outFilename, "wb");
+	if (outF == NULL) goto cant_open_output;
+
+	ok = (fwrite (&header, sizeof(header), 1, outF) == 1);
+	if ((ok) && (numChroms > 0))
+		ok = (fwrite (table, sizeof(cfchrom), numChroms, outF) == numChroms);
+	if ((ok) && (namesBytes > 0))
+		ok = (fwrite (names, 1, namesBytes, outF) == namesBytes);
+	for (chromIx=0 ; (ok)&&(chromIx<numChroms) ; chromIx++)
+		{
+		dataLen = table[chromIx].dataBytes;
+		if (dataLen > 0)
+			ok = (fwrite (chroms[chromIx].intervals, 1, dataLen, outF) == dataLen);
+		}
+	if (fclose (outF) != 0) ok = false;
+	if (!ok) goto cant_write;
+
+	// success
+
+	for (chromIx=0 ; chromIx<numChroms ; chromIx++)
+		{
+		free (chroms[chromIx].name);
+		if (chroms[chromIx].intervals != NULL) free (chroms[chromIx].intervals);
+		}
+	if (chroms != NULL) free (chroms);
+	if (data   != NULL) free (data);
+	free (table);
+	free (names);
+
+	return EXIT_SUCCESS;
+
+	// failure exits
+
+cant_open_input:
+	fprintf (stderr, "[compile] can't open \"%s\" for reading\n", inFilename);
+	exit (EXIT_FAILURE);
+
+cant_open_output:
+	fprintf (stderr, "[compile] can't open \"%s\" for writing\n", outFilename);
+	exit (EXIT_FAILURE);
+
+cant_write:
+	fprintf (stderr, "[compile] failed to write \"%s\"\n", outFilename);
+	exit (EXIT_FAILURE);
+
+cant_allocate:
+	fprintf (stderr, "[compile] failed to allocate %s bytes\n",
+	                 ucommatize(numBytes));
+	exit (EXIT_FAILURE);
+	return EXIT_FAILURE; // (never reaches here)
+	}
+
+
+static int cinterval_compare (const void* _v1, const void* _v2)
+	{
+	const cinterval* v1 = (const cinterval*) _v1;
+	const cinterval* v2 = (const cinterval*) _v2;
+
+	if (v1->start < v2->start) return -1;
+	if (v1->start > v2->start) return  1;
+	if (v1->end   < v2->end)   return -1;
+	if (v1->end   > v2->end)   return  1;
+	return 0;
+	}
+
+
+static cchrom* compile_chrom
+   (cchrom**	_chroms,
+	u32*		_numChroms,
+	u32*		_chromsSize,
+	char*		name)
+	{
+	cchrom*		chroms = *_chroms;
+	u32			chromIx;
+	size_t		numBytes;
+
+	for (chromIx=0 ; chromIx<*_numChroms ; chromIx++)
+		{ if (strcmp (chroms[chromIx].name, name) == 0) return &chroms[chromIx]; }
+
+	if (*_numChroms >= *_chromsSize)
+		{
+		*_chromsSize = (*_chromsSize == 0)? 100 : 2 * *_chromsSize;
+		numBytes = *_chromsSize * sizeof(cchrom);
+		chroms = *_chroms = (cchrom*) realloc (chroms, numBytes);
+		if (chroms == NULL) goto cant_allocate;
+		}
+
+	chromIx = (*_numChroms)++;
+	chroms[chromIx].name          = copy_string (name);
+	chroms[chromIx].numIntervals  = 0;
+	chroms[chromIx].intervalsSize = 0;
+	chroms[chromIx].intervals     = NULL;
+
+	return &chroms[chromIx];
+
+cant_allocate:
+	fprintf (stderr, "[compile] failed to allocate %s bytes\n",
+	                 ucommatize(numBytes));
+	exit (EXIT_FAILURE);
+	return NULL; // (never reaches here)
+	}
+
+//----------
+//
+// is_compiled_file--
+//	Determine whether a file is a compiled interval file.
+//
+//----------
+//
+// Arguments:
+//	char*	filename:	The file to check.
+//
+// Returns:
+//	true if the file begins with the compiled file signature;  false otherwise
+//	(including if the file can't be read).
+//
+//----------
+
+int is_compiled_file
+   (char*		filename)
+	{
+	FILE*		f;
+	char		magic[8];
+	int			ok;
+
+	f = fopen (filename, "rb");
+	if (f == NULL) return false;
+
+	ok = (fread (magic, sizeof(magic), 1, f) == 1);
+	fclose (f);
+
+	return (ok) && (memcmp (magic, compiledMagic, sizeof(magic)) == 0);
+	}
+
+//----------
+//
+// open_compiled_file, seek_compiled_chromosome, next_compiled_interval,
+// close_compiled_file--
+//	Read intervals from a compiled file, in the same manner as read_interval
+//	does for a text file.
+//
+//----------
+//
+// open_compiled_file--
+//
+// Arguments:
+//	char*	filename:	The file to read.
+//	int		valCol:		-1 if the caller wants no values (all values are
+//						.. reported as 1, as read_interval does);  anything
+//						.. else means the caller wants the file's values.
+//
+// Returns:
+//	A pointer to the opened file;  NULL if the file can't be opened.  A file
+//	that isn't a valid compiled file results in program termination.
+//
+//----------
+//
+// seek_compiled_chromosome--
+//
+// Arguments:
+//	compiledfile*	cf:		The file to read from.
+//	char*			chrom:	The chromosome to read;  subsequent calls to
+//							.. next_compiled_interval will only report
+//							.. intervals on this chromosome (if it isn't in
+//							.. the file, they will report none).
+//
+// Returns:
+//	(nothing)
+//
+//----------
+//
+// next_compiled_interval--
+//
+// Arguments:
+//	compiledfile*	cf:		The file to read from.
+//	char**			chrom:	Place to return a pointer to the chromosome;  this
+//							.. points into the file's mapping, and is valid
+//							.. until the file is closed.
+//	u32*			start:	Place to return the start.
+//	u32*			end:	Place to return the end.
+//	valtype*		val:	Place to return the value.
+//
+// Returns:
+//	true if we were successful;  false if there are no more intervals.
+//
+//----------
+//
+// close_compiled_file--
+//
+// Arguments:
+//	compiledfile*	cf:		The file to close.
+//
+// Returns:
+//	(nothing)
+//
+//----------
+
+compiledfile* open_compiled_file
+   (char*			filename,
+	int				valCol)
+	{
+	compiledfile*	cf;
+	struct stat		fileStat;
+	int				fd;
+	void*			base;
+	cfheader*		header;
+	cfchrom*		chrom;
+	u64				tableEnd;
+	u32				chromIx;
+
+	fd = open (filename, O_RDONLY);
+	if (fd < 0) return NULL;
+
+	if (fstat (fd, &fileStat) != 0)
+		{ close (fd);  return NULL; }
+	if ((size_t) fileStat.st_size < sizeof(cfheader))
+		{ close (fd);  goto not_compiled; }
+
+	base = mmap (NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close (fd);
+	if (base == MAP_FAILED) return NULL;
+
+	cf = (compiledfile*) malloc (sizeof(compiledfile));
+	if (cf == NULL) goto cant_allocate;
+
+	cf->filename  = filename;
+	cf->valCol    = valCol;
+	cf->base      = (unsigned char*) base;
+	cf->size      = fileStat.st_size;
+	cf->header    = header = (cfheader*) base;
+	cf->chroms    = (cfchrom*) (cf->base + sizeof(cfheader));
+	cf->names     = (char*) (cf->chroms + header->numChroms);
+	cf->chromIx   = 0;
+	cf->chromEnd  = header->numChroms;
+	cf->chrom     = NULL;
+	cf->remaining = 0;
+	cf->scan      = cf->scanEnd = NULL;
+	cf->prevStart = 0;
+
+	// validate the header and table
+
+	if (memcmp (header->magic, compiledMagic, sizeof(header->magic)) != 0)
+		goto not_compiled;
+	if (header->version   != compiledVersion)   goto wrong_version;
+	if (header->byteOrder != compiledByteOrder) goto wrong_byte_order;
+	if (header->valSize   != sizeof(valtype))   goto wrong_val_size;
+	if ((valCol != -1) && ((header->flags & cfHasValues) == 0))
+		goto no_values;
+
+	tableEnd = sizeof(cfheader) + (u64) header->numChroms * sizeof(cfchrom)
+	         + header->namesBytes;
+	if (tableEnd > cf->size) goto truncated;
+	if ((header->namesBytes > 0) && (cf->names[header->namesBytes-1] != 0))
+		goto corrupt;
+
+	for (chromIx=0 ; chromIx<header->numChroms ; chromIx++)
+		{
+		chrom = &cf->chroms[chromIx];
+		if (chrom->nameOffset >= header->namesBytes)             goto corrupt;
+		if (chrom->dataOffset < tableEnd)                        goto corrupt;
+		if (chrom->dataOffset + chrom->dataBytes > cf->size)     goto truncated;
+		}
+
+	return cf;
+
+	// failure exits
+
+cant_allocate:
+	fprintf (stderr, "failed to allocate compiled file record for \"%s\" (%d bytes)\n",
+	                 filename, (int) sizeof(compiledfile));
+	exit (EXIT_FAILURE);
+
+not_compiled:
+	fprintf (stderr, "\"%s\" is not a compiled interval file\n", filename);
+	exit (EXIT_FAILURE);
+
+wrong_version:
+	fprintf (stderr, "\"%s\" is a version %u compiled interval file (this program reads version %u)\n",
+	                 filename, header->version, compiledVersion);
+	exit (EXIT_FAILURE);
+
+wrong_byte_order:
+	fprintf (stderr, "\"%s\" was compiled on a machine with a different byte order\n",
+	                 filename);
+	exit (EXIT_FAILURE);
+
+wrong_val_size:
+	fprintf (stderr, "\"%s\" was compiled with %u-byte values (this program uses %d-byte values)\n",
+	                 filename, header->valSize, (int) sizeof(valtype));
+	exit (EXIT_FAILURE);
+
+no_values:
+	fprintf (stderr, "\"%s\" was compiled without values (use --novalue with the operator)\n",
+	                 filename);
+	exit (EXIT_FAILURE);
+
+truncated:
+	fprintf (stderr, "compiled interval file \"%s\" is truncated\n", filename);
+	exit (EXIT_FAILURE);
+
+corrupt:
+	fprintf (stderr, "compiled interval file \"%s\" is corrupt\n", filename);
+	exit (EXIT_FAILURE);
+	return NULL; // (never reaches here)
+	}
+
+
+void seek_compiled_chromosome
+   (compiledfile*	cf,
+	char*			chrom)
+	{
+	u32				chromIx;
+
+	cf->remaining = 0;
+	cf->scan      = cf->scanEnd = NULL;
+
+	for (chromIx=0 ; chromIx<cf->header->numChroms ; chromIx++)
+		{
+		if (strcmp (cf->names + cf->chroms[chromIx].nameOffset, chrom) == 0)
+			{
+			cf->chromIx  = chromIx;
+			cf->chromEnd = chromIx+1;
+			return;
+			}
+		}
+
+	cf->chromIx = cf->chromEnd = 0;
+	}
+
+
+int next_compiled_interval
+   (compiledfile*	cf,
+	char**			chrom,
+	u32*			start,
+	u32*			end,
+	valtype*		val)
+	{
+	cfchrom*		c;
+	u32				s;
+
+	// move to the next chromosome with intervals
+
+	while (cf->remaining == 0)
+		{
+		if (cf->scan != cf->scanEnd) goto corrupt;
+		if (cf->chromIx >= cf->chromEnd) return false;
+
+		c = &cf->chroms[cf->chromIx++];
+		cf->chrom     = cf->names + c->nameOffset;
+		cf->remaining = c->numIntervals;
+		cf->scan      = cf->base + c->dataOffset;
+		cf->scanEnd   = cf->scan + c->dataBytes;
+		cf->prevStart = 0;
+		}
+
+	// decode the interval
+
+	s = cf->prevStart + decode_u32 (cf);
+	*chrom = cf->chrom;
+	*start = s;
+	*end   = s + decode_u32 (cf);
+	cf->prevStart = s;
+
+	if ((cf->header->flags & cfHasValues) != 0)
+		{
+		if (cf->scan + sizeof(valtype) > cf->scanEnd) goto corrupt;
+		if (cf->valCol != -1) memcpy (val, cf->scan, sizeof(valtype));
+		cf->scan += sizeof(valtype);
+		}
+	if (cf->valCol == -1) *val = 1.0;
+
+	cf->remaining--;
+	return true;
+
+corrupt:
+	fprintf (stderr, "compiled interval file \"%s\" is corrupt\n", cf->filename);
+	exit (EXIT_FAILURE);
+	return false; // (never reaches here)
+	}
+
+
+void close_compiled_file
+   (compiledfile*	cf)
+	{
+	munmap (cf->base, cf->size);
+	free (cf);
+	}
+
+//----------
+//
+// encode_u32, decode_u32--
+//	Write or read a variable-length unsigned integer.
+//
+//----------
+
+static u32 encode_u32
+   (unsigned char*	buffer,
+	u32				v)
+	{
+	u32				len = 0;
+
+	while (v >= 0x80)
+		{
+		buffer[len++] = (unsigned char) (v | 0x80);
+		v >>= 7;
+		}
+	buffer[len++] = (unsigned char) v;
+
+	return len;
+	}
+
+
+static u32 decode_u32
+   (compiledfile*	cf)
+	{
+	u32				v = 0;
+	int				shift;
+	unsigned char	b;
+
+	for (shift=0 ; shift<35 ; shift+=7)
+		{
+		if (cf->scan >= cf->scanEnd) break;
+		b = *(cf->scan++);
+		v |= ((u32) (b & 0x7F)) << shift;
+		if ((b & 0x80) == 0) return v;
+		}
+
+	fprintf (stderr, "compiled interval file \"%s\" is corrupt\n", cf->filename);
+	exit (EXIT_FAILURE);
+	return 0; // (never reaches here)
+	}
@@ -0,0 +1,20 @@
+#ifndef compiled_H				// (prevent multiple inclusion)
+#define compiled_H
+
+// compiledfile is a compiled (binary) interval file opened for reading;  its
+// contents are private to compiled.c
+
+typedef struct compiledfile compiledfile;
+
+// functions in this module
+
+int           compile_main             (int argc, char** argv);
+int           is_compiled_file         (char* filename);
+compiledfile* open_compiled_file       (char* filename, int valCol);
+void          seek_compiled_chromosome (compiledfile* cf, char* chrom);
+int           next_compiled_interval   (compiledfile* cf,
+                                        char** chrom, u32* start, u32* end,
+                                        valtype* val);
+void          close_compiled_file      (compiledfile* cf);
+
+#endif // compiled_H
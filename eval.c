@@ -0,0 +1,1322 @@
+// eval.c-- genodsp operator evaluating an arithmetic expression
+
+#include <stdlib.h>
+#define  true  1
+#define  false 0
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdarg.h>
+#include <math.h>
+#include <float.h>
+#include "utilities.h"
+#include "genodsp_interface.h"
+#include "eval.h"
+
+//----------
+//
+// expression bytecode--
+//
+// An expression is compiled to a program for a stack machine.  Each
+// instruction works on a block of positions at once (evalBlockLen of them),
+// so that the inner loops are short, simple and vectorizable, and the whole
+// expression is evaluated in one pass over the signal.
+//
+// Operands on the stack are pointers to blocks;  pushing a signal just points
+// into that signal's vector, without copying.  Results are written to the
+// stack slot's own buffer.
+//
+//----------
+
+#define evalBlockLen 256
+
+enum
+	{
+	ev_signal,						// push a signal (arg is its index)
+	ev_const,						// push a constant (arg is its index)
+	ev_neg,   ev_not,
+	ev_abs,   ev_sqrt,  ev_exp,   ev_log,   ev_log2,  ev_log10,
+	ev_floor, ev_ceil,  ev_round,
+	ev_add,   ev_sub,   ev_mul,   ev_div,   ev_mod,   ev_pow,
+	ev_min,   ev_max,
+	ev_lt,    ev_le,    ev_gt,    ev_ge,    ev_eq,    ev_ne,
+	ev_and,   ev_or,
+	ev_if
+	};
+
+typedef struct evalinstr
+	{
+	int			opcode;			// one of ev_signal, etc.
+	u32			arg;			// operand (for ev_signal and ev_const)
+	} evalinstr;
+
+// functions that can be called in an expression
+
+typedef struct evalfunc
+	{
+	char*		name;
+	int			numArgs;
+	int			opcode;
+	} evalfunc;
+
+static evalfunc evalFuncs[] =
+	{{ "abs"   , 1, ev_abs   },
+	 { "sqrt"  , 1, ev_sqrt  },
+	 { "exp"   , 1, ev_exp   },
+	 { "log"   , 1, ev_log   },
+	 { "ln"    , 1, ev_log   },
+	 { "log2"  , 1, ev_log2  },
+	 { "log10" , 1, ev_log10 },
+	 { "floor" , 1, ev_floor },
+	 { "ceil"  , 1, ev_ceil  },
+	 { "round" , 1, ev_round },
+	 { "min"   , 2, ev_min   },
+	 { "max"   , 2, ev_max   },
+	 { "pow"   , 2, ev_pow   },
+	 { "if"    , 3, ev_if    }};
+
+#define evalFuncsLen (sizeof(evalFuncs)/sizeof(evalFuncs[0]))
+
+// a secondary signal, read from a file or register
+
+typedef struct evalsignal
+	{
+	char*		name;			// the name used in the expression
+	char*		source;			// file or register name
+	int			byChromosome;	// true => the source can be read one
+								//         .. chromosome at a time
+	valtype**	genomeV;		// (when not byChromosome) the source's vector
+								// .. for each chromosome, indexed as
+								// .. chromsSorted
+	rangefile*	rf;				// (for op_eval_range) the source being read
+	} evalsignal;
+
+// a constant;  constants that come from named variables are fetched anew
+// for each chromosome
+
+typedef struct evalconst
+	{
+	valtype		val;
+	char*		varName;		// (NULL if this is a literal)
+	} evalconst;
+
+// parser state
+
+typedef struct evalparser
+	{
+	struct dspop_eval* op;
+	char*		name;			// the operator's name, for error messages
+	char*		text;			// the whole expression
+	char*		scan;			// current position in the expression
+	u32			depth;			// current stack depth
+	} evalparser;
+
+// private dspop subtype
+
+typedef struct dspop_eval
+	{
+	dspop		common;			// common elements shared with all operators
+	char*		expression;
+	int			valColumn;
+	int			originOne;
+	u32			numSignals;		// signals;  signals[0] is the current signal,
+	evalsignal*	signals;		// .. "x"
+	u32			numConsts;
+	evalconst*	consts;
+	u32			numInstrs;
+	evalinstr*	program;
+	u32			maxDepth;		// maximum stack depth the program needs
+	valtype*	stackBuffers;	// maxDepth blocks of evalBlockLen values
+	valtype**	sigV;			// (for op_eval_range) the vector for each
+	u32			tileLen;		// .. signal, and buffers to read each
+	valtype*	tileBuffers;	// .. secondary signal into, tileLen values each
+	int			debug;
+	} dspop_eval;
+
+// prototypes for private functions
+
+static void    compile_expression (dspop_eval* op, char* name);
+static void    parse_or           (evalparser* p);
+static void    parse_and          (evalparser* p);
+static void    parse_compare      (evalparser* p);
+static void    parse_sum          (evalparser* p);
+static void    parse_product      (evalparser* p);
+static void    parse_unary        (evalparser* p);
+static void    parse_power        (evalparser* p);
+static void    parse_primary      (evalparser* p);
+static int     parse_token        (evalparser* p, char* token);
+static void    emit               (evalparser* p, int opcode, u32 arg);
+static u32     add_const          (evalparser* p, valtype val, char* varName);
+static void    parse_error        (evalparser* p, char* message);
+static valtype fold               (int opcode, valtype a, valtype b, valtype c);
+static void    run_program        (dspop_eval* op, valtype** sigV, u32 vLen,
+                                   valtype* v);
+static void    load_signal        (dspop_eval* op, evalsignal* sig,
+                                   char* chrom, valtype* sv);
+static void    dump_program       (dspop_eval* op, FILE* f);
+
+//----------
+// [[-- a dsp operation function group, operating on a single chromosome (or
+//      on the whole genome, if a secondary signal must be read in one pass)
+//      --]]
+//
+// See genodsp_interface.h, "headers for dsp operator function groups" for
+// function descriptions and argument details.
+//
+//----------
+//
+// op_eval--
+//	Replace the signal with the value of an expression, computed at each
+//	position.
+//
+//----------
+
+// op_eval_short--
+
+void op_eval_short (char* name, int nameWidth, FILE* f, char* indent)
+	{
+	int nameFill = nameWidth-2 - strlen(name);
+	if (indent == NULL) indent = "";
+
+	if (nameFill > 0) fprintf (f, "%s%s:%*s", indent, name, nameFill+1, " ");
+	             else fprintf (f, "%s%s: ", indent, name);
+
+	fprintf (f, "replace the signal with the value of an expression\n");
+	}
+
+
+// op_eval_usage--
+
+void op_eval_usage (char* name, FILE* f, char* indent)
+	{
+	if (indent == NULL) indent = "";
+	//             3456789-123456789-123456789-123456789-123456789-123456789-123456789-123456789
+	fprintf (f, "%sReplace the signal with the value of an expression, computed at each\n",         indent);
+	fprintf (f, "%sposition.  In the expression, x is the current signal.  Other signals can be\n",  indent);
+	fprintf (f, "%sread from files or registers and given names with --signal:<name>.  Any other\n", indent);
+	fprintf (f, "%sname is a named variable (e.g. percentile99).\n",                                 indent);
+	fprintf (f, "%s\n", indent);
+	fprintf (f, "%sExpressions may use + - * / %% ^ (power), comparisons (< <= > >= == !=),\n",      indent);
+	fprintf (f, "%s&& || and !, and the functions abs, sqrt, exp, log, log2, log10, floor, ceil,\n", indent);
+	fprintf (f, "%sround, min(a,b), max(a,b), pow(a,b) and if(cond,a,b).  Comparisons and\n",        indent);
+	fprintf (f, "%slogical operators give 1 or 0.\n",                                                indent);
+	fprintf (f, "%s\n", indent);
+	fprintf (f, "%sFor example, %s \"max(0,log2((x+1)/(y+1)))\" --signal:y=control.dat\n",          indent, name);
+	fprintf (f, "%s\n", indent);
+	fprintf (f, "%susage: %s <expression> [options]\n", indent, name);
+	fprintf (f, "%s  --signal:<name>=<file>   read a signal from a file (or register), for use\n",   indent);
+	fprintf (f, "%s                           in the expression as <name>;  positions not\n",        indent);
+	fprintf (f, "%s                           covered by the file are zero\n",                       indent);
+	fprintf (f, "%s  --value=<col>            signal files contain a value in the specified\n",      indent);
+	fprintf (f, "%s                           column;  by default we assume this is in column 4\n",  indent);
+	fprintf (f, "%s  --novalue                signal files have no value (value given is 1)\n",      indent);
+	fprintf (f, "%s  --origin=one             signal files are origin-one, closed\n",                indent);
+	fprintf (f, "%s  --origin=zero            signal files are origin-zero, half-open\n",            indent);
+	fprintf (f, "%s                           (this is the default)\n",                              indent);
+	fprintf (f, "%s  --debug                  report the compiled program to stderr\n",              indent);
+	}
+
+
+// op_eval_parse--
+
+dspop* op_eval_parse (char* name, int _argc, char** _argv)
+	{
+	dspop_eval*	op;
+	int			argc = _argc;
+	char**		argv = _argv;
+	char*		arg, *argVal, *sigName;
+	evalsignal*	sig;
+	u32			sigIx, constIx, numBytes;
+	int			tempInt;
+
+	// allocate and initialize our control record
+
+	op = (dspop_eval*) malloc (sizeof(dspop_eval));
+	if (op == NULL) goto cant_allocate;
+
+	op->common.atRandom = false;
+
+	op->expression   = NULL;
+	op->valColumn    = (int) get_named_global ("valColumn", 4-1);
+	op->originOne    = (int) get_named_global ("originOne", false);
+	op->numConsts    = 0;
+	op->consts       = NULL;
+	op->numInstrs    = 0;
+	op->program      = NULL;
+	op->maxDepth     = 0;
+	op->stackBuffers = NULL;
+	op->sigV         = NULL;
+	op->tileLen      = 0;
+	op->tileBuffers  = NULL;
+	op->debug        = false;
+
+	// the current signal is always signal 0
+
+	numBytes = (argc+1) * sizeof(evalsignal);
+	op->signals = (evalsignal*) malloc (numBytes);
+	if (op->signals == NULL) goto cant_allocate_signals;
+	op->numSignals = 1;
+	op->signals[0].name         = copy_string ("x");
+	op->signals[0].source       = NULL;
+	op->signals[0].byChromosome = true;
+	op->signals[0].genomeV      = NULL;
+	op->signals[0].rf           = NULL;
+
+	// parse arguments
+
+	while (argc > 0)
+		{
+		arg    = argv[0];
+		argVal = strchr(arg,'=');
+		if (argVal != NULL) argVal++;
+
+		// --signal:<name>=<file>
+
+		if (strcmp_prefix (arg, "--signal:") == 0)
+			{
+			sigName = arg + strlen("--signal:");
+			if ((argVal == NULL) || (argVal-1 == sigName) || (*argVal == 0))
+				chastise ("[%s] expected --signal:<name>=<file> (\"%s\")\n", name, arg);
+			for (sigIx=0 ; sigIx<op->numSignals ; sigIx++)
+				{
+				if ((strncmp (op->signals[sigIx].name, sigName, argVal-1-sigName) == 0)
+				 && (strlen (op->signals[sigIx].name) == (size_t) (argVal-1-sigName)))
+					chastise ("[%s] signal name is already in use (\"%s\")\n", name, arg);
+				}
+
+			sig = &op->signals[op->numSignals++];
+			sig->name         = copy_string (sigName);
+			sig->name[argVal-1-sigName] = 0;
+			sig->source       = copy_string (argVal);
+			sig->byChromosome = false;
+			sig->genomeV      = NULL;
+			sig->rf           = NULL;
+			goto next_arg;
+			}
+
+		// --value=<col>
+
+		if ((strcmp (arg, "--novalue") == 0)
+		 || (strcmp (arg, "--value=none") == 0))
+			{ op->valColumn = -1;  goto next_arg; }
+
+		if (strcmp_prefix (arg, "--value=") == 0)
+			{
+			tempInt = string_to_int (argVal) - 1;
+			if (tempInt == -1)
+				chastise ("[%s] value column can't be 0 (\"%s\")\n", name, arg);
+			if (tempInt < 0)
+				chastise ("[%s] value column can't be negative (\"%s\")\n", name, arg);
+			if (tempInt < 3)
+				chastise ("[%s] value column can't be 1, 2 or 3 (\"%s\")\n", name, arg);
+			op->valColumn = tempInt;
+			goto next_arg;
+			}
+
+		// --origin=one, --origin=zero
+
+		if ((strcmp (arg, "--origin=one") == 0)
+		 || (strcmp (arg, "--origin=1")   == 0))
+			{ op->originOne = true;  goto next_arg; }
+
+		if ((strcmp (arg, "--origin=zero") == 0)
+		 || (strcmp (arg, "--origin=0")    == 0))
+			{ op->originOne = false;  goto next_arg; }
+
+		// --debug
+
+		if (strcmp (arg, "--debug") == 0)
+			{ op->debug = true;  goto next_arg; }
+
+		// unknown -- argument
+
+		if (strcmp_prefix (arg, "--") == 0)
+			chastise ("[%s] Can't understand \"%s\"\n", name, arg);
+
+		// <expression>
+
+		if (op->expression == NULL)
+			{
+			op->expression = copy_string (arg);
+			goto next_arg;
+			}
+
+		// unknown argument
+
+		chastise ("[%s] Can't understand \"%s\"\n", name, arg);
+
+	next_arg:
+		argv++;  argc--;
+		continue;
+		}
+
+	if (op->expression == NULL) goto expression_missing;
+
+	// register our use of the secondary signals;  if any of them must be read
+	// in one pass, we have to run on the whole genome
+
+	for (sigIx=1 ; sigIx<op->numSignals ; sigIx++)
+		{
+		sig = &op->signals[sigIx];
+		note_interval_file (sig->source, op->valColumn);
+		sig->byChromosome = interval_file_by_chromosome (sig->source);
+		if (!sig->byChromosome) op->common.atRandom = true;
+		}
+
+	// compile the expression
+
+	compile_expression (op, name);
+
+	if (op->debug)
+		{
+		fprintf (stderr, "[%s] \"%s\"\n", name, op->expression);
+		dump_program (op, stderr);
+		}
+
+	numBytes = op->maxDepth * evalBlockLen * sizeof(valtype);
+	op->stackBuffers = (valtype*) malloc (numBytes);
+	if (op->stackBuffers == NULL) goto cant_allocate_stack;
+
+	numBytes = op->numSignals * sizeof(valtype*);
+	op->sigV = (valtype**) malloc (numBytes);
+	if (op->sigV == NULL) goto cant_allocate_signals;
+
+	declare_footprint (footprintPointwise, 0, 0);
+
+	for (constIx=0 ; constIx<op->numConsts ; constIx++)
+		{
+		if (op->consts[constIx].varName != NULL)
+			declare_resource_use (resourceVariable, op->consts[constIx].varName, useRead);
+		}
+
+	return (dspop*) op;
+
+cant_allocate:
+	fprintf (stderr, "[%s] failed to allocate control record (%d bytes)\n",
+	                 name, (int) sizeof(dspop_eval));
+	exit(EXIT_FAILURE);
+
+cant_allocate_signals:
+	fprintf (stderr, "[%s] failed to allocate signal records (%u bytes)\n",
+	                 name, numBytes);
+	exit(EXIT_FAILURE);
+
+cant_allocate_stack:
+	fprintf (stderr, "[%s] failed to allocate evaluation stack (%u bytes)\n",
+	                 name, numBytes);
+	exit(EXIT_FAILURE);
+
+expression_missing:
+	fprintf (stderr, "[%s] no expression was provided\n",
+	                 name);
+	exit(EXIT_FAILURE);
+	return NULL; // (never reaches here)
+	}
+
+
+// op_eval_free--
+
+void op_eval_free (dspop* _op)
+	{
+	dspop_eval*	op = (dspop_eval*) _op;
+	u32			ix;
+
+	for (ix=0 ; ix<op->numSignals ; ix++)
+		{
+		if (op->signals[ix].name   != NULL) free (op->signals[ix].name);
+		if (op->signals[ix].source != NULL) free (op->signals[ix].source);
+		if (op->signals[ix].rf     != NULL) close_range_file (op->signals[ix].rf);
+		}
+	for (ix=0 ; ix<op->numConsts ; ix++)
+		{ if (op->consts[ix].varName != NULL) free (op->consts[ix].varName); }
+
+	if (op->expression   != NULL) free (op->expression);
+	if (op->signals      != NULL) free (op->signals);
+	if (op->consts       != NULL) free (op->consts);
+	if (op->program      != NULL) free (op->program);
+	if (op->stackBuffers != NULL) free (op->stackBuffers);
+	if (op->sigV         != NULL) free (op->sigV);
+	if (op->tileBuffers  != NULL) free (op->tileBuffers);
+	free (op);
+	}
+
+
+// op_eval_apply--
+
+void op_eval_apply
+   (arg_dont_complain(dspop*	_op),
+	arg_dont_complain(char*		vName),
+	arg_dont_complain(u32		vLen),
+	arg_dont_complain(valtype*	_v))
+	{
+	dspop_eval*	op = (dspop_eval*) _op;
+	spec**		chroms;
+	spec*		oneChrom[2];
+	spec*		chromSpec;
+	evalsignal*	sig;
+	evalconst*	c;
+	valtype**	sigV;
+	valtype*	sv;
+	char		prevChrom[1001];
+	char*		chrom;
+	u32			start, end, o, ix, chromIx, sigIx, numChroms, numBytes;
+	valtype		val;
+	intervalfile* f;
+	int			ok;
+
+	chroms = chromosomes_to_apply (vName, oneChrom);
+	o = (op->originOne)? 1 : 0;
+
+	// read any secondary signals that can't be read one chromosome at a time;
+	// these are read in one pass, into a separate vector for each chromosome
+
+	for (numChroms=0 ; chromsSorted[numChroms]!=NULL ; numChroms++) ;
+
+	for (sigIx=1 ; sigIx<op->numSignals ; sigIx++)
+		{
+		sig = &op->signals[sigIx];
+		if (sig->byChromosome) continue;
+
+		numBytes = numChroms * sizeof(valtype*);
+		sig->genomeV = (valtype**) calloc (numChroms, sizeof(valtype*));
+		if (sig->genomeV == NULL) goto cant_allocate;
+		for (chromIx=0 ; chromIx<numChroms ; chromIx++)
+			{
+			chromSpec = chromsSorted[chromIx];
+			numBytes = chromSpec->length * sizeof(valtype);
+			sig->genomeV[chromIx] = (valtype*) calloc (chromSpec->length, sizeof(valtype));
+			if (sig->genomeV[chromIx] == NULL) goto cant_allocate;
+			}
+
+		f = open_interval_file (sig->source, op->valColumn, op->originOne, "*");
+		if (f == NULL) goto cant_open_file;
+
+		prevChrom[0] = 0;
+		sv = NULL;
+		while (true)
+			{
+			ok = next_interval (f, &chrom, &start, &end, &val);
+			if (!ok) break;
+
+			if (strcmp (chrom, prevChrom) != 0)
+				{
+				sv = NULL;
+				chromSpec = find_chromosome_spec (chrom);
+				if (chromSpec != NULL)
+					{
+					for (chromIx=0 ; chromsSorted[chromIx]!=chromSpec ; chromIx++) ;
+					sv = sig->genomeV[chromIx];
+					}
+				safe_strncpy (prevChrom, chrom, sizeof(prevChrom)-1);
+				}
+
+			if (sv == NULL) continue;
+
+			start -= o;
+			if (chromSpec->start == 0)
+				{ if (end > chromSpec->length) goto chrom_too_short; }
+			else
+				{
+				if (end <= chromSpec->start) continue;
+				start = (start <= chromSpec->start)? 0 : start - chromSpec->start;
+				end   = end - chromSpec->start;
+				if (start >= chromSpec->length) continue;
+				if (end   >  chromSpec->length) end = chromSpec->length;
+				}
+
+			for (ix=start ; ix<end ; ix++)
+				sv[ix] += val;
+			}
+
+		close_interval_file (f, /*destroy*/ false);
+		}
+
+	// evaluate the expression on each chromosome
+
+	numBytes = op->numSignals * sizeof(valtype*);
+	sigV = (valtype**) malloc (numBytes);
+	if (sigV == NULL) goto cant_allocate;
+
+	for (chromIx=0 ; chroms[chromIx]!=NULL ; chromIx++)
+		{
+		chromSpec = chroms[chromIx];
+		if ((trackOperations) && (chroms == chromsSorted))
+			fprintf (stderr, "%s(%s)\n", op->common.name, chromSpec->chrom);
+
+		// fetch named variables (anew for each chromosome, since a variable
+		// may have a separate value for each)
+
+		for (ix=0 ; ix<op->numConsts ; ix++)
+			{
+			c = &op->consts[ix];
+			if (c->varName == NULL) continue;
+			if (!chrom_named_global_exists (c->varName, chromSpec->chrom, &c->val))
+				goto no_variable;
+			}
+
+		sigV[0] = chromSpec->valVector;
+		for (sigIx=1 ; sigIx<op->numSignals ; sigIx++)
+			{
+			sig = &op->signals[sigIx];
+			if (sig->byChromosome)
+				{
+				sigV[sigIx] = get_sized_scratch_vector (chromSpec->length);
+				load_signal (op, sig, chromSpec->chrom, sigV[sigIx]);
+				}
+			else
+				{
+				for (ix=0 ; chromsSorted[ix]!=chromSpec ; ix++) ;
+				sigV[sigIx] = sig->genomeV[ix];
+				}
+			}
+
+		run_program (op, sigV, chromSpec->length, chromSpec->valVector);
+
+		for (sigIx=1 ; sigIx<op->numSignals ; sigIx++)
+			{
+			if (op->signals[sigIx].byChromosome)
+				release_scratch_vector (sigV[sigIx]);
+			}
+		}
+
+	free (sigV);
+
+	for (sigIx=1 ; sigIx<op->numSignals ; sigIx++)
+		{
+		sig = &op->signals[sigIx];
+		if (sig->genomeV == NULL) continue;
+		for (chromIx=0 ; chromIx<numChroms ; chromIx++)
+			free (sig->genomeV[chromIx]);
+		free (sig->genomeV);
+		sig->genomeV = NULL;
+		}
+
+	// success
+
+	return;
+
+	//////////
+	// failure exits
+	//////////
+
+no_variable:
+	fprintf (stderr, "[%s] attempt to use %s in expression failed (no such variable)\n",
+	                 op->common.name, c->varName);
+	exit (EXIT_FAILURE);
+
+cant_allocate:
+	fprintf (stderr, "[%s] failed to allocate %s bytes\n",
+	                 op->common.name, ucommatize(numBytes));
+	exit (EXIT_FAILURE);
+
+cant_open_file:
+	fprintf (stderr, "[%s] can't open \"%s\" for reading\n",
+	                 op->common.name, sig->source);
+	exit (EXIT_FAILURE);
+
+chrom_too_short:
+	fprintf (stderr, "[%s] in \"%s\", %s %d %d is beyond the end of the chromosome (L=%d)\n",
+	                 op->common.name, sig->source, chrom, start, end, chromSpec->length);
+	exit (EXIT_FAILURE);
+	}
+
+
+// op_eval_range--
+//	(only used when every secondary signal can be read one chromosome at a
+//	time)
+
+void op_eval_range
+   (arg_dont_complain(dspop*	_op),
+	arg_dont_complain(char*		vName),
+	arg_dont_complain(u32		vLen),
+	arg_dont_complain(valtype*	v),
+	arg_dont_complain(u32		start),
+	arg_dont_complain(u32		end))
+	{
+	dspop_eval*	op = (dspop_eval*) _op;
+	evalsignal*	sig;
+	evalconst*	c;
+	valtype*	sv;
+	u32			tileLen = end - start;
+	u32			pieceStart, pieceEnd, ix, sigIx;
+	size_t		numBytes;
+	valtype		val;
+
+	// (first subrange) fetch named variables, and open the secondary signals
+
+	if (start == 0)
+		{
+		for (ix=0 ; ix<op->numConsts ; ix++)
+			{
+			c = &op->consts[ix];
+			if (c->varName == NULL) continue;
+			if (!chrom_named_global_exists (c->varName, vName, &c->val))
+				goto no_variable;
+			}
+
+		for (sigIx=1 ; sigIx<op->numSignals ; sigIx++)
+			{
+			sig = &op->signals[sigIx];
+			if (sig->rf != NULL) close_range_file (sig->rf);
+			sig->rf = open_range_file (_op->name, sig->source, op->valColumn, op->originOne,
+			                           vName, /*skipZeros*/ false, /*disjoint*/ false);
+			if (sig->rf == NULL) goto cant_open_file;
+			}
+		}
+
+	// make sure we have room to read this subrange of each secondary signal
+
+	if ((op->numSignals > 1) && (tileLen > op->tileLen))
+		{
+		numBytes = (op->numSignals-1) * (size_t) tileLen * sizeof(valtype);
+		if (op->tileBuffers != NULL) free (op->tileBuffers);
+		op->tileBuffers = (valtype*) malloc (numBytes);
+		if (op->tileBuffers == NULL) goto cant_allocate;
+		op->tileLen = tileLen;
+		}
+
+	// read this subrange of each secondary signal;  the buffers are indexed
+	// from the start of the subrange
+
+	op->sigV[0] = v + start;
+	for (sigIx=1 ; sigIx<op->numSignals ; sigIx++)
+		{
+		sig = &op->signals[sigIx];
+		sv  = op->tileBuffers + (sigIx-1) * (size_t) op->tileLen;
+		for (ix=0 ; ix<tileLen ; ix++)
+			sv[ix] = 0.0;
+
+		while (next_range_interval (sig->rf, start, end, &pieceStart, &pieceEnd, &val))
+			{
+			for (ix=pieceStart ; ix<pieceEnd ; ix++)
+				sv[ix-start] += val;
+			}
+
+		op->sigV[sigIx] = sv;
+		if (end == vLen)
+			{ close_range_file (sig->rf);  sig->rf = NULL; }
+		}
+
+	run_program (op, op->sigV, tileLen, v + start);
+
+	return;
+
+	//////////
+	// failure exits
+	//////////
+
+no_variable:
+	fprintf (stderr, "[%s] attempt to use %s in expression failed (no such variable)\n",
+	                 _op->name, c->varName);
+	exit (EXIT_FAILURE);
+
+cant_allocate:
+	fprintf (stderr, "[%s] failed to allocate %s bytes\n",
+	                 _op->name, ucommatize(numBytes));
+	exit (EXIT_FAILURE);
+
+cant_open_file:
+	fprintf (stderr, "[%s] can't open \"%s\" for reading\n",
+	                 _op->name, sig->source);
+	exit (EXIT_FAILURE);
+	}
+
+//----------
+//
+// load_signal--
+//	Read one chromosome of a secondary signal into a vector.
+//
+//----------
+//
+// Arguments:
+//	dspop_eval*	op:		The operator.
+//	evalsignal*	sig:	The signal to read.
+//	char*		chrom:	The chromosome to read.
+//	valtype*	sv:		The vector to read it into;  this is as long as the
+//						.. longest chromosome.
+//
+// Returns:
+//	(nothing);  failures result in program termination.
+//
+//----------
+
+static void load_signal
+   (dspop_eval*		op,
+	evalsignal*		sig,
+	char*			_chrom,
+	valtype*		sv)
+	{
+	intervalfile*	f;
+	spec*			chromSpec;
+	char*			chrom;
+	u32				start, end, o, ix;
+	valtype			val;
+	int				ok;
+
+	chromSpec = find_chromosome_spec (_chrom);
+	for (ix=0 ; ix<chromSpec->length ; ix++)
+		sv[ix] = 0.0;
+
+	f = open_interval_file (sig->source, op->valColumn, op->originOne, _chrom);
+	if (f == NULL) goto cant_open_file;
+
+	o = (op->originOne)? 1 : 0;
+	while (true)
+		{
+		ok = next_interval (f, &chrom, &start, &end, &val);
+		if (!ok) break;
+
+		start -= o;
+		if (chromSpec->start == 0)
+			{ if (end > chromSpec->length) goto chrom_too_short; }
+		else
+			{
+			if (end <= chromSpec->start) continue;
+			start = (start <= chromSpec->start)? 0 : start - chromSpec->start;
+			end   = end - chromSpec->start;
+			if (start >= chromSpec->length) continue;
+			if (end   >  chromSpec->length) end = chromSpec->length;
+			}
+
+		for (ix=start ; ix<end ; ix++)
+			sv[ix] += val;
+		}
+
+	close_interval_file (f, /*destroy*/ false);
+	return;
+
+cant_open_file:
+	fprintf (stderr, "[%s] can't open \"%s\" for reading\n",
+	                 op->common.name, sig->source);
+	exit (EXIT_FAILURE);
+
+chrom_too_short:
+	fprintf (stderr, "[%s] in \"%s\", %s %d %d is beyond the end of the chromosome (L=%d)\n",
+	                 op->common.name, sig->source, chrom, start, end, chromSpec->length);
+	exit (EXIT_FAILURE);
+	}
+
+//----------
+//
+// run_program--
+//	Evaluate the compiled expression along a chromosome.
+//
+//----------
+//
+// Arguments:
+//	dspop_eval*	op:		The operator.
+//	valtype**	sigV:	The vector for each signal (sigV[0] is the current
+//						.. signal).
+//	u32			vLen:	The length of the vectors.
+//	valtype*	v:		The vector to write the result to.  This may be the
+//						.. same as sigV[0].
+//
+// Returns:
+//	(nothing)
+//
+//----------
+
+static void run_program
+   (dspop_eval*	op,
+	valtype**	sigV,
+	u32			vLen,
+	valtype*	v)
+	{
+	evalinstr*	instr, *instrEnd = op->program + op->numInstrs;
+	valtype*	slot[op->maxDepth];		// the block each stack entry refers to
+	valtype*	a, *b, *c, *out;
+	valtype		k;
+	u32			blockStart, n, i, sp;
+
+	for (blockStart=0 ; blockStart<vLen ; blockStart+=evalBlockLen)
+		{
+		n = vLen - blockStart;
+		if (n > evalBlockLen) n = evalBlockLen;
+
+		sp = 0;
+		for (instr=op->program ; instr<instrEnd ; instr++)
+			{
+			switch (instr->opcode)
+				{
+				// operands
+
+				case ev_signal:
+					slot[sp++] = sigV[instr->arg] + blockStart;
+					continue;
+				case ev_const:
+					out = op->stackBuffers + sp*evalBlockLen;
+					k   = op->consts[instr->arg].val;
+					for (i=0 ; i<n ; i++) out[i] = k;
+					slot[sp++] = out;
+					continue;
+
+				// unary operators and functions
+
+				#define unary(expr)                    \
+					out = op->stackBuffers + (sp-1)*evalBlockLen; \
+					a = slot[sp-1];                    \
+					for (i=0 ; i<n ; i++) out[i] = expr; \
+					slot[sp-1] = out;                  \
+					continue;
+
+				case ev_neg:   unary (-a[i])
+				case ev_not:   unary ((a[i] == 0.0)? 1.0 : 0.0)
+				case ev_abs:   unary (fabs  (a[i]))
+				case ev_sqrt:  unary (sqrt  (a[i]))
+				case ev_exp:   unary (exp   (a[i]))
+				case ev_log:   unary (log   (a[i]))
+				case ev_log2:  unary (log2  (a[i]))
+				case ev_log10: unary (log10 (a[i]))
+				case ev_floor: unary (floor (a[i]))
+				case ev_ceil:  unary (ceil  (a[i]))
+				case ev_round: unary (round (a[i]))
+
+				// binary operators and functions
+
+				#define binary(expr)                   \
+					out = op->stackBuffers + (sp-2)*evalBlockLen; \
+					a = slot[sp-2];  b = slot[sp-1];   \
+					for (i=0 ; i<n ; i++) out[i] = expr; \
+					slot[--sp-1] = out;                \
+					continue;
+
+				case ev_add:   binary (a[i] + b[i])
+				case ev_sub:   binary (a[i] - b[i])
+				case ev_mul:   binary (a[i] * b[i])
+				case ev_div:   binary (a[i] / b[i])
+				case ev_mod:   binary (fmod (a[i], b[i]))
+				case ev_pow:   binary (pow  (a[i], b[i]))
+				case ev_min:   binary ((b[i] < a[i])? b[i] : a[i])
+				case ev_max:   binary ((b[i] > a[i])? b[i] : a[i])
+				case ev_lt:    binary ((a[i] <  b[i])? 1.0 : 0.0)
+				case ev_le:    binary ((a[i] <= b[i])? 1.0 : 0.0)
+				case ev_gt:    binary ((a[i] >  b[i])? 1.0 : 0.0)
+				case ev_ge:    binary ((a[i] >= b[i])? 1.0 : 0.0)
+				case ev_eq:    binary ((a[i] == b[i])? 1.0 : 0.0)
+				case ev_ne:    binary ((a[i] != b[i])? 1.0 : 0.0)
+				case ev_and:   binary (((a[i] != 0.0) && (b[i] != 0.0))? 1.0 : 0.0)
+				case ev_or:    binary (((a[i] != 0.0) || (b[i] != 0.0))? 1.0 : 0.0)
+
+				#undef unary
+				#undef binary
+
+				// if(cond,a,b)
+
+				case ev_if:
+					out = op->stackBuffers + (sp-3)*evalBlockLen;
+					c = slot[sp-3];  a = slot[sp-2];  b = slot[sp-1];
+					for (i=0 ; i<n ; i++) out[i] = (c[i] != 0.0)? a[i] : b[i];
+					sp -= 2;
+					slot[sp-1] = out;
+					continue;
+				}
+			}
+
+		// copy the result to the signal (unless the result *is* the signal)
+
+		a = slot[0];
+		if (a != v + blockStart)
+			{
+			out = v + blockStart;
+			for (i=0 ; i<n ; i++) out[i] = a[i];
+			}
+		}
+	}
+
+//----------
+//
+// compile_expression--
+//	Compile the operator's expression to bytecode.
+//
+// The grammar, loosest binding first:
+//	or      := and     { "||" and }
+//	and     := compare { "&&" compare }
+//	compare := sum     [ ("<"|"<="|">"|">="|"=="|"!=") sum ]
+//	sum     := product { ("+"|"-") product }
+//	product := unary   { ("*"|"/"|"%") unary }
+//	unary   := ("-"|"+"|"!") unary | power
+//	power   := primary [ "^" unary ]
+//	primary := number | name | name "(" or { "," or } ")" | "(" or ")"
+//
+// Operations whose operands are all literal constants are folded at compile
+// time.
+//
+//----------
+//
+// Arguments:
+//	dspop_eval*	op:		The operator;  the program is written to this.
+//	char*		name:	The operator's name, for error messages.
+//
+// Returns:
+//	(nothing);  failures result in program termination.
+//
+//----------
+
+static void compile_expression
+   (dspop_eval*	op,
+	char*		name)
+	{
+	evalparser	p;
+	u32			numBytes;
+
+	// the program can't be longer than the expression has characters (each
+	// instruction consumes at least one), plus one
+
+	numBytes = (strlen(op->expression) + 1) * sizeof(evalinstr);
+	op->program = (evalinstr*) malloc (numBytes);
+	if (op->program == NULL) goto cant_allocate;
+
+	p.op    = op;
+	p.name  = name;
+	p.text  = op->expression;
+	p.scan  = op->expression;
+	p.depth = 0;
+
+	parse_or (&p);
+	while (isspace (*p.scan)) p.scan++;
+	if (*p.scan != 0) parse_error (&p, "unexpected text");
+	return;
+
+cant_allocate:
+	fprintf (stderr, "[%s] failed to allocate program (%u bytes)\n",
+	                 name, numBytes);
+	exit(EXIT_FAILURE);
+	}
+
+
+static void parse_or (evalparser* p)
+	{
+	parse_and (p);
+	while (parse_token (p, "||"))
+		{ parse_and (p);  emit (p, ev_or, 0); }
+	}
+
+
+static void parse_and (evalparser* p)
+	{
+	parse_compare (p);
+	while (parse_token (p, "&&"))
+		{ parse_compare (p);  emit (p, ev_and, 0); }
+	}
+
+
+static void parse_compare (evalparser* p)
+	{
+	int		opcode;
+
+	parse_sum (p);
+
+	if      (parse_token (p, "<=")) opcode = ev_le;
+	else if (parse_token (p, ">=")) opcode = ev_ge;
+	else if (parse_token (p, "==")) opcode = ev_eq;
+	else if (parse_token (p, "!=")) opcode = ev_ne;
+	else if (parse_token (p, "<"))  opcode = ev_lt;
+	else if (parse_token (p, ">"))  opcode = ev_gt;
+	else return;
+
+	parse_sum (p);
+	emit (p, opcode, 0);
+	}
+
+
+static void parse_sum (evalparser* p)
+	{
+	parse_product (p);
+	while (true)
+		{
+		if      (parse_token (p, "+")) { parse_product (p);  emit (p, ev_add, 0); }
+		else if (parse_token (p, "-")) { parse_product (p);  emit (p, ev_sub, 0); }
+		else break;
+		}
+	}
+
+
+static void parse_product (evalparser* p)
+	{
+	parse_unary (p);
+	while (true)
+		{
+		if      (parse_token (p, "*")) { parse_unary (p);  emit (p, ev_mul, 0); }
+		else if (parse_token (p, "/")) { parse_unary (p);  emit (p, ev_div, 0); }
+		else if (parse_token (p, "%")) { parse_unary (p);  emit (p, ev_mod, 0); }
+		else break;
+		}
+	}
+
+
+static void parse_unary (evalparser* p)
+	{
+	if (parse_token (p, "-"))
+		{ parse_unary (p);  emit (p, ev_neg, 0); }
+	else if (parse_token (p, "+"))
+		parse_unary (p);
+	else if ((p->scan[0] == '!') && (p->scan[1] != '=') && (parse_token (p, "!")))
+		{ parse_unary (p);  emit (p, ev_not, 0); }
+	else
+		parse_power (p);
+	}
+
+
+static void parse_power (evalparser* p)
+	{
+	parse_primary (p);
+	if (parse_token (p, "^"))
+		{ parse_unary (p);  emit (p, ev_pow, 0); }
+	}
+
+
+static void parse_primary (evalparser* p)
+	{
+	dspop_eval*	op = p->op;
+	char*		start, *end;
+	char		nameBuf[101];
+	u32			nameLen, ix, numArgs;
+	valtype		val;
+
+	while (isspace (*p->scan)) p->scan++;
+	start = p->scan;
+
+	// ( expression )
+
+	if (parse_token (p, "("))
+		{
+		parse_or (p);
+		if (!parse_token (p, ")")) parse_error (p, "expected \")\"");
+		return;
+		}
+
+	// number
+
+	if ((isdigit (*start)) || ((*start == '.') && (isdigit (start[1]))))
+		{
+		val = strtod (start, &end);
+		p->scan = end;
+		emit (p, ev_const, add_const (p, val, NULL));
+		return;
+		}
+
+	// name or function call
+
+	if ((!isalpha (*start)) && (*start != '_'))
+		parse_error (p, "expected a number, name or \"(\"");
+
+	for (end=start ; (isalnum (*end)) || (*end == '_') ; end++) ;
+	nameLen = end - start;
+	if (nameLen >= sizeof(nameBuf)) parse_error (p, "name is too long");
+	memcpy (nameBuf, start, nameLen);
+	nameBuf[nameLen] = 0;
+	p->scan = end;
+
+	if (parse_token (p, "("))
+		{
+		for (ix=0 ; ix<evalFuncsLen ; ix++)
+			{ if (strcmp (nameBuf, evalFuncs[ix].name) == 0) break; }
+		if (ix >= evalFuncsLen)
+			{ p->scan = start;  parse_error (p, "unknown function"); }
+
+		for (numArgs=0 ; ; )
+			{
+			parse_or (p);
+			numArgs++;
+			if (!parse_token (p, ",")) break;
+			}
+		if (!parse_token (p, ")")) parse_error (p, "expected \")\"");
+		if (numArgs != (u32) evalFuncs[ix].numArgs)
+			{ p->scan = start;  parse_error (p, "wrong number of arguments"); }
+
+		emit (p, evalFuncs[ix].opcode, 0);
+		return;
+		}
+
+	// constants
+
+	if ((strcmp (nameBuf, "inf") == 0) || (strcmp (nameBuf, "infinity") == 0))
+		{ emit (p, ev_const, add_const (p, INFINITY, NULL));  return; }
+	if (strcmp (nameBuf, "nan") == 0)
+		{ emit (p, ev_const, add_const (p, NAN, NULL));  return; }
+	if (strcmp (nameBuf, "pi") == 0)
+		{ emit (p, ev_const, add_const (p, M_PI, NULL));  return; }
+
+	// signals
+
+	for (ix=0 ; ix<op->numSignals ; ix++)
+		{
+		if (strcmp (nameBuf, op->signals[ix].name) == 0)
+			{ emit (p, ev_signal, ix);  return; }
+		}
+
+	// otherwise, a named variable
+
+	emit (p, ev_const, add_const (p, 0.0, nameBuf));
+	}
+
+
+static int parse_token (evalparser* p, char* token)
+	{
+	u32		tokenLen = strlen(token);
+
+	while (isspace (*p->scan)) p->scan++;
+	if (strncmp (p->scan, token, tokenLen) != 0) return false;
+
+	p->scan += tokenLen;
+	return true;
+	}
+
+
+static void emit (evalparser* p, int opcode, u32 arg)
+	{
+	dspop_eval*	op = p->op;
+	evalinstr*	instr;
+	int			numArgs, ix;
+	valtype		k[3];
+
+	switch (opcode)
+		{
+		case ev_signal: case ev_const:
+			numArgs = 0;  break;
+		case ev_neg:   case ev_not:   case ev_abs:   case ev_sqrt:
+		case ev_exp:   case ev_log:   case ev_log2:  case ev_log10:
+		case ev_floor: case ev_ceil:  case ev_round:
+			numArgs = 1;  break;
+		case ev_if:
+			numArgs = 3;  break;
+		default:
+			numArgs = 2;  break;
+		}
+
+	// fold operations on literal constants;  note that an expression that ends
+	// with a constant push consists of nothing but that push
+
+	if ((numArgs > 0) && (op->numInstrs >= (u32) numArgs))
+		{
+		for (ix=0 ; ix<numArgs ; ix++)
+			{
+			instr = &op->program[op->numInstrs-numArgs+ix];
+			if ((instr->opcode != ev_const)
+			 || (op->consts[instr->arg].varName != NULL)) break;
+			k[ix] = op->consts[instr->arg].val;
+			}
+
+		if (ix == numArgs)
+			{
+			op->numInstrs -= numArgs;
+			p->depth      -= numArgs;
+			op->numConsts -= numArgs;	// (the operands were the most recent
+										//  .. constants added)
+			arg    = add_const (p, fold (opcode, k[0], k[1], k[2]), NULL);
+			opcode = ev_const;
+			numArgs = 0;
+			}
+		}
+
+	instr = &op->program[op->numInstrs++];
+	instr->opcode = opcode;
+	instr->arg    = arg;
+
+	if (numArgs == 0) p->depth++;
+	             else p->depth -= numArgs-1;
+	if (p->depth > op->maxDepth) op->maxDepth = p->depth;
+	}
+
+
+static u32 add_const (evalparser* p, valtype val, char* varName)
+	{
+	dspop_eval*	op = p->op;
+	evalconst*	c;
+	u32			numBytes;
+
+	numBytes = (op->numConsts+1) * sizeof(evalconst);
+	op->consts = (evalconst*) realloc (op->consts, numBytes);
+	if (op->consts == NULL) goto cant_allocate;
+
+	c = &op->consts[op->numConsts];
+	c->val     = val;
+	c->varName = (varName == NULL)? NULL : copy_string (varName);
+	return op->numConsts++;
+
+cant_allocate:
+	fprintf (stderr, "[%s] failed to allocate constants (%u bytes)\n",
+	                 p->name, numBytes);
+	exit(EXIT_FAILURE);
+	return 0; // (never reaches here)
+	}
+
+
+static valtype fold (int opcode, valtype a, valtype b, valtype c)
+	{
+	switch (opcode)
+		{
+		case ev_neg:   return -a;
+		case ev_not:   return (a == 0.0)? 1.0 : 0.0;
+		case ev_abs:   return fabs  (a);
+		case ev_sqrt:  return sqrt  (a);
+		case ev_exp:   return exp   (a);
+		case ev_log:   return log   (a);
+		case ev_log2:  return log2  (a);
+		case ev_log10: return log10 (a);
+		case ev_floor: return floor (a);
+		case ev_ceil:  return ceil  (a);
+		case ev_round: return round (a);
+		case ev_add:   return a + b;
+		case ev_sub:   return a - b;
+		case ev_mul:   return a * b;
+		case ev_div:   return a / b;
+		case ev_mod:   return fmod (a, b);
+		case ev_pow:   return pow  (a, b);
+		case ev_min:   return (b < a)? b : a;
+		case ev_max:   return (b > a)? b : a;
+		case ev_lt:    return (a <  b)? 1.0 : 0.0;
+		case ev_le:    return (a <= b)? 1.0 : 0.0;
+		case ev_gt:    return (a >  b)? 1.0 : 0.0;
+		case ev_ge:    return (a >= b)? 1.0 : 0.0;
+		case ev_eq:    return (a == b)? 1.0 : 0.0;
+		case ev_ne:    return (a != b)? 1.0 : 0.0;
+		case ev_and:   return ((a != 0.0) && (b != 0.0))? 1.0 : 0.0;
+		case ev_or:    return ((a != 0.0) || (b != 0.0))? 1.0 : 0.0;
+		case ev_if:    return (a != 0.0)? b : c;
+		}
+
+	return NAN; // (never reaches here)
+	}
+
+
+static void parse_error (evalparser* p, char* message)
+	{
+	chastise ("[%s] %s in expression, at character %d of \"%s\"\n",
+	          p->name, message, (int) (p->scan - p->text) + 1, p->text);
+	}
+
+//----------
+//
+// dump_program--
+//	Write the compiled program, for debugging.
+//
+//----------
+
+static void dump_program (dspop_eval* op, FILE* f)
+	{
+	static char* opNames[] =
+		{ "signal", "const", "neg",  "not",  "abs",  "sqrt", "exp",  "log",
+		  "log2",   "log10", "floor","ceil", "round","add",  "sub",  "mul",
+		  "div",    "mod",   "pow",  "min",  "max",  "lt",   "le",   "gt",
+		  "ge",     "eq",    "ne",   "and",  "or",   "if" };
+	evalinstr*	instr;
+	evalconst*	c;
+	u32			ix;
+
+	for (ix=0 ; ix<op->numInstrs ; ix++)
+		{
+		instr = &op->program[ix];
+		fprintf (f, "  %2u: %s", ix, opNames[instr->opcode]);
+		if (instr->opcode == ev_signal)
+			fprintf (f, " %s", op->signals[instr->arg].name);
+		else if (instr->opcode == ev_const)
+			{
+			c = &op->consts[instr->arg];
+			if (c->varName != NULL) fprintf (f, " %s", c->varName);
+			                   else fprintf (f, " " valtypeFmt, c->val);
+			}
+		fprintf (f, "\n");
+		}
+	fprintf (f, "  (stack depth %u)\n", op->maxDepth);
+	}
@@ -0,0 +1,10 @@
+#ifndef eval_H					// (prevent multiple inclusion)
+#define eval_H
+
+// functions in this module
+
+dspprototypes(op_eval)
+
+dsprangeprototype(op_eval)
+
+#endif // eval_H
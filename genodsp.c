@@ -10,6 +10,9 @@
 #include <stdarg.h>
 #include <math.h>
 #include <float.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <pthread.h>
 #include "utilities.h"
 
 // program revision vitals (not the best way to do this!))
@@ -35,8 +38,11 @@ char* programName = "genodsp";
 #include "minmax.h"
 #include "morphology.h"
 #include "map.h"
+#include "eval.h"
 #include "opio.h"
 #include "variables.h"
+#include "compiled.h"
+#include "profile.h"
 
 //----------
 //
@@ -57,26 +63,91 @@ int			showUncovered    = uncovered_hide;  // (one of uncovered_show, etc.)
 int			clipToLength     = false;
 int			originOne        = false;
 int			inhibitOutput    = false;
+int			explainPlan      = false;
+int			reportProfile    = false;
+int			countHardware    = false;
+char*		profileFilename  = NULL;
+char*		traceFilename    = NULL;
+u64			memoryBudget     = 0;		// 0 means no limit
+int			reportMemory     = false;
 
 int			dbgInput         = false;
 int			dbgPipe          = false;
 int			dbgGlobals       = false;
 
-// linked lists for scratch vectors
+// storage classes the operator currently being parsed can consume (see
+// accept_signal_storage)
 
-typedef struct svspec			// vector of values
+static int	parsedStorage    = storeValues;
+
+// footprint of the operator currently being parsed (see declare_footprint);
+// -1 means the operator hasn't declared one
+
+static int	parsedFootprint  = -1;
+static u32	parsedHaloLeft   = 0;
+static u32	parsedHaloRight  = 0;
+
+// planner records;  each operator has an opplan, listing the resources it
+// uses (see declare_signal_use and declare_resource_use)
+
+typedef struct planuse
+	{
+	struct planuse* next;		// next use in a linked list
+	int			kind;			// resourceVariable or resourceData
+	int			access;			// useRead or useWrite
+	char*		name;
+	dspop*		producer;		// for a read, the latest earlier operator
+								// .. that writes the same resource (NULL if
+								// .. there is none)
+	} planuse;
+
+typedef struct opplan
+	{
+	u32			opNum;			// position in the pipeline, counting from 1
+	char*		args;			// the operator's arguments (for --explain)
+	int			signalUse;		// useRead and/or useWrite
+	planuse*	uses;			// variables, files and registers
+	char*		dropReason;		// non-NULL => the planner has dropped this
+								// .. operator
+	int			inserted;		// true => the planner added this operator
+								// .. (it follows operator opNum)
+	} opplan;
+
+static int		parsedSignalUse = useRead|useWrite;
+static planuse*	parsedUses      = NULL;
+
+// number of values in each tile, when a series of operators is run over a
+// vector a tile at a time (see apply_tiled)
+
+#define rangeTileLen (16*1024)
+
+// linked list for scratch vectors;  a scratch buffer can serve as a vector of
+// values or of integers, and is only as long as its first requester asked for
+// (so a small chromosome doesn't cause a buffer as long as the longest one)
+
+typedef struct svspec
 	{
 	struct svspec* next;		// next spec in a linked list
 	int			inUse;			// true => someone is using this vector
-	valtype*	vector;			// vector of values
+	int			usedSinceTrim;	// true => the vector has been used since the
+								//         .. last call to trim_scratch_vectors
+	int			mapped;			// true => vector was allocated by mmap
+								//         .. rather than malloc
+	pthread_t	lastUser;		// the thread that most recently used this
+	size_t		numBytes;		// the vector's allocated size
+	void*		vector;			// vector of values or integers
 	} svspec;
 
-typedef struct svispec			// vector of integers
-	{
-	struct svispec* next;		// next spec in a linked list
-	int			inUse;			// true => someone is using this vector
-	s32*		vector;			// vector of values
-	} svispec;
+// memory accounting (see account_memory)
+
+#define memSignal   0
+#define memScratch  1
+#define memCache    2
+#define memRegister 3
+#define numMemKinds 4
+
+static char* memKindNames[numMemKinds] =
+	{ "signal", "scratch vectors", "interval caches", "registers" };
 
 // linked lists for named global variables
 
@@ -84,9 +155,112 @@ typedef struct namedglobal
 	{
 	struct namedglobal* next;	// next variable in a linked list
 	char*	name;				// variable's name (allocated within this block)
-	valtype	v;					// variable's value
+	valtype	v;					// variable's value (for a per-chromosome
+								// .. variable, the most recently set value)
+	int		perChromosome;		// true => the variable has a separate value
+								//         .. for each chromosome
+	valtype* chromV;			// per-chromosome values, indexed the same as
+								// .. chromsSorted (NULL if none have been set)
+	char*	chromHas;			// true => chromV[ix] has been set
 	} namedglobal;
 
+// linked list for named signal registers;  a register holds a copy of the
+// signal, one vector per chromosome (indexed the same as chromsSorted)
+
+typedef struct sigregister
+	{
+	struct sigregister* next;	// next register in a linked list
+	char*		name;			// register's name (allocated within this block)
+	u32			numUses;		// number of operator references to the
+								// .. register (as counted by
+								// .. note_signal_register_use)
+	valtype**	vectors;		// the stored vectors (each NULL until stored)
+	} sigregister;
+
+// cache of interval files that are read by more than one operator;  the
+// intervals are kept in file order, as runs of intervals on the same
+// chromosome
+
+typedef struct cachedrun
+	{
+	u32			chromOffset;	// chromosome name (as an offset into the
+								// .. cachedfile's chromosome name block)
+	u32			firstIx;		// index of the run's first interval
+	u32			numIntervals;	// number of intervals in the run
+	} cachedrun;
+
+typedef struct cachedfile
+	{
+	struct cachedfile* next;	// next file in a linked list
+	char*		filename;		// (allocated within this block)
+	int			valCol;			// the column values were read from
+	u32			numUses;		// number of operator uses (as counted by
+								// .. note_interval_file) not yet closed
+	int			isLoaded;		// true => the intervals below hold the file's
+								//         .. complete contents
+	dev_t		fileDev;		// the file's identity and modification time
+	ino_t		fileIno;		// .. when the intervals were loaded
+	off_t		fileSize;
+	time_t		fileMtime;
+	long		fileMtimeNsec;
+	u32			numRuns, runsSize;
+	cachedrun*	runs;
+	u32			numIntervals, intervalsSize;
+	u32*		starts;
+	u32*		ends;
+	valtype*	vals;
+	char*		chromNames;		// block of zero-terminated chromosome names
+	u32			chromNamesLen, chromNamesSize;
+	size_t		accountedBytes;	// memory counted for this cache (see
+								// .. account_memory)
+	} cachedfile;
+
+struct intervalfile
+	{
+	FILE*		f;				// the file (NULL if reading from the cache or
+								// .. from a compiled file)
+	compiledfile* compiled;		// the compiled file (NULL if reading text)
+	char*		filename;
+	int			valCol;
+	char*		chrom;			// the only chromosome to report (NULL for all)
+	cachedfile*	cache;			// the cache entry (NULL if not cached)
+	sigregister* reg;			// the register (NULL if reading a file)
+	int			originOne;		// (when reading a register) the origin to
+								// .. report intervals in
+	u32			regChromIx;		// (when reading a register) the current
+	u32			regPos;			// .. chromosome (index into chromsSorted) and
+								// .. position
+	int			isLoading;		// true => intervals are being read from the
+								//         .. file and added to the cache
+	u32			runIx;			// (when reading from the cache) the current
+	u32			ix;				// .. run and interval
+	char		lineBuffer[1001];
+	};
+
+struct rangefile
+	{
+	intervalfile* f;			// the underlying file (NULL once it has been
+								// .. read to the end)
+	char*		opName;			// (for error reports)
+	char*		filename;
+	spec*		chromSpec;
+	u32			o;				// 1 => the file is origin-one
+	int			skipZeros;		// true => intervals with value zero are ignored
+	int			disjoint;		// true => intervals may not overlap
+	u32			prevEnd;		// (when disjoint) end of the last interval read
+	int			inRange;		// true => we are partway through a subrange
+	u32			carryIx;		// (within a subrange) the next carried
+	u32			numCarried;		// .. interval, and how many there are
+	u32			numPending;		// intervals that extend beyond the current
+	u32			pendingSize;	// .. subrange, to be carried into the next;
+	u32*		pendingEnd;		// .. each one begins at the next subrange's
+	valtype*	pendingVal;		// .. start
+	int			haveNext;		// true => next* hold an interval that begins
+	u32			nextStart;		// .. beyond the current subrange
+	u32			nextEnd;
+	valtype		nextVal;
+	};
+
 // miscellany
 
 #define min_of(a,b) ((a <= b)? a: b)
@@ -103,14 +277,71 @@ int main (int argc, char** argv);
 
 static void  parse_options              (int _argc, char** _argv);
 static int   process_operator_options   (int _argc, char** _argv);
+static dspinfo* find_operator_info      (char* dspName);
+static dspop* parse_operator            (dspinfo* opInfo, int argc, char** argv,
+                                         u32 opNum);
 static void  read_chromosome_lengths    (char* filename);
 static int   add_chromosome_spec        (char* name,
                                          u32 chromStart, u32 chromLength);
 static void  sort_chromosomes_by_length (void);
 static void  init_scratch_vectors       (u32 scratchLength);
+static void* get_scratch_buffer         (size_t numBytes, int exactSize);
+static size_t scratch_alloc_size        (size_t numBytes);
+static void  release_scratch_buffer     (void* v);
+static void  trim_scratch_vectors       (void);
 static void  free_scratch_vectors       (void);
+static void  free_signal_vector         (valtype* v, size_t numBytes);
+static void  account_memory             (int kind, s64 numBytes);
+static void  account_cache              (cachedfile* cache);
+static void  report_memory              (FILE* f);
+static u64   plan_memory                (u64* kindBytes);
+static u64   genome_length              (void);
+static u64   estimate_cache_size        (char* filename);
+static void  free_vector_spec           (svspec* svSpec);
+static void  report_bit_runs            (FILE* f, spec* chromSpec,
+                                         int precision, int noOutputValues,
+                                         u32 o);
+static void  report_count_runs          (FILE* f, spec* chromSpec,
+                                         int precision, int noOutputValues,
+                                         u32 o);
+static void  plan_pipeline              (void);
+static void  share_repeated_work        (void);
+static int   is_repeat                  (dspop** ops, u32 firstIx, u32 repeatIx,
+                                         u32 seriesIx);
+static void  print_op_label             (FILE* f, dspop* op);
+static char* stage_label                (dspop* firstOp, dspop* stopOp);
+static void  explain_plan               (FILE* f);
+static void  drop_dead_operators        (void);
+static opplan* new_op_plan              (u32 opNum, int argc, char** argv);
+static void  free_op_plan               (opplan* plan);
+static int   can_apply_tiled            (dspop* op);
+static void  apply_tiled                (dspop* firstOp, dspop* stopOp,
+                                         char* chrom, u32 vLen, valtype* v);
+static void  report_run_list            (FILE* f, spec* chromSpec,
+                                         int precision, int noOutputValues,
+                                         u32 o);
+static void  append_run                 (sigrun** runs, u32* numRuns,
+                                         u32* runsAllocated,
+                                         u32 start, u32 end);
+static void  add_signal_counts          (spec* chromSpec, u32 start, u32 end);
 static void  init_named_globals         (void);
+static void  set_named_global_value     (char* name, char* chrom, valtype val);
 static void  free_named_globals         (void);
+static int   next_text_interval         (intervalfile* f,
+                                         char** chrom, u32* start, u32* end,
+                                         valtype* val);
+static int   next_register_interval     (intervalfile* f,
+                                         char** chrom, u32* start, u32* end,
+                                         valtype* val);
+static cachedfile* find_cached_file     (char* filename, int valCol);
+static void  cache_interval             (intervalfile* f, char* chrom,
+                                         u32 start, u32 end, valtype val);
+static void  free_cached_intervals      (cachedfile* cache);
+static void  free_cached_files          (void);
+static sigregister* find_signal_register (char* name);
+static u32   sorted_chrom_index         (char* chrom);
+static void  apply_to_chromosome        (char* chrom);
+static void  free_signal_registers      (void);
 
 // dsp operations table
 
@@ -120,7 +351,7 @@ dspinfo dspTable[] =
 	 dspinforecord("slidingsum"    , op_sliding_sum)    ,
 	 dspinfoalias ("sliding_sum")                       ,
 	 dspinforecord("smooth"        , op_smooth)         ,
-	 dspinforecord("cumulativesum" , op_cumulative_sum) ,
+	 dspinforange ("cumulativesum" , op_cumulative_sum) ,
 	 dspinfoalias ("cumulative")                        ,
 	 dspinfoalias ("integrate")                         ,
 	 dspinforecord("clump"         , op_clump)          ,
@@ -128,22 +359,23 @@ dspinfo dspTable[] =
 	 dspinfoalias ("anti_clump")                        ,
 	 dspinfoalias ("skimp")                             ,
 	 dspinforecord("percentile"    , op_percentile)     ,
-	 dspinforecord("add"           , op_add)            ,
-	 dspinforecord("subtract"      , op_subtract)       ,
-	 dspinforecord("addconst"      , op_add_constant)   ,
+	 dspinforange ("add"           , op_add)            ,
+	 dspinforange ("subtract"      , op_subtract)       ,
+	 dspinforange ("addconst"      , op_add_constant)   ,
 	 dspinfoalias ("add_const")                         ,
-	 dspinforecord("invert"        , op_invert)         ,
-	 dspinforecord("multiply"      , op_multiply)       ,
-	 dspinforecord("divide"        , op_divide)         ,
-	 dspinforecord("abs"           , op_absolute_value) ,
-	 dspinforecord("mask"          , op_mask)           ,
-	 dspinforecord("masknot"       , op_mask_not)       ,
+	 dspinforange ("invert"        , op_invert)         ,
+	 dspinforange ("multiply"      , op_multiply)       ,
+	 dspinforange ("divide"        , op_divide)         ,
+	 dspinforange ("abs"           , op_absolute_value) ,
+	 dspinforange ("eval"          , op_eval)           ,
+	 dspinforange ("mask"          , op_mask)           ,
+	 dspinforange ("masknot"       , op_mask_not)       ,
 	 dspinfoalias ("mask_not")                          ,
-	 dspinforecord("clip"          , op_clip)           ,
-	 dspinforecord("erase"         , op_erase)          ,
-	 dspinforecord("binarize"      , op_binarize)       ,
-	 dspinforecord("or"            , op_or)             ,
-	 dspinforecord("and"           , op_and)            ,
+	 dspinforange ("clip"          , op_clip)           ,
+	 dspinforange ("erase"         , op_erase)          ,
+	 dspinforange ("binarize"      , op_binarize)       ,
+	 dspinforange ("or"            , op_or)             ,
+	 dspinforange ("and"           , op_and)            ,
 	 dspinforecord("maxover"       , op_max_in_interval),
 	 dspinfoalias ("max_over")                          ,
 	 dspinforecord("minover"       , op_min_in_interval),
@@ -160,9 +392,9 @@ dspinfo dspTable[] =
 	 dspinfoalias ("best_max")                          ,
 	 dspinfoalias ("bestlocalmax")                      ,
 	 dspinfoalias ("best_local_max")                    ,
-	 dspinforecord("minwith",        op_min_with)       ,
+	 dspinforange ("minwith",        op_min_with)       ,
 	 dspinfoalias ("min_with")                          ,
-	 dspinforecord("maxwith",        op_max_with)       ,
+	 dspinforange ("maxwith",        op_max_with)       ,
 	 dspinfoalias ("max_with")                          ,
 	 dspinforecord("close"         , op_close)          ,
 	 dspinforecord("open"          , op_open)           ,
@@ -171,6 +403,8 @@ dspinfo dspTable[] =
 	 dspinforecord("map"           , op_map)            ,
 	 dspinforecord("input"         , op_input)          ,
 	 dspinforecord("output"        , op_output)         ,
+	 dspinforecord("store"         , op_store)          ,
+	 dspinforecord("recall"        , op_recall)         ,
 	 dspinforecord("variables"     , op_show_variables) };
 
 #define dspTableLen (sizeof(dspTable)/sizeof(dspinfo))
@@ -237,8 +471,12 @@ static void usage (char* message)
 	fprintf (stderr, "                            (this is the default)\n");
 	fprintf (stderr, "  --nooutput                don't output the resulting intervals/values\n");
 	fprintf (stderr, "                            (by default these are written to stdout)\n");
+	fprintf (stderr, "  --explain                 describe the execution plan (and estimated passes\n");
+	fprintf (stderr, "                            over memory), instead of running it\n");
 	fprintf (stderr, "  --window=<length>         (W=) size of window\n");
 	fprintf (stderr, "                            (for operators that have a window size)\n");
+	fprintf (stderr, "  --threads=<n>             allow operators to use up to n threads\n");
+	fprintf (stderr, "                            (by default we use only one thread)\n");
 	fprintf (stderr, "  --help[=<operator>]       get detail about a particular operator\n");
 	fprintf (stderr, "  ?                         list available operators with brief descriptions\n");
 	fprintf (stderr, "  ?<operator>               same as --help=<operator>\n");
@@ -247,6 +485,21 @@ static void usage (char* message)
 	fprintf (stderr, "                            helpful in tracking progress during a long run.\n");
 	fprintf (stderr, "  --progress=input:<n>      report processing of every nth input line\n");
 	fprintf (stderr, "  --progress=operations     report each operation as it begins\n");
+	fprintf (stderr, "  --profile[=<file>]        report time, bases, bytes read and written, and\n");
+	fprintf (stderr, "                            scratch vectors for each operator, to stderr at\n");
+	fprintf (stderr, "                            exit;  with a file, also write it there as JSON\n");
+	fprintf (stderr, "  --counters                add hardware counters to the profile (cycles,\n");
+	fprintf (stderr, "                            instructions, cache and branch misses);  implies\n");
+	fprintf (stderr, "                            --profile\n");
+	fprintf (stderr, "  --trace=<file>            write a timeline of the run to a file, in Chrome\n");
+	fprintf (stderr, "                            trace-event format (for chrome://tracing or\n");
+	fprintf (stderr, "                            Perfetto)\n");
+	fprintf (stderr, "  --report=memory           report current and peak memory use (signal,\n");
+	fprintf (stderr, "                            scratch vectors, interval caches, registers) to\n");
+	fprintf (stderr, "                            stderr at exit\n");
+	fprintf (stderr, "  --max-memory=<bytes>      refuse to run a pipeline whose planned memory use\n");
+	fprintf (stderr, "                            exceeds this, and stop if actual use would exceed\n");
+	fprintf (stderr, "                            it (e.g. --max-memory=16G)\n");
 	fprintf (stderr, "  --version                 report the program version and quit\n");
 	fprintf (stderr, "\n");
 	fprintf (stderr, "Note that if input intervals overlap, their values are summed.\n");
@@ -255,6 +508,10 @@ static void usage (char* message)
 	fprintf (stderr, "stdin is ignored.\n");
 	fprintf (stderr, "\n");
 
+	fprintf (stderr, "Interval files read by operators (e.g. mask) may be compiled to a binary form\n");
+	fprintf (stderr, "that is faster to read;  do \"genodsp compile --help\" for details.\n");
+	fprintf (stderr, "\n");
+
 	fprintf (stderr, "For a list of available operations, do \"genodsp ?\".\n");
 	fprintf (stderr, "For more detailed descriptions of the operations, do \"genodsp --help\".\n");
 
@@ -293,6 +550,7 @@ static void parse_options (int _argc, char** _argv)
 	u32			dspIx;
 	int			argsConsumed;
 	int			tempInt;
+	s64			tempS64;
 
 	// skip program name
 
@@ -455,6 +713,11 @@ static void parse_options (int _argc, char** _argv)
 		if (strcmp (arg, "--nooutput") == 0)
 			{ inhibitOutput = true;  goto next_arg; }
 
+		// --explain
+
+		if (strcmp (arg, "--explain") == 0)
+			{ explainPlan = true;  goto next_arg; }
+
 		// --window=<length> or W=<length>
 
 		if ((strcmp_prefix (arg, "--window=") == 0)
@@ -514,6 +777,17 @@ static void parse_options (int _argc, char** _argv)
 			exit (EXIT_SUCCESS);
 			}
 
+		// --threads=<n>
+
+		if (strcmp_prefix (arg, "--threads=") == 0)
+			{
+			tempInt = string_to_int (argVal);
+			if (tempInt <= 0)
+				chastise ("number of threads must be positive (\"%s\")\n", arg);
+			numThreads = (u32) tempInt;
+			goto next_arg;
+			}
+
 		// --report=comments
 
 		if ((strcmp (arg, "--report=comments") == 0)
@@ -539,6 +813,45 @@ static void parse_options (int _argc, char** _argv)
 		 || (strcmp (arg, "--debug=operations")    == 0))  // backward compatibility
 			{ trackOperations = true;  goto next_arg; }
 
+		// --profile[=<file>]
+
+		if (strcmp (arg, "--profile") == 0)
+			{ reportProfile = profiling = true;  goto next_arg; }
+
+		if (strcmp_prefix (arg, "--profile=") == 0)
+			{
+			profileFilename = argVal;
+			reportProfile = profiling = true;
+			goto next_arg;
+			}
+
+		// --counters
+
+		if (strcmp (arg, "--counters") == 0)
+			{ countHardware = reportProfile = profiling = true;  goto next_arg; }
+
+		// --trace=<file>
+
+		if (strcmp_prefix (arg, "--trace=") == 0)
+			{ traceFilename = argVal;  profiling = true;  goto next_arg; }
+
+		// --max-memory=<bytes>
+
+		if (strcmp_prefix (arg, "--max-memory=") == 0)
+			{
+			tempS64 = string_to_unitized_int64 (argVal, /*thousands*/ false);
+			if (tempS64 <= 0)
+				chastise ("memory budget must be positive (\"%s\")\n", arg);
+			memoryBudget = (u64) tempS64;
+			goto next_arg;
+			}
+
+		// --report=memory
+
+		if ((strcmp (arg, "--report=memory") == 0)
+		 || (strcmp (arg, "--report:memory") == 0))
+			{ reportMemory = true;  goto next_arg; }
+
 		// --version
 
 		if (strcmp (arg, "--version") == 0)
@@ -638,8 +951,7 @@ static int process_operator_options (int _argc, char** _argv)
 	char*		arg;
 	int			argsConsumed, dspArgC, argIx;
 	char*		dspName;
-	dspinfo*	opInfo, *realOpInfo;
-	u32			dspIx;
+	dspinfo*	opInfo;
 	dspop*		op;
 
 	argv = _argv;  argc = _argc;
@@ -663,14 +975,7 @@ static int process_operator_options (int _argc, char** _argv)
 	if (dbgPipe)
 		fprintf (stderr, "  dspName=\"%s\"\n", dspName);
 
-	opInfo = realOpInfo = NULL;
-	for (dspIx=0 ; dspIx<dspTableLen ; dspIx++)
-		{
-		if (dspTable[dspIx].funcShort != NULL) realOpInfo = &dspTable[dspIx];
-		if (strcmp (dspName,dspTable[dspIx].name) != 0) continue;
-		opInfo = realOpInfo;
-		break;
-		}
+	opInfo = find_operator_info (dspName);
 	if (opInfo == NULL)
 		chastise ("\"%s\" is not a known operation\n", dspName);
 
@@ -698,16 +1003,8 @@ static int process_operator_options (int _argc, char** _argv)
 
 	// tell operator to parse its arguments
 
-	chastiseUsage     = opInfo->funcUsage;
-	chastiseUsageName = opInfo->name;
-	op = (*opInfo->funcParse) (opInfo->name, dspArgC, argv);
-	chastiseUsage     = NULL;
-	chastiseUsageName = NULL;
-
-	op->name      = copy_string (opInfo->name);
-	op->funcApply = opInfo->funcApply;
-	op->funcFree  = opInfo->funcFree;
-	// op->atRandom must be set by the parse function
+	op = parse_operator (opInfo, dspArgC, argv,
+	                     (tailOp == NULL)? 1 : tailOp->plan->opNum+1);
 
 	// add operation item to the pipeline
 
@@ -723,1482 +1020,4974 @@ static int process_operator_options (int _argc, char** _argv)
 	}
 
 
-// read_chromosome_lengths--
+// find_operator_info--
+//	Locate an operator's table entry by name (or alias);  returns NULL if there
+//	is no such operator.
 
-static void read_chromosome_lengths (char* filename)
+static dspinfo* find_operator_info
+   (char*		dspName)
 	{
-	FILE*	f;
-	char	lineBuffer[1001];
-	u32		lineNumber = 0;
-	int		missingEol = false;
-	int		lineLen;
-	char*	scan, *mark, *field;
-	char*	chrom;
-	u32		chromLength;
+	dspinfo*	realOpInfo;
+	u32			dspIx;
 
-	f = fopen (filename, "rt");
-	if (f == NULL) goto cant_open_file;
+	realOpInfo = NULL;
+	for (dspIx=0 ; dspIx<dspTableLen ; dspIx++)
+		{
+		if (dspTable[dspIx].funcShort != NULL) realOpInfo = &dspTable[dspIx];
+		if (strcmp (dspName,dspTable[dspIx].name) == 0) return realOpInfo;
+		}
 
-	lineNumber = 0;
-	while (true)
+	return NULL;
+	}
+
+
+// parse_operator--
+//	Have an operator parse its arguments, and fill in the common parts of the
+//	resulting dspop (including its planner record).  The operator is not added
+//	to the pipeline.
+
+static dspop* parse_operator
+   (dspinfo*	opInfo,
+	int			argc,
+	char**		argv,
+	u32			opNum)
+	{
+	dspop*		op;
+
+	chastiseUsage     = opInfo->funcUsage;
+	chastiseUsageName = opInfo->name;
+	parsedStorage     = storeValues;
+	parsedFootprint   = -1;
+	parsedHaloLeft    = parsedHaloRight = 0;
+	parsedSignalUse   = useRead|useWrite;
+	parsedUses        = NULL;
+	op = (*opInfo->funcParse) (opInfo->name, argc, argv);
+	chastiseUsage     = NULL;
+	chastiseUsageName = NULL;
+
+	op->name      = copy_string (opInfo->name);
+	op->funcApply = opInfo->funcApply;
+	op->funcRange = opInfo->funcRange;
+	op->funcFree  = opInfo->funcFree;
+	op->storage   = parsedStorage;
+	op->footprint = parsedFootprint;
+	op->haloLeft  = parsedHaloLeft;
+	op->haloRight = parsedHaloRight;
+	// op->atRandom must be set by the parse function
+
+	if (op->footprint == -1)
+		op->footprint = (op->atRandom)? footprintGlobal : footprintWhole;
+
+	op->plan = new_op_plan (opNum, argc, argv);
+
+	return op;
+	}
+
+
+//----------
+//
+// declare_signal_use, declare_resource_use--
+//	Tell the planner how the operator currently being parsed uses the signal,
+//	and which named variables, files and registers it reads or writes.  These
+//	are called from an operator's parse function.
+//
+//----------
+//
+// Arguments:
+//	int		access:	How the resource is used;  useRead and/or useWrite (for
+//					.. declare_signal_use, zero means the operator doesn't
+//					.. touch the signal at all).
+//	int		kind:	The kind of resource, resourceVariable or resourceData.
+//	char*	name:	The resource's name (a variable name, a filename, or a
+//					.. register name).  The caller needn't preserve this.
+//
+// Returns:
+//	(nothing)
+//
+//----------
+
+void declare_signal_use
+   (int			access)
+	{
+	parsedSignalUse = access;
+	}
+
+
+void declare_resource_use
+   (int			kind,
+	char*		name,
+	int			access)
+	{
+	planuse*	use, *tail;
+
+	use = (planuse*) malloc (sizeof(planuse));
+	if (use == NULL) goto cant_allocate;
+
+	use->next     = NULL;
+	use->kind     = kind;
+	use->access   = access;
+	use->name     = copy_string (name);
+	use->producer = NULL;
+
+	if (parsedUses == NULL)
+		parsedUses = use;
+	else
 		{
-		if (fgets (lineBuffer, sizeof(lineBuffer), f) == NULL)
-			break;
+		for (tail=parsedUses ; tail->next!=NULL ; tail=tail->next) ;
+		tail->next = use;
+		}
 
-		lineNumber++;
+	return;
 
-		// check for lines getting split by fgets (the final line in the file
-		// might not have a newline, but no internal lines can be that way)
+cant_allocate:
+	fprintf (stderr, "failed to allocate planner record for \"%s\"\n", name);
+	exit(EXIT_FAILURE);
+	}
 
-		if (missingEol) goto missing_eol;
 
-		lineLen = strlen(lineBuffer);
-		if (lineLen != 0)
-			missingEol = (lineBuffer[lineLen-1] != '\n');
+// new_op_plan--
+//	Create the planner record for the operator just parsed, collecting what it
+//	declared.
 
-		// parse the line
+static opplan* new_op_plan
+   (u32			opNum,
+	int			argc,
+	char**		argv)
+	{
+	opplan*		plan;
+	size_t		argsLen;
+	int			argIx;
 
-		scan = skip_whitespace(lineBuffer);
-		if (*scan == 0)   continue;  // empty line
-		if (*scan == '#') continue;  // comment line
+	argsLen = 1;
+	for (argIx=0 ; argIx<argc ; argIx++)
+		argsLen += strlen(argv[argIx]) + 1;
 
-		chrom = scan = lineBuffer;
-		if (*scan == 0) goto no_chrom;
-		mark = skip_darkspace(scan);
-		scan = skip_whitespace(mark);
-		if (*mark != 0) *mark = 0;
+	plan = (opplan*) malloc (sizeof(opplan) + argsLen);
+	if (plan == NULL) goto cant_allocate;
 
-		if (*scan == 0) goto no_length;
-		field = scan;
-		mark = skip_darkspace(scan);
-		scan = skip_whitespace(mark);
-		if (*mark != 0) *mark = 0;
-		chromLength = string_to_u32 (field);
+	plan->opNum      = opNum;
+	plan->args       = ((char*) plan) + sizeof(opplan);
+	plan->signalUse  = parsedSignalUse;
+	plan->uses       = parsedUses;
+	plan->dropReason = NULL;
+	plan->inserted   = false;
 
-		if (!add_chromosome_spec (chrom, 0, chromLength))
-			goto same_chromosome;
+	plan->args[0] = 0;
+	for (argIx=0 ; argIx<argc ; argIx++)
+		{
+		if (argIx > 0) strcat (plan->args, " ");
+		strcat (plan->args, argv[argIx]);
 		}
 
-	// success
+	parsedUses = NULL;
+	return plan;
 
-	fclose (f);
-	return;
+cant_allocate:
+	fprintf (stderr, "failed to allocate planner record (operator %u)\n", opNum);
+	exit(EXIT_FAILURE);
+	return NULL; // (never reaches here)
+	}
 
-	//////////
-	// failure exits
-	//////////
 
-cant_open_file:
-	fprintf (stderr, "can't open \"%s\" for reading\n", filename);
-	exit (EXIT_FAILURE);
+// free_op_plan--
 
-missing_eol:
-	fprintf (stderr, "problem at line %u, line is longer than internal buffer\n",
-			 lineNumber-1);
-	exit (EXIT_FAILURE);
+static void free_op_plan
+   (opplan*		plan)
+	{
+	planuse*	use, *nextUse;
 
-no_chrom:
-	fprintf (stderr, "problem at line %u, line contains no chromosome or begins with whitespace\n",
-			 lineNumber);
-	exit (EXIT_FAILURE);
+	if (plan == NULL) return;
 
-no_length:
-	fprintf (stderr, "problem at line %u, line contains no chromosome length\n",
-			 lineNumber);
-	exit (EXIT_FAILURE);
+	for (use=plan->uses ; use!=NULL ; use=nextUse)
+		{
+		nextUse = use->next;
+		free (use->name);
+		free (use);
+		}
 
-same_chromosome:
-	fprintf (stderr, "problem at line %u, chromosome \"%s\" appears more than once\n",
-			 lineNumber, chrom);
-	exit (EXIT_FAILURE);
+	free (plan);
 	}
 
 //----------
 //
-// main program--
+// plan_pipeline--
+//	Build the dependency graph of the pipeline, and decide what work is dead.
+//
+// Each read of a variable, file or register is linked to the latest earlier
+// operator that writes it.  Then, working backward from the end of the
+// pipeline, we track whether the signal is live (whether anything later
+// reads it), and which files and registers later operators read.  Dead work
+// is
+//	- an operator that only modifies the signal (it uses no variables, files or
+//	  registers), when the signal is not live after it, e.g. anything followed
+//	  by an input operator
+//	- a store to a register that no later operator reads
+// Such operators are marked as dropped (see drop_dead_operators).  Output
+// files are never considered dead, since they are results for the user.
+//
+// Before any of that, work that is repeated is replaced by a recall of the
+// earlier result (see share_repeated_work).
+//
+//----------
+//
+// Arguments:
+//	(none)
+//
+// Returns:
+//	(nothing)
 //
 //----------
 
-int main
-   (int			argc,
-	char**		argv)
+static void plan_pipeline
+   (void)
 	{
-	char*		chrom;
-	u32			vLen;
-	valtype*	v;
-	spec*		chromSpec;
-	dspop*		firstOp, *stopOp, *op, *nextOp;
-	u32			maxLength;
-	u32			ix, chromIx;
-	opfunc_free	funcFree;
+	dspop*		op, *scanOp;
+	planuse*	use, *scanUse, *laterUse;
+	u32			numOps, opIx;
+	dspop**		ops;
+	int			signalLive, isPure, isStore, laterRead;
 
-	init_named_globals ();
-	set_named_global ("valColumn",     (valtype) valColumn);
-	set_named_global ("valPrecision",  (valtype) valPrecision);
-	set_named_global ("collapseRuns",  (valtype) collapseRuns);
-	set_named_global ("showUncovered", (valtype) showUncovered);
-	set_named_global ("originOne",     (valtype) originOne);
+	// keep results that are computed more than once (this adds operators to
+	// the pipeline, so it must happen first)
 
-	parse_options (argc, argv);
+	share_repeated_work ();
 
-	//////////
-	// allocate vectors
-	//////////
+	numOps = 0;
+	for (op=pipeline ; op!=NULL ; op=op->next) numOps++;
+	if (numOps == 0) return;
 
-	sort_chromosomes_by_length ();
+	ops = (dspop**) malloc (numOps * sizeof(dspop*));
+	if (ops == NULL) goto cant_allocate;
 
-	// determine the length of any scratch vectors;  every scratch vector will
-	// be as long as the longest chromosome
+	opIx = 0;
+	for (op=pipeline ; op!=NULL ; op=op->next) ops[opIx++] = op;
 
-	maxLength = 0;
-	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+	// link reads to their producers
+
+	for (op=pipeline ; op!=NULL ; op=op->next)
 		{
-		chromSpec = chromsSorted[chromIx];
-		if (chromSpec->length == 0) goto no_length_specified;
-		if (chromSpec->length > maxLength) maxLength = chromSpec->length;
+		for (use=op->plan->uses ; use!=NULL ; use=use->next)
+			{
+			if ((use->access & useRead) == 0) continue;
+			for (scanOp=pipeline ; scanOp!=op ; scanOp=scanOp->next)
+				{
+				if (scanOp->plan->dropReason != NULL) continue;
+				for (scanUse=scanOp->plan->uses ; scanUse!=NULL ; scanUse=scanUse->next)
+					{
+					if ((scanUse->access & useWrite) == 0) continue;
+					if (scanUse->kind != use->kind) continue;
+					if (strcmp (scanUse->name, use->name) != 0) continue;
+					use->producer = scanOp;
+					}
+				}
+			}
 		}
 
-	init_scratch_vectors (maxLength);
+	// work backward, marking dead operators
 
-	// allocate chromosome value vectors
+	signalLive = !inhibitOutput;
 
-	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+	for (opIx=numOps ; opIx-->0 ; )
 		{
-		chromSpec = chromsSorted[chromIx];
+		op = ops[opIx];
+		if (op->plan->dropReason != NULL) continue;
 
-		if (trackOperations)
-			tracking_report ("allocate(%s / %s bytes)\n",
-			                  chromSpec->chrom, ucommatize(chromSpec->length));
+		isPure = (op->plan->uses == NULL)
+		      && ((op->plan->signalUse & useWrite) != 0);
 
-		chromSpec->valVector = (valtype*) calloc (chromSpec->length, sizeof(valtype));
-		if (chromSpec->valVector == NULL) goto cant_allocate_val;
-		v = chromSpec->valVector;
-		for (ix=0 ; ix<chromSpec->length ; ix++)
-			v[ix] = 0.0;
-		}
-
-	if (trackOperations)
-		tracking_report ("allocate(--done--)\n");
-
-	//////////
-	// process intervals
-	//////////
-
-	// read intervals and values;  note that if the first operator is an
-	// input operator, we avoid this step (since the first operator will
-	// overwrite whatever intervals we might have read)
-
-	op = pipeline;
-	if ((op == NULL) || (strcmp (op->name, "input") != 0))
-		read_intervals (stdin, valColumn, originOne, ri_overlapSum, /*clear*/ false, 0.0);
+		isStore = (op->plan->uses != NULL)
+		       && (op->plan->uses->next == NULL)
+		       && (op->plan->uses->kind == resourceData)
+		       && (op->plan->uses->access == useWrite)
+		       && (is_signal_register (op->plan->uses->name))
+		       && ((op->plan->signalUse & useWrite) == 0);
 
-	// perform operations;  when possible, we perform a series of operations on
-	// one chromosome before moving onto the next;  it is expected that this
-	// will have some improvement in cache performance, at least for chromosomes
-	// smaller than the cache
-
-	firstOp = pipeline;
-	while (firstOp != NULL)
-		{
-		for (stopOp=firstOp ; stopOp!=NULL ; stopOp=stopOp->next)
-			{ if (stopOp->atRandom) break; }
+		if ((isPure) && (!signalLive))
+			{
+			op->plan->dropReason = "its result is never used";
+			continue;
+			}
 
-		if (stopOp != firstOp)
+		if (isStore)
 			{
-			// run several operations serially on each chromosome
-			for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+			laterRead = false;
+			for (scanOp=op->next ; (scanOp!=NULL)&&(!laterRead) ; scanOp=scanOp->next)
 				{
-				chromSpec = chromsSorted[chromIx];
-				for (op=firstOp ; op!=stopOp ; op=op->next)
+				if (scanOp->plan->dropReason != NULL) continue;
+				for (laterUse=scanOp->plan->uses ; laterUse!=NULL ; laterUse=laterUse->next)
 					{
-					chrom = chromSpec->chrom;
-					vLen  = chromSpec->length;
-					v     = chromSpec->valVector;
-					if (trackOperations)
-						fprintf (stderr, "%s(%s)\n", op->name, chrom);
-					(*op->funcApply) (op, chrom, vLen, v);
+					if ((laterUse->access & useRead) == 0) continue;
+					if (laterUse->kind != resourceData) continue;
+					if (strcmp (laterUse->name, op->plan->uses->name) != 0) continue;
+					laterRead = true;
+					break;
 					}
 				}
+			if (!laterRead)
+				{
+				op->plan->dropReason = "its register is never read";
+				continue;
+				}
 			}
 
-		if (stopOp == NULL)
-			firstOp = NULL;
-		else
-			{
-			// run one operation on all chromosomes 'simultaneously'
-			op = stopOp;
-
-			if (trackOperations)
-				tracking_report ("%s(*)\n", op->name);
-			(*op->funcApply) (op, "*", maxLength, NULL);
-			firstOp = stopOp->next;
-			}
-		}
-
-	// report intervals
-
-	if (!inhibitOutput)
-		report_intervals (stdout, valPrecision, noOutputValues,
-		                  collapseRuns, showUncovered, originOne);
-
-	//////////
-	// success
-	//////////
-
-	// deallocate
-
-	free_scratch_vectors ();
-	free_named_globals   ();
-
-	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
-		{
-		chromSpec = chromsSorted[chromIx];
-		if (chromSpec->chrom     != NULL) free (chromSpec->chrom);
-		if (chromSpec->valVector != NULL) free (chromSpec->valVector);
-		free (chromSpec);
-		}
-	chromsOfInterest = NULL;
-
-	free (chromsSorted);
-	chromsSorted = NULL;
-
-	for (op=pipeline ; op!=NULL ; op=nextOp)
-		{
-		nextOp = op->next;
-		if (op->name != NULL) { free (op->name);  op->name = NULL; }
-		funcFree = op->funcFree;
-		funcFree (op);
+		if ((op->plan->signalUse & useRead) != 0)
+			signalLive = true;
+		else if ((op->plan->signalUse & useWrite) != 0)
+			signalLive = false;
 		}
 
-	// proclaim success
-
-	return EXIT_SUCCESS;
-
-	//////////
-	// failure exits
-	//////////
-
-no_length_specified:
-	fprintf (stderr, "no length was specified for %s\n",
-	                 chromSpec->chrom);
-	return EXIT_FAILURE;
+	free (ops);
+	return;
 
-cant_allocate_val:
-	fprintf (stderr, "failed to allocate %d-base vector for %s, %d bytes per base\n",
-	                 chromSpec->length, chromSpec->chrom, (int) sizeof(valtype));
-	return EXIT_FAILURE;
+cant_allocate:
+	fprintf (stderr, "failed to allocate planner list (%u operators)\n", numOps);
+	exit(EXIT_FAILURE);
 	}
 
+
 //----------
 //
-// add_chromosome_spec--
-//	Add a chromosome to our list of chromosome specifications.
+// share_repeated_work--
+//	Find series of operators that recompute a result that an earlier series
+//	already computed, and keep the earlier result in memory instead.
+//
+// A series qualifies if it begins with an input operator and appears again
+// later in the pipeline, with the same operators and the same arguments.  No
+// operator in the series may write anything other than the signal, nor
+// destroy a file, and nothing between the two occurrences may write a file,
+// register or variable that the series reads.  For example, in
+//	input signal.dat = sum --window=100 = percentile 99.5
+//	  = input signal.dat = sum --window=100 = clump ...
+// the second input and sum are replaced by a recall of a register that is
+// stored right after the first sum.  The register costs a copy of the signal
+// until it is recalled;  if that would take the planned memory use over the
+// budget (see --max-memory), the repeat is left to be recomputed.
+//
+// The inserted operators are named "(repeat<n>)";  the replaced operators are
+// marked as dropped.
 //
 //----------
 //
 // Arguments:
-//	char*	name:			The name of the chromsome (e.g. "chr1").
-//	u32		chromStart:		The first base of interest on the chromosome
-//							.. (origin zero);  usually this is zero.
-//	u32		chromLength:	The number of bases to allocate for chromosome;
-//							.. usually this is the chromosome's length.  Note
-//							.. that if this is zero, we don't bother adding
-//							.. a record for the chromosome.
+//	(none)
 //
 // Returns:
-//	true if successful;  false if the chromosome is already in the list;  all
-//	other failures result in program termination.
+//	(nothing)
 //
 //----------
 
-static int add_chromosome_spec
-   (char*	name,
-	u32		chromStart,
-	u32		chromLength)
+static void share_repeated_work
+   (void)
 	{
-	spec*	scanSpec, *tailSpec, *newSpec;
+	dspinfo*	storeInfo, *recallInfo;
+	dspop*		op, *prevOp, *storeOp, *recallOp;
+	dspop**		ops;
+	u32			numOps, opIx, firstIx, repeatIx, seriesLen, storedLen;
+	u32			numRegisters;
+	char		regName[30];
+	char*		regArgv[1];
+
+	numOps = 0;
+	for (op=pipeline ; op!=NULL ; op=op->next) numOps++;
+	if (numOps < 2) return;
+
+	ops = (dspop**) malloc (numOps * sizeof(dspop*));
+	if (ops == NULL) goto cant_allocate;
+
+	opIx = 0;
+	for (op=pipeline ; op!=NULL ; op=op->next) ops[opIx++] = op;
+
+	storeInfo  = find_operator_info ("store");
+	recallInfo = find_operator_info ("recall");
+	regArgv[0] = regName;
+
+	numRegisters = 0;
+	for (firstIx=0 ; firstIx<numOps ; firstIx++)
+		{
+		op = ops[firstIx];
+		if (op->plan->dropReason != NULL) continue;
+		if (strcmp (op->name, "input") != 0) continue;
 
-	if (chromLength == 0) return true;
+		storedLen = 0;
+		for (repeatIx=firstIx+1 ; repeatIx<numOps ; repeatIx++)
+			{
+			seriesLen = 0;
+			while ((firstIx+seriesLen < repeatIx)
+			    && (repeatIx+seriesLen < numOps)
+			    && (is_repeat (ops, firstIx, repeatIx, seriesLen)))
+				seriesLen++;
+			if (seriesLen == 0) continue;
 
-	// check whether this chromosome name is already in use, and find the tail
-	// of the list if the name is not in use
+			// if the repeat immediately follows the first series, the signal
+			// already holds the result
 
-	tailSpec = NULL;
-	for (scanSpec=chromsOfInterest ; scanSpec!=NULL ; scanSpec=scanSpec->next)
-		{
-		tailSpec = scanSpec;
-		if (strcmp (name, scanSpec->chrom) == 0) return false;
-		}
+			if (firstIx+seriesLen == repeatIx)
+				{
+				for (opIx=repeatIx ; opIx<repeatIx+seriesLen ; opIx++)
+					ops[opIx]->plan->dropReason = "it repeats the work just before it";
+				repeatIx += seriesLen-1;
+				continue;
+				}
 
-	// create a new spec for this chromosome and add it to the list
+			// store the result of the first series in a register (unless a
+			// register already holds it, for an earlier repeat)
 
-	newSpec = (spec*) malloc (sizeof(spec));
-	if (newSpec == NULL) goto cant_allocate_spec;
-	if (tailSpec == NULL) chromsOfInterest = newSpec;
-					 else tailSpec->next   = newSpec;
-	newSpec->next      = NULL;
-	newSpec->chrom     = copy_string (name);
-	newSpec->start     = chromStart;
-	newSpec->length    = chromLength;
-	newSpec->valVector = NULL;
+			if (seriesLen != storedLen)
+				{
+				if ((memoryBudget != 0)
+				 && (plan_memory (NULL) + genome_length () * sizeof(valtype) > memoryBudget))
+					{ repeatIx += seriesLen-1;  continue; }
+
+				sprintf (regName, "(repeat%u)", ++numRegisters);
+				storeOp = parse_operator (storeInfo, 1, regArgv,
+				                          ops[firstIx+seriesLen-1]->plan->opNum);
+				storeOp->plan->inserted = true;
+
+				prevOp = ops[firstIx+seriesLen-1];
+				storeOp->next = prevOp->next;
+				prevOp->next  = storeOp;
+				if (tailOp == prevOp) tailOp = storeOp;
+				storedLen = seriesLen;
+				}
 
-	return true;
+			// replace the repeat with a recall
 
-	//////////
-	// failure exits
-	//////////
+			for (prevOp=pipeline ; prevOp->next!=ops[repeatIx] ; prevOp=prevOp->next) ;
 
-cant_allocate_spec:
-	fprintf (stderr, "failed to allocate spec for \"%s\", %d bytes\n",
-	                 name, (int) sizeof(spec));
+			recallOp = parse_operator (recallInfo, 1, regArgv, prevOp->plan->opNum);
+			recallOp->plan->inserted = true;
+			recallOp->next = prevOp->next;
+			prevOp->next   = recallOp;
+
+			for (opIx=repeatIx ; opIx<repeatIx+seriesLen ; opIx++)
+				ops[opIx]->plan->dropReason = "it repeats earlier work, which is recalled instead";
+
+			repeatIx += seriesLen-1;
+			}
+		}
+
+	free (ops);
+	return;
+
+cant_allocate:
+	fprintf (stderr, "failed to allocate planner list (%u operators)\n", numOps);
 	exit(EXIT_FAILURE);
-	return false; // (never reaches here)
 	}
 
 
-//----------
-//
-// find_chromosome_spec--
-//	Locate the spec for a specific chromosome name.
-//
-//----------
-//
-// Arguments:
-//	char*	chrom:	name of the chromosome to look for.
-//
-// Returns:
-//	a pointer to the spec for the chromosome;  NULL if the chromosome is not
-//	in our list.
-//
-//----------
+// is_repeat--
+//	Determine whether the operator at repeatIx+seriesIx repeats the one at
+//	firstIx+seriesIx, as part of a repeated series (see share_repeated_work).
 
-spec* find_chromosome_spec
-   (char*	chrom)
+static int is_repeat
+   (dspop**		ops,
+	u32			firstIx,
+	u32			repeatIx,
+	u32			seriesIx)
 	{
-	spec*	scanSpec;
-
-	for (scanSpec=chromsOfInterest ; scanSpec!=NULL ; scanSpec=scanSpec->next)
-		{ if (strcmp (chrom, scanSpec->chrom) == 0) return scanSpec; }
+	dspop*		firstOp  = ops[firstIx+seriesIx];
+	dspop*		repeatOp = ops[repeatIx+seriesIx];
+	planuse*	use, *scanUse;
+	u32			opIx;
+
+	if (firstOp->plan->dropReason  != NULL) return false;
+	if (repeatOp->plan->dropReason != NULL) return false;
+	if (strcmp (firstOp->name,       repeatOp->name)       != 0) return false;
+	if (strcmp (firstOp->plan->args, repeatOp->plan->args) != 0) return false;
+	if (strstr (firstOp->plan->args, "--destroy") != NULL) return false;
+	if ((firstOp->plan->signalUse & useWrite) == 0) return false;
+
+	for (use=firstOp->plan->uses ; use!=NULL ; use=use->next)
+		{
+		if (use->access != useRead) return false;
+		for (opIx=firstIx ; opIx<repeatIx ; opIx++)
+			{
+			for (scanUse=ops[opIx]->plan->uses ; scanUse!=NULL ; scanUse=scanUse->next)
+				{
+				if ((scanUse->access & useWrite) == 0) continue;
+				if (scanUse->kind != use->kind) continue;
+				if (strcmp (scanUse->name, use->name) == 0) return false;
+				}
+			}
+		}
 
-	return NULL;
+	return true;
 	}
 
 
+// drop_dead_operators--
+//	Remove the operators the planner has dropped from the pipeline.
+
+static void drop_dead_operators
+   (void)
+	{
+	dspop*		op, *nextOp, *prevOp;
+
+	prevOp = NULL;
+	for (op=pipeline ; op!=NULL ; op=nextOp)
+		{
+		nextOp = op->next;
+		if (op->plan->dropReason == NULL) { prevOp = op;  continue; }
+
+		if (trackOperations)
+			tracking_report ("drop(%s, %s)\n", op->name, op->plan->dropReason);
+
+		if (prevOp == NULL) pipeline     = nextOp;
+		               else prevOp->next = nextOp;
+		if (tailOp == op) tailOp = prevOp;
+
+		free (op->name);
+		free_op_plan (op->plan);
+		(*op->funcFree) (op);
+		}
+	}
+
 //----------
 //
-// sort_chromosomes_by_length--
-//	Make an array of our list of chromosome specifications, sorted by
-//	decreasing length.
+// explain_plan--
+//	Describe the execution plan, as it will be carried out by main.
+//
+// The estimate of passes over memory counts one pass (reading and writing
+// each chromosome's vector once) for reading the input, for each operator
+// (or each series of operators that are run tile by tile), and for writing
+// the output.  Reductions are counted as two passes.  Operators that work on
+// compact storage (bits, counts or runs) will usually do less than this.
 //
 //----------
 //
 // Arguments:
-//	(none)
+//	FILE*	f:	The stream to print to.
 //
 // Returns:
 //	(nothing)
 //
 //----------
 
-int spec_length_descending (const void* _v1, const void* _v2);
-int spec_length_descending (const void* _v1, const void* _v2)
-	{
-	const u32 v1 = (*(const spec**) _v1)->length;
-	const u32 v2 = (*(const spec**) _v2)->length;
-	return (v1 < v2) - (v1 > v2);
-	}
+static char* footprintNames[] =
+	{ "whole vector", "pointwise", "windowed", "scan", "reduction", "global" };
 
-// sort_chromosomes_by_length--
 
-static void sort_chromosomes_by_length
-   (void)
+static void explain_plan
+   (FILE*		f)
 	{
-	spec*	chromSpec;
-	int		numChroms, chromIx;
-	u32		numBytes;
+	dspop*		op, *scanOp, *liveOp, *groupOp;
+	planuse*	use;
+	u64			genomeLen, passes, opPasses;
+	u64			kindBytes[numMemKinds], memoryNeeded;
+	u32			groupLen, groupLeft;
+	int			inGenomeStage, stageKnown, kind;
 
-	// count the chromosomes
+	genomeLen = genome_length ();
 
-	numChroms = 0;
-	for (chromSpec=chromsOfInterest ; chromSpec!=NULL ; chromSpec=chromSpec->next)
-		numChroms++;
+	fprintf (f, "plan for %s bases (%s bytes per pass over the signal)\n",
+	            ucommatize(genomeLen), ucommatize(genomeLen*sizeof(valtype)));
+	fprintf (f, "\n");
 
-	// allocate an array of pointers to the chromosome specs;  we allocate one
-	// extra entry at the end, to use as a terminator.
+	passes = 0;
 
-	numBytes = (numChroms+1) * sizeof(spec*);
-	chromsSorted = (spec**) malloc (numBytes);
-	if (chromsSorted == NULL) goto cant_allocate;
+	// reading the input
 
-	// copy the pointers into the array
+	for (liveOp=pipeline ; liveOp!=NULL ; liveOp=liveOp->next)
+		{ if (liveOp->plan->dropReason == NULL) break; }
 
-	chromIx = 0;
-	for (chromSpec=chromsOfInterest ; chromSpec!=NULL ; chromSpec=chromSpec->next)
-		chromsSorted[chromIx++] = chromSpec;
+	if ((liveOp != NULL) && (strcmp (liveOp->name, "input") == 0))
+		fprintf (f, "  (stdin is not read)\n");
+	else
+		{
+		fprintf (f, "  read signal from stdin;  1 pass\n");
+		passes++;
+		}
 
-	chromsSorted[chromIx] = NULL; // (terminator)
+	// operators
 
-	// sort 'em
+	stageKnown = inGenomeStage = false;
+	groupLeft  = 0;
+	groupOp    = NULL;
+	for (op=pipeline ; op!=NULL ; op=op->next)
+		{
+		if (op->plan->dropReason != NULL)
+			{
+			fprintf (f, "  ");
+			print_op_label (f, op);
+			fprintf (f, " %s%s%s\n", op->name,
+			            (op->plan->args[0] == 0)? "" : " ", op->plan->args);
+			fprintf (f, "      dropped;  %s\n", op->plan->dropReason);
+			continue;
+			}
 
-	qsort (chromsSorted, numChroms, sizeof(spec*), spec_length_descending);
+		if ((!stageKnown) || (op->atRandom) || (inGenomeStage))
+			{
+			if (op->atRandom)
+				fprintf (f, "  -- barrier;  whole genome --\n");
+			else
+				fprintf (f, "  -- %sper chromosome --\n", (stageKnown)? "barrier;  " : "");
+			stageKnown    = true;
+			inGenomeStage = op->atRandom;
+			}
 
-	return;
+		fprintf (f, "  ");
+		print_op_label (f, op);
+		fprintf (f, " %s%s%s\n", op->name,
+		            (op->plan->args[0] == 0)? "" : " ", op->plan->args);
 
-	//////////
-	// failure exits
-	//////////
+		fprintf (f, "      %s", footprintNames[op->footprint]);
+		if (op->footprint == footprintWindowed)
+			fprintf (f, " (halo %u left, %u right)", op->haloLeft, op->haloRight);
 
-cant_allocate:
-	fprintf (stderr, "failed to allocate sorted chromosome list, %d bytes\n",
-	                 numBytes);
-	exit(EXIT_FAILURE);
-	}
+		// a series of operators run tile by tile (see main) costs one pass
 
+		if (groupLeft > 0)
+			{
+			fprintf (f, ";  tiled with ");
+			print_op_label (f, groupOp);
 
-//----------
-//
-// read_intervals--
-//	Read all intervals from a file.
-//
-//----------
-//
-// Arguments:
-//	FILE*	f:			File to read from.
-//	int		valCol:		The column that contains interval value;  -1
-//						.. indicates no such column.
-//	int		originOne:	true  => interpret intervals as origin-one, closed
-//						false => interpret intervals as origin-zero, half-open
-//	int		overlapOp:	The operation to perform when a position is covered
-//						.. by more than one interval;  one of ri_overlapSum",
-//						.. etc.  When in doubt, sum is usually the appropriate
-//						.. choice.
-//	int		clear:		true  => zero all vectors before reading
-//	valtype	missingVal:	value to clear to (only valid if clear is true).
-//
-// Returns:
-//	nothing;  input failures result in program termination.
-//
-// Side effects:
-//	The chromsOfInterest vectors are written, representing the values of the
-//	incoming intervals.
-//
-//----------
+			groupLeft--;
+			}
+		else
+			{
+			groupLen = 0;
+			if (!op->atRandom)
+				{
+				for (scanOp=op ; scanOp!=NULL ; scanOp=scanOp->next)
+					{
+					if (scanOp->plan->dropReason != NULL) continue;
+					if ((scanOp->atRandom) || (!can_apply_tiled (scanOp))) break;
+					groupLen++;
+					}
+				}
 
-void read_intervals
-   (FILE*		f,
-	int			valCol,
-	int			originOne,
-	int			overlapOp,
-	int			clear,
-	valtype		missingVal)
-	{
-	char		lineBuffer[1001];
-	char		prevChrom[1001];
-	valtype*	v = NULL;
-	char*		chrom;
-	spec*		chromSpec;
-	u32			start, end, o, adjStart, adjEnd;
-	valtype		val;
-	u32			ix, chromIx;
-	int			ok;
+			if (groupLen > 1)
+				{
+				fprintf (f, ";  tiled with the next %u operator%s;  1 pass",
+				            groupLen-1, (groupLen == 2)? "" : "s");
+				groupOp    = op;
+				groupLeft  = groupLen-1;
+				passes++;
+				}
+			else
+				{
+				opPasses = 0;
+				if (op->plan->signalUse != 0)
+					opPasses = (op->footprint == footprintReduction)? 2 : 1;
+				fprintf (f, ";  %u pass%s", (u32) opPasses, (opPasses == 1)? "" : "es");
+				passes += opPasses;
+				}
+			}
 
-	// $$$ reset read_interval's lineNumber
+		fprintf (f, "\n");
 
-	if (trackOperations)
-		{
-		for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+		for (use=op->plan->uses ; use!=NULL ; use=use->next)
 			{
-			chromSpec = chromsSorted[chromIx];
-			chromSpec->flag = false;
+			fprintf (f, "      %s %s %s",
+			            (use->access == useWrite)? "writes" : "reads",
+			            (use->kind == resourceVariable)? "variable" : "data",
+			            use->name);
+			if (use->producer != NULL)
+				{
+				fprintf (f, " (from ");
+				print_op_label (f, use->producer);
+				fprintf (f, ")");
+				}
+			fprintf (f, "\n");
 			}
 		}
 
-	// clear all chromosomes
+	// writing the output
 
-	if (clear)
+	if (inhibitOutput)
+		fprintf (f, "  (no output)\n");
+	else
 		{
-		for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
-			{
-			chromSpec = chromsSorted[chromIx];
+		fprintf (f, "  write signal to stdout;  1 pass\n");
+		passes++;
+		}
 
-			chrom = chromSpec->chrom;
-			v     = chromSpec->valVector;
-			start = 0;
-			end   = chromSpec->length;
+	fprintf (f, "\n");
+	fprintf (f, "estimated %s passes over memory, %s bytes\n",
+	            ucommatize(passes), ucommatize(passes*genomeLen*sizeof(valtype)));
+
+	memoryNeeded = plan_memory (kindBytes);
+	fprintf (f, "estimated peak memory %s bytes (", ucommatize(memoryNeeded));
+	for (kind=0 ; kind<numMemKinds ; kind++)
+		fprintf (f, "%s%s %s", (kind == 0)? "" : ", ",
+		            memKindNames[kind], ucommatize(kindBytes[kind]));
+	fprintf (f, ")\n");
+	if ((memoryBudget != 0) && (memoryNeeded > memoryBudget))
+		fprintf (f, "(this exceeds --max-memory, %s bytes)\n", ucommatize(memoryBudget));
+	}
 
-			for (ix=start ; ix<end ; ix++)
-				v[ix] = missingVal;
-			}
 
-		}
+// print_op_label--
+//	Print the label --explain uses for an operator;  its position in the
+//	pipeline, or for an operator the planner inserted, the position it
+//	follows with a "+" appended.
 
-	// read intervals and values
+static void print_op_label
+   (FILE*		f,
+	dspop*		op)
+	{
+	fprintf (f, "[%u%s]", op->plan->opNum, (op->plan->inserted)? "+" : "");
+	}
 
-	if (originOne) o = 1;
-	          else o = 0;
 
-	prevChrom[0] = 0;
-	chromSpec    = NULL;
+// stage_label--
+//	Describe an operator, or a series of operators run tile by tile, for the
+//	profile (see --profile).  The result is a static buffer, overwritten by
+//	the next call.
 
-	v = NULL;
-	while (true)
-		{
-		ok = read_interval (f, lineBuffer, sizeof(lineBuffer), valCol,
-	                        &chrom, &start, &end, &val);
-		if (!ok) break;
+static char* stage_label
+   (dspop*		firstOp,
+	dspop*		stopOp)
+	{
+	static char	label[200];
+	dspop*		op;
+	size_t		len;
 
-		//fprintf (stderr, "%s %u %u %f\n", chrom, start, end, val);
+	sprintf (label, "[%u%s] ", firstOp->plan->opNum,
+	                (firstOp->plan->inserted)? "+" : "");
+	len = strlen (label);
 
-		if (strcmp (chrom, prevChrom) != 0)
+	if (firstOp->next == stopOp)
+		snprintf (label+len, sizeof(label)-len, "%s%s%s", firstOp->name,
+		          (firstOp->plan->args[0] == 0)? "" : " ", firstOp->plan->args);
+	else
+		{
+		for (op=firstOp ; (op!=stopOp)&&(len<sizeof(label)-1) ; op=op->next)
 			{
-			v = NULL;
-			chromSpec = find_chromosome_spec (chrom);
-			if (chromSpec != NULL) v = chromSpec->valVector;
-			safe_strncpy (prevChrom, chrom, sizeof(prevChrom)-1);
+			snprintf (label+len, sizeof(label)-len, "%s%s",
+			          (op == firstOp)? "" : "+", op->name);
+			len = strlen (label);
 			}
+		if (len < sizeof(label)-1)
+			snprintf (label+len, sizeof(label)-len, " (tiled)");
+		}
 
-		if (chromSpec == NULL) continue;
+	return label;
+	}
 
-		if ((trackOperations) && (!chromSpec->flag))
+
+// can_apply_tiled--
+//	Determine whether an operator can be run over a vector a tile at a time.
+
+static int can_apply_tiled
+   (dspop*		op)
+	{
+	if (op->funcRange == NULL) return false;
+	return (op->footprint == footprintPointwise)
+	    || (op->footprint == footprintScan);
+	}
+
+
+// apply_tiled--
+//	Run a series of operators over a vector a tile at a time, so that each tile
+//	stays in cache while every operator in the series is applied to it.  All
+//	the operators must satisfy can_apply_tiled.
+
+static void apply_tiled
+   (dspop*		firstOp,
+	dspop*		stopOp,
+	char*		chrom,
+	u32			vLen,
+	valtype*	v)
+	{
+	dspop*		op;
+	u32			start, end;
+
+	for (start=0 ; start<vLen ; start=end)
+		{
+		end = (vLen - start > rangeTileLen)? start + rangeTileLen : vLen;
+		for (op=firstOp ; op!=stopOp ; op=op->next)
 			{
-			tracking_report ("input(%s)\n", chrom);
-			chromSpec->flag = true;
+			if ((trackOperations) && (start == 0))
+				fprintf (stderr, "%s(%s)\n", op->name, chrom);
+			(*op->funcRange) (op, chrom, vLen, v, start, end);
 			}
+		}
+	}
 
-		start -= o;
-		adjStart = start;
-		adjEnd   = end;
 
-		if (clipToLength)
-			{
-			// if the use has told us to clip intervals to the chromosome
-			// length, do so
+// read_chromosome_lengths--
 
-			if (start > chromSpec->start + chromSpec->length)
-				adjStart = start = chromSpec->start + chromSpec->length;
+static void read_chromosome_lengths (char* filename)
+	{
+	FILE*	f;
+	char	lineBuffer[1001];
+	u32		lineNumber = 0;
+	int		missingEol = false;
+	int		lineLen;
+	char*	scan, *mark, *field;
+	char*	chrom;
+	u32		chromLength;
 
-			if (end > chromSpec->start + chromSpec->length)
-				adjEnd = end = chromSpec->start + chromSpec->length;
-			}
+	f = fopen (filename, "rt");
+	if (f == NULL) goto cant_open_file;
 
-		if (chromSpec->start == 0)
-			{
-			// if only length has been specified, we *reject* intervals beyond
-			// the end
+	lineNumber = 0;
+	while (true)
+		{
+		if (fgets (lineBuffer, sizeof(lineBuffer), f) == NULL)
+			break;
 
-			if (end > chromSpec->length) goto chrom_too_short;
-			}
-		else
-			{
-			// if start and end have been specified, we *ignore* intervals, or
-			// portions of intervals, beyond the end
+		lineNumber++;
 
-			if (end <= chromSpec->start) continue;
+		// check for lines getting split by fgets (the final line in the file
+		// might not have a newline, but no internal lines can be that way)
 
-			adjEnd = end - chromSpec->start;
-			if (start <= chromSpec->start) adjStart = 0;
-			                          else adjStart = start - chromSpec->start;
-			if (adjStart >= chromSpec->length) continue;
-			if (adjEnd   >= chromSpec->length) adjEnd = chromSpec->length;
-			}
+		if (missingEol) goto missing_eol;
 
-		// "write" the value into the vector, across the interval
+		lineLen = strlen(lineBuffer);
+		if (lineLen != 0)
+			missingEol = (lineBuffer[lineLen-1] != '\n');
 
-		if (overlapOp == ri_overlapMin)
-			{
-			for (ix=adjStart ; ix<adjEnd ; ix++)
-				{
-				if      ((clear) && (v[ix] == missingVal)) v[ix] = val;
-				else if (val < v[ix])                      v[ix] = val;
-				}
-			}
-		else if (overlapOp == ri_overlapMax)
-			{
-			for (ix=adjStart ; ix<adjEnd ; ix++)
-				{
-				if      ((clear) && (v[ix] == missingVal)) v[ix] = val;
-				else if (val > v[ix])                      v[ix] = val;
-				}
-			}
-		else // if (overlapOp == ri_overlapSum)
-			{
-			for (ix=adjStart ; ix<adjEnd ; ix++)
-				{
-				if ((clear) && (v[ix] == missingVal)) v[ix] =  val;
-												 else v[ix] += val;
-				}
-			}
-		}
+		// parse the line
 
-	if (trackOperations)
-		tracking_report ("input(--done--)\n");
+		scan = skip_whitespace(lineBuffer);
+		if (*scan == 0)   continue;  // empty line
+		if (*scan == '#') continue;  // comment line
+
+		chrom = scan = lineBuffer;
+		if (*scan == 0) goto no_chrom;
+		mark = skip_darkspace(scan);
+		scan = skip_whitespace(mark);
+		if (*mark != 0) *mark = 0;
+
+		if (*scan == 0) goto no_length;
+		field = scan;
+		mark = skip_darkspace(scan);
+		scan = skip_whitespace(mark);
+		if (*mark != 0) *mark = 0;
+		chromLength = string_to_u32 (field);
+
+		if (!add_chromosome_spec (chrom, 0, chromLength))
+			goto same_chromosome;
+		}
 
-	//////////
 	// success
-	//////////
 
+	fclose (f);
 	return;
 
 	//////////
 	// failure exits
 	//////////
 
-chrom_too_short:
-	fprintf (stderr, "%s %d %d is beyond the end of the chromosome (L=%d)\n",
-	                 chrom, start, end, chromSpec->length);
+cant_open_file:
+	fprintf (stderr, "can't open \"%s\" for reading\n", filename);
 	exit (EXIT_FAILURE);
-	}
 
-//----------
-//
-// read_interval--
-//	Read the next interval from a file.
-//
-//----------
-//
-// Arguments:
-//	FILE*		f:			File to read from.
-//	char*		buffer:		Buffer to read the line into.  Note that the caller
-//							.. should not expect anything about the contents of
-//							.. this buffer upon return.
-//	int			bufferLen:	Number of bytes allocated for the buffer.
-//	int			valCol:		The column that contains interval value;  -1
-//							.. indicates no such column.
-//	char**		chrom:		Place to return a pointer to the chromosome.  The
-//							.. returned value will point into the line buffer,
-//							.. and to a zero-terminated string.
-//	u32*		start:		Place to return the start.
-//	u32*		end:		Place to return the end.
-//	valtype*	val:		Place to return the value.
+missing_eol:
+	fprintf (stderr, "problem at line %u, line is longer than internal buffer\n",
+			 lineNumber-1);
+	exit (EXIT_FAILURE);
+
+no_chrom:
+	fprintf (stderr, "problem at line %u, line contains no chromosome or begins with whitespace\n",
+			 lineNumber);
+	exit (EXIT_FAILURE);
+
+no_length:
+	fprintf (stderr, "problem at line %u, line contains no chromosome length\n",
+			 lineNumber);
+	exit (EXIT_FAILURE);
+
+same_chromosome:
+	fprintf (stderr, "problem at line %u, chromosome \"%s\" appears more than once\n",
+			 lineNumber, chrom);
+	exit (EXIT_FAILURE);
+	}
+
+//----------
 //
-// Returns:
-//	true if we were successful;  false if there are no more lines in the file.
-//	Failures result in program termination.
+// main program--
 //
 //----------
 
-// $$$ need a way for the caller to reset lineNumber, perhaps just add a routine
-//     .. reset_read_interval;  note that this is called from several op routines
-//     .. in addition to read_intervals()
-
-int read_interval
-   (FILE*		f,
-	char*		buffer,
-	int			bufferLen,
-	int			valCol,
-	char**		_chrom,
-	u32*		_start,
-	u32*		_end,
-	valtype*	_val)
+int main
+   (int			argc,
+	char**		argv)
 	{
-	static u64	lineNumber = 0;			// u64 allows for an input stream that
-	static int	missingEol = false;		// .. consists of several files, each
-	int			reportProgressNow;		// .. covering a whole genome
-	int			lineLen;
-	char*		scan, *mark, *field;
-	int			col;
 	char*		chrom;
-	u32			start, end;
-	valtype		val;
+	u32			vLen;
+	valtype*	v;
+	spec*		chromSpec;
+	dspop*		firstOp, *stopOp, *op, *nextOp;
+	u32			maxLength;
+	u64			genomeLen;
+	u64			kindBytes[numMemKinds];
+	double		spanStart = 0.0;
+	u32			ix, chromIx;
+	int			countInput;
+	opfunc_free	funcFree;
 
-	// read the next line
+	// "genodsp compile" is a separate command, converting an interval file to
+	// the compiled format
 
-try_again:
+	if ((argc > 1) && (strcmp (argv[1], "compile") == 0))
+		return compile_main (argc-1, argv+1);
 
-	if (fgets (buffer, bufferLen, f) == NULL)
-		return false;
+	init_named_globals ();
+	set_named_global ("valColumn",     (valtype) valColumn);
+	set_named_global ("valPrecision",  (valtype) valPrecision);
+	set_named_global ("collapseRuns",  (valtype) collapseRuns);
+	set_named_global ("showUncovered", (valtype) showUncovered);
+	set_named_global ("originOne",     (valtype) originOne);
 
-	lineNumber++;
+	parse_options (argc, argv);
 
-	// check for lines getting split by fgets (the final line in the file might
-	// not have a newline, but no internal lines can be that way)
+	//////////
+	// plan the pipeline
+	//////////
 
-	if (missingEol) goto missing_eol;
+	plan_pipeline ();
 
-	lineLen = strlen(buffer);
-	if (lineLen != 0)
-		missingEol = (buffer[lineLen-1] != '\n');
+	if (explainPlan)
+		{
+		explain_plan (stdout);
+		exit (EXIT_SUCCESS);
+		}
 
-	if (dbgInput)
-		fprintf (stderr, "input = \"%s\"\n", buffer);
+	if ((memoryBudget != 0) && (plan_memory (kindBytes) > memoryBudget))
+		goto over_budget;
 
-	// ignore track lines (so that the input may be a bedgraph file)
+	drop_dead_operators ();
 
-	if (strcmp_prefix (buffer, "track ") == 0)
-		goto try_again;
+	if (traceFilename != NULL)
+		trace_open (traceFilename);
 
-	// parse the line
+	if (countHardware)
+		profile_open_counters ();
 
-	reportProgressNow = ((reportInputProgress != 0)
-	                  && ((lineNumber == 1) || (lineNumber % reportInputProgress == 0)));
+	//////////
+	// allocate vectors
+	//////////
 
-	scan = skip_whitespace(buffer);
-	if (*scan == 0)                    // empty line
-		{
-		if (reportProgressNow)
-			fprintf (stderr, "progress: input line %s\n", ucommatize(lineNumber));
-		goto try_again;
-		}
-	if (*scan == '#')                  // comment line
+	sort_chromosomes_by_length ();
+
+	// determine the length of any full-length scratch vectors;  these are as
+	// long as the longest chromosome
+
+	maxLength = 0;
+	genomeLen = 0;
+	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
 		{
-		if (reportComments)
-			fprintf (stderr, "input line %s: %s", ucommatize(lineNumber),scan);
-		else if (reportProgressNow)
-			fprintf (stderr, "progress: input line %s\n", ucommatize(lineNumber));
-		goto try_again;
+		chromSpec = chromsSorted[chromIx];
+		if (chromSpec->length == 0) goto no_length_specified;
+		if (chromSpec->length > maxLength) maxLength = chromSpec->length;
+		genomeLen += chromSpec->length;
 		}
 
-	if (reportProgressNow)
-		fprintf (stderr, "progress: input line %s\n", ucommatize(lineNumber));
-
-	chrom = scan = buffer;
-	if (*scan == ' ') goto no_chrom;
-	mark = skip_darkspace(scan);
-	scan = skip_whitespace(mark);
-	if (*mark != 0) *mark = 0;
+	init_scratch_vectors (maxLength);
 
-	if (*scan == 0) goto no_start;
-	field = scan;
-	mark = skip_darkspace(scan);
-	scan = skip_whitespace(mark);
-	if (*mark != 0) *mark = 0;
-	start = string_to_u32 (field);
+	// allocate chromosome value vectors;  if the input has no values, the
+	// signal will be coverage depth, so we start with (16-bit) integer counts
+	// instead, which are converted to values only when an operator needs them
 
-	if (*scan == 0) goto no_end;
-	field = scan;
-	mark = skip_darkspace(scan);
-	scan = skip_whitespace(mark);
-	if (*mark != 0) *mark = 0;
-	end = string_to_u32 (field);
+	op = pipeline;
+	countInput = (valColumn < 0)
+	          && ((op == NULL) || (strcmp (op->name, "input") != 0));
 
-	if ((valCol == -1) || (_val == NULL))
-		val = 1.0;
-	else
+	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
 		{
-		for (col=3 ; col<=valCol ; col++)
+		chromSpec = chromsSorted[chromIx];
+
+		if (trackOperations)
+			tracking_report ("allocate(%s / %s bytes)\n",
+			                  chromSpec->chrom, ucommatize(chromSpec->length));
+		if (profiling) spanStart = trace_clock ();
+
+		if (countInput)
 			{
-			if (*scan == 0) goto no_value;
-			field = scan;
-			mark = skip_darkspace(scan);
-			scan = skip_whitespace(mark);
+			account_memory (memSignal, chromSpec->length * (s64) sizeof(u16));
+			chromSpec->countVector = calloc (chromSpec->length, sizeof(u16));
+			if (chromSpec->countVector == NULL) goto cant_allocate_val;
+			chromSpec->countBytes  = sizeof(u16);
+			chromSpec->storage     = storeCounts;
+			if (profiling) trace_span ("allocate", "memory", chromSpec->chrom, spanStart);
+			continue;
 			}
-		if (*mark != 0) *mark = 0;
-		val = (valtype) string_to_valtype (field);
+
+		account_memory (memSignal, chromSpec->length * (s64) sizeof(valtype));
+		chromSpec->valVector = (valtype*) calloc (chromSpec->length, sizeof(valtype));
+		if (chromSpec->valVector == NULL) goto cant_allocate_val;
+		v = chromSpec->valVector;
+		for (ix=0 ; ix<chromSpec->length ; ix++)
+			v[ix] = 0.0;
+		if (profiling) trace_span ("allocate", "memory", chromSpec->chrom, spanStart);
 		}
 
+	if (trackOperations)
+		tracking_report ("allocate(--done--)\n");
+
 	//////////
-	// success
+	// process intervals
 	//////////
 
-	if (_chrom != NULL) *_chrom = chrom;
-	if (_start != NULL) *_start = start;
-	if (_end   != NULL) *_end   = end;
-	if (_val   != NULL) *_val   = val;
+	// read intervals and values;  note that if the first operator is an
+	// input operator, we avoid this step (since the first operator will
+	// overwrite whatever intervals we might have read)
 
-	return true;
+	op = pipeline;
+	if ((op == NULL) || (strcmp (op->name, "input") != 0))
+		{
+		if (profiling) profile_begin ();
+		read_intervals (stdin, valColumn, originOne, ri_overlapSum, /*clear*/ false, 0.0);
+		if (profiling) profile_end ("read signal from stdin", "*", genomeLen);
+		}
 
-	//////////
-	// failure exits
-	//
-	// nota bene: I'd like to report the line's contents with these messages,
-	//            but the line has usually been modified before we get here
-	//////////
+	// perform operations;  when possible, we perform a series of operations on
+	// one chromosome before moving onto the next;  it is expected that this
+	// will have some improvement in cache performance, at least for chromosomes
+	// smaller than the cache
 
-missing_eol:
-	fprintf (stderr, "problem at line %s, line is longer than internal buffer\n",
-			 ucommatize(lineNumber-1));
-	exit (EXIT_FAILURE);
+	firstOp = pipeline;
+	while (firstOp != NULL)
+		{
+		for (stopOp=firstOp ; stopOp!=NULL ; stopOp=stopOp->next)
+			{ if (stopOp->atRandom) break; }
 
-no_chrom:
-	fprintf (stderr, "problem at line %s, line contains no chromosome or begins with whitespace\n",
-			 ucommatize(lineNumber));
-	exit (EXIT_FAILURE);
+		if (stopOp != firstOp)
+			{
+			// run several operations serially on each chromosome
+			for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+				{
+				chromSpec = chromsSorted[chromIx];
+				for (op=firstOp ; op!=stopOp ; op=nextOp)
+					{
+					if (profiling) profile_begin ();
+					if ((op->storage & chromSpec->storage) == 0)
+						signal_to_values (chromSpec);
+					chrom = chromSpec->chrom;
+					vLen  = chromSpec->length;
+					v     = chromSpec->valVector;
+					apply_to_chromosome (chrom);
+
+					// a series of operators that can work on subranges is
+					// run over the vector a tile at a time
+
+					nextOp = op->next;
+					if ((can_apply_tiled (op)) && (chromSpec->storage == storeValues))
+						{
+						while ((nextOp != stopOp) && (can_apply_tiled (nextOp)))
+							nextOp = nextOp->next;
+						if (nextOp != op->next)
+							{
+							apply_tiled (op, nextOp, chrom, vLen, v);
+							if (profiling)
+								profile_end (stage_label (op, nextOp), chrom, vLen);
+							continue;
+							}
+						}
 
-no_start:
-	fprintf (stderr, "problem at line %s, line contains no interval start\n"
-	                 "(expected \"chromosome start end ...\", but there are fewer than 2 fields)\n",
-			 ucommatize(lineNumber));
-	exit (EXIT_FAILURE);
+					if (trackOperations)
+						fprintf (stderr, "%s(%s)\n", op->name, chrom);
+					(*op->funcApply) (op, chrom, vLen, v);
+					if (profiling)
+						profile_end (stage_label (op, nextOp), chrom, vLen);
+					}
+				}
+			apply_to_chromosome (NULL);
+			trim_scratch_vectors ();
+			}
 
-no_end:
-	fprintf (stderr, "problem at line %s, line contains no interval end\n"
-	                 "(expected \"chromosome start end ...\", but there are fewer than 3 fields)\n",
-			 ucommatize(lineNumber));
-	exit (EXIT_FAILURE);
+		if (stopOp == NULL)
+			firstOp = NULL;
+		else
+			{
+			// run one operation on all chromosomes 'simultaneously'
+			op = stopOp;
+			if (profiling) profile_begin ();
 
-no_value:
-	fprintf (stderr, "problem at line %s, line contains no interval value\n"
-	                 "(expected \"chromosome start end value\", but there are fewer than 4 fields)\n",
-			 ucommatize(lineNumber));
-	exit (EXIT_FAILURE);
-	}
+			for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+				{
+				chromSpec = chromsSorted[chromIx];
+				if ((op->storage & chromSpec->storage) == 0)
+					signal_to_values (chromSpec);
+				}
 
-//----------
-//
-// report_intervals--
-//	Report all intervals to a file.
-//
-//----------
+			if (trackOperations)
+				tracking_report ("%s(*)\n", op->name);
+			(*op->funcApply) (op, "*", maxLength, NULL);
+			if (profiling)
+				profile_end (stage_label (op, op->next), "*", genomeLen);
+			trim_scratch_vectors ();
+			firstOp = stopOp->next;
+			}
+		}
+
+	// report intervals
+
+	if (!inhibitOutput)
+		{
+		if (profiling) profile_begin ();
+		report_intervals (stdout, valPrecision, noOutputValues,
+		                  collapseRuns, showUncovered, originOne);
+		if (profiling)
+			{
+			fflush (stdout);	// (so the bytes written are counted here)
+			profile_end ("write signal to stdout", "*", genomeLen);
+			}
+		}
+
+	if (profiling)
+		{
+		if (reportProfile) profile_report (stderr);
+		if (profileFilename != NULL) profile_write_json (profileFilename);
+		profile_free ();
+		}
+
+	if ((reportMemory) || (reportProfile))
+		report_memory (stderr);
+
+	//////////
+	// success
+	//////////
+
+	// deallocate
+
+	free_scratch_vectors  ();
+	free_named_globals    ();
+	free_cached_files     ();
+	free_signal_registers ();
+
+	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+		{
+		chromSpec = chromsSorted[chromIx];
+		if (chromSpec->chrom     != NULL) free (chromSpec->chrom);
+		if (chromSpec->valVector != NULL)
+			free_signal_vector (chromSpec->valVector,
+			                    chromSpec->length * (size_t) sizeof(valtype));
+		if (chromSpec->bitVector != NULL)
+			{
+			free (chromSpec->bitVector);
+			account_memory (memSignal, -(s64) (bitsWords(chromSpec->length) * sizeof(u64)));
+			}
+		if (chromSpec->countVector != NULL)
+			{
+			free (chromSpec->countVector);
+			account_memory (memSignal, -(s64) chromSpec->length * chromSpec->countBytes);
+			}
+		if (chromSpec->runVector != NULL)
+			{
+			free (chromSpec->runVector);
+			account_memory (memSignal, -(s64) (chromSpec->numRuns * sizeof(sigrun)));
+			}
+		free (chromSpec);
+		}
+	chromsOfInterest = NULL;
+
+	free (chromsSorted);
+	chromsSorted = NULL;
+
+	for (op=pipeline ; op!=NULL ; op=nextOp)
+		{
+		nextOp = op->next;
+		if (op->name != NULL) { free (op->name);  op->name = NULL; }
+		free_op_plan (op->plan);
+		funcFree = op->funcFree;
+		funcFree (op);
+		}
+
+	// proclaim success
+
+	return EXIT_SUCCESS;
+
+	//////////
+	// failure exits
+	//////////
+
+over_budget:
+	fprintf (stderr, "the pipeline is expected to need %s bytes, more than --max-memory (%s bytes)\n",
+	                 ucommatize(plan_memory (NULL)), ucommatize(memoryBudget));
+	for (ix=0 ; ix<numMemKinds ; ix++)
+		fprintf (stderr, "  %-16s %18s\n", memKindNames[ix], ucommatize(kindBytes[ix]));
+	return EXIT_FAILURE;
+
+no_length_specified:
+	fprintf (stderr, "no length was specified for %s\n",
+	                 chromSpec->chrom);
+	return EXIT_FAILURE;
+
+cant_allocate_val:
+	fprintf (stderr, "failed to allocate %d-base vector for %s, %d bytes per base\n",
+	                 chromSpec->length, chromSpec->chrom, (int) sizeof(valtype));
+	return EXIT_FAILURE;
+	}
+
+//----------
+//
+// add_chromosome_spec--
+//	Add a chromosome to our list of chromosome specifications.
+//
+//----------
+//
+// Arguments:
+//	char*	name:			The name of the chromsome (e.g. "chr1").
+//	u32		chromStart:		The first base of interest on the chromosome
+//							.. (origin zero);  usually this is zero.
+//	u32		chromLength:	The number of bases to allocate for chromosome;
+//							.. usually this is the chromosome's length.  Note
+//							.. that if this is zero, we don't bother adding
+//							.. a record for the chromosome.
+//
+// Returns:
+//	true if successful;  false if the chromosome is already in the list;  all
+//	other failures result in program termination.
+//
+//----------
+
+static int add_chromosome_spec
+   (char*	name,
+	u32		chromStart,
+	u32		chromLength)
+	{
+	spec*	scanSpec, *tailSpec, *newSpec;
+
+	if (chromLength == 0) return true;
+
+	// check whether this chromosome name is already in use, and find the tail
+	// of the list if the name is not in use
+
+	tailSpec = NULL;
+	for (scanSpec=chromsOfInterest ; scanSpec!=NULL ; scanSpec=scanSpec->next)
+		{
+		tailSpec = scanSpec;
+		if (strcmp (name, scanSpec->chrom) == 0) return false;
+		}
+
+	// create a new spec for this chromosome and add it to the list
+
+	newSpec = (spec*) malloc (sizeof(spec));
+	if (newSpec == NULL) goto cant_allocate_spec;
+	if (tailSpec == NULL) chromsOfInterest = newSpec;
+					 else tailSpec->next   = newSpec;
+	newSpec->next      = NULL;
+	newSpec->chrom     = copy_string (name);
+	newSpec->start     = chromStart;
+	newSpec->length    = chromLength;
+	newSpec->storage   = storeValues;
+	newSpec->valVector = NULL;
+	newSpec->bitVector = NULL;
+	newSpec->countVector = NULL;
+	newSpec->countBytes  = 0;
+	newSpec->runVector   = NULL;
+	newSpec->numRuns     = 0;
+
+	return true;
+
+	//////////
+	// failure exits
+	//////////
+
+cant_allocate_spec:
+	fprintf (stderr, "failed to allocate spec for \"%s\", %d bytes\n",
+	                 name, (int) sizeof(spec));
+	exit(EXIT_FAILURE);
+	return false; // (never reaches here)
+	}
+
+
+//----------
+//
+// find_chromosome_spec--
+//	Locate the spec for a specific chromosome name.
+//
+//----------
+//
+// Arguments:
+//	char*	chrom:	name of the chromosome to look for.
+//
+// Returns:
+//	a pointer to the spec for the chromosome;  NULL if the chromosome is not
+//	in our list.
+//
+//----------
+
+spec* find_chromosome_spec
+   (char*	chrom)
+	{
+	spec*	scanSpec;
+
+	for (scanSpec=chromsOfInterest ; scanSpec!=NULL ; scanSpec=scanSpec->next)
+		{ if (strcmp (chrom, scanSpec->chrom) == 0) return scanSpec; }
+
+	return NULL;
+	}
+
+//----------
+//
+// chromosomes_to_apply--
+//	Determine the chromosomes an operator's apply function is responsible for.
+//	This is for operators that can run either on the whole genome or on one
+//	chromosome at a time, depending on how they set atRandom.
+//
+//----------
+//
+// Arguments:
+//	char*	vName:		The chromosome name the apply function was called
+//						.. with;  "*" indicates the whole genome.
+//	spec**	oneChrom:	A two-entry array the caller provides, which we fill
+//						.. in when only one chromosome is to be processed.
+//
+// Returns:
+//	A NULL-terminated array of the chromosomes to process;  this is either
+//	chromsSorted or oneChrom.
+//
+//----------
+
+spec** chromosomes_to_apply
+   (char*	vName,
+	spec**	oneChrom)
+	{
+	if (strcmp (vName, "*") == 0) return chromsSorted;
+
+	oneChrom[0] = find_chromosome_spec (vName);
+	oneChrom[1] = NULL;
+	return oneChrom;
+	}
+
+
+//----------
+//
+// sort_chromosomes_by_length--
+//	Make an array of our list of chromosome specifications, sorted by
+//	decreasing length.
+//
+//----------
+//
+// Arguments:
+//	(none)
+//
+// Returns:
+//	(nothing)
+//
+//----------
+
+int spec_length_descending (const void* _v1, const void* _v2);
+int spec_length_descending (const void* _v1, const void* _v2)
+	{
+	const u32 v1 = (*(const spec**) _v1)->length;
+	const u32 v2 = (*(const spec**) _v2)->length;
+	return (v1 < v2) - (v1 > v2);
+	}
+
+// sort_chromosomes_by_length--
+
+static void sort_chromosomes_by_length
+   (void)
+	{
+	spec*	chromSpec;
+	int		numChroms, chromIx;
+	u32		numBytes;
+
+	// count the chromosomes
+
+	numChroms = 0;
+	for (chromSpec=chromsOfInterest ; chromSpec!=NULL ; chromSpec=chromSpec->next)
+		numChroms++;
+
+	// allocate an array of pointers to the chromosome specs;  we allocate one
+	// extra entry at the end, to use as a terminator.
+
+	numBytes = (numChroms+1) * sizeof(spec*);
+	chromsSorted = (spec**) malloc (numBytes);
+	if (chromsSorted == NULL) goto cant_allocate;
+
+	// copy the pointers into the array
+
+	chromIx = 0;
+	for (chromSpec=chromsOfInterest ; chromSpec!=NULL ; chromSpec=chromSpec->next)
+		chromsSorted[chromIx++] = chromSpec;
+
+	chromsSorted[chromIx] = NULL; // (terminator)
+
+	// sort 'em
+
+	qsort (chromsSorted, numChroms, sizeof(spec*), spec_length_descending);
+
+	return;
+
+	//////////
+	// failure exits
+	//////////
+
+cant_allocate:
+	fprintf (stderr, "failed to allocate sorted chromosome list, %d bytes\n",
+	                 numBytes);
+	exit(EXIT_FAILURE);
+	}
+
+
+//----------
+//
+// read_intervals--
+//	Read all intervals from a file.
+//
+//----------
+//
+// Arguments:
+//	FILE*	f:			File to read from.
+//	int		valCol:		The column that contains interval value;  -1
+//						.. indicates no such column.
+//	int		originOne:	true  => interpret intervals as origin-one, closed
+//						false => interpret intervals as origin-zero, half-open
+//	int		overlapOp:	The operation to perform when a position is covered
+//						.. by more than one interval;  one of ri_overlapSum",
+//						.. etc.  When in doubt, sum is usually the appropriate
+//						.. choice.
+//	int		clear:		true  => zero all vectors before reading
+//	valtype	missingVal:	value to clear to (only valid if clear is true).
+//
+// Returns:
+//	nothing;  input failures result in program termination.
+//
+// Side effects:
+//	The chromsOfInterest vectors are written, representing the values of the
+//	incoming intervals.
+//
+//----------
+
+void read_intervals
+   (FILE*		f,
+	int			valCol,
+	int			originOne,
+	int			overlapOp,
+	int			clear,
+	valtype		missingVal)
+	{
+	char		lineBuffer[1001];
+	char		prevChrom[1001];
+	valtype*	v = NULL;
+	char*		chrom;
+	spec*		chromSpec;
+	u32			start, end, o, adjStart, adjEnd;
+	valtype		val;
+	u32			ix, chromIx;
+	int			ok;
+	double		spanStart = 0.0;
+
+	if (profiling) spanStart = trace_clock ();
+
+	// $$$ reset read_interval's lineNumber
+
+	if (trackOperations)
+		{
+		for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+			{
+			chromSpec = chromsSorted[chromIx];
+			chromSpec->flag = false;
+			}
+		}
+
+	// clear all chromosomes
+
+	if (clear)
+		{
+		for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+			{
+			chromSpec = chromsSorted[chromIx];
+
+			chrom = chromSpec->chrom;
+			v     = chromSpec->valVector;
+			start = 0;
+			end   = chromSpec->length;
+
+			for (ix=start ; ix<end ; ix++)
+				v[ix] = missingVal;
+			}
+
+		}
+
+	// read intervals and values
+
+	if (originOne) o = 1;
+	          else o = 0;
+
+	prevChrom[0] = 0;
+	chromSpec    = NULL;
+
+	v = NULL;
+	while (true)
+		{
+		ok = read_interval (f, lineBuffer, sizeof(lineBuffer), valCol,
+	                        &chrom, &start, &end, &val);
+		if (!ok) break;
+
+		//fprintf (stderr, "%s %u %u %f\n", chrom, start, end, val);
+
+		if (strcmp (chrom, prevChrom) != 0)
+			{
+			v = NULL;
+			chromSpec = find_chromosome_spec (chrom);
+			if (chromSpec != NULL) v = chromSpec->valVector;
+			safe_strncpy (prevChrom, chrom, sizeof(prevChrom)-1);
+			}
+
+		if (chromSpec == NULL) continue;
+
+		if ((trackOperations) && (!chromSpec->flag))
+			{
+			tracking_report ("input(%s)\n", chrom);
+			chromSpec->flag = true;
+			}
+
+		start -= o;
+		adjStart = start;
+		adjEnd   = end;
+
+		if (clipToLength)
+			{
+			// if the use has told us to clip intervals to the chromosome
+			// length, do so
+
+			if (start > chromSpec->start + chromSpec->length)
+				adjStart = start = chromSpec->start + chromSpec->length;
+
+			if (end > chromSpec->start + chromSpec->length)
+				adjEnd = end = chromSpec->start + chromSpec->length;
+			}
+
+		if (chromSpec->start == 0)
+			{
+			// if only length has been specified, we *reject* intervals beyond
+			// the end
+
+			if (end > chromSpec->length) goto chrom_too_short;
+			}
+		else
+			{
+			// if start and end have been specified, we *ignore* intervals, or
+			// portions of intervals, beyond the end
+
+			if (end <= chromSpec->start) continue;
+
+			adjEnd = end - chromSpec->start;
+			if (start <= chromSpec->start) adjStart = 0;
+			                          else adjStart = start - chromSpec->start;
+			if (adjStart >= chromSpec->length) continue;
+			if (adjEnd   >= chromSpec->length) adjEnd = chromSpec->length;
+			}
+
+		// a signal stored as counts (see main) gets integer adds
+
+		if (chromSpec->storage == storeCounts)
+			{ add_signal_counts (chromSpec, adjStart, adjEnd);  continue; }
+
+		// "write" the value into the vector, across the interval
+
+		if (overlapOp == ri_overlapMin)
+			{
+			for (ix=adjStart ; ix<adjEnd ; ix++)
+				{
+				if      ((clear) && (v[ix] == missingVal)) v[ix] = val;
+				else if (val < v[ix])                      v[ix] = val;
+				}
+			}
+		else if (overlapOp == ri_overlapMax)
+			{
+			for (ix=adjStart ; ix<adjEnd ; ix++)
+				{
+				if      ((clear) && (v[ix] == missingVal)) v[ix] = val;
+				else if (val > v[ix])                      v[ix] = val;
+				}
+			}
+		else // if (overlapOp == ri_overlapSum)
+			{
+			for (ix=adjStart ; ix<adjEnd ; ix++)
+				{
+				if ((clear) && (v[ix] == missingVal)) v[ix] =  val;
+												 else v[ix] += val;
+				}
+			}
+		}
+
+	if (trackOperations)
+		tracking_report ("input(--done--)\n");
+
+	if (profiling) trace_span ("read_intervals", "io", "*", spanStart);
+
+	//////////
+	// success
+	//////////
+
+	return;
+
+	//////////
+	// failure exits
+	//////////
+
+chrom_too_short:
+	fprintf (stderr, "%s %d %d is beyond the end of the chromosome (L=%d)\n",
+	                 chrom, start, end, chromSpec->length);
+	exit (EXIT_FAILURE);
+	}
+
+//----------
+//
+// read_interval--
+//	Read the next interval from a file.
+//
+//----------
+//
+// Arguments:
+//	FILE*		f:			File to read from.
+//	char*		buffer:		Buffer to read the line into.  Note that the caller
+//							.. should not expect anything about the contents of
+//							.. this buffer upon return.
+//	int			bufferLen:	Number of bytes allocated for the buffer.
+//	int			valCol:		The column that contains interval value;  -1
+//							.. indicates no such column.
+//	char**		chrom:		Place to return a pointer to the chromosome.  The
+//							.. returned value will point into the line buffer,
+//							.. and to a zero-terminated string.
+//	u32*		start:		Place to return the start.
+//	u32*		end:		Place to return the end.
+//	valtype*	val:		Place to return the value.
+//
+// Returns:
+//	true if we were successful;  false if there are no more lines in the file.
+//	Failures result in program termination.
+//
+//----------
+
+// $$$ need a way for the caller to reset lineNumber, perhaps just add a routine
+//     .. reset_read_interval;  note that this is called from several op routines
+//     .. in addition to read_intervals()
+
+int read_interval
+   (FILE*		f,
+	char*		buffer,
+	int			bufferLen,
+	int			valCol,
+	char**		_chrom,
+	u32*		_start,
+	u32*		_end,
+	valtype*	_val)
+	{
+	static u64	lineNumber = 0;			// u64 allows for an input stream that
+	static int	missingEol = false;		// .. consists of several files, each
+	int			reportProgressNow;		// .. covering a whole genome
+	int			lineLen;
+	char*		scan, *mark, *field;
+	int			col;
+	char*		chrom;
+	u32			start, end;
+	valtype		val;
+
+	// read the next line
+
+try_again:
+
+	if (fgets (buffer, bufferLen, f) == NULL)
+		return false;
+
+	lineNumber++;
+
+	// check for lines getting split by fgets (the final line in the file might
+	// not have a newline, but no internal lines can be that way)
+
+	if (missingEol) goto missing_eol;
+
+	lineLen = strlen(buffer);
+	if (lineLen != 0)
+		missingEol = (buffer[lineLen-1] != '\n');
+
+	if (dbgInput)
+		fprintf (stderr, "input = \"%s\"\n", buffer);
+
+	// ignore track lines (so that the input may be a bedgraph file)
+
+	if (strcmp_prefix (buffer, "track ") == 0)
+		goto try_again;
+
+	// parse the line
+
+	reportProgressNow = ((reportInputProgress != 0)
+	                  && ((lineNumber == 1) || (lineNumber % reportInputProgress == 0)));
+
+	scan = skip_whitespace(buffer);
+	if (*scan == 0)                    // empty line
+		{
+		if (reportProgressNow)
+			fprintf (stderr, "progress: input line %s\n", ucommatize(lineNumber));
+		goto try_again;
+		}
+	if (*scan == '#')                  // comment line
+		{
+		if (reportComments)
+			fprintf (stderr, "input line %s: %s", ucommatize(lineNumber),scan);
+		else if (reportProgressNow)
+			fprintf (stderr, "progress: input line %s\n", ucommatize(lineNumber));
+		goto try_again;
+		}
+
+	if (reportProgressNow)
+		fprintf (stderr, "progress: input line %s\n", ucommatize(lineNumber));
+
+	chrom = scan = buffer;
+	if (*scan == ' ') goto no_chrom;
+	mark = skip_darkspace(scan);
+	scan = skip_whitespace(mark);
+	if (*mark != 0) *mark = 0;
+
+	if (*scan == 0) goto no_start;
+	field = scan;
+	mark = skip_darkspace(scan);
+	scan = skip_whitespace(mark);
+	if (*mark != 0) *mark = 0;
+	start = string_to_u32 (field);
+
+	if (*scan == 0) goto no_end;
+	field = scan;
+	mark = skip_darkspace(scan);
+	scan = skip_whitespace(mark);
+	if (*mark != 0) *mark = 0;
+	end = string_to_u32 (field);
+
+	if ((valCol == -1) || (_val == NULL))
+		val = 1.0;
+	else
+		{
+		for (col=3 ; col<=valCol ; col++)
+			{
+			if (*scan == 0) goto no_value;
+			field = scan;
+			mark = skip_darkspace(scan);
+			scan = skip_whitespace(mark);
+			}
+		if (*mark != 0) *mark = 0;
+		val = (valtype) string_to_valtype (field);
+		}
+
+	//////////
+	// success
+	//////////
+
+	if (_chrom != NULL) *_chrom = chrom;
+	if (_start != NULL) *_start = start;
+	if (_end   != NULL) *_end   = end;
+	if (_val   != NULL) *_val   = val;
+
+	return true;
+
+	//////////
+	// failure exits
+	//
+	// nota bene: I'd like to report the line's contents with these messages,
+	//            but the line has usually been modified before we get here
+	//////////
+
+missing_eol:
+	fprintf (stderr, "problem at line %s, line is longer than internal buffer\n",
+			 ucommatize(lineNumber-1));
+	exit (EXIT_FAILURE);
+
+no_chrom:
+	fprintf (stderr, "problem at line %s, line contains no chromosome or begins with whitespace\n",
+			 ucommatize(lineNumber));
+	exit (EXIT_FAILURE);
+
+no_start:
+	fprintf (stderr, "problem at line %s, line contains no interval start\n"
+	                 "(expected \"chromosome start end ...\", but there are fewer than 2 fields)\n",
+			 ucommatize(lineNumber));
+	exit (EXIT_FAILURE);
+
+no_end:
+	fprintf (stderr, "problem at line %s, line contains no interval end\n"
+	                 "(expected \"chromosome start end ...\", but there are fewer than 3 fields)\n",
+			 ucommatize(lineNumber));
+	exit (EXIT_FAILURE);
+
+no_value:
+	fprintf (stderr, "problem at line %s, line contains no interval value\n"
+	                 "(expected \"chromosome start end value\", but there are fewer than 4 fields)\n",
+			 ucommatize(lineNumber));
+	exit (EXIT_FAILURE);
+	}
+
+//----------
+//
+// note_interval_file, interval_file_by_chromosome, open_interval_file,
+// next_interval, close_interval_file--
+//	Read intervals from a file, as operators do for their secondary input.
+//
+//	When the same file (with the same value column) is read by more than one
+//	operator in the pipeline, the first read keeps a compact copy of the
+//	intervals in memory, and later reads take them from there instead of
+//	parsing the file again.  Operators declare, when they are parsed, which
+//	files they will read (note_interval_file);  files that are only read once
+//	are never cached.  A cached copy is discarded once every use has been
+//	closed, or when the file is destroyed.  A file that has changed since it
+//	was cached (by its size, inode or modification time) is read afresh.
+//
+//	Only the chromosome, start, end and value are kept, exactly as read_interval
+//	would return them;  in particular, origin adjustment remains the caller's
+//	job, so cached intervals can be shared by operators using either origin.
+//
+//	A compiled file (see compiled.c) is recognized by its signature and read
+//	directly from its memory mapping, bypassing the cache.  Its intervals are
+//	sorted, so they may come in a different order than in the text file.
+//
+//----------
+//
+// note_interval_file--
+//
+// Arguments:
+//	char*	filename:	The file an operator will read.
+//	int		valCol:		The column the operator will read values from (as for
+//						.. read_interval).
+//
+// Returns:
+//	(nothing)
+//
+//----------
+//
+// interval_file_by_chromosome--
+//	Determine whether a file can be read one chromosome at a time without
+//	scanning the rest of it, in which case an operator needn't force a
+//	whole-genome barrier in the pipeline.  Currently this is true only for
+//	compiled files and signal registers.
+//
+// Arguments:
+//	char*	filename:	The file an operator will read.
+//
+// Returns:
+//	true if the file is indexed by chromosome;  false otherwise (including if
+//	the file doesn't exist yet).
+//
+//----------
+//
+// open_interval_file--
+//
+// Arguments:
+//	char*	filename:	The file to read.  If this is the name of a signal
+//						.. register (see store_signal_register), we read the
+//						.. register instead;  its intervals are the runs of
+//						.. identical non-zero values.
+//	int		valCol:		The column to read values from (as for read_interval).
+//	int		originOne:	true => the caller will treat coordinates as
+//						.. origin-one;  this only affects intervals from a
+//						.. register, which are reported in the caller's origin
+//						.. (as if written to a file and read back).
+//	char*	chrom:		The only chromosome the caller wants intervals for;
+//						.. "*" (or NULL) means all chromosomes.  A compiled
+//						.. file goes directly to that chromosome's intervals;
+//						.. for a text file the other chromosomes are skipped.
+//
+// Returns:
+//	A pointer to the opened file;  NULL if the file can't be opened.
+//
+//----------
+//
+// next_interval--
+//
+// Arguments:
+//	intervalfile*	f:		The file to read from.
+//	char**			chrom:	Place to return a pointer to the chromosome.  The
+//							.. caller should copy this if it is needed beyond
+//							.. the next call.
+//	u32*			start:	Place to return the start.
+//	u32*			end:	Place to return the end.
+//	valtype*		val:	Place to return the value.
+//
+// Returns:
+//	true if we were successful;  false if there are no more intervals.
+//
+//----------
+//
+// close_interval_file--
+//
+// Arguments:
+//	intervalfile*	f:			The file to close.
+//	int				destroy:	true => remove the file (and any cached copy).
+//
+// Returns:
+//	(nothing)
+//
+//----------
+
+static cachedfile*	cachedFileHead = NULL;
+
+
+void note_interval_file
+   (char*			filename,
+	int				valCol)
+	{
+	cachedfile*		cache;
+	u32				numBytes;
+
+	declare_resource_use (resourceData, filename, useRead);
+
+	if (find_signal_register (filename) != NULL)
+		{ note_signal_register_use (filename);  return; }
+
+	cache = find_cached_file (filename, valCol);
+	if (cache != NULL)
+		{ cache->numUses++;  return; }
+
+	numBytes = sizeof(cachedfile) + strlen(filename) + 1;
+	cache = (cachedfile*) malloc (numBytes);
+	if (cache == NULL) goto cant_allocate;
+
+	cache->filename = ((char*) cache) + sizeof(cachedfile);
+	strcpy (cache->filename, filename);
+	cache->valCol         = valCol;
+	cache->numUses        = 1;
+	cache->isLoaded       = false;
+	cache->numRuns        = cache->runsSize       = 0;
+	cache->numIntervals   = cache->intervalsSize  = 0;
+	cache->chromNamesLen  = cache->chromNamesSize = 0;
+	cache->accountedBytes = 0;
+	cache->runs           = NULL;
+	cache->starts         = NULL;
+	cache->ends           = NULL;
+	cache->vals           = NULL;
+	cache->chromNames     = NULL;
+
+	cache->next    = cachedFileHead;
+	cachedFileHead = cache;
+	return;
+
+cant_allocate:
+	fprintf (stderr, "failed to allocate cache record for \"%s\" (%u bytes)\n",
+	                 filename, numBytes);
+	exit(EXIT_FAILURE);
+	}
+
+
+int interval_file_by_chromosome
+   (char*			filename)
+	{
+	if (find_signal_register (filename) != NULL) return true;
+	return is_compiled_file (filename);
+	}
+
+
+intervalfile* open_interval_file
+   (char*			filename,
+	int				valCol,
+	int				originOne,
+	char*			chrom)
+	{
+	intervalfile*	f;
+	cachedfile*		cache;
+	struct stat		fileStat;
+
+	f = (intervalfile*) malloc (sizeof(intervalfile));
+	if (f == NULL) goto cant_allocate;
+
+	f->f         = NULL;
+	f->compiled  = NULL;
+	f->filename  = filename;
+	f->valCol    = valCol;
+	f->chrom     = ((chrom == NULL) || (strcmp (chrom, "*") == 0))? NULL : chrom;
+	f->cache     = NULL;
+	f->reg       = NULL;
+	f->originOne = originOne;
+	f->isLoading = false;
+	f->runIx     = 0;
+	f->ix        = 0;
+
+	// registers are read directly from memory
+
+	f->reg = find_signal_register (filename);
+	if (f->reg != NULL)
+		{
+		f->regChromIx = 0;
+		f->regPos     = 0;
+		if (f->chrom != NULL)
+			f->regChromIx = sorted_chrom_index (f->chrom);
+		return f;
+		}
+
+	if (stat (filename, &fileStat) != 0)
+		{ free (f);  return NULL; }
+
+	// compiled files are read directly;  there's nothing to gain by caching
+	// them
+
+	if (is_compiled_file (filename))
+		{
+		f->compiled = open_compiled_file (filename, valCol);
+		if (f->compiled == NULL)
+			{ free (f);  return NULL; }
+		if (f->chrom != NULL)
+			seek_compiled_chromosome (f->compiled, f->chrom);
+		return f;
+		}
+
+	// if we have a valid cached copy, read from it;  if it has gone stale,
+	// discard it
+
+	cache = find_cached_file (filename, valCol);
+	if ((cache != NULL) && (cache->isLoaded))
+		{
+		if ((fileStat.st_dev          == cache->fileDev)
+		 && (fileStat.st_ino          == cache->fileIno)
+		 && (fileStat.st_size         == cache->fileSize)
+		 && (fileStat.st_mtime        == cache->fileMtime)
+		 && (fileStat.st_mtim.tv_nsec == cache->fileMtimeNsec))
+			{
+			f->cache = cache;
+			return f;
+			}
+		free_cached_intervals (cache);
+		}
+
+	// otherwise, read the file;  if there will be more uses of it, keep a copy
+	// as we go (but not if we'll be skipping some of it)
+
+	f->f = fopen (filename, "rt");
+	if (f->f == NULL)
+		{ free (f);  return NULL; }
+
+	if ((cache != NULL) && (cache->numUses > 1) && (f->chrom == NULL))
+		{
+		f->cache     = cache;
+		f->isLoading = true;
+		cache->fileDev       = fileStat.st_dev;
+		cache->fileIno       = fileStat.st_ino;
+		cache->fileSize      = fileStat.st_size;
+		cache->fileMtime     = fileStat.st_mtime;
+		cache->fileMtimeNsec = fileStat.st_mtim.tv_nsec;
+		}
+
+	return f;
+
+cant_allocate:
+	fprintf (stderr, "failed to allocate interval file record for \"%s\" (%d bytes)\n",
+	                 filename, (int) sizeof(intervalfile));
+	exit(EXIT_FAILURE);
+	return NULL; // (never reaches here)
+	}
+
+
+int next_interval
+   (intervalfile*	f,
+	char**			chrom,
+	u32*			start,
+	u32*			end,
+	valtype*		val)
+	{
+	int				ok;
+
+	// reading from a register
+
+	if (f->reg != NULL)
+		return next_register_interval (f, chrom, start, end, val);
+
+	// reading from a compiled file (which has already been positioned to the
+	// chromosome of interest, if there is one)
+
+	if (f->compiled != NULL)
+		return next_compiled_interval (f->compiled, chrom, start, end, val);
+
+	// otherwise, skip anything not on the chromosome of interest
+
+	while (true)
+		{
+		ok = next_text_interval (f, chrom, start, end, val);
+		if (!ok) return false;
+		if ((f->chrom == NULL) || (strcmp (*chrom, f->chrom) == 0)) return true;
+		}
+	}
+
+
+static int next_text_interval
+   (intervalfile*	f,
+	char**			chrom,
+	u32*			start,
+	u32*			end,
+	valtype*		val)
+	{
+	cachedfile*		cache = f->cache;
+	cachedrun*		run;
+	int				ok;
+
+	// reading from the file
+
+	if (f->f != NULL)
+		{
+		ok = read_interval (f->f, f->lineBuffer, sizeof(f->lineBuffer), f->valCol,
+		                    chrom, start, end, val);
+		if (!ok)
+			{
+			if (f->isLoading) cache->isLoaded = true;
+			return false;
+			}
+		if (f->isLoading)
+			cache_interval (f, *chrom, *start, *end, *val);
+		return true;
+		}
+
+	// reading from the cache
+
+	if (f->runIx >= cache->numRuns) return false;
+	run = &cache->runs[f->runIx];
+
+	*chrom = cache->chromNames + run->chromOffset;
+	*start = cache->starts[f->ix];
+	*end   = cache->ends  [f->ix];
+	*val   = cache->vals  [f->ix];
+
+	if (++f->ix >= run->firstIx + run->numIntervals)
+		f->runIx++;
+
+	return true;
+	}
+
+
+void close_interval_file
+   (intervalfile*	f,
+	int				destroy)
+	{
+	cachedfile*		cache = f->cache;
+
+	if (f->compiled != NULL)
+		close_compiled_file (f->compiled);
+
+	if (f->f != NULL)
+		{
+		fclose (f->f);
+		if ((f->isLoading) && (!cache->isLoaded))  // (file wasn't read to the end)
+			free_cached_intervals (cache);
+		}
+
+	if ((destroy) && (f->reg == NULL))
+		remove (f->filename);
+
+	cache = find_cached_file (f->filename, f->valCol);
+	if (cache != NULL)
+		{
+		if (cache->numUses > 0) cache->numUses--;
+		if ((cache->numUses == 0) || (destroy))
+			free_cached_intervals (cache);
+		}
+
+	free (f);
+	}
+
+
+//----------
+//
+// open_range_file, next_range_interval, close_range_file--
+//	Read a chromosome's intervals from a file a subrange at a time, as an
+//	operator's range function does for its secondary input (see op_range in
+//	genodsp_interface.h).
+//
+//	The intervals are reported in vector coordinates (origin-zero, half-open,
+//	relative to the chromosome spec's start), clipped to the subrange.  An
+//	interval that extends beyond the subrange is carried into the next one,
+//	so the pieces of each interval are reported in the same order, relative to
+//	other intervals, in every subrange.
+//
+//	The file's intervals must be sorted by start.  This is true of the files
+//	that can be read one chromosome at a time (compiled files and signal
+//	registers, see interval_file_by_chromosome), which are the only ones an
+//	operator can be given subranges for.
+//
+//	Intervals with value zero can be ignored, and (for operators that also do
+//	something to the gaps between intervals) the intervals can be required
+//	not to overlap;  these are checked as each operator's apply function
+//	checks them, so that the same errors are reported either way.
+//
+//----------
+//
+// open_range_file--
+//
+// Arguments:
+//	char*	opName:		The operator's name (for error reports).
+//	char*	filename:	The file to read (as for open_interval_file).
+//	int		valCol:		The column to read values from (as for read_interval).
+//	int		originOne:	true => the file's coordinates are origin-one.
+//	char*	chrom:		The chromosome to read intervals for.
+//	int		skipZeros:	true => ignore intervals with value zero.
+//	int		disjoint:	true => it is an error for intervals to overlap.
+//
+// Returns:
+//	A pointer to the opened file;  NULL if the file can't be opened.
+//
+//----------
+//
+// next_range_interval--
+//
+// Arguments:
+//	rangefile*	rf:			The file to read from.
+//	u32			start:		The subrange, origin-zero half-open.  Successive
+//	u32			end:		.. subranges must be given in order, without gaps,
+//							.. beginning with start=0.
+//	u32*		pieceStart:	Place to return the part of the interval within
+//	u32*		pieceEnd:	.. the subrange.
+//	valtype*	val:		Place to return the interval's value.
+//
+// Returns:
+//	true if we were successful;  false if there are no more intervals in the
+//	subrange (the next call begins the next subrange).
+//
+//----------
+//
+// close_range_file--
+//
+// Arguments:
+//	rangefile*	rf:		The file to close.
+//
+// Returns:
+//	(nothing)
+//
+//----------
+
+rangefile* open_range_file
+   (char*			opName,
+	char*			filename,
+	int				valCol,
+	int				originOne,
+	char*			chrom,
+	int				skipZeros,
+	int				disjoint)
+	{
+	rangefile*		rf;
+
+	rf = (rangefile*) malloc (sizeof(rangefile));
+	if (rf == NULL) goto cant_allocate;
+
+	rf->f = open_interval_file (filename, valCol, originOne, chrom);
+	if (rf->f == NULL)
+		{ free (rf);  return NULL; }
+
+	rf->opName      = opName;
+	rf->filename    = filename;
+	rf->chromSpec   = find_chromosome_spec (chrom);
+	rf->o           = (originOne)? 1 : 0;
+	rf->skipZeros   = skipZeros;
+	rf->disjoint    = disjoint;
+	rf->prevEnd     = 0;
+	rf->inRange     = false;
+	rf->carryIx     = rf->numCarried = 0;
+	rf->numPending  = rf->pendingSize = 0;
+	rf->pendingEnd  = NULL;
+	rf->pendingVal  = NULL;
+	rf->haveNext    = false;
+
+	return rf;
+
+cant_allocate:
+	fprintf (stderr, "failed to allocate range file record for \"%s\" (%d bytes)\n",
+	                 filename, (int) sizeof(rangefile));
+	exit(EXIT_FAILURE);
+	return NULL; // (never reaches here)
+	}
+
+
+int next_range_interval
+   (rangefile*		rf,
+	u32				start,
+	u32				end,
+	u32*			pieceStart,
+	u32*			pieceEnd,
+	valtype*		val)
+	{
+	spec*			chromSpec = rf->chromSpec;
+	char*			chrom;
+	u32				iStart, iEnd, adjStart, adjEnd;
+	valtype			iVal;
+	int				ok;
+
+	// at the start of a subrange, everything pending is carried into it
+
+	if (!rf->inRange)
+		{
+		rf->inRange    = true;
+		rf->carryIx    = 0;
+		rf->numCarried = rf->numPending;
+		rf->numPending = 0;
+		}
+
+	// report the carried intervals first;  any that extend beyond this
+	// subrange are kept pending (compacted toward the front of the list)
+
+	if (rf->carryIx < rf->numCarried)
+		{
+		iEnd = rf->pendingEnd[rf->carryIx];
+		iVal = rf->pendingVal[rf->carryIx];
+		rf->carryIx++;
+
+		*pieceStart = start;
+		*pieceEnd   = (iEnd < end)? iEnd : end;
+		*val        = iVal;
+		if (iEnd > end)
+			{
+			rf->pendingEnd[rf->numPending] = iEnd;
+			rf->pendingVal[rf->numPending] = iVal;
+			rf->numPending++;
+			}
+		return true;
+		}
+
+	// then the intervals that begin in this subrange
+
+	while (!rf->haveNext)
+		{
+		if (rf->f == NULL) goto end_of_range;
+		ok = next_interval (rf->f, &chrom, &iStart, &iEnd, &iVal);
+		if (!ok)
+			{
+			close_interval_file (rf->f, /*destroy*/ false);
+			rf->f = NULL;
+			goto end_of_range;
+			}
+		if ((rf->skipZeros) && (iVal == 0.0)) continue;
+
+		// validate the interval, and (if necessary) shift it onto the vector
+
+		iStart  -= rf->o;
+		adjStart = iStart;
+		adjEnd   = iEnd;
+
+		if (chromSpec->start == 0)
+			{
+			// if only length has been specified, we *reject* intervals beyond
+			// the end
+
+			if (iEnd > chromSpec->length) goto chrom_too_short;
+			}
+		else
+			{
+			// if start and end have been specified, we *ignore* intervals, or
+			// portions of intervals, beyond the end
+
+			if (iEnd <= chromSpec->start) continue;
+			adjEnd = iEnd - chromSpec->start;
+			if (iStart <= chromSpec->start) adjStart = 0;
+			                           else adjStart = iStart - chromSpec->start;
+			if (adjStart >= chromSpec->length) continue;
+			if (adjEnd   >= chromSpec->length) adjEnd = chromSpec->length;
+			}
+
+		if (adjEnd <= adjStart) continue;
+		if (rf->disjoint)
+			{
+			if (adjStart < rf->prevEnd) goto intervals_overlap;
+			rf->prevEnd = adjEnd;
+			}
+		if (adjStart < start) goto intervals_out_of_order;
+
+		rf->nextStart = adjStart;
+		rf->nextEnd   = adjEnd;
+		rf->nextVal   = iVal;
+		rf->haveNext  = true;
+		}
+
+	if (rf->nextStart >= end) goto end_of_range;
+	rf->haveNext = false;
+
+	*pieceStart = rf->nextStart;
+	*pieceEnd   = (rf->nextEnd < end)? rf->nextEnd : end;
+	*val        = rf->nextVal;
+
+	if (rf->nextEnd > end)
+		{
+		if (rf->numPending >= rf->pendingSize)
+			{
+			rf->pendingSize = (rf->pendingSize == 0)? 16 : 2*rf->pendingSize;
+			rf->pendingEnd = (u32*)     realloc (rf->pendingEnd, rf->pendingSize * sizeof(u32));
+			rf->pendingVal = (valtype*) realloc (rf->pendingVal, rf->pendingSize * sizeof(valtype));
+			if ((rf->pendingEnd == NULL) || (rf->pendingVal == NULL)) goto cant_allocate;
+			}
+		rf->pendingEnd[rf->numPending] = rf->nextEnd;
+		rf->pendingVal[rf->numPending] = rf->nextVal;
+		rf->numPending++;
+		}
+
+	return true;
+
+end_of_range:
+	rf->inRange = false;
+	return false;
+
+	//////////
+	// failure exits
+	//////////
+
+chrom_too_short:
+	fprintf (stderr, "[%s] in \"%s\", %s %d %d is beyond the end of the chromosome (L=%d)\n",
+	                 rf->opName, rf->filename, chrom, iStart, iEnd, chromSpec->length);
+	exit (EXIT_FAILURE);
+
+intervals_overlap:
+	fprintf (stderr, "[%s] in \"%s\", intervals on %s are not sorted (%d..%d after %d)\n",
+	                 rf->opName, rf->filename, chrom, iStart, iEnd, chromSpec->start+rf->prevEnd);
+	exit (EXIT_FAILURE);
+
+intervals_out_of_order:
+	fprintf (stderr, "[%s] in \"%s\", intervals on %s are not sorted (%d..%d)\n",
+	                 rf->opName, rf->filename, chrom, iStart, iEnd);
+	exit (EXIT_FAILURE);
+
+cant_allocate:
+	fprintf (stderr, "[%s] failed to allocate pending intervals for \"%s\" (%s entries)\n",
+	                 rf->opName, rf->filename, ucommatize(rf->pendingSize));
+	exit (EXIT_FAILURE);
+	return false; // (never reaches here)
+	}
+
+
+void close_range_file
+   (rangefile*		rf)
+	{
+	if (rf->f != NULL) close_interval_file (rf->f, /*destroy*/ false);
+	if (rf->pendingEnd != NULL) free (rf->pendingEnd);
+	if (rf->pendingVal != NULL) free (rf->pendingVal);
+	free (rf);
+	}
+
+
+static int next_register_interval
+   (intervalfile*	f,
+	char**			chrom,
+	u32*			start,
+	u32*			end,
+	valtype*		val)
+	{
+	spec*			chromSpec;
+	valtype*		v;
+	valtype			runVal;
+	u32				pos, runStart;
+
+	while (true)
+		{
+		chromSpec = chromsSorted[f->regChromIx];
+		if (chromSpec == NULL) return false;
+		if ((f->chrom != NULL) && (strcmp (chromSpec->chrom, f->chrom) != 0))
+			return false;
+
+		v = f->reg->vectors[f->regChromIx];
+		if (v == NULL) goto not_stored;
+
+		// find the next run of identical non-zero values
+
+		for (pos=f->regPos ; pos<chromSpec->length ; pos++)
+			{ if (v[pos] != 0.0) break; }
+
+		if (pos >= chromSpec->length)
+			{ f->regChromIx++;  f->regPos = 0;  continue; }
+
+		runStart = pos;
+		runVal   = v[pos];
+		for (pos++ ; pos<chromSpec->length ; pos++)
+			{ if (v[pos] != runVal) break; }
+		f->regPos = pos;
+
+		*chrom = chromSpec->chrom;
+		*start = chromSpec->start + runStart + ((f->originOne)? 1 : 0);
+		*end   = chromSpec->start + pos;
+		*val   = (f->valCol == -1)? 1.0 : runVal;
+		return true;
+		}
+
+not_stored:
+	fprintf (stderr, "register \"%s\" holds nothing for %s\n",
+	                 f->reg->name, chromSpec->chrom);
+	exit(EXIT_FAILURE);
+	return false; // (never reaches here)
+	}
+
+
+static cachedfile* find_cached_file
+   (char*			filename,
+	int				valCol)
+	{
+	cachedfile*		cache;
+
+	for (cache=cachedFileHead ; cache!=NULL ; cache=cache->next)
+		{
+		if ((cache->valCol == valCol) && (strcmp (cache->filename, filename) == 0))
+			return cache;
+		}
+
+	return NULL;
+	}
+
+
+static void cache_interval
+   (intervalfile*	f,
+	char*			chrom,
+	u32				start,
+	u32				end,
+	valtype			val)
+	{
+	cachedfile*		cache = f->cache;
+	cachedrun*		run;
+	u32				chromLen, numBytes;
+
+	// start a new run if the chromosome has changed
+
+	run = (cache->numRuns == 0)? NULL : &cache->runs[cache->numRuns-1];
+	if ((run == NULL) || (strcmp (cache->chromNames + run->chromOffset, chrom) != 0))
+		{
+		if (cache->numRuns >= cache->runsSize)
+			{
+			cache->runsSize = (cache->runsSize == 0)? 100 : 2*cache->runsSize;
+			numBytes = cache->runsSize * sizeof(cachedrun);
+			cache->runs = (cachedrun*) realloc (cache->runs, numBytes);
+			if (cache->runs == NULL) goto cant_allocate;
+			account_cache (cache);
+			}
+
+		chromLen = strlen(chrom) + 1;
+		if (cache->chromNamesLen + chromLen > cache->chromNamesSize)
+			{
+			cache->chromNamesSize = 2*cache->chromNamesSize + chromLen + 1000;
+			numBytes = cache->chromNamesSize;
+			cache->chromNames = (char*) realloc (cache->chromNames, numBytes);
+			if (cache->chromNames == NULL) goto cant_allocate;
+			account_cache (cache);
+			}
+
+		run = &cache->runs[cache->numRuns++];
+		run->chromOffset  = cache->chromNamesLen;
+		run->firstIx      = cache->numIntervals;
+		run->numIntervals = 0;
+		strcpy (cache->chromNames + run->chromOffset, chrom);
+		cache->chromNamesLen += chromLen;
+		}
+
+	// add the interval
+
+	if (cache->numIntervals >= cache->intervalsSize)
+		{
+		cache->intervalsSize = (cache->intervalsSize == 0)? 10000 : 2*cache->intervalsSize;
+		numBytes = cache->intervalsSize * sizeof(u32);
+		cache->starts = (u32*) realloc (cache->starts, numBytes);
+		cache->ends   = (u32*) realloc (cache->ends,   numBytes);
+		numBytes = cache->intervalsSize * sizeof(valtype);
+		cache->vals   = (valtype*) realloc (cache->vals, numBytes);
+		if ((cache->starts == NULL) || (cache->ends == NULL) || (cache->vals == NULL))
+			goto cant_allocate;
+		account_cache (cache);
+		}
+
+	cache->starts[cache->numIntervals] = start;
+	cache->ends  [cache->numIntervals] = end;
+	cache->vals  [cache->numIntervals] = val;
+	cache->numIntervals++;
+	run->numIntervals++;
+	return;
+
+cant_allocate:
+	fprintf (stderr, "failed to allocate cache for \"%s\" (%u bytes)\n",
+	                 cache->filename, numBytes);
+	exit(EXIT_FAILURE);
+	}
+
+
+static void free_cached_intervals
+   (cachedfile*		cache)
+	{
+	if (cache->runs       != NULL) free (cache->runs);
+	if (cache->starts     != NULL) free (cache->starts);
+	if (cache->ends       != NULL) free (cache->ends);
+	if (cache->vals       != NULL) free (cache->vals);
+	if (cache->chromNames != NULL) free (cache->chromNames);
+	account_memory (memCache, -(s64) cache->accountedBytes);
+
+	cache->isLoaded       = false;
+	cache->accountedBytes = 0;
+	cache->numRuns        = cache->runsSize       = 0;
+	cache->numIntervals   = cache->intervalsSize  = 0;
+	cache->chromNamesLen  = cache->chromNamesSize = 0;
+	cache->runs           = NULL;
+	cache->starts         = NULL;
+	cache->ends           = NULL;
+	cache->vals           = NULL;
+	cache->chromNames     = NULL;
+	}
+
+
+static void free_cached_files
+   (void)
+	{
+	cachedfile*		cache, *cacheNext;
+
+	for (cache=cachedFileHead ; cache!=NULL ; cache=cacheNext)
+		{
+		cacheNext = cache->next;
+		free_cached_intervals (cache);
+		free (cache);
+		}
+	cachedFileHead = NULL;
+	}
+
+//----------
+//
+// report_intervals--
+//	Report all intervals to a file.
+//
+//----------
+//
+// Arguments:
+//	FILE*	f:				File to write to.
+//	int		precision:		Number of digits of precision.
+//	int		noOutputValues:	true  => just output intervals, without values
+//	int		collapseRuns:	true  => collapse runs into a single interval
+//							false => output every entry as its own interval
+//	int		showUncovered:	how to report uncovered gaps are reported as zeros
+//							  uncovered_hide => gaps are not reported
+//							  uncovered_show => gaps are reported as zeros
+//							  uncovered_NA   => gaps are reported as NAs
+//	int		originOne:		true  => report intervals as origin-one, closed
+//							false => report intervals as origin-zero, half-open
+//
+// Returns:
+//	(nothing)
+//
+//----------
+
+void report_intervals
+   (FILE*		f,
+	int			precision,
+	int			noOutputValues,
+	int			collapseRuns,
+	int			showUncovered,
+	int			originOne)
+	{
+	valtype*	v = NULL;
+	spec*		chromSpec;
+	u32			o;
+	u32			start, outputStart, outputEnd, prevOutputEnd;
+	valtype		val;
+	u32			ix;
+	int			active;
+	double		spanStart = 0.0;
+
+	if (profiling) spanStart = trace_clock ();
+
+	if (originOne) o = 1;
+	          else o = 0;
+
+	for (chromSpec=chromsOfInterest ; chromSpec!=NULL ; chromSpec=chromSpec->next)
+		{
+		if (trackOperations)
+			tracking_report ("output(%s)\n", chromSpec->chrom);
+
+		// a signal stored as bits is reported directly from the bits, if
+		// we're only reporting the runs of ones;  otherwise we convert it
+
+		if (chromSpec->storage == storeBits)
+			{
+			if ((collapseRuns) && (showUncovered == uncovered_hide))
+				{
+				report_bit_runs (f, chromSpec, precision, noOutputValues, o);
+				continue;
+				}
+			signal_to_values (chromSpec);
+			}
+
+		if (chromSpec->storage == storeCounts)
+			{
+			if ((collapseRuns) && (showUncovered == uncovered_hide))
+				{
+				report_count_runs (f, chromSpec, precision, noOutputValues, o);
+				continue;
+				}
+			signal_to_values (chromSpec);
+			}
+
+		if (chromSpec->storage == storeRuns)
+			{
+			if ((collapseRuns) && (showUncovered == uncovered_hide))
+				{
+				report_run_list (f, chromSpec, precision, noOutputValues, o);
+				continue;
+				}
+			signal_to_values (chromSpec);
+			}
+
+		v = chromSpec->valVector;
+
+		active = (showUncovered != uncovered_hide);
+
+		start = prevOutputEnd = 0;
+		val = 0.0;
+		for (ix=0 ; ix<chromSpec->length ; ix++)
+			{
+			// if this value is zero and we're hiding uncovered intervals,
+			// output the previous interval (if there was one), and set the
+			// current state to 'inactive'
+
+			if ((v[ix] == 0) && (showUncovered != uncovered_show))
+				{
+				if ((active) && (ix != start))
+					{
+					outputStart = chromSpec->start+start;
+					outputEnd   = chromSpec->start+ix;
+					if ((showUncovered == uncovered_NA)
+					 && (outputStart != prevOutputEnd))
+						fprintf (f, "%s\t%d\t%d\tNA\n",
+						            chromSpec->chrom, prevOutputEnd+o, outputStart);
+					if (noOutputValues)
+						fprintf (f, "%s\t%d\t%d\n",
+						            chromSpec->chrom, outputStart+o, outputEnd);
+
+					else
+						fprintf (f, "%s\t%d\t%d\t" valtypeFmtPrec "\n",
+						            chromSpec->chrom, outputStart+o, outputEnd,
+						            precision, val);
+					prevOutputEnd = outputEnd;
+					}
+				active = false;  start = 0;  val = 0.0;
+				continue;
+				}
+
+			// if we weren't previously 'active', mark the start of this active
+			// interval
+
+			if (!active)
+				{
+				active = true;  start = ix;  val = v[ix];
+				continue;
+				}
+
+			// if the new value is the same as the active run, and if we're
+			// supposed to collapse each equal-value runs into single output
+			// records, there's nothing else to do
+
+			if ((v[ix] == val) && (collapseRuns))
+				continue;
+
+			// otherwise, we need to output the previous active interval and
+			// mark the start of this new one 
+
+			if (ix != start)
+				{
+				outputStart = chromSpec->start+start;
+				outputEnd   = chromSpec->start+ix;
+				if ((showUncovered == uncovered_NA)
+				 && (outputStart != prevOutputEnd))
+					fprintf (f, "%s\t%d\t%d\tNA\n",
+								chromSpec->chrom, prevOutputEnd+o, outputStart);
+				if (noOutputValues)
+					fprintf (f, "%s\t%d\t%d\n",
+								chromSpec->chrom, outputStart+o, outputEnd);
+				else
+					fprintf (f, "%s\t%d\t%d\t" valtypeFmtPrec "\n",
+								chromSpec->chrom, outputStart+o, outputEnd,
+								precision, val);
+				prevOutputEnd = outputEnd;
+				}
+			active = true;  start = ix;  val = v[ix];
+			}
+
+		// show the final active interval (if there is one)
+
+		if ((active) && (chromSpec->length != start))
+			{
+			outputStart = chromSpec->start+start;
+			outputEnd   = chromSpec->start+chromSpec->length;
+			if ((showUncovered == uncovered_NA)
+			 && (outputStart != prevOutputEnd))
+				fprintf (f, "%s\t%d\t%d\tNA\n",
+							chromSpec->chrom, prevOutputEnd+o, outputStart);
+			if (noOutputValues)
+				fprintf (f, "%s\t%d\t%d\n",
+							chromSpec->chrom, outputStart+o, outputEnd);
+			else
+				fprintf (f, "%s\t%d\t%d\t" valtypeFmtPrec "\n",
+							chromSpec->chrom, outputStart+o, outputEnd,
+							precision, val);
+			prevOutputEnd = outputEnd;
+			}
+		else if ((showUncovered == uncovered_NA)
+		      && (chromSpec->start+chromSpec->length != prevOutputEnd))
+			{
+			outputEnd = chromSpec->start+chromSpec->length;
+			fprintf (f, "%s\t%d\t%d\tNA\n",
+						chromSpec->chrom, prevOutputEnd+o, outputEnd);
+			}
+		}
+
+	if (trackOperations)
+		tracking_report ("output(--done--)\n");
+
+	if (profiling) trace_span ("report_intervals", "io", "*", spanStart);
+	}
+
+
+// report_bit_runs--
+//	Report the runs of ones in a signal stored as bits.
+
+static void report_bit_runs
+   (FILE*		f,
+	spec*		chromSpec,
+	int			precision,
+	int			noOutputValues,
+	u32			o)
+	{
+	u32			pos, start, end;
+
+	pos = 0;
+	while (next_bit_run (chromSpec->bitVector, chromSpec->length, pos, &start, &end))
+		{
+		if (noOutputValues)
+			fprintf (f, "%s\t%d\t%d\n",
+			            chromSpec->chrom, chromSpec->start+start+o, chromSpec->start+end);
+		else
+			fprintf (f, "%s\t%d\t%d\t" valtypeFmtPrec "\n",
+			            chromSpec->chrom, chromSpec->start+start+o, chromSpec->start+end,
+			            precision, 1.0);
+		pos = end;
+		}
+	}
+
+
+// report_count_runs--
+//	Report the runs of equal non-zero counts in a signal stored as counts.
+
+static void report_count_runs
+   (FILE*		f,
+	spec*		chromSpec,
+	int			precision,
+	int			noOutputValues,
+	u32			o)
+	{
+	u16*		c16 = (u16*) chromSpec->countVector;
+	u32*		c32 = (u32*) chromSpec->countVector;
+	int			wide = (chromSpec->countBytes == sizeof(u32));
+	u32			start, ix, count;
+
+	for (ix=0 ; ix<chromSpec->length ; )
+		{
+		count = (wide)? c32[ix] : c16[ix];
+		start = ix;
+		if (wide) { while ((++ix < chromSpec->length) && (c32[ix] == count)) ; }
+		     else { while ((++ix < chromSpec->length) && (c16[ix] == count)) ; }
+		if (count == 0) continue;
+
+		if (noOutputValues)
+			fprintf (f, "%s\t%d\t%d\n",
+			            chromSpec->chrom, chromSpec->start+start+o, chromSpec->start+ix);
+		else
+			fprintf (f, "%s\t%d\t%d\t" valtypeFmtPrec "\n",
+			            chromSpec->chrom, chromSpec->start+start+o, chromSpec->start+ix,
+			            precision, (valtype) count);
+		}
+	}
+
+
+// report_run_list--
+//	Report the runs of ones in a signal stored as a list of runs.
+
+static void report_run_list
+   (FILE*		f,
+	spec*		chromSpec,
+	int			precision,
+	int			noOutputValues,
+	u32			o)
+	{
+	sigrun*		run;
+	u32			runIx;
+
+	for (runIx=0 ; runIx<chromSpec->numRuns ; runIx++)
+		{
+		run = &chromSpec->runVector[runIx];
+		if (noOutputValues)
+			fprintf (f, "%s\t%d\t%d\n",
+			            chromSpec->chrom, chromSpec->start+run->start+o, chromSpec->start+run->end);
+		else
+			fprintf (f, "%s\t%d\t%d\t" valtypeFmtPrec "\n",
+			            chromSpec->chrom, chromSpec->start+run->start+o, chromSpec->start+run->end,
+			            precision, 1.0);
+		}
+	}
+
+//----------
+//
+// read_all_chromosomes, write_all_chromosomes--
+//	Read/write the current data set from/to a file.  Operators can use these as
+//	a pair, to save and preserve an incomping dataset when the operation is
+//	destructive.
+//
+// No claim is made about the file format.  Files written by one run of the
+// program should not be expected to work when read into another run of the
+// program.
+//
+// $$$ this could be improved by using a smarter file format
+//
+//----------
+//
+// Arguments:
+//	char*	filename:	Name of the file to read from or write to.
+//
+// Returns:
+//	(nothing)
+//
+//----------
+
+// read_all_chromosomes--
+
+void read_all_chromosomes
+   (char*	filename)
+	{
+	FILE*	f;
+	int		saveTrackOperations;
+
+	f = fopen (filename, "rt");
+	if (f == NULL) goto cant_open_file;
+
+	if (trackOperations)
+		fprintf (stderr, "read_all(%s)\n", filename);
+
+	saveTrackOperations = trackOperations;
+	trackOperations     = false;
+	read_intervals (f,
+	                /* val column */ 4-1,
+	                /* origin one */ false,
+	                /* overlap op */ ri_overlapSum,
+	                /* clear      */ true, 0.0);
+	trackOperations = saveTrackOperations;
+
+	// success!
+
+	fclose (f);
+	return;
+
+	//////////
+	// failure exits
+	//////////
+
+cant_open_file:
+	fprintf (stderr, "can't open \"%s\" for reading\n",
+	                 filename);
+	exit (EXIT_FAILURE);
+	}
+
+
+// write_all_chromosomes--
+
+void write_all_chromosomes
+   (char*	filename)
+	{
+	FILE*	f;
+	int		saveTrackOperations;
+
+	f = fopen (filename, "wt");
+	if (f == NULL) goto cant_open_file;
+
+	if (trackOperations)
+		fprintf (stderr, "write_all(%s)\n", filename);
+
+	saveTrackOperations = trackOperations;
+	trackOperations     = false;
+	report_intervals (f,
+	                  /* precision        */ 10,
+	                  /* no output values */ false,
+	                  /* collapse runs    */ true,
+	                  /* show uncovered   */ false,
+	                  /* origin one       */ false);
+	trackOperations = saveTrackOperations;
+
+	// success!
+
+	fclose (f);
+	return;
+
+	//////////
+	// failure exits
+	//////////
+
+cant_open_file:
+	fprintf (stderr, "can't open \"%s\" for writing\n",
+	                 filename);
+	exit (EXIT_FAILURE);
+	}
+
+// binary-file versions;  these have not been debugged, and they have a problem
+
+//// read_all_chromosomes--
+//
+//void read_all_chromosomes
+//   (char*	filename)
+//	{
+//	FILE*	f;
+//	spec*	chromSpec;
+//	u32		chromIx, bytesToRead, bytesRead;
+//
+//	f = fopen (filename, "rb");
+//	if (f == NULL) goto cant_open_file;
+//
+//	if (trackOperations)
+//		fprintf (stderr, "read_all(%s)\n", filename);
+//
+//	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+//		{
+//		chromSpec = chromsSorted[chromIx];
+//
+//		bytesToRead = chromSpec->length * sizeof(valtype);
+//		bytesRead   = fread (chromSpec->valVector, 1, bytesToRead, f);
+//		if (bytesRead != bytesToRead) goto read_failure;
+//		}
+//
+//	// success!
+//
+//	fclose (f);
+//	return;
+//
+//	//////////
+//	// failure exits
+//	//////////
+//
+//cant_open_file:
+//	fprintf (stderr, "can't open \"%s\" for reading\n",
+//	                 filename);
+//	exit (EXIT_FAILURE);
+//
+//read_failure:
+//	fprintf (stderr, "problem reading from %s (attempted %d bytes, read %d)\n",
+//	                 filename, bytesToRead, bytesRead);
+//	}
+//
+//
+//// write_all_chromosomes--
+//
+//void write_all_chromosomes
+//   (char*	filename)
+//	{
+//	FILE*	f;
+//	spec*	chromSpec;
+//	u32		chromIx, bytesToWrite, bytesWritten;
+//
+//	f = fopen (filename, "wb");
+//	if (f == NULL) goto cant_open_file;
+//
+//	if (trackOperations)
+//		fprintf (stderr, "write_all(%s)\n", filename);
+//
+//	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+//		{
+//		chromSpec = chromsSorted[chromIx];
+//
+//		bytesToWrite = chromSpec->length * sizeof(valtype);
+//		bytesWritten = fwrite (chromSpec->valVector, 1, bytesToWrite, f);
+//		if (bytesWritten != bytesToWrite) goto write_failure;
+//		}
+//
+//	// success!
+//
+//	fclose (f);
+//	return;
+//
+//	//////////
+//	// failure exits
+//	//////////
+//
+//cant_open_file:
+//	fprintf (stderr, "can't open \"%s\" for writing\n",
+//	                 filename);
+//	exit (EXIT_FAILURE);
+//
+//write_failure:
+//	fprintf (stderr, "problem writing to %s (attempted %d bytes, wrote %d)\n",
+//	                 filename, bytesToWrite, bytesWritten);
+//	}
+
+//----------
+//
+// init_scratch_vectors, get_scratch_vector, release_scratch_vector, free_scratch_vectors--
+//	Allocate and reuse scratch vectors.
+//
+//	get_scratch_vector and get_scratch_ints give vectors as long as the
+//	longest chromosome;  get_sized_scratch_vector and get_sized_scratch_ints
+//	give vectors of (at least) a specified length, and should be preferred by
+//	operators that only need the current chromosome's length.
+//
+//	These can be called from any thread.  The pool is shared by all threads,
+//	but a thread prefers a free vector it used most recently, since that is
+//	more likely to still be in its cache.  Large vectors are allocated with
+//	mmap, on huge page boundaries, and we advise the kernel to back them with
+//	huge pages.
+//
+//	trim_scratch_vectors is called between pipeline stages;  it frees any
+//	vector that has not been used since the previous call, so that scratch
+//	space needed by an early operator isn't carried through the whole run.
+//
+//	swap_scratch_vector lets an operator that has computed its result into a
+//	scratch vector make that the chromosome's signal vector, rather than
+//	copying it back;  the signal's old vector becomes a free scratch vector.
+//	The scratch vector should come from get_exact_scratch_vector, which only
+//	gives a vector the size the chromosome's own would be (freeing a larger
+//	free one if it has to allocate), so that the signal doesn't grow into
+//	larger vectors;  a larger vector is copied back rather than swapped.
+//	Vectors that have moved from the pool to the signal are kept on a separate
+//	list, so that they are freed properly (free_signal_vector).
+//
+//----------
+
+#define hugePageSize (2*1024*1024)
+
+static u32		scratchLength;
+static svspec*	scratchVectorHead = NULL;
+static svspec*	signalVectorHead  = NULL;	// (vectors given to the signal)
+static pthread_mutex_t scratchLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+static void init_scratch_vectors
+   (u32 _scratchLength)
+	{
+	scratchLength     = _scratchLength;
+	scratchVectorHead = NULL;
+	}
+
+
+valtype* get_scratch_vector
+   (void)
+	{
+	return (valtype*) get_scratch_buffer (scratchLength * sizeof(valtype), false);
+	}
+
+
+valtype* get_sized_scratch_vector
+   (u32 length)
+	{
+	return (valtype*) get_scratch_buffer (length * (size_t) sizeof(valtype), false);
+	}
+
+
+valtype* get_exact_scratch_vector
+   (u32 length)
+	{
+	return (valtype*) get_scratch_buffer (length * (size_t) sizeof(valtype), true);
+	}
+
+
+s32* get_scratch_ints
+   (void)
+	{
+	return (s32*) get_scratch_buffer (scratchLength * sizeof(s32), false);
+	}
+
+
+s32* get_sized_scratch_ints
+   (u32 length)
+	{
+	return (s32*) get_scratch_buffer (length * (size_t) sizeof(s32), false);
+	}
+
+
+static void* get_scratch_buffer
+   (size_t		numBytes,
+	int			exactSize)		// true => only give a vector no larger than
+								//         .. one we'd allocate for numBytes
+	{
+	pthread_t	self = pthread_self();
+	svspec*		svSpec, *best, *larger, *prevSpec, *largerPrev;
+
+	if (numBytes == 0) numBytes = sizeof(valtype);
+
+	// look for the best free vector that's big enough;  we prefer one this
+	// thread used last, and otherwise the smallest
+
+	pthread_mutex_lock (&scratchLock);
+
+	best = larger = largerPrev = prevSpec = NULL;
+	for (svSpec=scratchVectorHead ; svSpec!=NULL ; prevSpec=svSpec,svSpec=svSpec->next)
+		{
+		if (svSpec->inUse) continue;
+		if (svSpec->numBytes < numBytes) continue;
+		if ((exactSize) && (svSpec->numBytes > scratch_alloc_size (numBytes)))
+			{
+			if ((larger == NULL) || (svSpec->numBytes < larger->numBytes))
+				{ larger = svSpec;  largerPrev = prevSpec; }
+			continue;
+			}
+		if (best == NULL) { best = svSpec;  continue; }
+		if (pthread_equal (svSpec->lastUser, self) != pthread_equal (best->lastUser, self))
+			{
+			if (pthread_equal (svSpec->lastUser, self)) best = svSpec;
+			continue;
+			}
+		if (svSpec->numBytes < best->numBytes) best = svSpec;
+		}
+
+	if (best != NULL)
+		{
+		best->inUse         = true;
+		best->usedSinceTrim = true;
+		best->lastUser      = self;
+		if (profiling) profile_note_scratch (numBytes, /*allocated*/ false);
+		pthread_mutex_unlock (&scratchLock);
+		//fprintf (stderr, "re-using scratch vector: %p\n", best->vector);
+		return best->vector;
+		}
+
+	// otherwise, allocate a new one;  the list is only locked while we add the
+	// spec, not while the vector is allocated;  if an exact size was asked for
+	// and a larger vector is free, that one is freed in exchange (otherwise
+	// vectors handed to the signal would pile up here)
+
+	if (larger != NULL)
+		{
+		if (largerPrev == NULL) scratchVectorHead = larger->next;
+		                   else largerPrev->next  = larger->next;
+		}
+
+	svSpec = malloc (sizeof(svspec));
+	if (svSpec == NULL) goto cant_allocate_spec;
+	svSpec->inUse         = true;
+	svSpec->usedSinceTrim = true;
+	svSpec->lastUser      = self;
+	svSpec->mapped        = false;
+	svSpec->numBytes      = 0;
+	svSpec->vector        = NULL;
+	svSpec->next = scratchVectorHead;
+	scratchVectorHead = svSpec;
+	if (profiling) profile_note_scratch (numBytes, /*allocated*/ true);
+
+	pthread_mutex_unlock (&scratchLock);
+
+	if (larger != NULL)
+		{
+		account_memory (memScratch, -(s64) larger->numBytes);
+		free_vector_spec (larger);
+		}
+
+	numBytes = scratch_alloc_size (numBytes);
+	account_memory (memScratch, numBytes);
+
+	if (numBytes >= hugePageSize)
+		{
+		svSpec->vector = mmap (NULL, numBytes, PROT_READ|PROT_WRITE,
+		                       MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+		if (svSpec->vector == MAP_FAILED) goto cant_allocate_scratch;
+		svSpec->mapped = true;
+#ifdef MADV_HUGEPAGE
+		madvise (svSpec->vector, numBytes, MADV_HUGEPAGE);
+#endif
+		}
+	else
+		{
+		svSpec->vector = calloc (numBytes, 1);
+		if (svSpec->vector == NULL) goto cant_allocate_scratch;
+		svSpec->mapped = false;
+		}
+
+	svSpec->numBytes = numBytes;
+	//fprintf (stderr, "allocated %s bytes for scratch vector: %p\n",
+	//                 ucommatize(numBytes), svSpec->vector);
+	return svSpec->vector;
+
+cant_allocate_spec:
+	fprintf (stderr, "failed to allocate spec for scratch vector, %d bytes\n",
+	                 (int) sizeof(svspec));
+	exit(EXIT_FAILURE);
+
+cant_allocate_scratch:
+	fprintf (stderr, "failed to allocate scratch vector, %s bytes\n",
+	                 ucommatize(numBytes));
+	exit(EXIT_FAILURE);
+	}
+
+
+void release_scratch_vector
+   (valtype*	v)
+	{
+	release_scratch_buffer (v);
+	}
+
+
+void release_scratch_ints
+   (s32*		v)
+	{
+	release_scratch_buffer (v);
+	}
+
+
+// scratch_alloc_size--
+//	The number of bytes get_scratch_buffer allocates for a request;  large
+//	vectors are rounded up to a whole number of huge pages.
+
+static size_t scratch_alloc_size
+   (size_t		numBytes)
+	{
+	if (numBytes < hugePageSize) return numBytes;
+	return (numBytes + hugePageSize-1) / hugePageSize * hugePageSize;
+	}
+
+
+static void release_scratch_buffer
+   (void*		v)
+	{
+	svspec*		svSpec;
+
+	pthread_mutex_lock (&scratchLock);
+
+	for (svSpec=scratchVectorHead ; svSpec!=NULL ; svSpec=svSpec->next)
+		{
+		if (svSpec->vector != v) continue;
+		svSpec->inUse = false;
+		//fprintf (stderr, "releasing scratch vector: %p\n", v);
+		break;
+		}
+
+	pthread_mutex_unlock (&scratchLock);
+	}
+
+
+static void trim_scratch_vectors
+   (void)
+	{
+	svspec*		svSpec, *nextSpec, *prevSpec;
+
+	pthread_mutex_lock (&scratchLock);
+
+	prevSpec = NULL;
+	for (svSpec=scratchVectorHead ; svSpec!=NULL ; svSpec=nextSpec)
+		{
+		nextSpec = svSpec->next;
+		if ((svSpec->inUse) || (svSpec->usedSinceTrim))
+			{
+			svSpec->usedSinceTrim = false;
+			prevSpec = svSpec;
+			continue;
+			}
+
+		if (trackOperations)
+			tracking_report ("trim scratch(%s bytes)\n", ucommatize(svSpec->numBytes));
+
+		if (prevSpec == NULL) scratchVectorHead = nextSpec;
+		                 else prevSpec->next    = nextSpec;
+		account_memory (memScratch, -(s64) svSpec->numBytes);
+		free_vector_spec (svSpec);
+		}
+
+	pthread_mutex_unlock (&scratchLock);
+	}
+
+
+static void free_scratch_vectors
+   (void)
+	{
+	svspec*		svSpec, *nextSpec;
+
+	for (svSpec=scratchVectorHead ; svSpec!=NULL ; svSpec=nextSpec)
+		{
+		nextSpec = svSpec->next;
+		//fprintf (stderr, "about to free scratch element: %p\n", svSpec);
+		//fprintf (stderr, "about to free scratch vector:  %p\n", svSpec->vector);
+		account_memory (memScratch, -(s64) svSpec->numBytes);
+		free_vector_spec (svSpec);
+		}
+	scratchVectorHead = NULL;
+	}
+
+
+static void free_vector_spec
+   (svspec*		svSpec)
+	{
+	if (svSpec->vector != NULL)
+		{
+		if (svSpec->mapped) munmap (svSpec->vector, svSpec->numBytes);
+		               else free   (svSpec->vector);
+		}
+	free (svSpec);
+	}
+
+
+void swap_scratch_vector
+   (char*		chrom,
+	valtype*	v)
+	{
+	spec*		chromSpec;
+	svspec*		svSpec, *oldSpec, *prevSpec;
+	valtype*	oldV;
+
+	chromSpec = find_chromosome_spec (chrom);
+	if (chromSpec == NULL) goto no_chrom;
+	oldV = chromSpec->valVector;
+
+	pthread_mutex_lock (&scratchLock);
+
+	// find the new vector in the scratch pool;  if it is larger than the
+	// chromosome's vector would be, copy it back instead, so that the signal
+	// doesn't take over oversized vectors
+
+	prevSpec = NULL;
+	for (svSpec=scratchVectorHead ; svSpec!=NULL ; svSpec=svSpec->next)
+		{ if (svSpec->vector == v) break;  prevSpec = svSpec; }
+	if (svSpec == NULL) goto not_scratch;
+
+	if (svSpec->numBytes > scratch_alloc_size (chromSpec->length * (size_t) sizeof(valtype)))
+		{
+		pthread_mutex_unlock (&scratchLock);
+		memcpy (oldV, v, chromSpec->length * sizeof(valtype));
+		release_scratch_vector (v);
+		return;
+		}
+
+	// remove it from the pool
+
+	if (prevSpec == NULL) scratchVectorHead = svSpec->next;
+	                 else prevSpec->next    = svSpec->next;
+
+	// find (or create) the spec for the old vector, and move it to the pool
+
+	prevSpec = NULL;
+	for (oldSpec=signalVectorHead ; oldSpec!=NULL ; oldSpec=oldSpec->next)
+		{ if (oldSpec->vector == oldV) break;  prevSpec = oldSpec; }
+
+	if (oldSpec != NULL)
+		{
+		if (prevSpec == NULL) signalVectorHead = oldSpec->next;
+		                 else prevSpec->next   = oldSpec->next;
+		}
+	else
+		{
+		// (the old vector is one allocated by main)
+		oldSpec = malloc (sizeof(svspec));
+		if (oldSpec == NULL) goto cant_allocate_spec;
+		oldSpec->mapped   = false;
+		oldSpec->numBytes = chromSpec->length * (size_t) sizeof(valtype);
+		oldSpec->vector   = oldV;
+		}
+
+	// (the two vectors trade places in the accounting too)
+
+	account_memory (memSignal,  (s64) svSpec->numBytes - (s64) oldSpec->numBytes);
+	account_memory (memScratch, (s64) oldSpec->numBytes - (s64) svSpec->numBytes);
+
+	oldSpec->inUse         = false;
+	oldSpec->usedSinceTrim = true;
+	oldSpec->lastUser      = pthread_self();
+	oldSpec->next          = scratchVectorHead;
+	scratchVectorHead      = oldSpec;
+
+	svSpec->next     = signalVectorHead;
+	signalVectorHead = svSpec;
+
+	pthread_mutex_unlock (&scratchLock);
+
+	chromSpec->valVector = v;
+	return;
+
+no_chrom:
+	fprintf (stderr, "internal error, can't swap vector for \"%s\"\n",
+	                 chrom);
+	exit(EXIT_FAILURE);
+
+not_scratch:
+	fprintf (stderr, "internal error, attempt to swap a non-scratch vector into \"%s\"\n",
+	                 chrom);
+	exit(EXIT_FAILURE);
+
+cant_allocate_spec:
+	fprintf (stderr, "failed to allocate spec for scratch vector, %d bytes\n",
+	                 (int) sizeof(svspec));
+	exit(EXIT_FAILURE);
+	}
+
+
+static void free_signal_vector
+   (valtype*	v,
+	size_t		numBytes)		// the vector's size, if it isn't one that
+								// .. came from the scratch pool
+	{
+	svspec*		svSpec, *prevSpec;
+
+	pthread_mutex_lock (&scratchLock);
+
+	prevSpec = NULL;
+	for (svSpec=signalVectorHead ; svSpec!=NULL ; svSpec=svSpec->next)
+		{ if (svSpec->vector == v) break;  prevSpec = svSpec; }
+
+	if (svSpec != NULL)
+		{
+		if (prevSpec == NULL) signalVectorHead = svSpec->next;
+		                 else prevSpec->next   = svSpec->next;
+		}
+
+	pthread_mutex_unlock (&scratchLock);
+
+	if (svSpec != NULL) numBytes = svSpec->numBytes;
+	account_memory (memSignal, -(s64) numBytes);
+
+	if (svSpec == NULL) free (v);
+	               else free_vector_spec (svSpec);
+	}
+
+//----------
+//
+// accept_signal_storage, new_signal_bits, install_signal_bits,
+// threshold_signal_bits, threshold_signal_runs, install_signal_runs,
+// signal_to_values, add_signal_counts, next_bit_run, fill_bit_run--
+//	Support for signals stored as something other than a vector of values.
+//
+//	A signal that is known to be binary (only zeros and ones) can be stored
+//	one bit per base, in the chromosome's bitVector, a 64x savings over a
+//	vector of values.  Operators that produce binary signals (e.g. binarize)
+//	install a bit vector with install_signal_bits, which discards the vector
+//	of values.  Operators that can consume a bit vector say so by calling
+//	accept_signal_storage from their parse function;  for any other operator,
+//	main converts the signal back to values (signal_to_values) before the
+//	operator is applied.
+//
+//	Bits beyond the end of the chromosome, in the final word of a bit vector,
+//	are always zero.
+//
+//	A coverage depth signal (input read with --novalue) starts out as integer
+//	counts in the chromosome's countVector, 16 bits per base (a 4x savings),
+//	promoted to 32 bits if any count would overflow.  Operators that threshold
+//	the signal (binarize and the morphology operators) consume counts
+//	directly.
+//
+//	A binary signal can also be stored as a list of its runs of ones, in the
+//	chromosome's runVector.  The morphology operators produce (and consume)
+//	this, so a series of them costs time proportional to the number of
+//	intervals rather than to the length of the chromosome;  the signal is
+//	only rasterized when an operator needs bits or values.
+//
+//----------
+
+void accept_signal_storage
+   (int			storage)
+	{
+	parsedStorage = storeValues | storage;
+	}
+
+//----------
+//
+// declare_footprint--
+//	Declare which positions of the signal each result of the operator
+//	currently being parsed depends on.  This is called from an operator's
+//	parse function.
+//
+//----------
 //
 // Arguments:
-//	FILE*	f:				File to write to.
-//	int		precision:		Number of digits of precision.
-//	int		noOutputValues:	true  => just output intervals, without values
-//	int		collapseRuns:	true  => collapse runs into a single interval
-//							false => output every entry as its own interval
-//	int		showUncovered:	how to report uncovered gaps are reported as zeros
-//							  uncovered_hide => gaps are not reported
-//							  uncovered_show => gaps are reported as zeros
-//							  uncovered_NA   => gaps are reported as NAs
-//	int		originOne:		true  => report intervals as origin-one, closed
-//							false => report intervals as origin-zero, half-open
+//	int		footprint:	The footprint class (one of footprintWhole, etc.).
+//	u32		haloLeft:	For footprintWindowed, how far to the left and right
+//	u32		haloRight:	.. of a position the positions it depends on can be.
+//						.. These are ignored for the other classes.
 //
 // Returns:
 //	(nothing)
 //
 //----------
 
-void report_intervals
-   (FILE*		f,
-	int			precision,
-	int			noOutputValues,
-	int			collapseRuns,
-	int			showUncovered,
-	int			originOne)
+void declare_footprint
+   (int			footprint,
+	u32			haloLeft,
+	u32			haloRight)
+	{
+	parsedFootprint = footprint;
+	parsedHaloLeft  = (footprint == footprintWindowed)? haloLeft  : 0;
+	parsedHaloRight = (footprint == footprintWindowed)? haloRight : 0;
+	}
+
+
+u64* new_signal_bits
+   (u32			length)
+	{
+	u64*		bits;
+
+	account_memory (memSignal, bitsWords(length) * (s64) sizeof(u64));
+	bits = (u64*) calloc (bitsWords(length), sizeof(u64));
+	if (bits == NULL) goto cant_allocate;
+	return bits;
+
+cant_allocate:
+	fprintf (stderr, "failed to allocate %s-base bit vector\n",
+	                 ucommatize(length));
+	exit(EXIT_FAILURE);
+	return NULL; // (never reaches here)
+	}
+
+
+void install_signal_bits
+   (char*		chrom,
+	u64*		bits)
+	{
+	spec*		chromSpec;
+
+	chromSpec = find_chromosome_spec (chrom);
+	if (chromSpec == NULL) goto no_chrom;
+
+	if (chromSpec->valVector != NULL)
+		free_signal_vector (chromSpec->valVector,
+		                    chromSpec->length * (size_t) sizeof(valtype));
+	if ((chromSpec->bitVector != NULL) && (chromSpec->bitVector != bits))
+		{
+		free (chromSpec->bitVector);
+		account_memory (memSignal, -(s64) (bitsWords(chromSpec->length) * sizeof(u64)));
+		}
+	if (chromSpec->countVector != NULL)
+		{
+		free (chromSpec->countVector);
+		account_memory (memSignal, -(s64) chromSpec->length * chromSpec->countBytes);
+		}
+	if (chromSpec->runVector != NULL)
+		{
+		free (chromSpec->runVector);
+		account_memory (memSignal, -(s64) (chromSpec->numRuns * sizeof(sigrun)));
+		}
+
+	chromSpec->countVector = NULL;
+	chromSpec->countBytes  = 0;
+	chromSpec->runVector   = NULL;
+	chromSpec->numRuns     = 0;
+	chromSpec->storage   = storeBits;
+	chromSpec->valVector = NULL;
+	chromSpec->bitVector = bits;
+	return;
+
+no_chrom:
+	fprintf (stderr, "internal error, can't install bits for \"%s\"\n",
+	                 chrom);
+	exit(EXIT_FAILURE);
+	}
+
+
+// threshold_signal_bits--
+//	Create a new bit vector, with a 1 wherever the signal is above the
+//	threshold (or at it, if tiesAbove is true).  The signal can be stored as
+//	values (in which case v is the vector of values) or as bits.
+
+u64* threshold_signal_bits
+   (char*		chrom,
+	valtype*	v,
+	u32			vLen,
+	valtype		threshold,
+	int			tiesAbove)
+	{
+	spec*		chromSpec;
+	u64*		bits, *srcBits;
+	u64			word;
+	u16*		c16;
+	u32*		c32;
+	valtype		val;
+	u32			numWords, wIx, base, n, ix;
+	int			oneBit, zeroBit, wide;
+
+	chromSpec = find_chromosome_spec (chrom);
+	bits      = new_signal_bits (vLen);
+	numWords  = bitsWords(vLen);
+
+	// a signal stored as bits is only zeros and ones, so each word is either
+	// copied, complemented, or filled with a constant
+
+	if ((chromSpec != NULL) && (chromSpec->storage == storeBits))
+		{
+		srcBits = chromSpec->bitVector;
+		oneBit  = (tiesAbove)? (1.0 >= threshold) : (1.0 > threshold);
+		zeroBit = (tiesAbove)? (0.0 >= threshold) : (0.0 > threshold);
+
+		if ((oneBit) && (zeroBit))
+			fill_bit_run (bits, 0, vLen);
+		else if (oneBit)
+			{ for (wIx=0 ; wIx<numWords ; wIx++) bits[wIx] = srcBits[wIx]; }
+		else if (zeroBit)
+			{
+			for (wIx=0 ; wIx<numWords ; wIx++) bits[wIx] = ~srcBits[wIx];
+			if (vLen % 64 != 0) bits[numWords-1] &= (((u64) 1) << (vLen % 64)) - 1;
+			}
+
+		return bits;
+		}
+
+	// a signal stored as runs is only zeros and ones, so each run (and each
+	// gap between runs) is filled or not
+
+	if ((chromSpec != NULL) && (chromSpec->storage == storeRuns))
+		{
+		oneBit  = (tiesAbove)? (1.0 >= threshold) : (1.0 > threshold);
+		zeroBit = (tiesAbove)? (0.0 >= threshold) : (0.0 > threshold);
+
+		if ((oneBit) && (zeroBit))
+			fill_bit_run (bits, 0, vLen);
+		else if (oneBit)
+			{
+			for (ix=0 ; ix<chromSpec->numRuns ; ix++)
+				fill_bit_run (bits, chromSpec->runVector[ix].start,
+				                    chromSpec->runVector[ix].end);
+			}
+		else if (zeroBit)
+			{
+			base = 0;
+			for (ix=0 ; ix<chromSpec->numRuns ; ix++)
+				{
+				fill_bit_run (bits, base, chromSpec->runVector[ix].start);
+				base = chromSpec->runVector[ix].end;
+				}
+			fill_bit_run (bits, base, vLen);
+			}
+
+		return bits;
+		}
+
+	// a signal stored as counts is compared count by count
+
+	if ((chromSpec != NULL) && (chromSpec->storage == storeCounts))
+		{
+		c16 = (u16*) chromSpec->countVector;
+		c32 = (u32*) chromSpec->countVector;
+		wide = (chromSpec->countBytes == sizeof(u32));
+		for (wIx=0 ; wIx<numWords ; wIx++)
+			{
+			base = wIx * 64;
+			n    = (vLen - base < 64)? vLen - base : 64;
+			word = 0;
+			for (ix=0 ; ix<n ; ix++)
+				{
+				val = (wide)? c32[base+ix] : c16[base+ix];
+				word |= ((u64) ((tiesAbove)? (val >= threshold) : (val > threshold))) << ix;
+				}
+			bits[wIx] = word;
+			}
+		return bits;
+		}
+
+	// otherwise, pack the comparisons 64 at a time
+
+	for (wIx=0 ; wIx<numWords ; wIx++)
+		{
+		base = wIx * 64;
+		n    = (vLen - base < 64)? vLen - base : 64;
+		word = 0;
+		if (tiesAbove)
+			{ for (ix=0 ; ix<n ; ix++) word |= ((u64) (v[base+ix] >= threshold)) << ix; }
+		else
+			{ for (ix=0 ; ix<n ; ix++) word |= ((u64) (v[base+ix] >  threshold)) << ix; }
+		bits[wIx] = word;
+		}
+
+	return bits;
+	}
+
+
+sigrun* threshold_signal_runs
+   (char*		chrom,
+	valtype*	v,
+	u32			vLen,
+	valtype		threshold,
+	int			tiesAbove,
+	u32*		_numRuns)
+	{
+	spec*		chromSpec;
+	sigrun*		runs, *srcRuns;
+	u32			numRuns, runsAllocated, numSrcRuns;
+	u16*		c16;
+	u32*		c32;
+	valtype		val;
+	u32			pos, start, end, runStart, ix;
+	int			oneIn, zeroIn, in;
+
+	chromSpec = find_chromosome_spec (chrom);
+
+	numRuns       = 0;
+	runsAllocated = 64;
+	runs = (sigrun*) malloc (runsAllocated * sizeof(sigrun));
+	if (runs == NULL) goto cant_allocate;
+
+	// a signal stored as bits or as runs is only zeros and ones, so its runs
+	// are either kept, complemented, or replaced by a constant;  if we keep
+	// the signal's own list of runs, we hand it over to the caller
+
+	if ((chromSpec != NULL)
+	 && ((chromSpec->storage == storeBits) || (chromSpec->storage == storeRuns)))
+		{
+		oneIn  = (tiesAbove)? (1.0 >= threshold) : (1.0 > threshold);
+		zeroIn = (tiesAbove)? (0.0 >= threshold) : (0.0 > threshold);
+
+		if ((oneIn) && (zeroIn))
+			append_run (&runs, &numRuns, &runsAllocated, 0, vLen);
+		else if ((oneIn) && (chromSpec->storage == storeRuns))
+			{
+			free (runs);
+			runs    = chromSpec->runVector;
+			numRuns = chromSpec->numRuns;
+			account_memory (memSignal, -(s64) (numRuns * sizeof(sigrun)));
+			chromSpec->runVector = NULL;
+			chromSpec->numRuns   = 0;
+			}
+		else if (oneIn)
+			{
+			for (pos=0 ; next_bit_run (chromSpec->bitVector, vLen, pos, &start, &end) ; pos=end)
+				append_run (&runs, &numRuns, &runsAllocated, start, end);
+			}
+		else if ((zeroIn) && (chromSpec->storage == storeRuns))
+			{
+			srcRuns    = chromSpec->runVector;
+			numSrcRuns = chromSpec->numRuns;
+			start = 0;
+			for (ix=0 ; ix<numSrcRuns ; ix++)
+				{
+				if (srcRuns[ix].start > start)
+					append_run (&runs, &numRuns, &runsAllocated, start, srcRuns[ix].start);
+				start = srcRuns[ix].end;
+				}
+			if (vLen > start)
+				append_run (&runs, &numRuns, &runsAllocated, start, vLen);
+			}
+		else if (zeroIn)
+			{
+			start = 0;
+			for (pos=0 ; next_bit_run (chromSpec->bitVector, vLen, pos, &runStart, &end) ; pos=end)
+				{
+				if (runStart > start)
+					append_run (&runs, &numRuns, &runsAllocated, start, runStart);
+				start = end;
+				}
+			if (vLen > start)
+				append_run (&runs, &numRuns, &runsAllocated, start, vLen);
+			}
+
+		*_numRuns = numRuns;
+		return runs;
+		}
+
+	// otherwise, compare base by base, noting where the comparison changes
+
+	start = 0;
+	in    = false;
+
+	if ((chromSpec != NULL) && (chromSpec->storage == storeCounts))
+		{
+		c16 = (u16*) chromSpec->countVector;
+		c32 = (u32*) chromSpec->countVector;
+		for (ix=0 ; ix<vLen ; ix++)
+			{
+			val = (chromSpec->countBytes == sizeof(u32))? c32[ix] : c16[ix];
+			if (((tiesAbove)? (val >= threshold) : (val > threshold)) == in) continue;
+			if (in) append_run (&runs, &numRuns, &runsAllocated, start, ix);
+			start = ix;  in = !in;
+			}
+		}
+	else
+		{
+		for (ix=0 ; ix<vLen ; ix++)
+			{
+			if (((tiesAbove)? (v[ix] >= threshold) : (v[ix] > threshold)) == in) continue;
+			if (in) append_run (&runs, &numRuns, &runsAllocated, start, ix);
+			start = ix;  in = !in;
+			}
+		}
+
+	if (in) append_run (&runs, &numRuns, &runsAllocated, start, vLen);
+
+	*_numRuns = numRuns;
+	return runs;
+
+cant_allocate:
+	fprintf (stderr, "failed to allocate a list of runs for %s\n", chrom);
+	exit(EXIT_FAILURE);
+	return NULL; // (never reaches here)
+	}
+
+
+void install_signal_runs
+   (char*		chrom,
+	sigrun*		runs,
+	u32			numRuns)
 	{
-	valtype*	v = NULL;
 	spec*		chromSpec;
-	u32			o;
-	u32			start, outputStart, outputEnd, prevOutputEnd;
-	valtype		val;
-	u32			ix;
-	int			active;
 
-	if (originOne) o = 1;
-	          else o = 0;
+	chromSpec = find_chromosome_spec (chrom);
+	if (chromSpec == NULL) goto no_chrom;
 
-	for (chromSpec=chromsOfInterest ; chromSpec!=NULL ; chromSpec=chromSpec->next)
+	if (chromSpec->valVector != NULL)
+		free_signal_vector (chromSpec->valVector,
+		                    chromSpec->length * (size_t) sizeof(valtype));
+	if (chromSpec->bitVector != NULL)
 		{
-		v = chromSpec->valVector;
+		free (chromSpec->bitVector);
+		account_memory (memSignal, -(s64) (bitsWords(chromSpec->length) * sizeof(u64)));
+		}
+	if (chromSpec->countVector != NULL)
+		{
+		free (chromSpec->countVector);
+		account_memory (memSignal, -(s64) chromSpec->length * chromSpec->countBytes);
+		}
+	if (chromSpec->runVector != NULL)
+		{
+		if (chromSpec->runVector != runs) free (chromSpec->runVector);
+		account_memory (memSignal, -(s64) (chromSpec->numRuns * sizeof(sigrun)));
+		}
+	account_memory (memSignal, numRuns * (s64) sizeof(sigrun));
+
+	chromSpec->storage     = storeRuns;
+	chromSpec->valVector   = NULL;
+	chromSpec->bitVector   = NULL;
+	chromSpec->countVector = NULL;
+	chromSpec->countBytes  = 0;
+	chromSpec->runVector   = runs;
+	chromSpec->numRuns     = numRuns;
+	return;
 
-		if (trackOperations)
-			tracking_report ("output(%s)\n", chromSpec->chrom);
+no_chrom:
+	fprintf (stderr, "internal error, can't install runs for \"%s\"\n",
+	                 chrom);
+	exit(EXIT_FAILURE);
+	}
 
-		active = (showUncovered != uncovered_hide);
 
-		start = prevOutputEnd = 0;
-		val = 0.0;
-		for (ix=0 ; ix<chromSpec->length ; ix++)
-			{
-			// if this value is zero and we're hiding uncovered intervals,
-			// output the previous interval (if there was one), and set the
-			// current state to 'inactive'
+// append_run--
+//	Add a run to the end of a growing list of runs.
 
-			if ((v[ix] == 0) && (showUncovered != uncovered_show))
-				{
-				if ((active) && (ix != start))
-					{
-					outputStart = chromSpec->start+start;
-					outputEnd   = chromSpec->start+ix;
-					if ((showUncovered == uncovered_NA)
-					 && (outputStart != prevOutputEnd))
-						fprintf (f, "%s\t%d\t%d\tNA\n",
-						            chromSpec->chrom, prevOutputEnd+o, outputStart);
-					if (noOutputValues)
-						fprintf (f, "%s\t%d\t%d\n",
-						            chromSpec->chrom, outputStart+o, outputEnd);
+static void append_run
+   (sigrun**	runs,
+	u32*		numRuns,
+	u32*		runsAllocated,
+	u32			start,
+	u32			end)
+	{
+	sigrun*		newRuns;
+	u32			newAllocated;
 
-					else
-						fprintf (f, "%s\t%d\t%d\t" valtypeFmtPrec "\n",
-						            chromSpec->chrom, outputStart+o, outputEnd,
-						            precision, val);
-					prevOutputEnd = outputEnd;
-					}
-				active = false;  start = 0;  val = 0.0;
-				continue;
-				}
+	if (*numRuns >= *runsAllocated)
+		{
+		newAllocated = (*runsAllocated == 0)? 64 : 2 * *runsAllocated;
+		newRuns = (sigrun*) realloc (*runs, newAllocated * sizeof(sigrun));
+		if (newRuns == NULL) goto cant_allocate;
+		*runs          = newRuns;
+		*runsAllocated = newAllocated;
+		}
 
-			// if we weren't previously 'active', mark the start of this active
-			// interval
+	(*runs)[*numRuns].start = start;
+	(*runs)[*numRuns].end   = end;
+	(*numRuns)++;
+	return;
 
-			if (!active)
-				{
-				active = true;  start = ix;  val = v[ix];
-				continue;
-				}
+cant_allocate:
+	fprintf (stderr, "failed to allocate a list of %s runs\n",
+	                 ucommatize(2 * *runsAllocated));
+	exit(EXIT_FAILURE);
+	}
 
-			// if the new value is the same as the active run, and if we're
-			// supposed to collapse each equal-value runs into single output
-			// records, there's nothing else to do
 
-			if ((v[ix] == val) && (collapseRuns))
-				continue;
+void signal_to_values
+   (spec*		chromSpec)
+	{
+	u64*		bits = chromSpec->bitVector;
+	u16*		c16  = (u16*) chromSpec->countVector;
+	u32*		c32  = (u32*) chromSpec->countVector;
+	valtype*	v;
+	u32			pos, start, end, ix;
 
-			// otherwise, we need to output the previous active interval and
-			// mark the start of this new one 
+	if (chromSpec->storage == storeValues) return;
 
-			if (ix != start)
-				{
-				outputStart = chromSpec->start+start;
-				outputEnd   = chromSpec->start+ix;
-				if ((showUncovered == uncovered_NA)
-				 && (outputStart != prevOutputEnd))
-					fprintf (f, "%s\t%d\t%d\tNA\n",
-								chromSpec->chrom, prevOutputEnd+o, outputStart);
-				if (noOutputValues)
-					fprintf (f, "%s\t%d\t%d\n",
-								chromSpec->chrom, outputStart+o, outputEnd);
-				else
-					fprintf (f, "%s\t%d\t%d\t" valtypeFmtPrec "\n",
-								chromSpec->chrom, outputStart+o, outputEnd,
-								precision, val);
-				prevOutputEnd = outputEnd;
-				}
-			active = true;  start = ix;  val = v[ix];
-			}
+	if (trackOperations)
+		tracking_report ("expand(%s)\n", chromSpec->chrom);
 
-		// show the final active interval (if there is one)
+	account_memory (memSignal, chromSpec->length * (s64) sizeof(valtype));
+	v = (valtype*) calloc (chromSpec->length, sizeof(valtype));
+	if (v == NULL) goto cant_allocate;
 
-		if ((active) && (chromSpec->length != start))
-			{
-			outputStart = chromSpec->start+start;
-			outputEnd   = chromSpec->start+chromSpec->length;
-			if ((showUncovered == uncovered_NA)
-			 && (outputStart != prevOutputEnd))
-				fprintf (f, "%s\t%d\t%d\tNA\n",
-							chromSpec->chrom, prevOutputEnd+o, outputStart);
-			if (noOutputValues)
-				fprintf (f, "%s\t%d\t%d\n",
-							chromSpec->chrom, outputStart+o, outputEnd);
-			else
-				fprintf (f, "%s\t%d\t%d\t" valtypeFmtPrec "\n",
-							chromSpec->chrom, outputStart+o, outputEnd,
-							precision, val);
-			prevOutputEnd = outputEnd;
-			}
-		else if ((showUncovered == uncovered_NA)
-		      && (chromSpec->start+chromSpec->length != prevOutputEnd))
+	if (chromSpec->storage == storeCounts)
+		{
+		if (chromSpec->countBytes == sizeof(u32))
+			{ for (ix=0 ; ix<chromSpec->length ; ix++) v[ix] = c32[ix]; }
+		else
+			{ for (ix=0 ; ix<chromSpec->length ; ix++) v[ix] = c16[ix]; }
+		free (chromSpec->countVector);
+		account_memory (memSignal, -(s64) chromSpec->length * chromSpec->countBytes);
+		chromSpec->storage     = storeValues;
+		chromSpec->valVector   = v;
+		chromSpec->countVector = NULL;
+		chromSpec->countBytes  = 0;
+		return;
+		}
+
+	if (chromSpec->storage == storeRuns)
+		{
+		for (pos=0 ; pos<chromSpec->numRuns ; pos++)
 			{
-			outputEnd = chromSpec->start+chromSpec->length;
-			fprintf (f, "%s\t%d\t%d\tNA\n",
-						chromSpec->chrom, prevOutputEnd+o, outputEnd);
+			for (ix=chromSpec->runVector[pos].start ; ix<chromSpec->runVector[pos].end ; ix++)
+				v[ix] = 1.0;
 			}
+		free (chromSpec->runVector);
+		account_memory (memSignal, -(s64) (chromSpec->numRuns * sizeof(sigrun)));
+		chromSpec->storage   = storeValues;
+		chromSpec->valVector = v;
+		chromSpec->runVector = NULL;
+		chromSpec->numRuns   = 0;
+		return;
 		}
 
-	if (trackOperations)
-		tracking_report ("output(--done--)\n");
+	pos = 0;
+	while (next_bit_run (bits, chromSpec->length, pos, &start, &end))
+		{
+		for (ix=start ; ix<end ; ix++) v[ix] = 1.0;
+		pos = end;
+		}
+
+	free (bits);
+	account_memory (memSignal, -(s64) (bitsWords(chromSpec->length) * sizeof(u64)));
+	chromSpec->storage   = storeValues;
+	chromSpec->valVector = v;
+	chromSpec->bitVector = NULL;
+	return;
 
+cant_allocate:
+	fprintf (stderr, "failed to allocate vector for %s, %s bytes\n",
+	                 chromSpec->chrom, ucommatize(chromSpec->length*sizeof(valtype)));
+	exit(EXIT_FAILURE);
+	}
+
+
+// add_signal_counts--
+//	Add one to each count in an interval.  16-bit counts that would overflow
+//	are promoted (for the whole chromosome) to 32 bits;  32-bit counts
+//	saturate.
+
+static void add_signal_counts
+   (spec*		chromSpec,
+	u32			start,
+	u32			end)
+	{
+	u16*		c16 = (u16*) chromSpec->countVector;
+	u32*		c32;
+	u32			ix;
+
+	if (chromSpec->countBytes == sizeof(u16))
+		{
+		for (ix=start ; ix<end ; ix++)
+			{ if (c16[ix] == 0xFFFF) break;  c16[ix]++; }
+		if (ix >= end) return;			// (includes empty intervals)
+
+		// promote, and finish the interval with 32-bit counts
+
+		start = ix;						// (skip the counts already added)
+		account_memory (memSignal, chromSpec->length * (s64) sizeof(u32));
+		c32 = (u32*) malloc (chromSpec->length * (size_t) sizeof(u32));
+		if (c32 == NULL) goto cant_allocate;
+		for (ix=0 ; ix<chromSpec->length ; ix++) c32[ix] = c16[ix];
+		free (c16);
+		account_memory (memSignal, -(s64) chromSpec->length * (s64) sizeof(u16));
+		chromSpec->countVector = c32;
+		chromSpec->countBytes  = sizeof(u32);
+		}
+
+	c32 = (u32*) chromSpec->countVector;
+	for (ix=start ; ix<end ; ix++)
+		{ if (c32[ix] != 0xFFFFFFFF) c32[ix]++; }
+	return;
+
+cant_allocate:
+	fprintf (stderr, "failed to allocate 32-bit counts for %s, %s bytes\n",
+	                 chromSpec->chrom, ucommatize(chromSpec->length*sizeof(u32)));
+	exit(EXIT_FAILURE);
+	}
+
+
+// next_bit_run--
+//	Find the next run of ones, at or after pos;  returns false if there are
+//	no more.
+
+int next_bit_run
+   (u64*		bits,
+	u32			length,
+	u32			pos,
+	u32*		_start,
+	u32*		_end)
+	{
+	u32			numWords = bitsWords(length);
+	u32			wIx, start, end;
+	u64			word;
+
+	if (pos >= length) return false;
+
+	// find the next one bit
+
+	wIx  = pos / 64;
+	word = bits[wIx] & (~((u64) 0) << (pos % 64));
+	while (word == 0)
+		{
+		if (++wIx >= numWords) return false;
+		word = bits[wIx];
+		}
+	start = wIx*64 + __builtin_ctzll (word);
+
+	// find the next zero bit after that
+
+	word = ~bits[wIx] & (~((u64) 0) << (start % 64));
+	while (word == 0)
+		{
+		if (++wIx >= numWords) { word = 0;  break; }
+		word = ~bits[wIx];
+		}
+	end = (word == 0)? length : wIx*64 + __builtin_ctzll (word);
+	if (end > length) end = length;
+
+	*_start = start;
+	*_end   = end;
+	return true;
+	}
+
+
+// fill_bit_run--
+//	Set the bits from start up to (but not including) end.
+
+void fill_bit_run
+   (u64*		bits,
+	u32			start,
+	u32			end)
+	{
+	u32			startWord, endWord, wIx;
+	u64			startMask, endMask;
+
+	if (start >= end) return;
+
+	startWord = start / 64;
+	endWord   = (end-1) / 64;
+	startMask = ~((u64) 0) << (start % 64);
+	endMask   = ~((u64) 0) >> (63 - ((end-1) % 64));
+
+	if (startWord == endWord)
+		{ bits[startWord] |= startMask & endMask;  return; }
+
+	bits[startWord] |= startMask;
+	for (wIx=startWord+1 ; wIx<endWord ; wIx++) bits[wIx] = ~((u64) 0);
+	bits[endWord] |= endMask;
 	}
 
 //----------
 //
-// read_all_chromosomes, write_all_chromosomes--
-//	Read/write the current data set from/to a file.  Operators can use these as
-//	a pair, to save and preserve an incomping dataset when the operation is
-//	destructive.
-//
-// No claim is made about the file format.  Files written by one run of the
-// program should not be expected to work when read into another run of the
-// program.
-//
-// $$$ this could be improved by using a smarter file format
-//
-//----------
-//
-// Arguments:
-//	char*	filename:	Name of the file to read from or write to.
+// init_named_globals, set_named_global, get_named_global, free_named_globals--
+//	Maintain a collection of named global variables.
 //
-// Returns:
-//	(nothing)
+//	set_chrom_named_global sets a variable's value for one chromosome;
+//	named_global_per_chrom lets a consumer know it must fetch such a variable
+//	anew for each chromosome.  get_named_global and named_global_exists give
+//	the value for the chromosome an operator is currently being applied to
+//	(see apply_to_chromosome);  chrom_named_global_exists gives it for any
+//	chromosome, for an operator that is applied to the whole genome at once.
 //
 //----------
 
-// read_all_chromosomes--
+static namedglobal*	namedGlobalHead    = NULL;
+static char*		appliedChrom       = NULL;
+
+
+// apply_to_chromosome--
+//	Note the chromosome that operators are being applied to (NULL if they are
+//	being applied to the whole genome).
+
+static void apply_to_chromosome
+   (char*			chrom)
+	{
+	appliedChrom = chrom;
+	}
+
+
+static void init_named_globals
+   (void)
+	{
+	namedGlobalHead = NULL;
+	}
+
+
+void set_named_global
+   (char*			name,
+	valtype			val)
+	{
+	set_named_global_value (name, /*chrom*/ NULL, val);
+	}
+
+
+void set_chrom_named_global
+   (char*			name,
+	char*			chrom,
+	valtype			val)
+	{
+	set_named_global_value (name, chrom, val);
+	}
+
+
+static void set_named_global_value
+   (char*			name,
+	char*			chrom,			// NULL => the value applies to every
+									// .. chromosome
+	valtype			val)
+	{
+	namedglobal*	ng, *ngVar;
+	u32				numBytes, nameOffset, numChroms, chromIx;
+
+	if (dbgGlobals)
+		fprintf (stderr, "set_named_global(%s," valtypeFmt "%s%s)\n",
+		                 name, val, (chrom == NULL)? "" : ",", (chrom == NULL)? "" : chrom);
+
+	ngVar = NULL;
+	for (ng=namedGlobalHead ; ng!=NULL ; ng=ng->next)
+		{
+		if ((ng->name == NULL) || (strcmp (name, ng->name) != 0)) continue;
+		ngVar = ng;
+		break;
+		}
+
+	if (ngVar == NULL)
+		{
+		numBytes   =  sizeof(namedglobal);
+		nameOffset =  numBytes;
+		numBytes   += strlen(name) + 1;
 
-void read_all_chromosomes
-   (char*	filename)
-	{
-	FILE*	f;
-	int		saveTrackOperations;
+		ngVar = (namedglobal*) malloc (numBytes);
+		if (ngVar == NULL) goto cant_allocate;
+		ngVar->next     = namedGlobalHead;
+		namedGlobalHead = ngVar;
 
-	f = fopen (filename, "rt");
-	if (f == NULL) goto cant_open_file;
+		ngVar->name = ((char*) ngVar) + nameOffset;
+		strcpy (ngVar->name, name);
+		ngVar->chromV   = NULL;
+		ngVar->chromHas = NULL;
+		}
 
-	if (trackOperations)
-		fprintf (stderr, "read_all(%s)\n", filename);
+	ngVar->v             = val;
+	ngVar->perChromosome = (chrom != NULL);
+	if (chrom == NULL) return;
 
-	saveTrackOperations = trackOperations;
-	trackOperations     = false;
-	read_intervals (f,
-	                /* val column */ 4-1,
-	                /* origin one */ false,
-	                /* overlap op */ ri_overlapSum,
-	                /* clear      */ true, 0.0);
-	trackOperations = saveTrackOperations;
+	// per-chromosome value
 
-	// success!
+	if (ngVar->chromV == NULL)
+		{
+		for (numChroms=0 ; chromsSorted[numChroms]!=NULL ; numChroms++) ;
+		numBytes = numChroms * (sizeof(valtype) + 1);
+		ngVar->chromV = (valtype*) calloc (1, numBytes);
+		if (ngVar->chromV == NULL) goto cant_allocate;
+		ngVar->chromHas = (char*) (ngVar->chromV + numChroms);
+		}
+
+	chromIx = sorted_chrom_index (chrom);
+	if (chromsSorted[chromIx] == NULL) goto no_chrom;
+	ngVar->chromV  [chromIx] = val;
+	ngVar->chromHas[chromIx] = true;
 
-	fclose (f);
 	return;
 
 	//////////
 	// failure exits
 	//////////
 
-cant_open_file:
-	fprintf (stderr, "can't open \"%s\" for reading\n",
-	                 filename);
-	exit (EXIT_FAILURE);
+cant_allocate:
+	fprintf (stderr, "failed to allocate named global \"%s\", %d bytes\n",
+	                 name, numBytes);
+	exit(EXIT_FAILURE);
+
+no_chrom:
+	fprintf (stderr, "internal error, can't set named global \"%s\" for %s\n",
+	                 name, chrom);
+	exit(EXIT_FAILURE);
 	}
 
 
-// write_all_chromosomes--
+valtype get_named_global
+   (char*			name,
+	valtype			defaultVal)
+	{
+	valtype			v;
 
-void write_all_chromosomes
-   (char*	filename)
+	if (chrom_named_global_exists (name, appliedChrom, &v))
+		return v;
+
+	if (dbgGlobals)
+		fprintf (stderr, "get_named_global(%s) = " valtypeFmt " (default)\n",
+		                 name, defaultVal);
+	return defaultVal;
+	}
+
+
+int named_global_exists
+   (char*			name,
+	valtype*		v)
 	{
-	FILE*	f;
-	int		saveTrackOperations;
+	return chrom_named_global_exists (name, appliedChrom, v);
+	}
 
-	f = fopen (filename, "wt");
-	if (f == NULL) goto cant_open_file;
 
-	if (trackOperations)
-		fprintf (stderr, "write_all(%s)\n", filename);
+int chrom_named_global_exists
+   (char*			name,
+	char*			chrom,			// NULL => the whole genome
+	valtype*		v)
+	{
+	namedglobal*	ng, *ngVar;
+	u32				chromIx;
+	valtype			val;
 
-	saveTrackOperations = trackOperations;
-	trackOperations     = false;
-	report_intervals (f,
-	                  /* precision        */ 10,
-	                  /* no output values */ false,
-	                  /* collapse runs    */ true,
-	                  /* show uncovered   */ false,
-	                  /* origin one       */ false);
-	trackOperations = saveTrackOperations;
+	if (dbgGlobals)
+		fprintf (stderr, "named_global_exists(%s%s%s) = ",
+		                 name, (chrom == NULL)? "" : ",", (chrom == NULL)? "" : chrom);
 
-	// success!
+	ngVar = NULL;
+	for (ng=namedGlobalHead ; ng!=NULL ; ng=ng->next)
+		{
+		if ((ng->name == NULL) || (strcmp (name, ng->name) != 0)) continue;
+		ngVar = ng;
+		break;
+		}
 
-	fclose (f);
-	return;
+	if (ngVar == NULL)
+		{
+		if (dbgGlobals)
+			fprintf (stderr, " (not found)\n");
+		return false;
+		}
 
-	//////////
-	// failure exits
-	//////////
+	// a per-chromosome variable has no value for a chromosome it wasn't set
+	// for;  outside of any chromosome, its most recent value is used
 
-cant_open_file:
-	fprintf (stderr, "can't open \"%s\" for writing\n",
-	                 filename);
-	exit (EXIT_FAILURE);
+	val = ngVar->v;
+	if ((ngVar->perChromosome) && (chrom != NULL))
+		{
+		chromIx = sorted_chrom_index (chrom);
+		if ((chromsSorted[chromIx] == NULL) || (!ngVar->chromHas[chromIx]))
+			{
+			if (dbgGlobals)
+				fprintf (stderr, " (not set for %s)\n", chrom);
+			return false;
+			}
+		val = ngVar->chromV[chromIx];
+		}
+
+	if (dbgGlobals)
+		fprintf (stderr, valtypeFmt "\n", val);
+	if (v != NULL) (*v) = val;
+	return true;
 	}
 
-// binary-file versions;  these have not been debugged, and they have a problem
 
-//// read_all_chromosomes--
-//
-//void read_all_chromosomes
-//   (char*	filename)
-//	{
-//	FILE*	f;
-//	spec*	chromSpec;
-//	u32		chromIx, bytesToRead, bytesRead;
-//
-//	f = fopen (filename, "rb");
-//	if (f == NULL) goto cant_open_file;
-//
-//	if (trackOperations)
-//		fprintf (stderr, "read_all(%s)\n", filename);
-//
-//	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
-//		{
-//		chromSpec = chromsSorted[chromIx];
-//
-//		bytesToRead = chromSpec->length * sizeof(valtype);
-//		bytesRead   = fread (chromSpec->valVector, 1, bytesToRead, f);
-//		if (bytesRead != bytesToRead) goto read_failure;
-//		}
-//
-//	// success!
+int named_global_per_chrom
+   (char*			name)
+	{
+	namedglobal*	ng;
+
+	for (ng=namedGlobalHead ; ng!=NULL ; ng=ng->next)
+		{
+		if ((ng->name == NULL) || (strcmp (name, ng->name) != 0)) continue;
+		return ng->perChromosome;
+		}
+
+	return false;
+	}
+
+
+static void free_named_globals
+   (void)
+	{
+	namedglobal*	ng,  *ngNext;
+
+	for (ng=namedGlobalHead ; ng!=NULL ; ng=ngNext)
+		{
+		ngNext = ng->next;
+		if (ng->chromV != NULL) free (ng->chromV);
+		free (ng);
+		}
+	namedGlobalHead = NULL;
+	}
+
+
+void report_named_globals
+   (FILE*	f,
+	char*	indent)
+	{
+	namedglobal*	ng;
+	int				nameLen, nameW;
+
+	if (indent == NULL) indent = "";
+
+	nameW = 1;
+	for (ng=namedGlobalHead ; ng!=NULL ; ng=ng->next)
+		{
+		nameLen = strlen(ng->name);
+		if (nameLen > nameW) nameW = nameLen;
+		}
+	if (nameW > 20) nameW = 20;
+
+	for (ng=namedGlobalHead ; ng!=NULL ; ng=ng->next)
+		fprintf (f, "%s%*s = " valtypeFmt "\n",
+		            indent, nameW, ng->name, ng->v);
+	}
+
+//----------
 //
-//	fclose (f);
-//	return;
+// declare_signal_register, is_signal_register, note_signal_register_use,
+// store_signal_register, recall_signal_register, free_signal_registers--
+//	Maintain a collection of named signal registers, in-memory copies of the
+//	signal.
 //
-//	//////////
-//	// failure exits
-//	//////////
+//	Registers are declared as operators are parsed (by the store operator), so
+//	that other operators can tell at parse time whether a name refers to a
+//	register or to a file.  Each reference to a register is counted;  when the
+//	last reference is a recall, the register's vectors are handed back to the
+//	signal rather than copied.
 //
-//cant_open_file:
-//	fprintf (stderr, "can't open \"%s\" for reading\n",
-//	                 filename);
-//	exit (EXIT_FAILURE);
+//	Storing and recalling are done one chromosome at a time, so that the store
+//	and recall operators needn't interrupt the per-chromosome flow of the
+//	pipeline.
 //
-//read_failure:
-//	fprintf (stderr, "problem reading from %s (attempted %d bytes, read %d)\n",
-//	                 filename, bytesToRead, bytesRead);
-//	}
+//----------
 //
+// note_signal_register_use--
 //
-//// write_all_chromosomes--
+// Arguments:
+//	char*	name:	The register's name;  this must have been declared.
 //
-//void write_all_chromosomes
-//   (char*	filename)
-//	{
-//	FILE*	f;
-//	spec*	chromSpec;
-//	u32		chromIx, bytesToWrite, bytesWritten;
+// Returns:
+//	The ordinal of this reference among all references to the register
+//	(the first is 1).  An operator can compare this to the register's final
+//	count (see recall_signal_register) to learn whether its reference is the
+//	last one.
 //
-//	f = fopen (filename, "wb");
-//	if (f == NULL) goto cant_open_file;
+//----------
 //
-//	if (trackOperations)
-//		fprintf (stderr, "write_all(%s)\n", filename);
+// store_signal_register--
 //
-//	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
-//		{
-//		chromSpec = chromsSorted[chromIx];
+// Arguments:
+//	char*	name:	The register's name.
+//	char*	chrom:	The chromosome to copy into the register.
 //
-//		bytesToWrite = chromSpec->length * sizeof(valtype);
-//		bytesWritten = fwrite (chromSpec->valVector, 1, bytesToWrite, f);
-//		if (bytesWritten != bytesToWrite) goto write_failure;
-//		}
+// Returns:
+//	(nothing)
 //
-//	// success!
+//----------
 //
-//	fclose (f);
-//	return;
+// recall_signal_register--
 //
-//	//////////
-//	// failure exits
-//	//////////
+// Arguments:
+//	char*	name:	The register's name.
+//	char*	chrom:	The chromosome to copy out of the register.
+//	u32		useIx:	The reference ordinal the operator was given by
+//					.. note_signal_register_use.
 //
-//cant_open_file:
-//	fprintf (stderr, "can't open \"%s\" for writing\n",
-//	                 filename);
-//	exit (EXIT_FAILURE);
+// Returns:
+//	(nothing)
 //
-//write_failure:
-//	fprintf (stderr, "problem writing to %s (attempted %d bytes, wrote %d)\n",
-//	                 filename, bytesToWrite, bytesWritten);
-//	}
+//----------
+
+static sigregister*	sigRegisterHead = NULL;
+
+
+void declare_signal_register
+   (char*			name)
+	{
+	sigregister*	reg;
+	u32				numBytes;
+
+	if (find_signal_register (name) != NULL) return;
+
+	numBytes = sizeof(sigregister) + strlen(name) + 1;
+	reg = (sigregister*) malloc (numBytes);
+	if (reg == NULL) goto cant_allocate;
+
+	reg->name = ((char*) reg) + sizeof(sigregister);
+	strcpy (reg->name, name);
+	reg->numUses = 0;
+	reg->vectors = NULL;
+
+	reg->next       = sigRegisterHead;
+	sigRegisterHead = reg;
+	return;
+
+cant_allocate:
+	fprintf (stderr, "failed to allocate register \"%s\", %d bytes\n",
+	                 name, numBytes);
+	exit(EXIT_FAILURE);
+	}
 
-//----------
-//
-// init_scratch_vectors, get_scratch_vector, release_scratch_vector, free_scratch_vectors--
-//	Allocate and reuse scratch vectors.
-//
-//----------
 
-static u32		scratchLength;
-static svspec*	scratchVectorHead    = NULL;
-static svispec*	scratchVectorIntHead = NULL;
+int is_signal_register
+   (char*			name)
+	{
+	return (find_signal_register (name) != NULL);
+	}
 
 
-static void init_scratch_vectors
-   (u32 _scratchLength)
+u32 note_signal_register_use
+   (char*			name)
 	{
-	scratchLength        = _scratchLength;
-	scratchVectorHead    = NULL;
-	scratchVectorIntHead = NULL;
+	sigregister*	reg;
+
+	reg = find_signal_register (name);
+	if (reg == NULL) return 0;
+
+	return ++reg->numUses;
 	}
 
 
-valtype* get_scratch_vector
-   (void)
+void store_signal_register
+   (char*			name,
+	char*			chrom)
 	{
-	svspec*	svSpec;
+	sigregister*	reg;
+	spec*			chromSpec;
+	u32				chromIx, numChroms, numBytes;
 
-	for (svSpec=scratchVectorHead ; svSpec!=NULL ; svSpec=svSpec->next)
+	reg = find_signal_register (name);
+	chromSpec = find_chromosome_spec (chrom);
+	if ((reg == NULL) || (chromSpec == NULL)) goto no_register;
+
+	// allocate the register's vector table the first time it's stored to
+
+	if (reg->vectors == NULL)
 		{
-		if (svSpec->inUse) continue;
-		svSpec->inUse = true;
-		//fprintf (stderr, "re-using scratch vector: %p\n", svSpec->vector);
-		return svSpec->vector;
+		for (numChroms=0 ; chromsSorted[numChroms]!=NULL ; numChroms++) ;
+		numBytes = (numChroms+1) * sizeof(valtype*);
+		reg->vectors = (valtype**) calloc (1, numBytes);
+		if (reg->vectors == NULL) goto cant_allocate;
 		}
 
-	svSpec = malloc (sizeof(svspec));
-	if (svSpec == NULL) goto cant_allocate_spec;
-	//fprintf (stderr, "allocated %u bytes for scratch element: %p\n",
-	//                 (u32) sizeof(svspec), svSpec);
-	svSpec->next = scratchVectorHead;
-	scratchVectorHead = svSpec;
-	svSpec->inUse = true;
+	chromIx = sorted_chrom_index (chrom);
+	if (reg->vectors[chromIx] == NULL)
+		{
+		numBytes = chromSpec->length * sizeof(valtype);
+		account_memory (memRegister, numBytes);
+		reg->vectors[chromIx] = (valtype*) malloc (numBytes);
+		if (reg->vectors[chromIx] == NULL) goto cant_allocate;
+		}
 
-	svSpec->vector = (valtype*) calloc (scratchLength, sizeof(valtype));
-	if (svSpec->vector == NULL) goto cant_allocate_scratch;
-	//fprintf (stderr, "allocated %u bytes for scratch vector: %p\n",
-	//                 (u32) (scratchLength*sizeof(valtype)), svSpec->vector);
-	return svSpec->vector;
+	memcpy (reg->vectors[chromIx], chromSpec->valVector,
+	        chromSpec->length * sizeof(valtype));
+	return;
 
-cant_allocate_spec:
-	fprintf (stderr, "failed to allocate spec for scratch vector, %d bytes\n",
-	                 (int) sizeof(svSpec));
+no_register:
+	fprintf (stderr, "internal error, can't store %s in register \"%s\"\n",
+	                 chrom, name);
 	exit(EXIT_FAILURE);
 
-cant_allocate_scratch:
-	fprintf (stderr, "failed to allocate %d-base scratch vector, %d bytes per base\n",
-	                 scratchLength, (int) sizeof(valtype));
+cant_allocate:
+	fprintf (stderr, "failed to allocate register \"%s\" for %s, %s bytes\n",
+	                 name, chrom, ucommatize(numBytes));
 	exit(EXIT_FAILURE);
 	}
 
 
-s32* get_scratch_ints
-   (void)
+void recall_signal_register
+   (char*			name,
+	char*			chrom,
+	u32				useIx)
 	{
-	svispec*	sviSpec;
+	sigregister*	reg;
+	spec*			chromSpec;
+	valtype*		v;
+	u32				chromIx;
+
+	reg = find_signal_register (name);
+	chromSpec = find_chromosome_spec (chrom);
+	if ((reg == NULL) || (chromSpec == NULL)) goto no_register;
+	if (reg->vectors == NULL) goto not_stored;
+
+	chromIx = sorted_chrom_index (chrom);
+	v = reg->vectors[chromIx];
+	if (v == NULL) goto not_stored;
 
-	for (sviSpec=scratchVectorIntHead ; sviSpec!=NULL ; sviSpec=sviSpec->next)
+	// if nothing will refer to the register after this, give its vector to the
+	// signal (and discard the signal's vector);  otherwise, copy it
+
+	if (useIx == reg->numUses)
 		{
-		if (sviSpec->inUse) continue;
-		sviSpec->inUse = true;
-		//fprintf (stderr, "re-using scratch vector: %p\n", sviSpec->vector);
-		return sviSpec->vector;
+		free_signal_vector (chromSpec->valVector,
+		                    chromSpec->length * (size_t) sizeof(valtype));
+		chromSpec->valVector  = v;
+		reg->vectors[chromIx] = NULL;
+		account_memory (memRegister, -(s64) chromSpec->length * (s64) sizeof(valtype));
+		account_memory (memSignal,    (s64) chromSpec->length * (s64) sizeof(valtype));
 		}
+	else
+		memcpy (chromSpec->valVector, v, chromSpec->length * sizeof(valtype));
 
-	sviSpec = malloc (sizeof(svispec));
-	if (sviSpec == NULL) goto cant_allocate_spec;
-	//fprintf (stderr, "allocated %u bytes for scratch element: %p\n",
-	//                 (u32) sizeof(svispec), sviSpec);
-	sviSpec->next = scratchVectorIntHead;
-	scratchVectorIntHead = sviSpec;
-	sviSpec->inUse = true;
-
-	sviSpec->vector = (s32*) calloc (scratchLength, sizeof(s32));
-	if (sviSpec->vector == NULL) goto cant_allocate_scratch;
-	//fprintf (stderr, "allocated %u bytes for scratch vector: %p\n",
-	//                 (u32) (scratchLength*sizeof(s32)), sviSpec->vector);
-	return sviSpec->vector;
+	return;
 
-cant_allocate_spec:
-	fprintf (stderr, "failed to allocate spec for int vector, %d bytes\n",
-	                 (int) sizeof(sviSpec));
+no_register:
+	fprintf (stderr, "internal error, can't recall %s from register \"%s\"\n",
+	                 chrom, name);
 	exit(EXIT_FAILURE);
 
-cant_allocate_scratch:
-	fprintf (stderr, "failed to allocate %d-base int vector, %d bytes per base\n",
-	                 scratchLength, (int) sizeof(u32));
+not_stored:
+	fprintf (stderr, "register \"%s\" holds nothing for %s\n",
+	                 name, chrom);
 	exit(EXIT_FAILURE);
 	}
 
 
-void release_scratch_vector
-   (valtype*	v)
+static sigregister* find_signal_register
+   (char*			name)
 	{
-	svspec*		svSpec;
+	sigregister*	reg;
 
-	for (svSpec=scratchVectorHead ; svSpec!=NULL ; svSpec=svSpec->next)
-		{
-		if (svSpec->vector != v) continue;
-		svSpec->inUse = false;
-		//fprintf (stderr, "releasing scratch vector: %p\n", v);
-		break;
-		}
+	for (reg=sigRegisterHead ; reg!=NULL ; reg=reg->next)
+		{ if (strcmp (name, reg->name) == 0) return reg; }
+
+	return NULL;
 	}
 
 
-void release_scratch_ints
-   (s32*		v)
+static u32 sorted_chrom_index
+   (char*			chrom)
 	{
-	svispec*	sviSpec;
+	u32				chromIx;
 
-	for (sviSpec=scratchVectorIntHead ; sviSpec!=NULL ; sviSpec=sviSpec->next)
-		{
-		if (sviSpec->vector != v) continue;
-		sviSpec->inUse = false;
-		//fprintf (stderr, "releasing scratch vector: %p\n", v);
-		break;
-		}
+	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+		{ if (strcmp (chromsSorted[chromIx]->chrom, chrom) == 0) break; }
+
+	return chromIx;
 	}
 
 
-static void free_scratch_vectors
+static void free_signal_registers
    (void)
 	{
-	svspec*		svSpec,  *nextSpec;
-	svispec*	sviSpec, *nextISpec;
-
-	for (svSpec=scratchVectorHead ; svSpec!=NULL ; svSpec=nextSpec)
-		{
-		nextSpec = svSpec->next;
-		//fprintf (stderr, "about to free scratch element: %p\n", svSpec);
-		//fprintf (stderr, "about to free scratch vector:  %p\n", svSpec->vector);
-		if (svSpec->vector != NULL) free (svSpec->vector);
-		free (svSpec);
-		}
-	scratchVectorHead = NULL;
+	sigregister*	reg, *regNext;
+	u32				chromIx;
 
-	for (sviSpec=scratchVectorIntHead ; sviSpec!=NULL ; sviSpec=nextISpec)
+	for (reg=sigRegisterHead ; reg!=NULL ; reg=regNext)
 		{
-		nextISpec = sviSpec->next;
-		//fprintf (stderr, "about to free scratch element: %p\n", sviSpec);
-		//fprintf (stderr, "about to free scratch vector:  %p\n", sviSpec->vector);
-		if (sviSpec->vector != NULL) free (sviSpec->vector);
-		free (sviSpec);
+		regNext = reg->next;
+		if (reg->vectors != NULL)
+			{
+			for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+				{
+				if (reg->vectors[chromIx] == NULL) continue;
+				free (reg->vectors[chromIx]);
+				account_memory (memRegister,
+				                -(s64) chromsSorted[chromIx]->length * (s64) sizeof(valtype));
+				}
+			free (reg->vectors);
+			}
+		free (reg);
 		}
-	scratchVectorIntHead = NULL;
+	sigRegisterHead = NULL;
 	}
 
 //----------
 //
-// init_named_globals, set_named_global, get_named_global, free_named_globals--
-//	Maintain a collection of named global variables.
+// account_memory--
+//	Record that some memory has been allocated or freed, and keep track of
+//	the peak use.
+//
+// Memory is counted in four kinds;  the signal itself (values, bits, counts
+// or runs), scratch vectors, cached interval files, and signal registers.
+// Only these large blocks are counted, not the small records that describe
+// them.  If a memory budget has been set (see --max-memory), an allocation
+// that would take the total over it is fatal.
+//
+//----------
+//
+// Arguments:
+//	int	kind:		The kind of memory (one of memSignal, etc.).
+//	s64	numBytes:	The number of bytes allocated (or freed, if negative).
+//
+// Returns:
+//	(nothing)
 //
 //----------
 
-static namedglobal*	namedGlobalHead    = NULL;
-
+static pthread_mutex_t memoryLock = PTHREAD_MUTEX_INITIALIZER;
+static s64	memInUse[numMemKinds] = { 0 };
+static s64	memPeak[numMemKinds]  = { 0 };
+static s64	memTotal     = 0;
+static s64	memPeakTotal = 0;
 
-static void init_named_globals
-   (void)
+static void account_memory
+   (int		kind,
+	s64		numBytes)
 	{
-	namedGlobalHead = NULL;
-	}
+	if (numBytes == 0) return;
 
+	pthread_mutex_lock (&memoryLock);
 
-void set_named_global
-   (char*			name,
-	valtype			val)
-	{
-	namedglobal*	ng, *ngVar;
-	u32				numBytes, nameOffset;
-
-	if (dbgGlobals)
-		fprintf (stderr, "set_named_global(%s," valtypeFmt ")\n", name, val);
+	if ((memoryBudget != 0) && (numBytes > 0)
+	 && ((u64) (memTotal + numBytes) > memoryBudget))
+		goto over_budget;
 
-	ngVar = NULL;
-	for (ng=namedGlobalHead ; ng!=NULL ; ng=ng->next)
-		{
-		if ((ng->name == NULL) || (strcmp (name, ng->name) != 0)) continue;
-		ngVar = ng;
-		break;
-		}
+	memInUse[kind] += numBytes;
+	memTotal       += numBytes;
+	if (memInUse[kind] > memPeak[kind]) memPeak[kind] = memInUse[kind];
+	if (memTotal       > memPeakTotal)  memPeakTotal  = memTotal;
 
-	if (ngVar == NULL)
-		{
-		numBytes   =  sizeof(namedglobal);
-		nameOffset =  numBytes;
-		numBytes   += strlen(name) + 1;
+	pthread_mutex_unlock (&memoryLock);
+	return;
 
-		ngVar = (namedglobal*) malloc (numBytes);
-		if (ngVar == NULL) goto cant_allocate;
-		ngVar->next     = namedGlobalHead;
-		namedGlobalHead = ngVar;
+over_budget:
+	pthread_mutex_unlock (&memoryLock);
+	fprintf (stderr, "memory use would exceed --max-memory (%s bytes);"
+	                 "  %s more bytes needed for %s\n",
+	                 ucommatize(memoryBudget), ucommatize((u64) numBytes),
+	                 memKindNames[kind]);
+	report_memory (stderr);
+	exit(EXIT_FAILURE);
+	}
 
-		ngVar->name = ((char*) ngVar) + nameOffset;
-		strcpy (ngVar->name, name);
-		}
 
-	ngVar->v = val;
+// account_cache--
+//	Bring the memory counted for a cached interval file up to date with its
+//	allocated size.
 
-	return;
+static void account_cache
+   (cachedfile*	cache)
+	{
+	size_t		numBytes;
 
-	//////////
-	// failure exits
-	//////////
+	numBytes = cache->runsSize      * sizeof(cachedrun)
+	         + cache->chromNamesSize
+	         + cache->intervalsSize * (2*sizeof(u32) + sizeof(valtype));
 
-cant_allocate:
-	fprintf (stderr, "failed to allocate named global \"%s\", %d bytes\n",
-	                 name, numBytes);
-	exit(EXIT_FAILURE);
+	account_memory (memCache, (s64) numBytes - (s64) cache->accountedBytes);
+	cache->accountedBytes = numBytes;
 	}
 
 
-valtype get_named_global
-   (char*			name,
-	valtype			defaultVal)
+// report_memory--
+//	Report the current and peak memory use of each kind (see account_memory).
+
+static void report_memory
+   (FILE*		f)
 	{
-	namedglobal*	ng, *ngVar;
+	int			kind;
 
-	if (dbgGlobals)
-		fprintf (stderr, "get_named_global(%s) = ", name);
+	pthread_mutex_lock (&memoryLock);
 
-	ngVar = NULL;
-	for (ng=namedGlobalHead ; ng!=NULL ; ng=ng->next)
+	fprintf (f, "%-16s %18s %18s\n", "memory", "current", "peak");
+	for (kind=0 ; kind<numMemKinds ; kind++)
+		fprintf (f, "%-16s %18s %18s\n", memKindNames[kind],
+		            ucommatize((u64) memInUse[kind]), ucommatize((u64) memPeak[kind]));
+	fprintf (f, "%-16s %18s %18s\n", "total",
+	            ucommatize((u64) memTotal), ucommatize((u64) memPeakTotal));
+	if (memoryBudget != 0)
+		fprintf (f, "%-16s %18s %18s\n", "budget", "", ucommatize(memoryBudget));
+
+	pthread_mutex_unlock (&memoryLock);
+	}
+
+//----------
+//
+// plan_memory--
+//	Estimate the peak memory the pipeline will need, as planned.
+//
+// The estimate counts the signal (eight bytes per base, or two if the input
+// is coverage depth and every operator can work on counts), a scratch vector
+// as long as the longest chromosome for each thread if any operator looks at
+// more than the current position, a copy of the signal for each register that
+// is stored to, and each text file that will be cached.  Sizes follow what the
+// allocators actually do;  scratch vectors are rounded up to huge pages (see
+// scratch_alloc_size), and since such an operator may swap a scratch vector
+// into the signal, so is each chromosome's signal vector.  A cache's size is
+// found by scanning the file the way cache_interval would grow it.  Operators
+// the planner has dropped are ignored.
+//
+//----------
+//
+// Arguments:
+//	u64*	kindBytes:	Place to return the estimate for each kind of memory
+//						(see account_memory);  this may be NULL.
+//
+// Returns:
+//	The estimated total.
+//
+//----------
+
+static u64 plan_memory
+   (u64*		kindBytes)
+	{
+	u64			bytes[numMemKinds];
+	spec*		chromSpec;
+	dspop*		op, *scanOp;
+	planuse*	use, *scanUse;
+	cachedfile*	cache;
+	u64			genomeLen, total;
+	u32			maxLength, numChroms, numReaders;
+	int			countInput, countsOnly, needsScratch, kind, seen;
+
+	genomeLen = maxLength = numChroms = 0;
+	for (chromSpec=chromsOfInterest ; chromSpec!=NULL ; chromSpec=chromSpec->next)
 		{
-		if ((ng->name == NULL) || (strcmp (name, ng->name) != 0)) continue;
-		ngVar = ng;
-		break;
+		numChroms++;
+		genomeLen += chromSpec->length;
+		if (chromSpec->length > maxLength) maxLength = chromSpec->length;
 		}
 
-	if (ngVar == NULL)
+	for (kind=0 ; kind<numMemKinds ; kind++) bytes[kind] = 0;
+
+	// signal and scratch vectors
+
+	for (op=pipeline ; op!=NULL ; op=op->next)
+		{ if (op->plan->dropReason == NULL) break; }
+	countInput = (valColumn < 0)
+	          && ((op == NULL) || (strcmp (op->name, "input") != 0));
+	countsOnly = countInput;
+
+	needsScratch = false;
+	for ( ; op!=NULL ; op=op->next)
 		{
-		if (dbgGlobals)
-			fprintf (stderr, valtypeFmt " (default)\n", defaultVal);
-		return defaultVal;
+		if (op->plan->dropReason != NULL) continue;
+		if ((op->plan->signalUse & useRead) == 0) continue;
+		if ((op->storage & storeCounts) == 0) countsOnly = false;
+		if ((op->footprint != footprintPointwise)
+		 && (op->footprint != footprintScan))
+			needsScratch = true;
 		}
+
+	if (countsOnly)
+		bytes[memSignal] = genomeLen * sizeof(u16);
+	else if (!needsScratch)
+		bytes[memSignal] = genomeLen * sizeof(valtype);
 	else
 		{
-		if (dbgGlobals)
-			fprintf (stderr, valtypeFmt "\n", ngVar->v);
-		return ngVar->v;
+		for (chromSpec=chromsOfInterest ; chromSpec!=NULL ; chromSpec=chromSpec->next)
+			bytes[memSignal] += scratch_alloc_size (chromSpec->length * (size_t) sizeof(valtype));
+		bytes[memScratch] = ((numThreads < numChroms)? numThreads : numChroms)
+		                  * (u64) scratch_alloc_size (maxLength * (size_t) sizeof(valtype));
 		}
 
-	}
-
+	// (counts are converted one chromosome at a time, to 32-bit counts if
+	// they overflow, or to values, so both forms exist for one chromosome)
 
-int named_global_exists
-   (char*			name,
-	valtype*		v)
-	{
-	namedglobal*	ng, *ngVar;
+	if (countInput)
+		bytes[memSignal] += maxLength * (u64) sizeof(u32);
 
-	if (dbgGlobals)
-		fprintf (stderr, "named_global_exists(%s) = ", name);
+	// registers (counting each one once, no matter how often it's stored to)
 
-	ngVar = NULL;
-	for (ng=namedGlobalHead ; ng!=NULL ; ng=ng->next)
+	for (op=pipeline ; op!=NULL ; op=op->next)
 		{
-		if ((ng->name == NULL) || (strcmp (name, ng->name) != 0)) continue;
-		ngVar = ng;
-		break;
+		if (op->plan->dropReason != NULL) continue;
+		if (strcmp (op->name, "store") != 0) continue;
+		for (use=op->plan->uses ; use!=NULL ; use=use->next)
+			{
+			if ((use->kind != resourceData) || (use->access != useWrite)) continue;
+
+			seen = false;
+			for (scanOp=pipeline ; (scanOp!=op) && (!seen) ; scanOp=scanOp->next)
+				{
+				if (scanOp->plan->dropReason != NULL) continue;
+				if (strcmp (scanOp->name, "store") != 0) continue;
+				for (scanUse=scanOp->plan->uses ; scanUse!=NULL ; scanUse=scanUse->next)
+					{
+					if ((scanUse->kind == resourceData)
+					 && (scanUse->access == useWrite)
+					 && (strcmp (scanUse->name, use->name) == 0))
+						{ seen = true;  break; }
+					}
+				}
+			if (!seen) bytes[memRegister] += genomeLen * sizeof(valtype);
+			}
 		}
 
-	if (ngVar == NULL)
+	// interval caches (a text file is only cached if more than one operator
+	// reads it;  compiled files and registers are read directly)
+
+	for (cache=cachedFileHead ; cache!=NULL ; cache=cache->next)
 		{
-		if (dbgGlobals)
-			fprintf (stderr, " (not found)\n");
-		return false;
+		if (is_signal_register (cache->filename)) continue;
+		if (is_compiled_file (cache->filename)) continue;
+
+		numReaders = 0;
+		for (op=pipeline ; op!=NULL ; op=op->next)
+			{
+			if (op->plan->dropReason != NULL) continue;
+			for (use=op->plan->uses ; use!=NULL ; use=use->next)
+				{
+				if ((use->kind == resourceData)
+				 && (use->access == useRead)
+				 && (strcmp (use->name, cache->filename) == 0))
+					{ numReaders++;  break; }
+				}
+			}
+		if (numReaders < 2) continue;
+
+		bytes[memCache] += estimate_cache_size (cache->filename);
 		}
-	else
+
+	total = 0;
+	for (kind=0 ; kind<numMemKinds ; kind++)
 		{
-		if (dbgGlobals)
-			fprintf (stderr, valtypeFmt "\n", ngVar->v);
-		if (v != NULL) (*v) = ngVar->v;
-		return true;
+		total += bytes[kind];
+		if (kindBytes != NULL) kindBytes[kind] = bytes[kind];
 		}
 
+	return total;
 	}
 
 
-static void free_named_globals
-   (void)
+// estimate_cache_size--
+//	Determine how much memory cache_interval would allocate to cache a text
+//	interval file, by scanning the file's chromosome names and mimicking its
+//	growth.  Every line other than blank lines and comments is counted as an
+//	interval.
+
+static u64 estimate_cache_size
+   (char*		filename)
 	{
-	namedglobal*	ng,  *ngNext;
+	FILE*		f;
+	char		chrom[1001], prevChrom[1001];
+	u64			numRuns, runsSize, namesLen, namesSize, numIntervals, intervalsSize;
+	u32			chromLen;
+	int			ch, atLineStart, inName;
 
-	for (ng=namedGlobalHead ; ng!=NULL ; ng=ngNext)
-		{ ngNext = ng->next;  free (ng); }
-	namedGlobalHead = NULL;
-	}
+	f = fopen (filename, "rt");
+	if (f == NULL) return 0;
 
+	numRuns = runsSize = namesLen = namesSize = numIntervals = intervalsSize = 0;
+	prevChrom[0] = 0;
+	chromLen     = 0;
+	atLineStart  = true;
+	inName       = false;
 
-void report_named_globals
-   (FILE*	f,
-	char*	indent)
-	{
-	namedglobal*	ng;
-	int				nameLen, nameW;
+	while (true)
+		{
+		ch = getc (f);
 
-	if (indent == NULL) indent = "";
+		if ((atLineStart) && ((ch == '#') || (ch == '\n')))
+			{
+			while ((ch != '\n') && (ch != EOF)) ch = getc (f);
+			if (ch == EOF) break;
+			continue;
+			}
+		if (ch == EOF) break;
 
-	nameW = 1;
-	for (ng=namedGlobalHead ; ng!=NULL ; ng=ng->next)
-		{
-		nameLen = strlen(ng->name);
-		if (nameLen > nameW) nameW = nameLen;
+		if (atLineStart) { atLineStart = false;  inName = true;  chromLen = 0; }
+
+		if ((inName) && ((ch == ' ') || (ch == '\t') || (ch == '\n')))
+			{
+			inName = false;
+			chrom[chromLen] = 0;
+
+			if ((numRuns == 0) || (strcmp (chrom, prevChrom) != 0))
+				{
+				if (numRuns >= runsSize)
+					runsSize = (runsSize == 0)? 100 : 2*runsSize;
+				if (namesLen + chromLen+1 > namesSize)
+					namesSize = 2*namesSize + chromLen+1 + 1000;
+				numRuns++;
+				namesLen += chromLen+1;
+				strcpy (prevChrom, chrom);
+				}
+
+			if (numIntervals >= intervalsSize)
+				intervalsSize = (intervalsSize == 0)? 10000 : 2*intervalsSize;
+			numIntervals++;
+			}
+		else if ((inName) && (chromLen < sizeof(chrom)-1))
+			chrom[chromLen++] = ch;
+
+		if (ch == '\n') atLineStart = true;
 		}
-	if (nameW > 20) nameW = 20;
 
-	for (ng=namedGlobalHead ; ng!=NULL ; ng=ng->next)
-		fprintf (f, "%s%*s = " valtypeFmt "\n",
-		            indent, nameW, ng->name, ng->v);
+	fclose (f);
+
+	return runsSize      * sizeof(cachedrun)
+	     + namesSize
+	     + intervalsSize * (2*sizeof(u32) + sizeof(valtype));
+	}
+
+
+// genome_length--
+//	Total length of the chromosomes of interest.
+
+static u64 genome_length
+   (void)
+	{
+	spec*		chromSpec;
+	u64			genomeLen;
+
+	genomeLen = 0;
+	for (chromSpec=chromsOfInterest ; chromSpec!=NULL ; chromSpec=chromSpec->next)
+		genomeLen += chromSpec->length;
+
+	return genomeLen;
 	}
 
 //----------
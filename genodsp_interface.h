@@ -34,6 +34,14 @@ typedef double valtype;
 // operators that need to access the list of chromosomes should use this array
 // instead of the linked list;  the array is terminated by a NULL entry
 
+// sigrun is one run of ones in a binary signal, origin-zero half-open
+
+typedef struct sigrun
+	{
+	u32			start;
+	u32			end;
+	} sigrun;
+
 typedef struct spec
 	{
 	struct spec* next;			// next spec in a linked list
@@ -45,9 +53,42 @@ typedef struct spec
 	u32			length;			// the length of v[], i.e. the number of
 								// .. interesting bases in the chromosome;
 								// .. this is guaranteed to be non-zero
-	valtype*	valVector;		// vector of values
+	int			storage;		// how the signal is currently stored (one of
+								// .. storeValues, etc.)
+	valtype*	valVector;		// vector of values (storeValues)
+	u64*		bitVector;		// vector of bits (storeBits);  each bit is
+								// .. one base, 1 for a value of 1.0 and 0 for
+								// .. a value of 0.0
+	void*		countVector;	// vector of integer counts (storeCounts);
+	int			countBytes;		// .. these are u16 (countBytes=2) unless a
+								// .. count has overflowed, in which case they
+								// .. are u32 (countBytes=4)
+	sigrun*		runVector;		// list of the runs of ones in a binary signal
+	u32			numRuns;		// .. (storeRuns), sorted, non-overlapping and
+								// .. non-adjacent;  every other base is 0.0
 	} spec;
 
+// signal storage classes;  these are also used as a bit mask, for the classes
+// an operator can consume (see accept_signal_storage)
+
+#define storeValues 1
+#define storeBits   2
+#define storeCounts 4
+#define storeRuns   8
+
+#define bitsWords(length) (((length)+63)/64)
+
+// intervalfile is an interval file opened for reading by an operator;  its
+// contents are private to genodsp.c (see open_interval_file)
+
+typedef struct intervalfile intervalfile;
+
+// rangefile is an interval file read by an operator's range function, a
+// subrange at a time;  its contents are private to genodsp.c (see
+// open_range_file)
+
+typedef struct rangefile rangefile;
+
 #ifdef globals_owner
 global spec*  chromsOfInterest = NULL;
 global spec** chromsSorted     = NULL;
@@ -71,6 +112,9 @@ global spec** chromsSorted;
 //	free:  de-allocate control record
 //	apply: apply function to vector(s)
 //
+// an operator may also have a sixth function
+//	range: apply function to a subrange of a vector
+//
 // headers for these functions are show later in this file
 
 #define opfuncargs_short (char*,int,FILE*,char*)
@@ -78,12 +122,14 @@ global spec** chromsSorted;
 #define opfuncargs_parse (char*,int,char**)
 #define opfuncargs_free  (struct dspop*)
 #define opfuncargs_apply (struct dspop*,char*,u32,valtype*)
+#define opfuncargs_range (struct dspop*,char*,u32,valtype*,u32,u32)
 
 typedef void          (*opfunc_short) opfuncargs_short;
 typedef void          (*opfunc_usage) opfuncargs_usage;
 typedef struct dspop* (*opfunc_parse) opfuncargs_parse;
 typedef void          (*opfunc_free)  opfuncargs_free;
 typedef void          (*opfunc_apply) opfuncargs_apply;
+typedef void          (*opfunc_range) opfuncargs_range;
 
 #define dspprototypes(funcName) \
 void          funcName##_short opfuncargs_short; \
@@ -92,6 +138,9 @@ struct dspop* funcName##_parse opfuncargs_parse; \
 void          funcName##_free  opfuncargs_free;  \
 void          funcName##_apply opfuncargs_apply;
 
+#define dsprangeprototype(funcName) \
+void          funcName##_range opfuncargs_range;
+
 // linked list for dsp operators
 //
 // the list will actually contain a mixture of records for different operators;
@@ -106,8 +155,43 @@ typedef struct dspop
 	opfunc_free		funcFree;
 	int				atRandom;	// true => this function needs 'random' access
 								//         .. to hop around the whole genome
+	int				storage;	// storage classes the function can consume
+								// .. (a mask of storeValues, etc.);  the signal
+								// .. is converted to values before any other
+								// .. class is given to the function
+	opfunc_range	funcRange;	// function that performs the operation over
+								// .. a subrange (NULL if there is none)
+	int				footprint;	// which positions each result depends on (one
+								// .. of footprintWhole, etc.)
+	u32				haloLeft;	// for footprintWindowed, how far to the left
+	u32				haloRight;	// .. and right of a position the positions it
+								// .. depends on can be
+	struct opplan*	plan;		// the planner's record of the operation
+								// .. (private to genodsp.c)
 	} dspop;
 
+// operator footprint classes (see declare_footprint)
+
+#define footprintWhole     0	// unknown;  the operator must be given whole
+								// .. vectors
+#define footprintPointwise 1	// each result depends only on the signal at
+								// .. the same position
+#define footprintWindowed  2	// .. on the signal within a halo around the
+								// .. same position
+#define footprintScan      3	// .. on the signal at the same and all earlier
+								// .. positions (on the same chromosome)
+#define footprintReduction 4	// the operator first reduces the whole genome
+								// .. to a few values
+#define footprintGlobal    5	// the operator hops around the whole genome
+
+// planner resource kinds and access modes (see declare_resource_use)
+
+#define resourceVariable 1		// a named variable
+#define resourceData     2		// a file or a signal register
+
+#define useRead  1
+#define useWrite 2
+
 typedef struct dspinfo
 	{
 	char*			name;		// operation
@@ -116,13 +200,17 @@ typedef struct dspinfo
 	opfunc_parse	funcParse;
 	opfunc_free		funcFree;
 	opfunc_apply	funcApply;
+	opfunc_range	funcRange;
 	} dspinfo;
 
 #define dspinforecord(name,funcName) \
-	{ name, funcName##_short, funcName##_usage, funcName##_parse, funcName##_free, funcName##_apply }
+	{ name, funcName##_short, funcName##_usage, funcName##_parse, funcName##_free, funcName##_apply, NULL }
+
+#define dspinforange(name,funcName) \
+	{ name, funcName##_short, funcName##_usage, funcName##_parse, funcName##_free, funcName##_apply, funcName##_range }
 
 #define dspinfoalias(name) \
-	{ name, NULL, NULL, NULL, NULL, NULL }
+	{ name, NULL, NULL, NULL, NULL, NULL, NULL }
 
 //----------
 //
@@ -140,10 +228,12 @@ typedef struct dspinfo
 global int trackOperations  = false;
 global int reportComments   = false;
 global u32 reportInputProgress = 0;
+global u32 numThreads       = 1;
 #else
 global int trackOperations;
 global int reportComments;
 global u32 reportInputProgress;
+global u32 numThreads;
 #endif
 
 // values for showUncovered
@@ -166,12 +256,32 @@ global u32 reportInputProgress;
 
 void     chastise               (const char* format, ...);
 spec*    find_chromosome_spec   (char* chrom);
+spec**   chromosomes_to_apply   (char* vName, spec** oneChrom);
 void     read_intervals         (FILE* f, int valCol, int originOne,
                                  int overlapOp, int clear, valtype missingVal);
 int      read_interval          (FILE* f,
                                  char* buffer, int bufferLen, int valCol,
                                  char** chrom, u32* start, u32* end,
                                  valtype* val);
+void     note_interval_file     (char* filename, int valCol);
+int      interval_file_by_chromosome (char* filename);
+intervalfile* open_interval_file (char* filename, int valCol, int originOne,
+                                 char* chrom);
+int      next_interval          (intervalfile* f,
+                                 char** chrom, u32* start, u32* end,
+                                 valtype* val);
+void     close_interval_file    (intervalfile* f, int destroy);
+rangefile* open_range_file      (char* opName, char* filename, int valCol,
+                                 int originOne, char* chrom,
+                                 int skipZeros, int disjoint);
+int      next_range_interval    (rangefile* rf, u32 start, u32 end,
+                                 u32* pieceStart, u32* pieceEnd, valtype* val);
+void     close_range_file       (rangefile* rf);
+void     declare_signal_register (char* name);
+int      is_signal_register     (char* name);
+u32      note_signal_register_use (char* name);
+void     store_signal_register  (char* name, char* chrom);
+void     recall_signal_register (char* name, char* chrom, u32 useIx);
 void     report_intervals       (FILE* f,
                                  int precision,
                                  int noOutputValues, int collapseRuns,
@@ -179,12 +289,35 @@ void     report_intervals       (FILE* f,
 void     read_all_chromosomes   (char* filename);
 void     write_all_chromosomes  (char* filename);
 valtype* get_scratch_vector     (void);
+valtype* get_sized_scratch_vector (u32 length);
+valtype* get_exact_scratch_vector (u32 length);
 s32*     get_scratch_ints       (void);
+s32*     get_sized_scratch_ints (u32 length);
 void     release_scratch_vector (valtype* v);
 void     release_scratch_ints   (s32* v);
+void     swap_scratch_vector    (char* chrom, valtype* v);
+void     accept_signal_storage  (int storage);
+void     declare_footprint      (int footprint, u32 haloLeft, u32 haloRight);
+void     declare_signal_use     (int access);
+void     declare_resource_use   (int kind, char* name, int access);
+u64*     new_signal_bits        (u32 length);
+void     install_signal_bits    (char* chrom, u64* bits);
+u64*     threshold_signal_bits  (char* chrom, valtype* v, u32 vLen,
+                                 valtype threshold, int tiesAbove);
+sigrun*  threshold_signal_runs  (char* chrom, valtype* v, u32 vLen,
+                                 valtype threshold, int tiesAbove,
+                                 u32* numRuns);
+void     install_signal_runs    (char* chrom, sigrun* runs, u32 numRuns);
+void     signal_to_values       (spec* chromSpec);
+int      next_bit_run           (u64* bits, u32 length, u32 pos,
+                                 u32* start, u32* end);
+void     fill_bit_run           (u64* bits, u32 start, u32 end);
 void     set_named_global       (char* name, valtype val);
+void     set_chrom_named_global (char* name, char* chrom, valtype val);
 valtype  get_named_global       (char* name, valtype defaultVal);
 int      named_global_exists    (char* name, valtype* val);
+int      chrom_named_global_exists (char* name, char* chrom, valtype* val);
+int      named_global_per_chrom (char* name);
 void     report_named_globals   (FILE* f, char* indent);
 void     tracking_report        (const char* format, ...);
 int      valtype_ascending      (const void* v1, const void* v2);
@@ -265,6 +398,20 @@ int      valtype_ascending      (const void* v1, const void* v2);
 //	atRandom, which tells the caller whether the operator performs on multiple
 //	vectors (atRandom=true) or single vectors (atRandom=false).
 //
+//	If the operator can consume the signal in a form other than a vector of
+//	values (e.g. packed bits), it should say so by calling
+//	accept_signal_storage().
+//
+//	The operator should describe which positions each of its results depends
+//	on by calling declare_footprint().  Otherwise it is assumed to need whole
+//	vectors (or the whole genome, if atRandom is true).
+//
+//	The operator should tell the planner how it uses the signal, if it
+//	doesn't both read and modify it, by calling declare_signal_use(), and
+//	name any variables, files or registers it reads or writes by calling
+//	declare_resource_use().  (Files given to note_interval_file() are
+//	declared automatically.)
+//
 //	The operator will be responsible for de-allocating this control record, in
 //	op_free().
 //
@@ -308,7 +455,41 @@ int      valtype_ascending      (const void* v1, const void* v2);
 //	u32			vLen:	Number of entries in v[].  If this is a "whole genome"
 //						operator, vLen is the maximum number of entries in any
 //						vector.
-//	valtype*	v:		The vector to operate opon.
+//	valtype*	v:		The vector to operate opon.  If the operator accepts
+//						.. other storage classes, this is NULL when the
+//						.. signal is stored some other way (the chromosome's
+//						.. spec tells how).
+//
+// Returns:
+//	(nothing)
+//
+//----------
+
+//----------
+//
+// op_range--
+//	Apply operation to a subrange of a vector.  This is optional, and only
+//	used for operators with a pointwise or scan footprint;  the caller can
+//	then split a vector into tiles, and run several operators over one tile
+//	before moving on to the next.
+//
+//	The subranges of a vector are given in order, without gaps, beginning
+//	with start=0.  An operator with a scan footprint carries whatever state it
+//	needs from one subrange to the next in its control record, resetting it
+//	when start=0.  Anything the apply function would do once per vector (e.g.
+//	fetching a named variable) is done when start=0.
+//
+//----------
+//
+// Arguments:
+//	dspop*		op:		Pointer to the operator's control record (as for
+//						.. op_apply).
+//	char*		vName:	The name of the vector (a chromosome name).
+//	u32			vLen:	Number of entries in v[].
+//	valtype*	v:		The whole vector;  only v[start] through v[end-1]
+//						.. are to be operated upon.
+//	u32			start:	The subrange, origin-zero half-open.
+//	u32			end:
 //
 // Returns:
 //	(nothing)
@@ -36,8 +36,14 @@ typedef struct dspop_binarize
 	int			tiesAbove;
 	valtype		oneVal;
 	valtype		zeroVal;
+	valtype		chromThreshold;	// the threshold in effect for the current
+								// .. chromosome (see op_binarize_range)
 	} dspop_binarize;
 
+// prototypes for private functions
+
+static valtype binarize_threshold (dspop_binarize* op, char* vName);
+
 
 // op_binarize_short--
 
@@ -184,6 +190,17 @@ dspop* op_binarize_parse (char* name, int _argc, char** _argv)
 		continue;
 		}
 
+	// with the default one and zero, we can produce a signal stored as bits,
+	// and consume one stored as bits, counts or runs
+
+	if ((op->oneVal == 1.0) && (op->zeroVal == 0.0))
+		accept_signal_storage (storeBits|storeCounts|storeRuns);
+
+	declare_footprint (footprintPointwise, 0, 0);
+
+	if (op->thresholdVarName != NULL)
+		declare_resource_use (resourceVariable, op->thresholdVarName, useRead);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -220,51 +237,102 @@ void op_binarize_apply
 	arg_dont_complain(valtype*	v))
 	{
 	dspop_binarize*	op = (dspop_binarize*) _op;
-	valtype			cutoffThresh = op->threshold;
-	int				tiesAbove    = op->tiesAbove;
-	valtype			oneVal       = op->oneVal;
-	valtype			zeroVal      = op->zeroVal;
-	int				ok;
-	u32				ix;
+	valtype			cutoffThresh;
 
-	// if the threshold is a named variable, fetch it now;  note that we copy
-	// the value from the named variable, then destroy our reference to the
-	// named variable
+	// with the default one and zero, produce a signal stored as bits
 
-	if (op->thresholdVarName != NULL)
+	if ((op->oneVal == 1.0) && (op->zeroVal == 0.0))
 		{
-		ok = named_global_exists (op->thresholdVarName, &cutoffThresh);
-		if (!ok) goto no_threshold;
-		op->threshold = cutoffThresh;
-		fprintf (stderr, "[%s] using %s = " valtypeFmt " as threshold\n",
-		                 _op->name, op->thresholdVarName, cutoffThresh);
-		free (op->thresholdVarName);
-		op->thresholdVarName = NULL;
+		cutoffThresh = binarize_threshold (op, vName);
+		install_signal_bits (vName,
+		                     threshold_signal_bits (vName, v, vLen, cutoffThresh, op->tiesAbove));
+		return;
 		}
 
+	op_binarize_range (_op, vName, vLen, v, 0, vLen);
+	}
+
+
+// op_binarize_range--
+//	(when run over subranges, the result is stored as values even with the
+//	default one and zero)
+
+void op_binarize_range
+   (arg_dont_complain(dspop*	_op),
+	arg_dont_complain(char*		vName),
+	arg_dont_complain(u32		vLen),
+	arg_dont_complain(valtype*	v),
+	u32							start,
+	u32							end)
+	{
+	dspop_binarize*	op = (dspop_binarize*) _op;
+	valtype			cutoffThresh;
+	valtype			oneVal  = op->oneVal;
+	valtype			zeroVal = op->zeroVal;
+	u32				ix;
+
+	// a threshold that is a named variable is fetched once per chromosome, at
+	// the first subrange
+
+	if (start == 0)
+		op->chromThreshold = binarize_threshold (op, vName);
+	cutoffThresh = op->chromThreshold;
+
 	// process the vector
 
-	if (tiesAbove)
+	if (op->tiesAbove)
 		{
-		for (ix=0 ; ix<vLen ; ix++)
+		for (ix=start ; ix<end ; ix++)
 			{ v[ix] = (v[ix] >= cutoffThresh)? oneVal : zeroVal; }
 		}
 	else
 		{
-		for (ix=0 ; ix<vLen ; ix++)
+		for (ix=start ; ix<end ; ix++)
 			{ v[ix] = (v[ix] > cutoffThresh)? oneVal : zeroVal; }
 		}
 
-	// success
+	}
 
-	return;
 
-	// failure
+// binarize_threshold--
+//	Determine the threshold for a chromosome.
+//
+// If the threshold is a named variable, we fetch it now;  note that we copy
+// the value from the named variable, then destroy our reference to the named
+// variable (unless the variable has a separate value for each chromosome, in
+// which case we fetch it anew for every chromosome).
+
+static valtype binarize_threshold
+   (dspop_binarize*	op,
+	char*			vName)
+	{
+	valtype			cutoffThresh = op->threshold;
+	int				ok;
+
+	if (op->thresholdVarName != NULL)
+		{
+		ok = named_global_exists (op->thresholdVarName, &cutoffThresh);
+		if (!ok) goto no_threshold;
+		if (named_global_per_chrom (op->thresholdVarName))
+			fprintf (stderr, "[%s] using %s = " valtypeFmt " as threshold for %s\n",
+			                 op->common.name, op->thresholdVarName, cutoffThresh, vName);
+		else
+			{
+			op->threshold = cutoffThresh;
+			fprintf (stderr, "[%s] using %s = " valtypeFmt " as threshold\n",
+			                 op->common.name, op->thresholdVarName, cutoffThresh);
+			free (op->thresholdVarName);
+			op->thresholdVarName = NULL;
+			}
+		}
+
+	return cutoffThresh;
 
 no_threshold:
 	fprintf (stderr, "[%s] attempt to use %s as threshold failed (no such variable)\n",
-	                 _op->name, op->thresholdVarName);
+	                 op->common.name, op->thresholdVarName);
 	exit(EXIT_FAILURE);
+	return 0.0; // (never reaches here)
 	}
 
 //----------
@@ -289,6 +357,7 @@ typedef struct dspop_or
 	char*		filename;
 	int			valColumn;
 	int			originOne;
+	rangefile*	rf;				// (for op_or_range) the file being read
 	} dspop_or;
 
 
@@ -345,6 +414,7 @@ dspop* op_or_parse (char* name, int _argc, char** _argv)
 	op->filename  = NULL;
 	op->valColumn = (int) get_named_global ("valColumn", 4-1);
 	op->originOne = (int) get_named_global ("originOne", false);
+	op->rf        = NULL;
 
 	// parse arguments
 
@@ -408,6 +478,11 @@ dspop* op_or_parse (char* name, int _argc, char** _argv)
 
 	if (op->filename == NULL) goto filename_missing;
 
+	note_interval_file (op->filename, op->valColumn);
+	op->common.atRandom = !interval_file_by_chromosome (op->filename);
+
+	declare_footprint (footprintPointwise, 0, 0);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -429,6 +504,7 @@ void op_or_free (dspop* _op)
 	{
 	dspop_or*	op = (dspop_or*) _op;
 
+	if (op->rf       != NULL) close_range_file (op->rf);
 	if (op->filename != NULL) free (op->filename);
 	free (op);
 	}
@@ -444,34 +520,37 @@ void op_or_apply
 	{
 	dspop_or*	op = (dspop_or*) _op;
 	char*			filename = op->filename;
-	FILE*			f;
-	char			lineBuffer[1001];
+	intervalfile*	f;
 	char			prevChrom[1001];
 	valtype*		v = NULL;
 	char*			chrom;
 	spec*			chromSpec;
+	spec**			chroms;
+	spec*			oneChrom[2];
 	u32				start, end, o, adjStart, adjEnd;
 	valtype			val;
 	u32				ix, chromIx;
 	int				ok;
 
-	f = fopen (filename, "rt");
+	chroms = chromosomes_to_apply (vName, oneChrom);
+
+	f = open_interval_file (filename, op->valColumn, op->originOne, vName);
 	if (f == NULL) goto cant_open_file;
 
 	if (trackOperations)
 		{
-		for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+		for (chromIx=0 ; chroms[chromIx]!=NULL ; chromIx++)
 			{
-			chromSpec = chromsSorted[chromIx];
+			chromSpec = chroms[chromIx];
 			chromSpec->flag = false;
 			}
 		}
 
 	// convert existing intervals to true/false (one/zero)
 
-	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+	for (chromIx=0 ; chroms[chromIx]!=NULL ; chromIx++)
 		{
-		chromSpec = chromsSorted[chromIx];
+		chromSpec = chroms[chromIx];
 		v = chromSpec->valVector;
 		for (ix=0 ; ix<chromSpec->length ; ix++)
 			{ if (v[ix] != 0.0) v[ix] = 1.0; }
@@ -488,8 +567,7 @@ void op_or_apply
 	v = NULL;
 	while (true)
 		{
-		ok = read_interval (f, lineBuffer, sizeof(lineBuffer), op->valColumn,
-	                        &chrom, &start, &end, &val);
+		ok = next_interval (f, &chrom, &start, &end, &val);
 		if (!ok) break;
 		if (val == 0.0) continue;
 
@@ -503,7 +581,7 @@ void op_or_apply
 
 		if (chromSpec == NULL) continue;
 
-		if ((trackOperations) && (!chromSpec->flag))
+		if ((trackOperations) && (chroms == chromsSorted) && (!chromSpec->flag))
 			{
 			fprintf (stderr, "%s(%s)\n", op->common.name, chrom);
 			chromSpec->flag = true;
@@ -541,7 +619,7 @@ void op_or_apply
 
 	// success
 
-	fclose (f);
+	close_interval_file (f, /*destroy*/ false);
 	return;
 
 	//////////
@@ -559,6 +637,58 @@ chrom_too_short:
 	exit (EXIT_FAILURE);
 	}
 
+
+// op_or_range--
+
+void op_or_range
+   (arg_dont_complain(dspop*	_op),
+	arg_dont_complain(char*		vName),
+	arg_dont_complain(u32		vLen),
+	arg_dont_complain(valtype*	v),
+	arg_dont_complain(u32		start),
+	arg_dont_complain(u32		end))
+	{
+	dspop_or*	op = (dspop_or*) _op;
+	u32			pieceStart, pieceEnd;
+	valtype		val;
+	u32			ix;
+
+	if (start == 0)
+		{
+		if (op->rf != NULL) close_range_file (op->rf);
+		op->rf = open_range_file (_op->name, op->filename, op->valColumn, op->originOne,
+		                          vName, /*skipZeros*/ true, /*disjoint*/ false);
+		if (op->rf == NULL) goto cant_open_file;
+		}
+
+	// convert existing intervals to true/false (one/zero)
+
+	for (ix=start ; ix<end ; ix++)
+		{ if (v[ix] != 0.0) v[ix] = 1.0; }
+
+	// read this subrange's intervals and values and "or" them
+
+	while (next_range_interval (op->rf, start, end, &pieceStart, &pieceEnd, &val))
+		{
+		for (ix=pieceStart ; ix<pieceEnd ; ix++)
+			v[ix] = 1.0;
+		}
+
+	if (end == vLen)
+		{ close_range_file (op->rf);  op->rf = NULL; }
+
+	return;
+
+	//////////
+	// failure exits
+	//////////
+
+cant_open_file:
+	fprintf (stderr, "[%s] can't open \"%s\" for reading\n",
+	                 _op->name, op->filename);
+	exit (EXIT_FAILURE);
+	}
+
 //----------
 // [[-- a dsp operation function group, operating on the whole genome --]]
 //
@@ -584,6 +714,7 @@ typedef struct dspop_and
 	int			valColumn;
 	int			originOne;
 	int			debug;
+	rangefile*	rf;				// (for op_and_range) the file being read
 	} dspop_and;
 
 
@@ -643,6 +774,7 @@ dspop* op_and_parse (char* name, int _argc, char** _argv)
 	op->filename  = NULL;
 	op->valColumn = (int) get_named_global ("valColumn", 4-1);
 	op->originOne = (int) get_named_global ("originOne", false);
+	op->rf        = NULL;
 
 	// parse arguments
 
@@ -706,6 +838,11 @@ dspop* op_and_parse (char* name, int _argc, char** _argv)
 
 	if (op->filename == NULL) goto filename_missing;
 
+	note_interval_file (op->filename, op->valColumn);
+	op->common.atRandom = !interval_file_by_chromosome (op->filename);
+
+	declare_footprint (footprintPointwise, 0, 0);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -727,6 +864,7 @@ void op_and_free (dspop* _op)
 	{
 	dspop_and*	op = (dspop_and*) _op;
 
+	if (op->rf       != NULL) close_range_file (op->rf);
 	if (op->filename != NULL) free (op->filename);
 	free (op);
 	}
@@ -742,31 +880,34 @@ void op_and_apply
 	{
 	dspop_and*	op = (dspop_and*) _op;
 	char*		filename = op->filename;
-	FILE*		f;
-	char		lineBuffer[1001];
+	intervalfile* f;
 	char		prevChrom[1001];
 	valtype*	v = NULL;
 	char*		chrom;
 	spec*		chromSpec;
+	spec**		chroms;
+	spec*		oneChrom[2];
 	u32			start, end, o, prevEnd, adjStart, adjEnd;
 	valtype		val;
 	u32			ix, chromIx;
 	int			ok;
 
-	f = fopen (filename, "rt");
+	chroms = chromosomes_to_apply (vName, oneChrom);
+
+	f = open_interval_file (filename, op->valColumn, op->originOne, vName);
 	if (f == NULL) goto cant_open_file;
 
-	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+	for (chromIx=0 ; chroms[chromIx]!=NULL ; chromIx++)
 		{
-		chromSpec = chromsSorted[chromIx];
+		chromSpec = chroms[chromIx];
 		chromSpec->flag = false;
 		}
 
 	// convert existing intervals to true/false (one/zero)
 
-	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+	for (chromIx=0 ; chroms[chromIx]!=NULL ; chromIx++)
 		{
-		chromSpec = chromsSorted[chromIx];
+		chromSpec = chroms[chromIx];
 		v = chromSpec->valVector;
 		for (ix=0 ; ix<chromSpec->length ; ix++)
 			{ if (v[ix] != 0.0) v[ix] = 1.0; }
@@ -784,8 +925,7 @@ void op_and_apply
 	v = NULL;
 	while (true)
 		{
-		ok = read_interval (f, lineBuffer, sizeof(lineBuffer), op->valColumn,
-	                        &chrom, &start, &end, &val);
+		ok = next_interval (f, &chrom, &start, &end, &val);
 		if (!ok) break;
 		if (val == 0.0) continue; // treat zero as a missing interval
 
@@ -824,7 +964,8 @@ void op_and_apply
 
 		if (!chromSpec->flag)
 			{
-			if (trackOperations) fprintf (stderr, "%s(%s)\n", op->common.name, chrom);
+			if ((trackOperations) && (chroms == chromsSorted))
+				fprintf (stderr, "%s(%s)\n", op->common.name, chrom);
 			chromSpec->flag = true;
 			}
 
@@ -882,9 +1023,9 @@ void op_and_apply
 
 	// clear any chromosomes that weren't observed in the incoming set
 
-	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+	for (chromIx=0 ; chroms[chromIx]!=NULL ; chromIx++)
 		{
-		chromSpec = chromsSorted[chromIx];
+		chromSpec = chroms[chromIx];
 		if (chromSpec->flag) continue;
 
 		chrom = chromSpec->chrom;
@@ -901,7 +1042,7 @@ void op_and_apply
 
 	// success
 
-	fclose (f);
+	close_interval_file (f, /*destroy*/ false);
 	return;
 
 	//////////
@@ -928,3 +1069,61 @@ intervals_out_of_order:
 	                 op->common.name, filename, chrom, start, end, chromSpec->start+prevEnd);
 	exit (EXIT_FAILURE);
 	}
+
+
+// op_and_range--
+
+void op_and_range
+   (arg_dont_complain(dspop*	_op),
+	arg_dont_complain(char*		vName),
+	arg_dont_complain(u32		vLen),
+	arg_dont_complain(valtype*	v),
+	arg_dont_complain(u32		start),
+	arg_dont_complain(u32		end))
+	{
+	dspop_and*	op = (dspop_and*) _op;
+	u32			pieceStart, pieceEnd, prevEnd;
+	valtype		val;
+	u32			ix;
+
+	if (start == 0)
+		{
+		if (op->rf != NULL) close_range_file (op->rf);
+		op->rf = open_range_file (_op->name, op->filename, op->valColumn, op->originOne,
+		                          vName, /*skipZeros*/ true, /*disjoint*/ true);
+		if (op->rf == NULL) goto cant_open_file;
+		}
+
+	// convert existing intervals to true/false (one/zero)
+
+	for (ix=start ; ix<end ; ix++)
+		{ if (v[ix] != 0.0) v[ix] = 1.0; }
+
+	// read this subrange's intervals, and clear the gaps between them
+
+	prevEnd = start;
+
+	while (next_range_interval (op->rf, start, end, &pieceStart, &pieceEnd, &val))
+		{
+		for (ix=prevEnd ; ix<pieceStart ; ix++)
+			v[ix] = 0.0;
+		prevEnd = pieceEnd;
+		}
+
+	for (ix=prevEnd ; ix<end ; ix++)
+		v[ix] = 0.0;
+
+	if (end == vLen)
+		{ close_range_file (op->rf);  op->rf = NULL; }
+
+	return;
+
+	//////////
+	// failure exits
+	//////////
+
+cant_open_file:
+	fprintf (stderr, "[%s] can't open \"%s\" for reading\n",
+	                 _op->name, op->filename);
+	exit (EXIT_FAILURE);
+	}
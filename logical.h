@@ -7,4 +7,8 @@ dspprototypes(op_binarize)
 dspprototypes(op_or)
 dspprototypes(op_and)
 
+dsprangeprototype(op_binarize)
+dsprangeprototype(op_or)
+dsprangeprototype(op_and)
+
 #endif // logical_H
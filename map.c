@@ -25,11 +25,21 @@ typedef struct mapping
 	// note that v is allocated as part of the same heap block
 	u32		len;				// number of elements in vIn[] and vOut[]
 	mappingel* v;				// function input-to-output values
+
+	// uniform-bucket index over the input values;  the range from v[0].vIn
+	// to v[len-1].vIn is divided into numBuckets equal buckets, and bucket[b]
+	// is the last piece that begins in a bucket before b;  so for any value in
+	// bucket b, the piece containing it is bucket[b] or a few pieces after
+	u32		numBuckets;
+	valtype	bucketScale;		// numBuckets / (input value range)
+	u32*	bucket;				// (allocated separately)
 	} mapping;
 
 // prototypes for private functions
 
 static mapping* read_mapping    (FILE* f);
+static void     index_mapping   (mapping* map);
+static void     free_mapping    (mapping* map);
 static int      read_value_pair (FILE* f, char* buffer, int bufferLen,
                                  valtype* val1, valtype* val2);
 
@@ -58,6 +68,7 @@ typedef struct dspop_map
 	char*		filename;
 	int			destroyFile;
 	int			debug;
+	mapping*	map;			// the mapping, read at the first apply
 	} dspop_map;
 
 
@@ -118,6 +129,7 @@ dspop* op_map_parse (char* name, int _argc, char** _argv)
 	op->filename    = NULL;
 	op->destroyFile = false;
 	op->debug       = false;
+	op->map         = NULL;
 
 	// parse arguments
 
@@ -163,6 +175,10 @@ dspop* op_map_parse (char* name, int _argc, char** _argv)
 
 	if (op->filename == NULL) goto filename_missing;
 
+	declare_resource_use (resourceData, op->filename, useRead);
+	if (op->destroyFile)
+		declare_resource_use (resourceData, op->filename, useWrite);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -185,11 +201,15 @@ void op_map_free (dspop* _op)
 	dspop_map*	op = (dspop_map*) _op;
 
 	if (op->filename != NULL) free (op->filename);
+	if (op->map      != NULL) free_mapping (op->map);
 	free (op);
 	}
 
 
 // op_map_apply--
+//
+// The mapping is read (and indexed) the first time we're called, and kept for
+// the remaining chromosomes.
 
 void op_map_apply
    (arg_dont_complain(dspop*	_op),
@@ -198,171 +218,85 @@ void op_map_apply
 	arg_dont_complain(valtype*	v))
 	{
 	dspop_map*	op = (dspop_map*) _op;
-	mapping*	map = NULL;
+	mapping*	map = op->map;
 	FILE*		f;
-	valtype		minIn, maxIn, outForMin, outForMax;
-	valtype		pieceLo, pieceHi, outForLo, outForHi, inDiff, outDiff;
-	u32			maxIx, pieceIx, ixLo, ixHi, ixMid;
+	mappingel*	pieces;
+	u32*		bucket;
+	valtype		minIn, maxIn, outForMin, outForMax, scale, bucketVal;
+	valtype		pieceLo, inVal;
+	u32			maxIx, pieceIx, numBuckets;
 	u32			ix;
-	valtype		inVal;
 
 	// read the mapping file
 
-	f = fopen (op->filename, "rt");
-	if (f == NULL) goto cant_open_file;
-
-	map = read_mapping (f);
-	fclose (f);
-	if (map == NULL) goto cat_read_mapping;
-
-	if (op->destroyFile)
-		remove (op->filename);
-
-	if (op->debug)
+	if (map == NULL)
 		{
-		fprintf (stderr, "mapping:\n");
-		for (pieceIx=0 ; pieceIx<map->len ; pieceIx++)
-			fprintf (stderr, "  [%u] " valtypeFmt " -> " valtypeFmt "\n",
-			                 pieceIx, map->v[pieceIx].vIn, map->v[pieceIx].vOut);
-		}
+		f = fopen (op->filename, "rt");
+		if (f == NULL) goto cant_open_file;
 
-	maxIx     = map->len - 1;
-	minIn     = map->v[0].vIn;
-	maxIn     = map->v[maxIx].vIn;
-	outForMin = map->v[0].vOut;
-	outForMax = map->v[maxIx].vOut;
+		map = read_mapping (f);
+		fclose (f);
+		if (map == NULL) goto cat_read_mapping;
 
-	// apply the mapping
+		if (op->destroyFile)
+			remove (op->filename);
 
-	pieceIx  = noIndex;
-	pieceLo  = pieceHi  = 0.0;	// (placate compiler)
-	outForLo = outForHi = 0.0;	// (placate compiler)
-	inDiff   = outDiff  = 0.0;	// (placate compiler)
-	ixLo     = ixHi     = 0;	// (placate compiler)
+		index_mapping (map);
+		op->map = map;
 
-	for (ix=0 ; ix<vLen ; ix++)
-		{
 		if (op->debug)
 			{
-			fprintf (stderr, "[%u] " valtypeFmt "\n", ix, v[ix]);
-			if (v[ix] <= minIn)
-				{
-				fprintf (stderr, "  below minimum\n");
-				fprintf (stderr, "  --> " valtypeFmt "\n", outForMin);
-				}
-			if (v[ix] >= maxIn)
-				{
-				fprintf (stderr, "  above minimum\n");
-				fprintf (stderr, "  --> " valtypeFmt "\n", outForMax);
-				}
-			}
-
-		// if the next unmapped value is beyond the range of the mapping,
-		// assign it the edge value
-
-		inVal = v[ix];
-		if (inVal <= minIn) { v[ix] = outForMin;  continue; }
-		if (inVal >= maxIn) { v[ix] = outForMax;  continue; }
-
-		// otherwise, find the piece the unmapped value is on;  if it is on
-		// the most recent piece we've used, or a piece next to it, we can
-		// shortcut the search;  otherwise, we do a binary search over the
-		// possible pieces (full range the first time, limited to above or
-		// below the most recent piece aferwards);  the rational behind the
-		// shortcut operations is that most signals will vary smoothly, and
-		// we want to avoid doing the binary search if we can
-		
-		if (pieceIx == noIndex)
-			{ ixLo = 0;  ixHi = maxIx;  goto find_piece; }
-
-		if ((inVal >= pieceLo) && (inVal <= pieceHi))
-			{
-			if (op->debug)
-				fprintf (stderr, "  on same piece\n");
-			goto piece_known;
-			}
-
-		if (inVal < pieceLo)
-			{
-			if ((pieceIx == 0) || (inVal < map->v[pieceIx-1].vIn))
-				{ ixLo = 0;  ixHi = pieceIx-1;  goto find_piece; }
-			ixLo = pieceIx-1;
-			if (op->debug)
-				fprintf (stderr, "  on next piece below\n");
-			goto piece_found;
-			}
-
-		if (inVal > pieceHi)
-			{
-			if ((pieceIx > maxIx-2) || (inVal > map->v[pieceIx+2].vIn))
-				{ ixLo = pieceIx+2;  ixHi = maxIx;  goto find_piece; }
-			ixLo = pieceIx+1;
-			if (op->debug)
-				fprintf (stderr, "  on next piece above\n");
-			goto piece_found;
+			fprintf (stderr, "mapping:\n");
+			for (pieceIx=0 ; pieceIx<map->len ; pieceIx++)
+				fprintf (stderr, "  [%u] " valtypeFmt " -> " valtypeFmt "\n",
+				                 pieceIx, map->v[pieceIx].vIn, map->v[pieceIx].vOut);
+			fprintf (stderr, "  (%u index buckets)\n", map->numBuckets);
 			}
+		}
 
-	find_piece:
-		if (op->debug)
-			fprintf (stderr, "  on new piece\n");
+	if (map->len == 0) goto cat_read_mapping;
 
-		while (ixLo+1 < ixHi)
-			{
-			// invariant: v[ixLo].vIn <= inVal < v[ixHi].vIn
+	pieces     = map->v;
+	maxIx      = map->len - 1;
+	minIn      = pieces[0].vIn;
+	maxIn      = pieces[maxIx].vIn;
+	outForMin  = pieces[0].vOut;
+	outForMax  = pieces[maxIx].vOut;
+	numBuckets = map->numBuckets;
+	scale      = map->bucketScale;
+	bucket     = map->bucket;
 
-			if (op->debug)
-				fprintf (stderr, "  %u..%u " valtypeFmt ".." valtypeFmt "\n",
-								 ixLo,ixHi, map->v[ixLo].vIn, map->v[ixHi].vIn);
+	// apply the mapping;  values beyond the range of the mapping are assigned
+	// the edge value;  otherwise we locate the value's bucket, which gives us
+	// a piece at or below the one containing the value, and step forward to
+	// the last piece that begins at or below the value
 
-			ixMid = (ixLo + ixHi) / 2;
-			if      (inVal < map->v[ixMid].vIn) ixHi = ixMid;
-			else if (inVal > map->v[ixMid].vIn) ixLo = ixMid;
-			else                              { ixLo = ixMid;  break; }
-			}
+	for (ix=0 ; ix<vLen ; ix++)
+		{
+		inVal = v[ix];
+		if (inVal <= minIn) { v[ix] = outForMin;  goto next_value; }
+		if (inVal >= maxIn) { v[ix] = outForMax;  goto next_value; }
 
-		while ((ixLo < maxIx) && (map->v[ixLo].vIn == map->v[ixLo+1].vIn))
-			ixLo++;
+		bucketVal = (inVal - minIn) * scale;
+		pieceIx   = (bucketVal < numBuckets)? bucket[(u32) bucketVal] : bucket[numBuckets-1];
+		while (pieces[pieceIx+1].vIn <= inVal) pieceIx++;
 
-	piece_found:
-		if (op->debug)
-			fprintf (stderr, "  piece %u"
-							 " maps " valtypeFmt ".." valtypeFmt
-							 " to "   valtypeFmt ".." valtypeFmt "\n",
-							 ixLo,
-							 map->v[ixLo].vIn,  map->v[ixLo+1].vIn,
-							 map->v[ixLo].vOut, map->v[ixLo+1].vOut);
-
-		pieceIx  = ixLo;
-		pieceLo  = map->v[pieceIx  ].vIn;
-		pieceHi  = map->v[pieceIx+1].vIn;
-		outForLo = map->v[pieceIx  ].vOut;
-		outForHi = map->v[pieceIx+1].vOut;
-		inDiff   = pieceHi  - pieceLo;
-		outDiff  = outForHi - outForLo;
-
-		// map the value on the piece
-
-	piece_known:
+		pieceLo = pieces[pieceIx].vIn;
 		if (inVal == pieceLo)
-			v[ix] = outForLo;
-		else if (inVal == pieceHi)
-			v[ix] = outForHi;
+			v[ix] = pieces[pieceIx].vOut;
 		else
-			{
-			v[ix] = outForLo + (inVal - pieceLo) * outDiff / inDiff;
-			if (op->debug)
-				fprintf (stderr, "  " valtypeFmt
-				                 " maps to " valtypeFmt " + (" valtypeFmt " * " valtypeFmt ")\n",
-				                 inVal, outForLo, inVal-pieceLo, outDiff/inDiff);
-			}
+			v[ix] = pieces[pieceIx].vOut
+			      + (inVal - pieceLo) * (pieces[pieceIx+1].vOut - pieces[pieceIx].vOut)
+			                          / (pieces[pieceIx+1].vIn  - pieceLo);
 
+	next_value:
 		if (op->debug)
-			fprintf (stderr, "  --> " valtypeFmt "\n", v[ix]);
+			fprintf (stderr, "[%u] " valtypeFmt " --> " valtypeFmt "\n",
+			                 ix, inVal, v[ix]);
 		}
 
 	// success
 
-	free (map);
 	return;
 
 	//////////
@@ -465,6 +399,86 @@ static mapping* read_mapping
 	return map;
 	}
 
+//----------
+//
+// index_mapping--
+//	Build the uniform-bucket index for a mapping.
+//
+// Since the bucket a value falls into never decreases as the value increases,
+// every value in bucket b is above the input value of any piece that begins in
+// an earlier bucket.  So bucket[b] is a safe starting point for a forward
+// search, and that search crosses only the pieces that begin in bucket b.
+//
+//----------
+//
+// Arguments:
+//	mapping*	map:	The mapping to index.  The pieces must already be
+//						.. sorted by increasing input value.
+//
+// Returns:
+//	(nothing);  failures result in program termination.
+//
+//----------
+
+#define bucketsPerPiece 2
+
+static void index_mapping
+   (mapping*	map)
+	{
+	valtype		minIn, maxIn, bucketVal;
+	u32			numBuckets, b, pieceB, ix;
+	size_t		bytesNeeded;
+
+	map->numBuckets  = 0;
+	map->bucketScale = 0.0;
+	map->bucket      = NULL;
+	if (map->len < 2) return;
+
+	minIn = map->v[0].vIn;
+	maxIn = map->v[map->len-1].vIn;
+
+	numBuckets = bucketsPerPiece * map->len;
+	map->bucketScale = numBuckets / (maxIn - minIn);
+	if (!isfinite (map->bucketScale))
+		{ numBuckets = 1;  map->bucketScale = 0.0; }
+
+	bytesNeeded = numBuckets * sizeof(u32);
+	map->bucket = (u32*) malloc (bytesNeeded);
+	if (map->bucket == NULL) goto cant_allocate;
+	map->numBuckets = numBuckets;
+
+	// fill the buckets;  pieceB is the bucket in which piece ix begins
+
+	b = 0;
+	for (ix=0 ; ix<map->len-1 ; ix++)
+		{
+		bucketVal = (map->v[ix].vIn - minIn) * map->bucketScale;
+		pieceB = (bucketVal < numBuckets)? (u32) bucketVal : numBuckets-1;
+		for ( ; b<=pieceB ; b++)
+			map->bucket[b] = (ix == 0)? 0 : ix-1;
+		}
+
+	for ( ; b<numBuckets ; b++)
+		map->bucket[b] = map->len-2;
+
+	return;
+
+cant_allocate:
+	fprintf (stderr, "failed to allocate mapping index (%s bytes)\n",
+	                 ucommatize(bytesNeeded));
+	exit (EXIT_FAILURE);
+	}
+
+
+// free_mapping--
+
+static void free_mapping
+   (mapping*	map)
+	{
+	if (map->bucket != NULL) free (map->bucket);
+	free (map);
+	}
+
 //----------
 //
 // read_value_pair--
@@ -35,6 +35,9 @@ typedef struct dspop_mask
 	char*		maskValVarName;
 	valtype		maskVal;
 	int			originOne;
+	rangefile*	rf;				// (for op_mask_range) the file being read, and
+	int			haveChromMaskVal; // .. the mask value for the current
+	valtype		chromMaskVal;	// .. chromosome
 	} dspop_mask;
 
 
@@ -90,6 +93,7 @@ dspop* op_mask_parse (char* name, int _argc, char** _argv)
 	op->maskValVarName = NULL;
 	op->maskVal        = 0.0;
 	op->originOne      = (int) get_named_global ("originOne", false);
+	op->rf             = NULL;
 
 	// parse arguments
 
@@ -148,6 +152,14 @@ dspop* op_mask_parse (char* name, int _argc, char** _argv)
 
 	if (op->filename == NULL) goto filename_missing;
 
+	note_interval_file (op->filename, -1);
+	op->common.atRandom = !interval_file_by_chromosome (op->filename);
+
+	declare_footprint (footprintPointwise, 0, 0);
+
+	if (op->maskValVarName != NULL)
+		declare_resource_use (resourceVariable, op->maskValVarName, useRead);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -176,6 +188,7 @@ void op_mask_free (dspop* _op)
 	{
 	dspop_mask*	op = (dspop_mask*) _op;
 
+	if (op->rf             != NULL) close_range_file (op->rf);
 	if (op->filename       != NULL) free (op->filename);
 	if (op->maskValVarName != NULL) free (op->maskValVarName);
 	free (op);
@@ -193,34 +206,39 @@ void op_mask_apply
 	dspop_mask*	op = (dspop_mask*) _op;
 	char*		filename = op->filename;
 	valtype		maskVal  = op->maskVal;
-	FILE*		f;
-	char		lineBuffer[1001];
+	intervalfile* f;
 	char		prevChrom[1001];
 	valtype*	v = NULL;
 	char*		chrom;
 	spec*		chromSpec;
+	spec**		chroms;
+	spec*		oneChrom[2];
 	u32			start, end, o, adjStart, adjEnd;
 	valtype		val;
 	u32			ix, chromIx;
 	int			ok;
 
-	f = fopen (filename, "rt");
+	chroms = chromosomes_to_apply (vName, oneChrom);
+
+	f = open_interval_file (filename, -1, op->originOne, vName);
 	if (f == NULL) goto cant_open_file;
 
 	if (trackOperations)
 		{
-		for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+		for (chromIx=0 ; chroms[chromIx]!=NULL ; chromIx++)
 			{
-			chromSpec = chromsSorted[chromIx];
+			chromSpec = chroms[chromIx];
 			chromSpec->flag = false;
 			}
 		}
 
 	// if the mask value is a named variable, fetch it now;  note that we copy
 	// the value from the named variable, then destroy our reference to the
-	// named variable
+	// named variable (unless the variable has a separate value for each
+	// chromosome, in which case we fetch it anew for every chromosome, below)
 
-	if (op->maskValVarName != NULL)
+	if ((op->maskValVarName != NULL)
+	 && (!named_global_per_chrom (op->maskValVarName)))
 		{
 		ok = named_global_exists (op->maskValVarName, &maskVal);
 		if (!ok) goto no_mask_val;
@@ -242,8 +260,7 @@ void op_mask_apply
 	v = NULL;
 	while (true)
 		{
-		ok = read_interval (f, lineBuffer, sizeof(lineBuffer), -1,
-	                        &chrom, &start, &end, &val);
+		ok = next_interval (f, &chrom, &start, &end, &val);
 		if (!ok) break;
 
 		//fprintf (stderr, "%s %u %u %f\n", chrom, start, end, val);
@@ -254,11 +271,19 @@ void op_mask_apply
 			chromSpec = find_chromosome_spec (chrom);
 			if (chromSpec != NULL) v = chromSpec->valVector;
 			safe_strncpy (prevChrom, chrom, sizeof(prevChrom)-1);
+
+			if ((chromSpec != NULL) && (op->maskValVarName != NULL))
+				{
+				ok = chrom_named_global_exists (op->maskValVarName, chromSpec->chrom, &maskVal);
+				if (!ok) goto no_chrom_mask_val;
+				fprintf (stderr, "[%s] using %s = " valtypeFmt " as mask value for %s\n",
+				                 _op->name, op->maskValVarName, maskVal, chromSpec->chrom);
+				}
 			}
 
 		if (chromSpec == NULL) continue;
 
-		if ((trackOperations) && (!chromSpec->flag))
+		if ((trackOperations) && (chroms == chromsSorted) && (!chromSpec->flag))
 			{
 			fprintf (stderr, "%s(%s)\n", op->common.name, chrom);
 			chromSpec->flag = true;
@@ -294,7 +319,7 @@ void op_mask_apply
 
 	// success
 
-	fclose (f);
+	close_interval_file (f, /*destroy*/ false);
 	return;
 
 	//////////
@@ -311,12 +336,106 @@ no_mask_val:
 	                 _op->name, op->maskValVarName);
 	exit(EXIT_FAILURE);
 
+no_chrom_mask_val:
+	fprintf (stderr, "[%s] attempt to use %s as mask value for %s failed (no value for that chromosome)\n",
+	                 _op->name, op->maskValVarName, chromSpec->chrom);
+	exit(EXIT_FAILURE);
+
 chrom_too_short:
 	fprintf (stderr, "[%s] in \"%s\", %s %d %d is beyond the end of the chromosome (L=%d)\n",
 	                 op->common.name, filename, chrom, start, end, chromSpec->length);
 	exit (EXIT_FAILURE);
 	}
 
+
+// op_mask_range--
+
+void op_mask_range
+   (arg_dont_complain(dspop*	_op),
+	arg_dont_complain(char*		vName),
+	arg_dont_complain(u32		vLen),
+	arg_dont_complain(valtype*	v),
+	arg_dont_complain(u32		start),
+	arg_dont_complain(u32		end))
+	{
+	dspop_mask*	op = (dspop_mask*) _op;
+	valtype		maskVal;
+	u32			pieceStart, pieceEnd;
+	valtype		val;
+	u32			ix;
+	int			ok;
+
+	// (first subrange) open the file;  if the mask value is a named variable
+	// that has only one value, fetch it now (as op_mask_apply does)
+
+	if (start == 0)
+		{
+		if (op->rf != NULL) close_range_file (op->rf);
+		op->rf = open_range_file (_op->name, op->filename, -1, op->originOne,
+		                          vName, /*skipZeros*/ false, /*disjoint*/ false);
+		if (op->rf == NULL) goto cant_open_file;
+
+		if ((op->maskValVarName != NULL)
+		 && (!named_global_per_chrom (op->maskValVarName)))
+			{
+			ok = named_global_exists (op->maskValVarName, &maskVal);
+			if (!ok) goto no_mask_val;
+			op->maskVal = maskVal;
+			fprintf (stderr, "[%s] using %s = " valtypeFmt " as mask value\n",
+			                 _op->name, op->maskValVarName, maskVal);
+			free (op->maskValVarName);
+			op->maskValVarName = NULL;
+			}
+
+		op->haveChromMaskVal = (op->maskValVarName == NULL);
+		op->chromMaskVal     = op->maskVal;
+		}
+
+	// apply this subrange's intervals as masks;  a per-chromosome mask value
+	// is fetched when the first interval is seen
+
+	while (next_range_interval (op->rf, start, end, &pieceStart, &pieceEnd, &val))
+		{
+		if (!op->haveChromMaskVal)
+			{
+			ok = chrom_named_global_exists (op->maskValVarName, vName, &maskVal);
+			if (!ok) goto no_chrom_mask_val;
+			fprintf (stderr, "[%s] using %s = " valtypeFmt " as mask value for %s\n",
+			                 _op->name, op->maskValVarName, maskVal, vName);
+			op->chromMaskVal     = maskVal;
+			op->haveChromMaskVal = true;
+			}
+
+		maskVal = op->chromMaskVal;
+		for (ix=pieceStart ; ix<pieceEnd ; ix++)
+			v[ix] = maskVal;
+		}
+
+	if (end == vLen)
+		{ close_range_file (op->rf);  op->rf = NULL; }
+
+	return;
+
+	//////////
+	// failure exits
+	//////////
+
+cant_open_file:
+	fprintf (stderr, "[%s] can't open \"%s\" for reading\n",
+	                 _op->name, op->filename);
+	exit (EXIT_FAILURE);
+
+no_mask_val:
+	fprintf (stderr, "[%s] attempt to use %s as mask value failed (no such variable)\n",
+	                 _op->name, op->maskValVarName);
+	exit(EXIT_FAILURE);
+
+no_chrom_mask_val:
+	fprintf (stderr, "[%s] attempt to use %s as mask value for %s failed (no value for that chromosome)\n",
+	                 _op->name, op->maskValVarName, vName);
+	exit(EXIT_FAILURE);
+	}
+
 //----------
 // [[-- a dsp operation function group, operating on the whole genome --]]
 //
@@ -341,6 +460,7 @@ typedef struct dspop_masknot
 	valtype		maskVal;
 	int			originOne;
 	int			debug;
+	rangefile*	rf;				// (for op_mask_not_range) the file being read
 	} dspop_masknot;
 
 
@@ -398,6 +518,7 @@ dspop* op_mask_not_parse (char* name, int _argc, char** _argv)
 	op->filename  = NULL;
 	op->maskVal   = 0.0;
 	op->originOne = (int) get_named_global ("originOne", false);
+	op->rf        = NULL;
 
 	// parse arguments
 
@@ -452,6 +573,11 @@ dspop* op_mask_not_parse (char* name, int _argc, char** _argv)
 
 	if (op->filename == NULL) goto filename_missing;
 
+	note_interval_file (op->filename, -1);
+	op->common.atRandom = !interval_file_by_chromosome (op->filename);
+
+	declare_footprint (footprintPointwise, 0, 0);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -473,6 +599,7 @@ void op_mask_not_free (dspop* _op)
 	{
 	dspop_masknot*	op = (dspop_masknot*) _op;
 
+	if (op->rf       != NULL) close_range_file (op->rf);
 	if (op->filename != NULL) free (op->filename);
 	free (op);
 	}
@@ -489,23 +616,26 @@ void op_mask_not_apply
 	dspop_masknot*	op = (dspop_masknot*) _op;
 	char*		filename = op->filename;
 	valtype		maskVal  = op->maskVal;
-	FILE*		f;
-	char		lineBuffer[1001];
+	intervalfile* f;
 	char		prevChrom[1001];
 	valtype*	v = NULL;
 	char*		chrom;
 	spec*		chromSpec;
+	spec**		chroms;
+	spec*		oneChrom[2];
 	u32			start, end, o, prevEnd, adjStart, adjEnd;
 	valtype		val;
 	u32			ix, chromIx;
 	int			ok;
 
-	f = fopen (filename, "rt");
+	chroms = chromosomes_to_apply (vName, oneChrom);
+
+	f = open_interval_file (filename, -1, op->originOne, vName);
 	if (f == NULL) goto cant_open_file;
 
-	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+	for (chromIx=0 ; chroms[chromIx]!=NULL ; chromIx++)
 		{
-		chromSpec = chromsSorted[chromIx];
+		chromSpec = chroms[chromIx];
 		chromSpec->flag = false;
 		}
 
@@ -521,8 +651,7 @@ void op_mask_not_apply
 	v = NULL;
 	while (true)
 		{
-		ok = read_interval (f, lineBuffer, sizeof(lineBuffer), -1,
-	                        &chrom, &start, &end, &val);
+		ok = next_interval (f, &chrom, &start, &end, &val);
 		if (!ok) break;
 		if (val == 0.0) continue; // treat zero as a missing interval
 
@@ -561,7 +690,8 @@ void op_mask_not_apply
 
 		if (!chromSpec->flag)
 			{
-			if (trackOperations) fprintf (stderr, "%s(%s)\n", op->common.name, chrom);
+			if ((trackOperations) && (chroms == chromsSorted))
+				fprintf (stderr, "%s(%s)\n", op->common.name, chrom);
 			chromSpec->flag = true;
 			}
 
@@ -620,9 +750,9 @@ void op_mask_not_apply
 
 	// clear any chromosomes that weren't observed in the incoming set
 
-	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+	for (chromIx=0 ; chroms[chromIx]!=NULL ; chromIx++)
 		{
-		chromSpec = chromsSorted[chromIx];
+		chromSpec = chroms[chromIx];
 		if (chromSpec->flag) continue;
 
 		chrom = chromSpec->chrom;
@@ -639,7 +769,7 @@ void op_mask_not_apply
 
 	// success
 
-	fclose (f);
+	close_interval_file (f, /*destroy*/ false);
 	return;
 
 	//////////
@@ -667,6 +797,60 @@ intervals_out_of_order:
 	exit (EXIT_FAILURE);
 	}
 
+
+// op_mask_not_range--
+
+void op_mask_not_range
+   (arg_dont_complain(dspop*	_op),
+	arg_dont_complain(char*		vName),
+	arg_dont_complain(u32		vLen),
+	arg_dont_complain(valtype*	v),
+	arg_dont_complain(u32		start),
+	arg_dont_complain(u32		end))
+	{
+	dspop_masknot*	op = (dspop_masknot*) _op;
+	valtype		maskVal  = op->maskVal;
+	u32			pieceStart, pieceEnd, prevEnd;
+	valtype		val;
+	u32			ix;
+
+	if (start == 0)
+		{
+		if (op->rf != NULL) close_range_file (op->rf);
+		op->rf = open_range_file (_op->name, op->filename, -1, op->originOne,
+		                          vName, /*skipZeros*/ true, /*disjoint*/ true);
+		if (op->rf == NULL) goto cant_open_file;
+		}
+
+	// clear the gaps between this subrange's intervals
+
+	prevEnd = start;
+
+	while (next_range_interval (op->rf, start, end, &pieceStart, &pieceEnd, &val))
+		{
+		for (ix=prevEnd ; ix<pieceStart ; ix++)
+			v[ix] = maskVal;
+		prevEnd = pieceEnd;
+		}
+
+	for (ix=prevEnd ; ix<end ; ix++)
+		v[ix] = maskVal;
+
+	if (end == vLen)
+		{ close_range_file (op->rf);  op->rf = NULL; }
+
+	return;
+
+	//////////
+	// failure exits
+	//////////
+
+cant_open_file:
+	fprintf (stderr, "[%s] can't open \"%s\" for reading\n",
+	                 _op->name, op->filename);
+	exit (EXIT_FAILURE);
+	}
+
 //----------
 // [[-- a dsp operation function group, operating on a single chromosome --]]
 //
@@ -692,6 +876,8 @@ typedef struct dspop_clip
 	int			haveMaxVal;
 	char*		maxValVarName;
 	valtype		maxVal;
+	valtype		chromMinVal;	// the limits in effect for the current
+	valtype		chromMaxVal;	// .. chromosome (see op_clip_range)
 	} dspop_clip;
 
 // op_clip_short--
@@ -799,6 +985,13 @@ dspop* op_clip_parse (char* name, int _argc, char** _argv)
 	if ((op->haveMaxVal) && (op->haveMinVal))
 		{ if (op->minVal > op->maxVal) goto conflicting_limits; }
 
+	declare_footprint (footprintPointwise, 0, 0);
+
+	if (op->minValVarName != NULL)
+		declare_resource_use (resourceVariable, op->minValVarName, useRead);
+	if (op->maxValVarName != NULL)
+		declare_resource_use (resourceVariable, op->maxValVarName, useRead);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -848,58 +1041,100 @@ void op_clip_free (dspop* _op)
 // op_clip_apply--
 
 void op_clip_apply
-   (arg_dont_complain(dspop*	_op),
+   (arg_dont_complain(dspop*	op),
 	arg_dont_complain(char*		vName),
 	arg_dont_complain(u32		vLen),
 	arg_dont_complain(valtype*	v))
 	{
+	op_clip_range (op, vName, vLen, v, 0, vLen);
+	}
+
+
+// op_clip_range--
+
+void op_clip_range
+   (arg_dont_complain(dspop*	_op),
+	arg_dont_complain(char*		vName),
+	arg_dont_complain(u32		vLen),
+	arg_dont_complain(valtype*	v),
+	u32							start,
+	u32							end)
+	{
 	dspop_clip*	op = (dspop_clip*) _op;
 	valtype		minVal = op->minVal;
 	valtype		maxVal = op->maxVal;
 	int			ok;
 	u32			ix;
 
+	// limits that are named variables are fetched once per chromosome, at the
+	// first subrange
+
+	if (start != 0)
+		{
+		minVal = op->chromMinVal;
+		maxVal = op->chromMaxVal;
+		goto apply_limits;
+		}
+
 	// if either limit is a named variable, fetch it now;  note that we copy
 	// the value from the named variable, then destroy our reference to the
-	// named variable
+	// named variable (unless the variable has a separate value for each
+	// chromosome, in which case we fetch it anew for every chromosome)
 
 	if (op->minValVarName != NULL)
 		{
 		ok = named_global_exists (op->minValVarName, &minVal);
 		if (!ok) goto no_minimum;
-		op->minVal = minVal;
-		fprintf (stderr, "[%s] using %s = " valtypeFmt " as minimum limit\n",
-		                 _op->name, op->minValVarName, minVal);
-		free (op->minValVarName);
-		op->minValVarName = NULL;
+		if (named_global_per_chrom (op->minValVarName))
+			fprintf (stderr, "[%s] using %s = " valtypeFmt " as minimum limit for %s\n",
+			                 _op->name, op->minValVarName, minVal, vName);
+		else
+			{
+			op->minVal = minVal;
+			fprintf (stderr, "[%s] using %s = " valtypeFmt " as minimum limit\n",
+			                 _op->name, op->minValVarName, minVal);
+			free (op->minValVarName);
+			op->minValVarName = NULL;
+			}
 		}
 
 	if (op->maxValVarName != NULL)
 		{
 		ok = named_global_exists (op->maxValVarName, &maxVal);
 		if (!ok) goto no_maximum;
-		op->maxVal = maxVal;
-		fprintf (stderr, "[%s] using %s = " valtypeFmt " as maximum limit\n",
-		                 _op->name, op->maxValVarName, maxVal);
-		free (op->maxValVarName);
-		op->maxValVarName = NULL;
+		if (named_global_per_chrom (op->maxValVarName))
+			fprintf (stderr, "[%s] using %s = " valtypeFmt " as maximum limit for %s\n",
+			                 _op->name, op->maxValVarName, maxVal, vName);
+		else
+			{
+			op->maxVal = maxVal;
+			fprintf (stderr, "[%s] using %s = " valtypeFmt " as maximum limit\n",
+			                 _op->name, op->maxValVarName, maxVal);
+			free (op->maxValVarName);
+			op->maxValVarName = NULL;
+			}
 		}
 
+	op->chromMinVal = minVal;
+	op->chromMaxVal = maxVal;
+
 	// apply limits over the vector
 
+apply_limits:
+
 	if (!op->haveMaxVal)
 		{ // clip to minimum only
-		for (ix=0 ; ix<vLen ; ix++)
+		for (ix=start ; ix<end ; ix++)
 			{ if (v[ix] < minVal) v[ix] = minVal; }
 		}
 	else if (!op->haveMinVal)
 		{ // clip to maximum only
-		for (ix=0 ; ix<vLen ; ix++)
+		for (ix=start ; ix<end ; ix++)
 			{ if (v[ix] > maxVal) v[ix] = maxVal; }
 		}
 	else
 		{ // clip to minimum and maximum
-		for (ix=0 ; ix<vLen ; ix++)
+		for (ix=start ; ix<end ; ix++)
 			{
 			if      (v[ix] < minVal) v[ix] = minVal;
 			else if (v[ix] > maxVal) v[ix] = maxVal;
@@ -950,6 +1185,8 @@ typedef struct dspop_erase
 	valtype		maxVal;
 	int			keepInside;
 	valtype		zeroVal;
+	valtype		chromMinVal;	// the limits in effect for the current
+	valtype		chromMaxVal;	// .. chromosome (see op_erase_range)
 	} dspop_erase;
 
 // op_erase_short--
@@ -1096,6 +1333,13 @@ dspop* op_erase_parse (char* name, int _argc, char** _argv)
 	if ((op->haveMaxVal) && (op->haveMinVal))
 		{ if (op->minVal > op->maxVal) goto conflicting_limits; }
 
+	declare_footprint (footprintPointwise, 0, 0);
+
+	if (op->minValVarName != NULL)
+		declare_resource_use (resourceVariable, op->minValVarName, useRead);
+	if (op->maxValVarName != NULL)
+		declare_resource_use (resourceVariable, op->maxValVarName, useRead);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -1145,62 +1389,104 @@ void op_erase_free (dspop* _op)
 // op_erase_apply--
 
 void op_erase_apply
-   (arg_dont_complain(dspop*	_op),
+   (arg_dont_complain(dspop*	op),
 	arg_dont_complain(char*		vName),
 	arg_dont_complain(u32		vLen),
 	arg_dont_complain(valtype*	v))
 	{
+	op_erase_range (op, vName, vLen, v, 0, vLen);
+	}
+
+
+// op_erase_range--
+
+void op_erase_range
+   (arg_dont_complain(dspop*	_op),
+	arg_dont_complain(char*		vName),
+	arg_dont_complain(u32		vLen),
+	arg_dont_complain(valtype*	v),
+	u32							start,
+	u32							end)
+	{
 	dspop_erase* op = (dspop_erase*) _op;
 	valtype		minVal = op->minVal;
 	valtype		maxVal = op->maxVal;
 	int			ok;
 	u32			ix;
 
+	// limits that are named variables are fetched once per chromosome, at the
+	// first subrange
+
+	if (start != 0)
+		{
+		minVal = op->chromMinVal;
+		maxVal = op->chromMaxVal;
+		goto apply_limits;
+		}
+
 	// if either limit is a named variable, fetch it now;  note that we copy
 	// the value from the named variable, then destroy our reference to the
-	// named variable
+	// named variable (unless the variable has a separate value for each
+	// chromosome, in which case we fetch it anew for every chromosome)
 
 	if (op->minValVarName != NULL)
 		{
 		ok = named_global_exists (op->minValVarName, &minVal);
 		if (!ok) goto no_minimum;
-		op->minVal = minVal;
-		fprintf (stderr, "[%s] using %s = " valtypeFmt " as minimum limit\n",
-		                 _op->name, op->minValVarName, minVal);
-		free (op->minValVarName);
-		op->minValVarName = NULL;
+		if (named_global_per_chrom (op->minValVarName))
+			fprintf (stderr, "[%s] using %s = " valtypeFmt " as minimum limit for %s\n",
+			                 _op->name, op->minValVarName, minVal, vName);
+		else
+			{
+			op->minVal = minVal;
+			fprintf (stderr, "[%s] using %s = " valtypeFmt " as minimum limit\n",
+			                 _op->name, op->minValVarName, minVal);
+			free (op->minValVarName);
+			op->minValVarName = NULL;
+			}
 		}
 
 	if (op->maxValVarName != NULL)
 		{
 		ok = named_global_exists (op->maxValVarName, &maxVal);
 		if (!ok) goto no_maximum;
-		op->maxVal = maxVal;
-		fprintf (stderr, "[%s] using %s = " valtypeFmt " as maximum limit\n",
-		                 _op->name, op->maxValVarName, maxVal);
-		free (op->maxValVarName);
-		op->maxValVarName = NULL;
+		if (named_global_per_chrom (op->maxValVarName))
+			fprintf (stderr, "[%s] using %s = " valtypeFmt " as maximum limit for %s\n",
+			                 _op->name, op->maxValVarName, maxVal, vName);
+		else
+			{
+			op->maxVal = maxVal;
+			fprintf (stderr, "[%s] using %s = " valtypeFmt " as maximum limit\n",
+			                 _op->name, op->maxValVarName, maxVal);
+			free (op->maxValVarName);
+			op->maxValVarName = NULL;
+			}
 		}
 
+	op->chromMinVal = minVal;
+	op->chromMaxVal = maxVal;
+
 	// apply limits over the vector
 
+apply_limits:
+
 	if (op->keepInside)
 		{
 		// keep the inside, erase the outside
 
 		if (!op->haveMaxVal)
 			{ // erase below minimum only
-			for (ix=0 ; ix<vLen ; ix++)
+			for (ix=start ; ix<end ; ix++)
 				{ if (v[ix] < minVal) v[ix] = op->zeroVal; }
 			}
 		else if (!op->haveMinVal)
 			{ // erase above maximum only
-			for (ix=0 ; ix<vLen ; ix++)
+			for (ix=start ; ix<end ; ix++)
 				{ if (v[ix] > maxVal) v[ix] = op->zeroVal; }
 			}
 		else
 			{ // erase outside of minimum and maximum
-			for (ix=0 ; ix<vLen ; ix++)
+			for (ix=start ; ix<end ; ix++)
 				{ if ((v[ix] < minVal) || (v[ix] > maxVal)) v[ix] = op->zeroVal; }
 			}
 		}
@@ -1210,17 +1496,17 @@ void op_erase_apply
 
 		if (!op->haveMaxVal)
 			{ // erase above minimum only
-			for (ix=0 ; ix<vLen ; ix++)
+			for (ix=start ; ix<end ; ix++)
 				{ if (v[ix] >= minVal) v[ix] = op->zeroVal; }
 			}
 		else if (!op->haveMinVal)
 			{ // erase below maximum only
-			for (ix=0 ; ix<vLen ; ix++)
+			for (ix=start ; ix<end ; ix++)
 				{ if (v[ix] <= maxVal) v[ix] = op->zeroVal; }
 			}
 		else
 			{ // erase inside of minimum and maximum
-			for (ix=0 ; ix<vLen ; ix++)
+			for (ix=start ; ix<end ; ix++)
 				{ if ((v[ix] >= minVal) && (v[ix] <= maxVal)) v[ix] = op->zeroVal; }
 			}
 		}
@@ -8,4 +8,9 @@ dspprototypes(op_mask_not)
 dspprototypes(op_clip)
 dspprototypes(op_erase)
 
+dsprangeprototype(op_mask)
+dsprangeprototype(op_mask_not)
+dsprangeprototype(op_clip)
+dsprangeprototype(op_erase)
+
 #endif // mask_H
@@ -159,6 +159,9 @@ dspop* op_min_in_interval_parse (char* name, int _argc, char** _argv)
 
 	if (op->filename == NULL) goto filename_missing;
 
+	note_interval_file (op->filename, -1);
+	op->common.atRandom = !interval_file_by_chromosome (op->filename);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -199,23 +202,26 @@ void op_min_in_interval_apply
 	dspop_minover*	op = (dspop_minover*) _op;
 	char*			filename    = op->filename;
 	valtype			infinityVal = op->infinityVal;
-	FILE*			f;
-	char			lineBuffer[1001];
+	intervalfile*	f;
 	char			prevChrom[1001];
 	valtype*		v = NULL;
 	char*			chrom;
 	spec*			chromSpec;
+	spec**			chroms;
+	spec*			oneChrom[2];
 	u32				start, end, o, prevEnd, adjStart, adjEnd;
 	valtype			minVal, val;
 	u32				ix, chromIx, minIx, inset, maxInset;
 	int				ok;
 
-	f = fopen (filename, "rt");
+	chroms = chromosomes_to_apply (vName, oneChrom);
+
+	f = open_interval_file (filename, -1, op->originOne, vName);
 	if (f == NULL) goto cant_open_file;
 
-	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+	for (chromIx=0 ; chroms[chromIx]!=NULL ; chromIx++)
 		{
-		chromSpec = chromsSorted[chromIx];
+		chromSpec = chroms[chromIx];
 		chromSpec->flag = false;
 		}
 
@@ -231,8 +237,7 @@ void op_min_in_interval_apply
 	v = NULL;
 	while (true)
 		{
-		ok = read_interval (f, lineBuffer, sizeof(lineBuffer), -1,
-	                        &chrom, &start, &end, &val);
+		ok = next_interval (f, &chrom, &start, &end, &val);
 		if (!ok) break;
 		if (val == 0.0) continue; // treat zero as a missing interval
 
@@ -274,7 +279,8 @@ void op_min_in_interval_apply
 
 		if (!chromSpec->flag)
 			{
-			if (trackOperations) fprintf (stderr, "%s(%s)\n", op->common.name, chrom);
+			if ((trackOperations) && (chroms == chromsSorted))
+				fprintf (stderr, "%s(%s)\n", op->common.name, chrom);
 			chromSpec->flag = true;
 			}
 
@@ -367,9 +373,9 @@ void op_min_in_interval_apply
 
 	// clear any chromosomes that weren't observed in the incoming set
 
-	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+	for (chromIx=0 ; chroms[chromIx]!=NULL ; chromIx++)
 		{
-		chromSpec = chromsSorted[chromIx];
+		chromSpec = chroms[chromIx];
 		if (chromSpec->flag) continue;
 
 		chrom = chromSpec->chrom;
@@ -390,7 +396,7 @@ void op_min_in_interval_apply
 
 	// success
 
-	fclose (f);
+	close_interval_file (f, /*destroy*/ false);
 	return;
 
 	//////////
@@ -562,6 +568,9 @@ dspop* op_max_in_interval_parse (char* name, int _argc, char** _argv)
 
 	if (op->filename == NULL) goto filename_missing;
 
+	note_interval_file (op->filename, -1);
+	op->common.atRandom = !interval_file_by_chromosome (op->filename);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -602,23 +611,26 @@ void op_max_in_interval_apply
 	dspop_maxover*	op = (dspop_maxover*) _op;
 	char*			filename = op->filename;
 	valtype			zeroVal  = op->zeroVal;
-	FILE*			f;
-	char			lineBuffer[1001];
+	intervalfile*	f;
 	char			prevChrom[1001];
 	valtype*		v = NULL;
 	char*			chrom;
 	spec*			chromSpec;
+	spec**			chroms;
+	spec*			oneChrom[2];
 	u32				start, end, o, prevEnd, adjStart, adjEnd;
 	valtype			maxVal, val;
 	u32				ix, chromIx, maxIx, inset, maxInset;
 	int				ok;
 
-	f = fopen (filename, "rt");
+	chroms = chromosomes_to_apply (vName, oneChrom);
+
+	f = open_interval_file (filename, -1, op->originOne, vName);
 	if (f == NULL) goto cant_open_file;
 
-	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+	for (chromIx=0 ; chroms[chromIx]!=NULL ; chromIx++)
 		{
-		chromSpec = chromsSorted[chromIx];
+		chromSpec = chroms[chromIx];
 		chromSpec->flag = false;
 		}
 
@@ -634,8 +646,7 @@ void op_max_in_interval_apply
 	v = NULL;
 	while (true)
 		{
-		ok = read_interval (f, lineBuffer, sizeof(lineBuffer), -1,
-	                        &chrom, &start, &end, &val);
+		ok = next_interval (f, &chrom, &start, &end, &val);
 		if (!ok) break;
 		if (val == 0.0) continue; // treat zero as a missing interval
 
@@ -677,7 +688,8 @@ void op_max_in_interval_apply
 
 		if (!chromSpec->flag)
 			{
-			if (trackOperations) fprintf (stderr, "%s(%s)\n", op->common.name, chrom);
+			if ((trackOperations) && (chroms == chromsSorted))
+				fprintf (stderr, "%s(%s)\n", op->common.name, chrom);
 			chromSpec->flag = true;
 			}
 
@@ -770,9 +782,9 @@ void op_max_in_interval_apply
 
 	// clear any chromosomes that weren't observed in the incoming set
 
-	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+	for (chromIx=0 ; chroms[chromIx]!=NULL ; chromIx++)
 		{
-		chromSpec = chromsSorted[chromIx];
+		chromSpec = chroms[chromIx];
 		if (chromSpec->flag) continue;
 
 		chrom = chromSpec->chrom;
@@ -793,7 +805,7 @@ void op_max_in_interval_apply
 
 	// success
 
-	fclose (f);
+	close_interval_file (f, /*destroy*/ false);
 	return;
 
 	//////////
@@ -958,6 +970,9 @@ dspop* op_local_minima_parse (char* name, int _argc, char** _argv)
 		continue;
 		}
 
+	declare_footprint (footprintWindowed,
+	                   (op->neighborhood-1)/2, op->neighborhood-1 - (op->neighborhood-1)/2);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -987,7 +1002,7 @@ void op_local_minima_apply
 	dspop_localmin*	op = (dspop_localmin*) _op;
 	u32			neighborhood = op->neighborhood;
 	valtype		infinityVal  = op->infinityVal;
-	valtype*	s = get_scratch_vector();
+	valtype*	s = get_exact_scratch_vector(vLen);
 	valtype		val;
 	u32			hOff, ix, wIx, wStart, wEnd;
 
@@ -1013,12 +1028,9 @@ void op_local_minima_apply
 		s[ix] = val;
 		}
 
-	// copy scratch array to vector
+	// make the scratch array the chromosome's vector
 
-	for (ix=0 ; ix<vLen ; ix++)
-		v[ix] = s[ix];
-
-	release_scratch_vector(s);
+	swap_scratch_vector (vName, s);
 	}
 
 //----------
@@ -1160,6 +1172,9 @@ dspop* op_local_maxima_parse (char* name, int _argc, char** _argv)
 		continue;
 		}
 
+	declare_footprint (footprintWindowed,
+	                   (op->neighborhood-1)/2, op->neighborhood-1 - (op->neighborhood-1)/2);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -1189,7 +1204,7 @@ void op_local_maxima_apply
 	dspop_localmax*	op = (dspop_localmax*) _op;
 	u32			neighborhood = op->neighborhood;
 	valtype		zeroVal      = op->zeroVal;
-	valtype*	s = get_scratch_vector();
+	valtype*	s = get_exact_scratch_vector(vLen);
 	valtype		val;
 	u32			hOff, ix, wIx, wStart, wEnd;
 
@@ -1218,12 +1233,9 @@ void op_local_maxima_apply
 		s[ix] = val;
 		}
 
-	// copy scratch array to vector
-
-	for (ix=0 ; ix<vLen ; ix++)
-		v[ix] = s[ix];
+	// make the scratch array the chromosome's vector
 
-	release_scratch_vector(s);
+	swap_scratch_vector (vName, s);
 	}
 
 //----------
@@ -1374,7 +1386,7 @@ void op_best_local_min_apply
 	{
 	dspop_bestmin*	op = (dspop_bestmin*) _op;
 	u32			windowSize = op->windowSize;
-	valtype*	s = get_scratch_vector();
+	valtype*	s = get_exact_scratch_vector(vLen);
 	valtype		minVal;
 	u32			wLft, wRgt, ix, ixLft, ixRgt, wIx, bestIx;
 
@@ -1465,12 +1477,9 @@ void op_best_local_min_apply
 		s[ix] = minVal;
 		}
 
-	// copy scratch array to vector
+	// make the scratch array the chromosome's vector
 
-	for (ix=0 ; ix<vLen ; ix++)
-		v[ix] = s[ix];
-
-	release_scratch_vector(s);
+	swap_scratch_vector (vName, s);
 	}
 
 //----------
@@ -1621,7 +1630,7 @@ void op_best_local_max_apply
 	{
 	dspop_bestmax*	op = (dspop_bestmax*) _op;
 	u32			windowSize = op->windowSize;
-	valtype*	s = get_scratch_vector();
+	valtype*	s = get_exact_scratch_vector(vLen);
 	valtype		maxVal;
 	u32			wLft, wRgt, ix, ixLft, ixRgt, wIx, bestIx;
 
@@ -1712,12 +1721,9 @@ void op_best_local_max_apply
 		s[ix] = maxVal;
 		}
 
-	// copy scratch array to vector
+	// make the scratch array the chromosome's vector
 
-	for (ix=0 ; ix<vLen ; ix++)
-		v[ix] = s[ix];
-
-	release_scratch_vector(s);
+	swap_scratch_vector (vName, s);
 	}
 
 //----------
@@ -1743,6 +1749,7 @@ typedef struct dspop_min_with
 	int			valColumn;
 	int			originOne;
 	int			destroyFile;
+	rangefile*	rf;				// (for op_min_with_range) the file being read
 	} dspop_min_with;
 
 
@@ -1798,6 +1805,7 @@ dspop* op_min_with_parse (char* name, int _argc, char** _argv)
 	op->filename    = NULL;
 	op->valColumn   = (int) get_named_global ("valColumn", 4-1);
 	op->originOne   = (int) get_named_global ("originOne", false);
+	op->rf          = NULL;
 	op->destroyFile = false;
 
 	// parse arguments
@@ -1862,6 +1870,14 @@ dspop* op_min_with_parse (char* name, int _argc, char** _argv)
 
 	if (op->filename == NULL) goto filename_missing;
 
+	note_interval_file (op->filename, op->valColumn);
+	if (!op->destroyFile)  // (a file to be destroyed is read in one pass)
+		op->common.atRandom = !interval_file_by_chromosome (op->filename);
+	else
+		declare_resource_use (resourceData, op->filename, useWrite);
+
+	declare_footprint (footprintPointwise, 0, 0);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -1883,6 +1899,7 @@ void op_min_with_free (dspop* _op)
 	{
 	dspop_min_with*	op = (dspop_min_with*) _op;
 
+	if (op->rf       != NULL) close_range_file (op->rf);
 	if (op->filename != NULL) free (op->filename);
 	free (op);
 	}
@@ -1898,25 +1915,28 @@ void op_min_with_apply
 	{
 	dspop_min_with*	op = (dspop_min_with*) _op;
 	char*		filename = op->filename;
-	FILE*		f;
-	char		lineBuffer[1001];
+	intervalfile* f;
 	char		prevChrom[1001];
 	valtype*	v = NULL;
 	char*		chrom;
 	spec*		chromSpec;
+	spec**		chroms;
+	spec*		oneChrom[2];
 	u32			start, end, o, adjStart, adjEnd;
 	valtype		val;
 	u32			ix, chromIx;
 	int			ok;
 
-	f = fopen (filename, "rt");
+	chroms = chromosomes_to_apply (vName, oneChrom);
+
+	f = open_interval_file (filename, op->valColumn, op->originOne, vName);
 	if (f == NULL) goto cant_open_file;
 
 	if (trackOperations)
 		{
-		for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+		for (chromIx=0 ; chroms[chromIx]!=NULL ; chromIx++)
 			{
-			chromSpec = chromsSorted[chromIx];
+			chromSpec = chroms[chromIx];
 			chromSpec->flag = false;
 			}
 		}
@@ -1932,8 +1952,7 @@ void op_min_with_apply
 	v = NULL;
 	while (true)
 		{
-		ok = read_interval (f, lineBuffer, sizeof(lineBuffer), op->valColumn,
-	                        &chrom, &start, &end, &val);
+		ok = next_interval (f, &chrom, &start, &end, &val);
 		if (!ok) break;
 
 		if (strcmp (chrom, prevChrom) != 0)
@@ -1946,7 +1965,7 @@ void op_min_with_apply
 
 		if (chromSpec == NULL) continue;
 
-		if ((trackOperations) && (!chromSpec->flag))
+		if ((trackOperations) && (chroms == chromsSorted) && (!chromSpec->flag))
 			{
 			fprintf (stderr, "%s(%s)\n", op->common.name, chrom);
 			chromSpec->flag = true;
@@ -1984,10 +2003,7 @@ void op_min_with_apply
 
 	// success
 
-	fclose (f);
-
-	if (op->destroyFile)
-		remove (filename);
+	close_interval_file (f, op->destroyFile);
 
 	return;
 
@@ -2006,6 +2022,55 @@ chrom_too_short:
 	exit (EXIT_FAILURE);
 	}
 
+
+// op_min_with_range--
+//	(only used when the file can be read one chromosome at a time, which
+//	excludes a file that is to be destroyed)
+
+void op_min_with_range
+   (arg_dont_complain(dspop*	_op),
+	arg_dont_complain(char*		vName),
+	arg_dont_complain(u32		vLen),
+	arg_dont_complain(valtype*	v),
+	arg_dont_complain(u32		start),
+	arg_dont_complain(u32		end))
+	{
+	dspop_min_with*	op = (dspop_min_with*) _op;
+	u32				pieceStart, pieceEnd;
+	valtype			val;
+	u32				ix;
+
+	if (start == 0)
+		{
+		if (op->rf != NULL) close_range_file (op->rf);
+		op->rf = open_range_file (_op->name, op->filename, op->valColumn, op->originOne,
+		                          vName, /*skipZeros*/ false, /*disjoint*/ false);
+		if (op->rf == NULL) goto cant_open_file;
+		}
+
+	// read this subrange's intervals and values and minimize with them
+
+	while (next_range_interval (op->rf, start, end, &pieceStart, &pieceEnd, &val))
+		{
+		for (ix=pieceStart ; ix<pieceEnd ; ix++)
+			{ if (val < v[ix]) v[ix] = val; }
+		}
+
+	if (end == vLen)
+		{ close_range_file (op->rf);  op->rf = NULL; }
+
+	return;
+
+	//////////
+	// failure exits
+	//////////
+
+cant_open_file:
+	fprintf (stderr, "[%s] can't open \"%s\" for reading\n",
+	                 _op->name, op->filename);
+	exit (EXIT_FAILURE);
+	}
+
 //----------
 // [[-- a dsp operation function group, operating on the whole genome --]]
 //
@@ -2029,6 +2094,7 @@ typedef struct dspop_max_with
 	int			valColumn;
 	int			originOne;
 	int			destroyFile;
+	rangefile*	rf;				// (for op_max_with_range) the file being read
 	} dspop_max_with;
 
 
@@ -2084,6 +2150,7 @@ dspop* op_max_with_parse (char* name, int _argc, char** _argv)
 	op->filename    = NULL;
 	op->valColumn   = (int) get_named_global ("valColumn", 4-1);
 	op->originOne   = (int) get_named_global ("originOne", false);
+	op->rf          = NULL;
 	op->destroyFile = false;
 
 	// parse arguments
@@ -2148,6 +2215,14 @@ dspop* op_max_with_parse (char* name, int _argc, char** _argv)
 
 	if (op->filename == NULL) goto filename_missing;
 
+	note_interval_file (op->filename, op->valColumn);
+	if (!op->destroyFile)  // (a file to be destroyed is read in one pass)
+		op->common.atRandom = !interval_file_by_chromosome (op->filename);
+	else
+		declare_resource_use (resourceData, op->filename, useWrite);
+
+	declare_footprint (footprintPointwise, 0, 0);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -2169,6 +2244,7 @@ void op_max_with_free (dspop* _op)
 	{
 	dspop_max_with*	op = (dspop_max_with*) _op;
 
+	if (op->rf       != NULL) close_range_file (op->rf);
 	if (op->filename != NULL) free (op->filename);
 	free (op);
 	}
@@ -2184,25 +2260,28 @@ void op_max_with_apply
 	{
 	dspop_max_with*	op = (dspop_max_with*) _op;
 	char*		filename = op->filename;
-	FILE*		f;
-	char		lineBuffer[1001];
+	intervalfile* f;
 	char		prevChrom[1001];
 	valtype*	v = NULL;
 	char*		chrom;
 	spec*		chromSpec;
+	spec**		chroms;
+	spec*		oneChrom[2];
 	u32			start, end, o, adjStart, adjEnd;
 	valtype		val;
 	u32			ix, chromIx;
 	int			ok;
 
-	f = fopen (filename, "rt");
+	chroms = chromosomes_to_apply (vName, oneChrom);
+
+	f = open_interval_file (filename, op->valColumn, op->originOne, vName);
 	if (f == NULL) goto cant_open_file;
 
 	if (trackOperations)
 		{
-		for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+		for (chromIx=0 ; chroms[chromIx]!=NULL ; chromIx++)
 			{
-			chromSpec = chromsSorted[chromIx];
+			chromSpec = chroms[chromIx];
 			chromSpec->flag = false;
 			}
 		}
@@ -2218,8 +2297,7 @@ void op_max_with_apply
 	v = NULL;
 	while (true)
 		{
-		ok = read_interval (f, lineBuffer, sizeof(lineBuffer), op->valColumn,
-	                        &chrom, &start, &end, &val);
+		ok = next_interval (f, &chrom, &start, &end, &val);
 		if (!ok) break;
 
 		if (strcmp (chrom, prevChrom) != 0)
@@ -2232,7 +2310,7 @@ void op_max_with_apply
 
 		if (chromSpec == NULL) continue;
 
-		if ((trackOperations) && (!chromSpec->flag))
+		if ((trackOperations) && (chroms == chromsSorted) && (!chromSpec->flag))
 			{
 			fprintf (stderr, "%s(%s)\n", op->common.name, chrom);
 			chromSpec->flag = true;
@@ -2270,10 +2348,7 @@ void op_max_with_apply
 
 	// success
 
-	fclose (f);
-
-	if (op->destroyFile)
-		remove (filename);
+	close_interval_file (f, op->destroyFile);
 
 	return;
 
@@ -2292,3 +2367,52 @@ chrom_too_short:
 	exit (EXIT_FAILURE);
 	}
 
+
+// op_max_with_range--
+//	(only used when the file can be read one chromosome at a time, which
+//	excludes a file that is to be destroyed)
+
+void op_max_with_range
+   (arg_dont_complain(dspop*	_op),
+	arg_dont_complain(char*		vName),
+	arg_dont_complain(u32		vLen),
+	arg_dont_complain(valtype*	v),
+	arg_dont_complain(u32		start),
+	arg_dont_complain(u32		end))
+	{
+	dspop_max_with*	op = (dspop_max_with*) _op;
+	u32				pieceStart, pieceEnd;
+	valtype			val;
+	u32				ix;
+
+	if (start == 0)
+		{
+		if (op->rf != NULL) close_range_file (op->rf);
+		op->rf = open_range_file (_op->name, op->filename, op->valColumn, op->originOne,
+		                          vName, /*skipZeros*/ false, /*disjoint*/ false);
+		if (op->rf == NULL) goto cant_open_file;
+		}
+
+	// read this subrange's intervals and values and maximize with them
+
+	while (next_range_interval (op->rf, start, end, &pieceStart, &pieceEnd, &val))
+		{
+		for (ix=pieceStart ; ix<pieceEnd ; ix++)
+			{ if (val > v[ix]) v[ix] = val; }
+		}
+
+	if (end == vLen)
+		{ close_range_file (op->rf);  op->rf = NULL; }
+
+	return;
+
+	//////////
+	// failure exits
+	//////////
+
+cant_open_file:
+	fprintf (stderr, "[%s] can't open \"%s\" for reading\n",
+	                 _op->name, op->filename);
+	exit (EXIT_FAILURE);
+	}
+
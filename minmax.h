@@ -12,4 +12,7 @@ dspprototypes(op_best_local_max)
 dspprototypes(op_min_with)
 dspprototypes(op_max_with)
 
+dsprangeprototype(op_min_with)
+dsprangeprototype(op_max_with)
+
 #endif // minmax_H
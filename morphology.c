@@ -12,6 +12,17 @@
 #include "genodsp_interface.h"
 #include "morphology.h"
 
+// prototypes for private functions
+
+static void close_runs  (char* vName, valtype* v, u32 vLen,
+                         valtype threshold, u32 closingLength);
+static void open_runs   (char* vName, valtype* v, u32 vLen,
+                         valtype threshold, u32 openingLength);
+static void dilate_runs (char* vName, valtype* v, u32 vLen,
+                         valtype threshold, u32 leftDilation, u32 rightDilation);
+static void erode_runs  (char* vName, valtype* v, u32 vLen,
+                         valtype threshold, u32 leftErosion, u32 rightErosion);
+
 //----------
 // [[-- a dsp operation function group, operating on a single chromosome --]]
 //
@@ -194,6 +205,15 @@ dspop* op_close_parse (char* name, int _argc, char** _argv)
 
 	if (!haveLength) goto length_missing;
 
+	// with the default one and zero, we can produce a signal stored as runs,
+	// and consume one stored as bits, counts or runs
+
+	if ((op->oneVal == 1.0) && (op->zeroVal == 0.0) && (!op->debug))
+		accept_signal_storage (storeBits|storeCounts|storeRuns);
+
+	if (op->thresholdVarName != NULL)
+		declare_resource_use (resourceVariable, op->thresholdVarName, useRead);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -246,17 +266,32 @@ void op_close_apply
 
 	// if the threshold is a named variable, fetch it now;  note that we copy
 	// the value from the named variable, then destroy our reference to the
-	// named variable
+	// named variable (unless the variable has a separate value for each
+	// chromosome, in which case we fetch it anew for every chromosome)
 
 	if (op->thresholdVarName != NULL)
 		{
 		ok = named_global_exists (op->thresholdVarName, &cutoffThresh);
 		if (!ok) goto no_threshold;
-		op->threshold = cutoffThresh;
-		fprintf (stderr, "[%s] using %s = " valtypeFmt " as threshold\n",
-		                 _op->name, op->thresholdVarName, cutoffThresh);
-		free (op->thresholdVarName);
-		op->thresholdVarName = NULL;
+		if (named_global_per_chrom (op->thresholdVarName))
+			fprintf (stderr, "[%s] using %s = " valtypeFmt " as threshold for %s\n",
+			                 _op->name, op->thresholdVarName, cutoffThresh, vName);
+		else
+			{
+			op->threshold = cutoffThresh;
+			fprintf (stderr, "[%s] using %s = " valtypeFmt " as threshold\n",
+			                 _op->name, op->thresholdVarName, cutoffThresh);
+			free (op->thresholdVarName);
+			op->thresholdVarName = NULL;
+			}
+		}
+
+	// with the default one and zero, work on the signal's list of runs
+
+	if ((oneVal == 1.0) && (zeroVal == 0.0) && (!op->debug))
+		{
+		close_runs (vName, v, vLen, cutoffThresh, op->closingLength);
+		return;
 		}
 
 	// process the vector, filling short gaps (and binarizing);  note that we
@@ -492,6 +527,15 @@ dspop* op_open_parse (char* name, int _argc, char** _argv)
 
 	if (!haveLength) goto length_missing;
 
+	// with the default one and zero, we can produce a signal stored as runs,
+	// and consume one stored as bits, counts or runs
+
+	if ((op->oneVal == 1.0) && (op->zeroVal == 0.0))
+		accept_signal_storage (storeBits|storeCounts|storeRuns);
+
+	if (op->thresholdVarName != NULL)
+		declare_resource_use (resourceVariable, op->thresholdVarName, useRead);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -544,17 +588,32 @@ void op_open_apply
 
 	// if the threshold is a named variable, fetch it now;  note that we copy
 	// the value from the named variable, then destroy our reference to the
-	// named variable
+	// named variable (unless the variable has a separate value for each
+	// chromosome, in which case we fetch it anew for every chromosome)
 
 	if (op->thresholdVarName != NULL)
 		{
 		ok = named_global_exists (op->thresholdVarName, &cutoffThresh);
 		if (!ok) goto no_threshold;
-		op->threshold = cutoffThresh;
-		fprintf (stderr, "[%s] using %s = " valtypeFmt " as threshold\n",
-		                 _op->name, op->thresholdVarName, cutoffThresh);
-		free (op->thresholdVarName);
-		op->thresholdVarName = NULL;
+		if (named_global_per_chrom (op->thresholdVarName))
+			fprintf (stderr, "[%s] using %s = " valtypeFmt " as threshold for %s\n",
+			                 _op->name, op->thresholdVarName, cutoffThresh, vName);
+		else
+			{
+			op->threshold = cutoffThresh;
+			fprintf (stderr, "[%s] using %s = " valtypeFmt " as threshold\n",
+			                 _op->name, op->thresholdVarName, cutoffThresh);
+			free (op->thresholdVarName);
+			op->thresholdVarName = NULL;
+			}
+		}
+
+	// with the default one and zero, work on the signal's list of runs
+
+	if ((oneVal == 1.0) && (zeroVal == 0.0))
+		{
+		open_runs (vName, v, vLen, cutoffThresh, op->openingLength);
+		return;
 		}
 
 	// process the vector, clearing short intervals (and binarizing)
@@ -840,6 +899,15 @@ dspop* op_dilate_parse (char* name, int _argc, char** _argv)
 		if ((op->leftDilation == 0) && (op->rightDilation == 0)) goto length_missing;
 		}
 
+	// with the default one and zero, we can produce a signal stored as runs,
+	// and consume one stored as bits, counts or runs
+
+	if ((op->oneVal == 1.0) && (op->zeroVal == 0.0) && (!op->debug))
+		accept_signal_storage (storeBits|storeCounts|storeRuns);
+
+	if (op->thresholdVarName != NULL)
+		declare_resource_use (resourceVariable, op->thresholdVarName, useRead);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -897,17 +965,24 @@ void op_dilate_apply
 
 	// if the threshold is a named variable, fetch it now;  note that we copy
 	// the value from the named variable, then destroy our reference to the
-	// named variable
+	// named variable (unless the variable has a separate value for each
+	// chromosome, in which case we fetch it anew for every chromosome)
 
 	if (op->thresholdVarName != NULL)
 		{
 		ok = named_global_exists (op->thresholdVarName, &cutoffThresh);
 		if (!ok) goto no_threshold;
-		op->threshold = cutoffThresh;
-		fprintf (stderr, "[%s] using %s = " valtypeFmt " as threshold\n",
-		                 _op->name, op->thresholdVarName, cutoffThresh);
-		free (op->thresholdVarName);
-		op->thresholdVarName = NULL;
+		if (named_global_per_chrom (op->thresholdVarName))
+			fprintf (stderr, "[%s] using %s = " valtypeFmt " as threshold for %s\n",
+			                 _op->name, op->thresholdVarName, cutoffThresh, vName);
+		else
+			{
+			op->threshold = cutoffThresh;
+			fprintf (stderr, "[%s] using %s = " valtypeFmt " as threshold\n",
+			                 _op->name, op->thresholdVarName, cutoffThresh);
+			free (op->thresholdVarName);
+			op->thresholdVarName = NULL;
+			}
 		}
 
 	// process the vector, widening intervals (and binarizing);  note that
@@ -925,6 +1000,12 @@ void op_dilate_apply
 		rightDilation = op->rightDilation;
 		}
 
+	if ((oneVal == 1.0) && (zeroVal == 0.0) && (!op->debug))
+		{
+		dilate_runs (vName, v, vLen, cutoffThresh, leftDilation, rightDilation);
+		return;
+		}
+
 	gapStartIx = 0;
 	inInterval = (v[0] > cutoffThresh);
 	if (inInterval) v[0] = oneVal;
@@ -1289,6 +1370,15 @@ dspop* op_erode_parse (char* name, int _argc, char** _argv)
 		if ((op->leftErosion == 0) && (op->rightErosion == 0)) goto length_missing;
 		}
 
+	// with the default one and zero, we can produce a signal stored as runs,
+	// and consume one stored as bits, counts or runs
+
+	if ((op->oneVal == 1.0) && (op->zeroVal == 0.0) && (!op->debug))
+		accept_signal_storage (storeBits|storeCounts|storeRuns);
+
+	if (op->thresholdVarName != NULL)
+		declare_resource_use (resourceVariable, op->thresholdVarName, useRead);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -1346,17 +1436,24 @@ void op_erode_apply
 
 	// if the threshold is a named variable, fetch it now;  note that we copy
 	// the value from the named variable, then destroy our reference to the
-	// named variable
+	// named variable (unless the variable has a separate value for each
+	// chromosome, in which case we fetch it anew for every chromosome)
 
 	if (op->thresholdVarName != NULL)
 		{
 		ok = named_global_exists (op->thresholdVarName, &cutoffThresh);
 		if (!ok) goto no_threshold;
-		op->threshold = cutoffThresh;
-		fprintf (stderr, "[%s] using %s = " valtypeFmt " as threshold\n",
-		                 _op->name, op->thresholdVarName, cutoffThresh);
-		free (op->thresholdVarName);
-		op->thresholdVarName = NULL;
+		if (named_global_per_chrom (op->thresholdVarName))
+			fprintf (stderr, "[%s] using %s = " valtypeFmt " as threshold for %s\n",
+			                 _op->name, op->thresholdVarName, cutoffThresh, vName);
+		else
+			{
+			op->threshold = cutoffThresh;
+			fprintf (stderr, "[%s] using %s = " valtypeFmt " as threshold\n",
+			                 _op->name, op->thresholdVarName, cutoffThresh);
+			free (op->thresholdVarName);
+			op->thresholdVarName = NULL;
+			}
 		}
 
 	// process the vector, widening intervals (and binarizing);  note that
@@ -1377,6 +1474,12 @@ void op_erode_apply
 		rightErosion = op->rightErosion;
 		}
 
+	if ((oneVal == 1.0) && (zeroVal == 0.0) && (!op->debug))
+		{
+		erode_runs (vName, v, vLen, cutoffThresh, leftErosion, rightErosion);
+		return;
+		}
+
 	startIx = 0;
 	inInterval = (v[0] > cutoffThresh);
 	if (!inInterval) v[0] = zeroVal;
@@ -1403,8 +1506,8 @@ void op_erode_apply
 			// we've encountered the start of a new gap;  set and/or clear
 			// items to narrow the interval between this gap and the last
 
-			rightIx = startIx + rightErosion;
-			leftIx  = ix - leftErosion;
+			rightIx = (ix - startIx <= rightErosion)? ix      : startIx + rightErosion;
+			leftIx  = (ix - startIx <= leftErosion)?  startIx : ix - leftErosion;
 
 			if (op->debug)
 				{
@@ -1453,3 +1556,146 @@ no_threshold:
 	exit(EXIT_FAILURE);
 	}
 
+//----------
+//
+// close_runs, open_runs, dilate_runs, erode_runs--
+//	Perform a morphology operation on the runs of the binarized signal,
+//	producing a signal stored as a list of runs.
+//
+// The binarized signal is extracted as a list of runs (if it isn't stored that
+// way already, see threshold_signal_runs), and the operation rewrites that
+// list in place, so the cost depends on the number of runs rather than on the
+// number of bases.
+//
+//----------
+//
+// Arguments:
+//	char*		vName:		The chromosome.
+//	valtype*	v:			The chromosome's vector of values (NULL if it is
+//							.. stored some other way).
+//	u32			vLen:		The length of the chromosome.
+//	valtype		threshold:	Locations above this are in the set.
+//	(others)				The lengths, as for the corresponding operators.
+//
+// Returns:
+//	(nothing)
+//
+//----------
+
+static void close_runs
+   (char*		vName,
+	valtype*	v,
+	u32			vLen,
+	valtype		threshold,
+	u32			closingLength)
+	{
+	sigrun*		runs;
+	u32			numRuns, ix, outIx;
+
+	runs = threshold_signal_runs (vName, v, vLen, threshold, /*tiesAbove*/ false,
+	                              &numRuns);
+
+	// gaps of closingLength or less, between two runs, are filled;  the gaps
+	// at either end are never filled
+
+	outIx = 0;
+	for (ix=0 ; ix<numRuns ; ix++)
+		{
+		if ((outIx > 0) && (runs[ix].start - runs[outIx-1].end <= closingLength))
+			runs[outIx-1].end = runs[ix].end;
+		else
+			runs[outIx++] = runs[ix];
+		}
+
+	install_signal_runs (vName, runs, outIx);
+	}
+
+
+static void open_runs
+   (char*		vName,
+	valtype*	v,
+	u32			vLen,
+	valtype		threshold,
+	u32			openingLength)
+	{
+	sigrun*		runs;
+	u32			numRuns, ix, outIx;
+
+	runs = threshold_signal_runs (vName, v, vLen, threshold, /*tiesAbove*/ false,
+	                              &numRuns);
+
+	// runs longer than openingLength survive
+
+	outIx = 0;
+	for (ix=0 ; ix<numRuns ; ix++)
+		{
+		if (runs[ix].end - runs[ix].start > openingLength)
+			runs[outIx++] = runs[ix];
+		}
+
+	install_signal_runs (vName, runs, outIx);
+	}
+
+
+static void dilate_runs
+   (char*		vName,
+	valtype*	v,
+	u32			vLen,
+	valtype		threshold,
+	u32			leftDilation,
+	u32			rightDilation)
+	{
+	sigrun*		runs;
+	u32			numRuns, ix, outIx, start, end;
+
+	runs = threshold_signal_runs (vName, v, vLen, threshold, /*tiesAbove*/ false,
+	                              &numRuns);
+
+	// each run is widened, and clipped to the chromosome;  runs that now
+	// overlap or abut are merged
+
+	outIx = 0;
+	for (ix=0 ; ix<numRuns ; ix++)
+		{
+		start = (runs[ix].start <= leftDilation)? 0 : runs[ix].start - leftDilation;
+		end   = ((u64) runs[ix].end + rightDilation >= vLen)? vLen : runs[ix].end + rightDilation;
+		if ((outIx > 0) && (start <= runs[outIx-1].end))
+			{ runs[outIx-1].end = end;  continue; }
+		runs[outIx].start = start;
+		runs[outIx].end   = end;
+		outIx++;
+		}
+
+	install_signal_runs (vName, runs, outIx);
+	}
+
+
+static void erode_runs
+   (char*		vName,
+	valtype*	v,
+	u32			vLen,
+	valtype		threshold,
+	u32			leftErosion,
+	u32			rightErosion)
+	{
+	sigrun*		runs;
+	u32			numRuns, ix, outIx;
+
+	runs = threshold_signal_runs (vName, v, vLen, threshold, /*tiesAbove*/ false,
+	                              &numRuns);
+
+	// each run is narrowed;  runs that narrow to nothing disappear
+
+	outIx = 0;
+	for (ix=0 ; ix<numRuns ; ix++)
+		{
+		if ((u64) runs[ix].start + rightErosion + leftErosion < runs[ix].end)
+			{
+			runs[outIx].start = runs[ix].start + rightErosion;
+			runs[outIx].end   = runs[ix].end   - leftErosion;
+			outIx++;
+			}
+		}
+
+	install_signal_runs (vName, runs, outIx);
+	}
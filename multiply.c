@@ -35,6 +35,7 @@ typedef struct dspop_multiply
 	int			valColumn;
 	int			originOne;
 	int			debug;
+	rangefile*	rf;				// (for op_multiply_range) the file being read
 	} dspop_multiply;
 
 
@@ -94,6 +95,7 @@ dspop* op_multiply_parse (char* name, int _argc, char** _argv)
 	op->valColumn = (int) get_named_global ("valColumn", 4-1);
 	op->originOne = (int) get_named_global ("originOne", false);
 	op->debug     = false;
+	op->rf        = NULL;
 
 	// parse arguments
 
@@ -162,6 +164,11 @@ dspop* op_multiply_parse (char* name, int _argc, char** _argv)
 
 	if (op->filename == NULL) goto filename_missing;
 
+	note_interval_file (op->filename, op->valColumn);
+	op->common.atRandom = !interval_file_by_chromosome (op->filename);
+
+	declare_footprint (footprintPointwise, 0, 0);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -183,6 +190,7 @@ void op_multiply_free (dspop* _op)
 	{
 	dspop_multiply*	op = (dspop_multiply*) _op;
 
+	if (op->rf       != NULL) close_range_file (op->rf);
 	if (op->filename != NULL) free (op->filename);
 	free (op);
 	}
@@ -198,23 +206,26 @@ void op_multiply_apply
 	{
 	dspop_multiply*	op = (dspop_multiply*) _op;
 	char*		filename = op->filename;
-	FILE*		f;
-	char		lineBuffer[1001];
+	intervalfile* f;
 	char		prevChrom[1001];
 	valtype*	v = NULL;
 	char*		chrom;
 	spec*		chromSpec;
+	spec**		chroms;
+	spec*		oneChrom[2];
 	u32			start, end, o, prevEnd, adjStart, adjEnd;
 	valtype		val;
 	u32			ix, chromIx;
 	int			ok;
 
-	f = fopen (filename, "rt");
+	chroms = chromosomes_to_apply (vName, oneChrom);
+
+	f = open_interval_file (filename, op->valColumn, op->originOne, vName);
 	if (f == NULL) goto cant_open_file;
 
-	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+	for (chromIx=0 ; chroms[chromIx]!=NULL ; chromIx++)
 		{
-		chromSpec = chromsSorted[chromIx];
+		chromSpec = chroms[chromIx];
 		chromSpec->flag = false;
 		}
 
@@ -230,8 +241,7 @@ void op_multiply_apply
 	v = NULL;
 	while (true)
 		{
-		ok = read_interval (f, lineBuffer, sizeof(lineBuffer), op->valColumn,
-	                        &chrom, &start, &end, &val);
+		ok = next_interval (f, &chrom, &start, &end, &val);
 		if (!ok) break;
 		if (val == 0.0) continue; // treat zero as a missing interval
 
@@ -273,7 +283,8 @@ void op_multiply_apply
 
 		if (!chromSpec->flag)
 			{
-			if (trackOperations) fprintf (stderr, "%s(%s)\n", op->common.name, chrom);
+			if ((trackOperations) && (chroms == chromsSorted))
+				fprintf (stderr, "%s(%s)\n", op->common.name, chrom);
 			chromSpec->flag = true;
 			}
 
@@ -341,9 +352,9 @@ void op_multiply_apply
 
 	// clear any chromosomes that weren't observed in the incoming set
 
-	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+	for (chromIx=0 ; chroms[chromIx]!=NULL ; chromIx++)
 		{
-		chromSpec = chromsSorted[chromIx];
+		chromSpec = chroms[chromIx];
 		if (chromSpec->flag) continue;
 
 		chrom = chromSpec->chrom;
@@ -364,7 +375,7 @@ void op_multiply_apply
 
 	// success
 
-	fclose (f);
+	close_interval_file (f, /*destroy*/ false);
 	return;
 
 	//////////
@@ -392,6 +403,74 @@ intervals_out_of_order:
 	exit (EXIT_FAILURE);
 	}
 
+
+// op_multiply_range--
+
+void op_multiply_range
+   (arg_dont_complain(dspop*	_op),
+	arg_dont_complain(char*		vName),
+	arg_dont_complain(u32		vLen),
+	arg_dont_complain(valtype*	v),
+	arg_dont_complain(u32		start),
+	arg_dont_complain(u32		end))
+	{
+	dspop_multiply*	op = (dspop_multiply*) _op;
+	u32				pieceStart, pieceEnd, prevEnd;
+	valtype			val;
+	u32				ix;
+
+	if (start == 0)
+		{
+		if (op->rf != NULL) close_range_file (op->rf);
+		op->rf = open_range_file (_op->name, op->filename, op->valColumn, op->originOne,
+		                          vName, /*skipZeros*/ true, /*disjoint*/ true);
+		if (op->rf == NULL) goto cant_open_file;
+		}
+
+	// read this subrange's intervals and values and multiply by them, and
+	// zero the gaps between them
+
+	prevEnd = start;
+
+	while (next_range_interval (op->rf, start, end, &pieceStart, &pieceEnd, &val))
+		{
+		if ((op->debug) && (prevEnd < pieceStart))
+			fprintf (stderr, "zeroing %s %u..%u\n", vName, prevEnd, pieceStart-1);
+
+		for (ix=prevEnd ; ix<pieceStart ; ix++)
+			v[ix] = 0.0;
+
+		if (op->debug)
+			fprintf (stderr, "multiplying by " valtypeFmt " over %s %u..%u\n",
+			                 val, vName, pieceStart, pieceEnd-1);
+
+		for (ix=pieceStart ; ix<pieceEnd ; ix++)
+			v[ix] *= val;
+
+		prevEnd = pieceEnd;
+		}
+
+	if ((op->debug) && (prevEnd < end))
+		fprintf (stderr, "zeroing %s %u..%u\n", vName, prevEnd, end-1);
+
+	for (ix=prevEnd ; ix<end ; ix++)
+		v[ix] = 0.0;
+
+	if (end == vLen)
+		{ close_range_file (op->rf);  op->rf = NULL; }
+
+	return;
+
+	//////////
+	// failure exits
+	//////////
+
+cant_open_file:
+	fprintf (stderr, "[%s] can't open \"%s\" for reading\n",
+	                 _op->name, op->filename);
+	exit (EXIT_FAILURE);
+	}
+
 //----------
 // [[-- a dsp operation function group, operating on the whole genome --]]
 //
@@ -415,6 +494,7 @@ typedef struct dspop_divide
 	int			originOne;
 	valtype		infinityVal;
 	int			debug;
+	rangefile*	rf;				// (for op_divide_range) the file being read
 	} dspop_divide;
 
 
@@ -478,6 +558,7 @@ dspop* op_divide_parse (char* name, int _argc, char** _argv)
 	op->originOne   = (int) get_named_global ("originOne", false);
 	op->infinityVal = valtypeMax;
 	op->debug       = false;
+	op->rf          = NULL;
 
 	// parse arguments
 
@@ -555,6 +636,11 @@ dspop* op_divide_parse (char* name, int _argc, char** _argv)
 
 	if (op->filename == NULL) goto filename_missing;
 
+	note_interval_file (op->filename, op->valColumn);
+	op->common.atRandom = !interval_file_by_chromosome (op->filename);
+
+	declare_footprint (footprintPointwise, 0, 0);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -576,6 +662,7 @@ void op_divide_free (dspop* _op)
 	{
 	dspop_divide*	op = (dspop_divide*) _op;
 
+	if (op->rf       != NULL) close_range_file (op->rf);
 	if (op->filename != NULL) free (op->filename);
 	free (op);
 	}
@@ -592,23 +679,26 @@ void op_divide_apply
 	dspop_divide*	op = (dspop_divide*) _op;
 	char*			filename    = op->filename;
 	valtype			infinityVal = op->infinityVal;
-	FILE*			f;
-	char			lineBuffer[1001];
+	intervalfile*	f;
 	char			prevChrom[1001];
 	valtype*		v = NULL;
 	char*			chrom;
 	spec*			chromSpec;
+	spec**			chroms;
+	spec*			oneChrom[2];
 	u32				start, end, o, prevEnd, adjStart, adjEnd;
 	valtype			val;
 	u32				ix, chromIx;
 	int				ok;
 
-	f = fopen (filename, "rt");
+	chroms = chromosomes_to_apply (vName, oneChrom);
+
+	f = open_interval_file (filename, op->valColumn, op->originOne, vName);
 	if (f == NULL) goto cant_open_file;
 
-	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+	for (chromIx=0 ; chroms[chromIx]!=NULL ; chromIx++)
 		{
-		chromSpec = chromsSorted[chromIx];
+		chromSpec = chroms[chromIx];
 		chromSpec->flag = false;
 		}
 
@@ -624,8 +714,7 @@ void op_divide_apply
 	v = NULL;
 	while (true)
 		{
-		ok = read_interval (f, lineBuffer, sizeof(lineBuffer), op->valColumn,
-	                        &chrom, &start, &end, &val);
+		ok = next_interval (f, &chrom, &start, &end, &val);
 		if (!ok) break;
 		if (val == 0.0) continue; // treat zero as a missing interval
 
@@ -667,7 +756,8 @@ void op_divide_apply
 
 		if (!chromSpec->flag)
 			{
-			if (trackOperations) fprintf (stderr, "%s(%s)\n", op->common.name, chrom);
+			if ((trackOperations) && (chroms == chromsSorted))
+				fprintf (stderr, "%s(%s)\n", op->common.name, chrom);
 			chromSpec->flag = true;
 			}
 
@@ -735,9 +825,9 @@ void op_divide_apply
 
 	// infinitize any chromosomes that weren't observed in the incoming set
 
-	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+	for (chromIx=0 ; chroms[chromIx]!=NULL ; chromIx++)
 		{
-		chromSpec = chromsSorted[chromIx];
+		chromSpec = chroms[chromIx];
 		if (chromSpec->flag) continue;
 
 		chrom = chromSpec->chrom;
@@ -758,7 +848,7 @@ void op_divide_apply
 
 	// success
 
-	fclose (f);
+	close_interval_file (f, /*destroy*/ false);
 	return;
 
 	//////////
@@ -786,3 +876,72 @@ intervals_out_of_order:
 	exit (EXIT_FAILURE);
 	}
 
+
+// op_divide_range--
+
+void op_divide_range
+   (arg_dont_complain(dspop*	_op),
+	arg_dont_complain(char*		vName),
+	arg_dont_complain(u32		vLen),
+	arg_dont_complain(valtype*	v),
+	arg_dont_complain(u32		start),
+	arg_dont_complain(u32		end))
+	{
+	dspop_divide*	op = (dspop_divide*) _op;
+	valtype			infinityVal = op->infinityVal;
+	u32				pieceStart, pieceEnd, prevEnd;
+	valtype			val;
+	u32				ix;
+
+	if (start == 0)
+		{
+		if (op->rf != NULL) close_range_file (op->rf);
+		op->rf = open_range_file (_op->name, op->filename, op->valColumn, op->originOne,
+		                          vName, /*skipZeros*/ true, /*disjoint*/ true);
+		if (op->rf == NULL) goto cant_open_file;
+		}
+
+	// read this subrange's intervals and values and divide by them, and
+	// infinitize the gaps between them
+
+	prevEnd = start;
+
+	while (next_range_interval (op->rf, start, end, &pieceStart, &pieceEnd, &val))
+		{
+		if ((op->debug) && (prevEnd < pieceStart))
+			fprintf (stderr, "infinitizing %s %u..%u\n", vName, prevEnd, pieceStart-1);
+
+		for (ix=prevEnd ; ix<pieceStart ; ix++)
+			v[ix] = (v[ix]>=0)? infinityVal : -infinityVal;
+
+		if (op->debug)
+			fprintf (stderr, "dividing by " valtypeFmt " over %s %u..%u\n",
+			                 val, vName, pieceStart, pieceEnd-1);
+
+		for (ix=pieceStart ; ix<pieceEnd ; ix++)
+			v[ix] /= val;  // nota bene: val is never zero
+
+		prevEnd = pieceEnd;
+		}
+
+	if ((op->debug) && (prevEnd < end))
+		fprintf (stderr, "infinitizing %s %u..%u\n", vName, prevEnd, end-1);
+
+	for (ix=prevEnd ; ix<end ; ix++)
+		v[ix] = (v[ix]>=0)? infinityVal : -infinityVal;
+
+	if (end == vLen)
+		{ close_range_file (op->rf);  op->rf = NULL; }
+
+	return;
+
+	//////////
+	// failure exits
+	//////////
+
+cant_open_file:
+	fprintf (stderr, "[%s] can't open \"%s\" for reading\n",
+	                 _op->name, op->filename);
+	exit (EXIT_FAILURE);
+	}
+
@@ -6,4 +6,7 @@
 dspprototypes(op_multiply)
 dspprototypes(op_divide)
 
+dsprangeprototype(op_multiply)
+dsprangeprototype(op_divide)
+
 #endif // multiply_H
@@ -194,6 +194,11 @@ dspop* op_input_parse (char* name, int _argc, char** _argv)
 
 	if (op->filename == NULL) goto filename_missing;
 
+	declare_signal_use   (useWrite);
+	declare_resource_use (resourceData, op->filename, useRead);
+	if (op->destroyFile)
+		declare_resource_use (resourceData, op->filename, useWrite);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -334,6 +339,10 @@ dspop* op_output_parse (char* name, int _argc, char** _argv)
 
 	op->common.atRandom = true;
 
+	// report_intervals can write the signal however it is stored
+
+	accept_signal_storage (storeBits|storeCounts|storeRuns);
+
 	op->filename       = NULL;
 	op->noOutputValues = (int) get_named_global ("noOutputValues", false);
 	op->valPrecision   = (int) get_named_global ("valPrecision",   0);
@@ -423,6 +432,9 @@ dspop* op_output_parse (char* name, int _argc, char** _argv)
 
 	if (op->filename == NULL) goto filename_missing;
 
+	declare_signal_use   (useRead);
+	declare_resource_use (resourceData, op->filename, useWrite);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -481,3 +493,301 @@ cant_open_file:
 	exit (EXIT_FAILURE);
 	}
 
+//----------
+// [[-- a dsp operation function group, operating on a single chromosome --]]
+//
+// See genodsp_interface.h, "headers for dsp operator function groups" for
+// function descriptions and argument details.
+//
+//----------
+//
+// op_store--
+//	Copy the signal into a named in-memory register.
+//
+//----------
+
+// private dspop subtype
+
+typedef struct dspop_store
+	{
+	dspop		common;			// common elements shared with all operators
+	char*		regName;
+	} dspop_store;
+
+
+// op_store_short--
+
+void op_store_short (char* name, int nameWidth, FILE* f, char* indent)
+	{
+	int nameFill = nameWidth-2 - strlen(name);
+	if (indent == NULL) indent = "";
+
+	if (nameFill > 0) fprintf (f, "%s%s:%*s", indent, name, nameFill+1, " ");
+	             else fprintf (f, "%s%s: ", indent, name);
+
+	fprintf (f, "copy the current signal into a named in-memory register\n");
+	}
+
+
+// op_store_usage--
+
+void op_store_usage (char* name, FILE* f, char* indent)
+	{
+	if (indent == NULL) indent = "";
+	//             3456789-123456789-123456789-123456789-123456789-123456789-123456789-123456789
+	fprintf (f, "%sCopy the current signal into a named in-memory register.  The signal can\n", indent);
+	fprintf (f, "%slater be restored with recall, and later operators that read a secondary\n",  indent);
+	fprintf (f, "%sinterval file (e.g. add, multiply, mask or minwith) accept the register's\n", indent);
+	fprintf (f, "%sname in place of a filename.  This is equivalent to output followed by\n",     indent);
+	fprintf (f, "%sinput (or reading the file) but avoids formatting and parsing the signal,\n",  indent);
+	fprintf (f, "%sand values aren't rounded.\n",                                                 indent);
+	fprintf (f, "%s\n", indent);
+	fprintf (f, "%sOnce a register is stored, its name refers to the register rather than to\n", indent);
+	fprintf (f, "%sany file with the same name, for the rest of the pipeline.\n",                 indent);
+	fprintf (f, "%s\n", indent);
+	fprintf (f, "%susage: %s <register>\n", indent, name);
+	}
+
+
+// op_store_parse--
+
+dspop* op_store_parse (char* name, int _argc, char** _argv)
+	{
+	dspop_store*	op;
+	int				argc = _argc;
+	char**			argv = _argv;
+	char*			arg;
+
+	// allocate and initialize our control record
+
+	op = (dspop_store*) malloc (sizeof(dspop_store));
+	if (op == NULL) goto cant_allocate;
+
+	op->common.atRandom = false;
+
+	op->regName = NULL;
+
+	// parse arguments
+
+	while (argc > 0)
+		{
+		arg = argv[0];
+
+		// unknown -- argument
+
+		if (strcmp_prefix (arg, "--") == 0)
+			chastise ("[%s] Can't understand \"%s\"\n", name, arg);
+
+		// <register>
+
+		if (op->regName == NULL)
+			{
+			op->regName = copy_string (arg);
+			goto next_arg;
+			}
+
+		// unknown argument
+
+		chastise ("[%s] Can't understand \"%s\"\n", name, arg);
+
+	next_arg:
+		argv++;  argc--;
+		continue;
+		}
+
+	if (op->regName == NULL) goto name_missing;
+
+	declare_signal_register  (op->regName);
+	note_signal_register_use (op->regName);
+
+	declare_signal_use   (useRead);
+	declare_resource_use (resourceData, op->regName, useWrite);
+
+	return (dspop*) op;
+
+cant_allocate:
+	fprintf (stderr, "[%s] failed to allocate control record (%d bytes)\n",
+	                 name, (int) sizeof(dspop_store));
+	exit(EXIT_FAILURE);
+
+name_missing:
+	fprintf (stderr, "[%s] no register name was provided\n",
+	                 name);
+	exit(EXIT_FAILURE);
+	return NULL; // (never reaches here)
+	}
+
+
+// op_store_free--
+
+void op_store_free (dspop* _op)
+	{
+	dspop_store*	op = (dspop_store*) _op;
+
+	if (op->regName != NULL) free (op->regName);
+	free (op);
+	}
+
+
+// op_store_apply--
+
+void op_store_apply
+   (arg_dont_complain(dspop*	_op),
+	arg_dont_complain(char*		vName),
+	arg_dont_complain(u32		vLen),
+	arg_dont_complain(valtype*	v))
+	{
+	dspop_store*	op = (dspop_store*) _op;
+
+	store_signal_register (op->regName, vName);
+	}
+
+//----------
+// [[-- a dsp operation function group, operating on a single chromosome --]]
+//
+// See genodsp_interface.h, "headers for dsp operator function groups" for
+// function descriptions and argument details.
+//
+//----------
+//
+// op_recall--
+//	Replace the signal with a copy from a named in-memory register.
+//
+//----------
+
+// private dspop subtype
+
+typedef struct dspop_recall
+	{
+	dspop		common;			// common elements shared with all operators
+	char*		regName;
+	u32			useIx;			// our reference to the register (see
+								// .. note_signal_register_use)
+	} dspop_recall;
+
+
+// op_recall_short--
+
+void op_recall_short (char* name, int nameWidth, FILE* f, char* indent)
+	{
+	int nameFill = nameWidth-2 - strlen(name);
+	if (indent == NULL) indent = "";
+
+	if (nameFill > 0) fprintf (f, "%s%s:%*s", indent, name, nameFill+1, " ");
+	             else fprintf (f, "%s%s: ", indent, name);
+
+	fprintf (f, "replace the current signal with a copy from a register\n");
+	}
+
+
+// op_recall_usage--
+
+void op_recall_usage (char* name, FILE* f, char* indent)
+	{
+	if (indent == NULL) indent = "";
+	//             3456789-123456789-123456789-123456789-123456789-123456789-123456789-123456789
+	fprintf (f, "%sReplace the current signal with a copy from a named in-memory register,\n",  indent);
+	fprintf (f, "%sas saved by an earlier store operator.  If nothing later in the pipeline\n",  indent);
+	fprintf (f, "%srefers to the register, its memory is handed back to the signal instead\n",   indent);
+	fprintf (f, "%sof being copied.\n",                                                          indent);
+	fprintf (f, "%s\n", indent);
+	fprintf (f, "%susage: %s <register>\n", indent, name);
+	}
+
+
+// op_recall_parse--
+
+dspop* op_recall_parse (char* name, int _argc, char** _argv)
+	{
+	dspop_recall*	op;
+	int				argc = _argc;
+	char**			argv = _argv;
+	char*			arg;
+
+	// allocate and initialize our control record
+
+	op = (dspop_recall*) malloc (sizeof(dspop_recall));
+	if (op == NULL) goto cant_allocate;
+
+	op->common.atRandom = false;
+
+	op->regName = NULL;
+
+	// parse arguments
+
+	while (argc > 0)
+		{
+		arg = argv[0];
+
+		// unknown -- argument
+
+		if (strcmp_prefix (arg, "--") == 0)
+			chastise ("[%s] Can't understand \"%s\"\n", name, arg);
+
+		// <register>
+
+		if (op->regName == NULL)
+			{
+			op->regName = copy_string (arg);
+			goto next_arg;
+			}
+
+		// unknown argument
+
+		chastise ("[%s] Can't understand \"%s\"\n", name, arg);
+
+	next_arg:
+		argv++;  argc--;
+		continue;
+		}
+
+	if (op->regName == NULL) goto name_missing;
+
+	if (!is_signal_register (op->regName))
+		chastise ("[%s] no earlier operator stores to register \"%s\"\n",
+		          name, op->regName);
+
+	op->useIx = note_signal_register_use (op->regName);
+
+	declare_signal_use   (useWrite);
+	declare_resource_use (resourceData, op->regName, useRead);
+
+	return (dspop*) op;
+
+cant_allocate:
+	fprintf (stderr, "[%s] failed to allocate control record (%d bytes)\n",
+	                 name, (int) sizeof(dspop_recall));
+	exit(EXIT_FAILURE);
+
+name_missing:
+	fprintf (stderr, "[%s] no register name was provided\n",
+	                 name);
+	exit(EXIT_FAILURE);
+	return NULL; // (never reaches here)
+	}
+
+
+// op_recall_free--
+
+void op_recall_free (dspop* _op)
+	{
+	dspop_recall*	op = (dspop_recall*) _op;
+
+	if (op->regName != NULL) free (op->regName);
+	free (op);
+	}
+
+
+// op_recall_apply--
+
+void op_recall_apply
+   (arg_dont_complain(dspop*	_op),
+	arg_dont_complain(char*		vName),
+	arg_dont_complain(u32		vLen),
+	arg_dont_complain(valtype*	v))
+	{
+	dspop_recall*	op = (dspop_recall*) _op;
+
+	recall_signal_register (op->regName, vName, op->useIx);
+	}
+
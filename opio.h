@@ -5,5 +5,7 @@
 
 dspprototypes(op_input)
 dspprototypes(op_output)
+dspprototypes(op_store)
+dspprototypes(op_recall)
 
 #endif // opio_H
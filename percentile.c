@@ -8,6 +8,7 @@
 #include <stdarg.h>
 #include <math.h>
 #include <float.h>
+#include <pthread.h>
 #include "utilities.h"
 #include "genodsp_interface.h"
 #include "percentile.h"
@@ -15,12 +16,37 @@
 #define percentileStepUnits 1000		// resolution for percentiles is in
 										// .. thousandths of a percent
 
+#define selectSmallCount 32			// when a selection narrows to this many
+										// .. values (or fewer), we just sort them
+
+#define radixSelectBits   16			// number of key bits examined in each
+#define radixSelectLimit  (1<<16)		// .. radix-select pass, and the bucket
+										// .. size small enough to gather
+
 static void set_percentile_name    (char* varName, u32 percentile);
-static void combine_sorted_vectors (valtype* v, u32 vLen, valtype* w, u32 wLen);
-//static void sort_two_increasing_blocks (valtype* v, u32 vSplit, u32 vLen);
+static void find_percentiles       (dspop* _op, FILE* mapF,
+                                    valtype** segV, u32* segLo, u32* segHi,
+                                    u32 numSegs, u32 numValues, int runsSorted);
+static void report_percentile      (dspop* _op, FILE* mapF, u32 percentile,
+                                    u32 pIx, valtype pVal);
+static void select_ranks           (valtype** segV, u32* segLo, u32* segHi,
+                                    u32 numSegs, u32 baseRank,
+                                    u32* ranks, valtype* rankVals, u32 numRanks);
+static void sort_segments          (valtype** segV, u32* segLo, u32* segHi,
+                                    u32 numSegs);
+static void radix_sort_values      (valtype* v, u32 vLen, valtype* scratch);
+static u32  radix_select_percentiles (dspop* _op);
+static void radix_select_pass      (dspop* _op, int gather, u64 prefix,
+                                    int prefixBits, u32* counts,
+                                    valtype* gatherV);
+static void percentiles_in_chromosome (dspop* _op, char* vName, u32 vLen,
+                                    valtype* v);
+static u32  percentile_rank        (u32 numValues, u32 percentile);
+static u64  valtype_key            (valtype val);
 
 //----------
-// [[-- a dsp operation function group, operating on the whole genome --]]
+// [[-- a dsp operation function group, operating on the whole genome (or on
+//      each chromosome, with --per-chromosome) --]]
 //
 // See genodsp_interface.h, "headers for dsp operator function groups" for
 // function descriptions and argument details.
@@ -31,8 +57,9 @@ static void combine_sorted_vectors (valtype* v, u32 vLen, valtype* w, u32 wLen);
 //	Determine specified percentiles in the data and report them;  if min and/or
 //	max values are specified, only values within this range are considered.
 //
-//	Note that the genome vectors *are* altered;  the only guarantee made about
-//	the state the vectors are left in is that the set of values is preserved.
+//	Note that the genome vectors *are* altered (unless --nondestructive,
+//	--radix or --per-chromosome is used);  the only guarantee made about the
+//	state the vectors are left in is that the set of values is preserved.
 //
 //----------
 
@@ -48,6 +75,15 @@ typedef struct dspop_percentile
 	u32			percentileHi;	// .. percent)
 	u32			percentileStep;
 	u32			windowSize;
+	int			keepData;		// true => gather values into a separate buffer
+								//         .. instead of reordering the vectors
+	int			radixSelect;	// true => locate percentiles by histograms of
+								//         .. the values' bits, without moving
+								//         .. any data
+	int			perChromosome;	// true => compute percentiles separately for
+								//         .. each chromosome
+	char*		chromName;		// the chromosome whose percentiles are being
+								// .. reported (NULL for the whole genome)
 	valtype		minAllowed;
 	valtype		maxAllowed;
 	int			valPrecision;
@@ -80,7 +116,8 @@ void op_percentile_usage (char* name, FILE* f, char* indent)
 	if (indent == NULL) indent = "";
 	//             3456789-123456789-123456789-123456789-123456789-123456789-123456789-123456789
 	fprintf (f, "%sIdentify percentiles in the current data. This is a destructive operation;\n",    indent);
-	fprintf (f, "%safterwards the data is in an undependable state unless --preserve is used.\n",    indent);
+	fprintf (f, "%safterwards the data is in an undependable state unless --preserve or\n",          indent);
+	fprintf (f, "%s--nondestructive is used.\n",                                                     indent);
 	fprintf (f, "%s(but see the special case noted below)\n",                                        indent);
 	fprintf (f, "%s\n", indent);
 	fprintf (f, "%susage: %s <low>[..<high>] [options]\n", indent, name);
@@ -102,6 +139,17 @@ void op_percentile_usage (char* name, FILE* f, char* indent)
 	fprintf (f, "%s                           recreate the data instead, since preservation adds\n", indent);
 	fprintf (f, "%s                           a write/read to/from a file\n",                        indent);
 	fprintf (f, "%s                           (by default, data is left in an erratic state)\n",     indent);
+	fprintf (f, "%s  --nondestructive         leave the current data intact, by copying the\n",      indent);
+	fprintf (f, "%s                           qualifying values to a separate buffer;  this needs\n", indent);
+	fprintf (f, "%s                           memory for the qualifying values but avoids the\n",    indent);
+	fprintf (f, "%s                           file round trip of --preserve\n",                      indent);
+	fprintf (f, "%s  --radix                  locate percentiles by repeated passes over the data,\n", indent);
+	fprintf (f, "%s                           counting the high bits of each value;  this leaves\n", indent);
+	fprintf (f, "%s                           the data intact and needs no extra memory for the\n",  indent);
+	fprintf (f, "%s                           values;  best suited to a few percentiles\n",          indent);
+	fprintf (f, "%s  --per-chromosome         compute percentiles separately for each chromosome;\n", indent);
+	fprintf (f, "%s                           this leaves the data intact, and the named variables\n", indent);
+	fprintf (f, "%s                           take on each chromosome's values as it is processed\n", indent);
 	fprintf (f, "%s  --map=<filename>         write percentile values to a file, suitable for\n",    indent);
 	fprintf (f, "%s                           use as a mapping file\n",                              indent);
 	fprintf (f, "%s  --quiet                  don't report percentile values to the console\n",      indent);
@@ -121,8 +169,12 @@ void op_percentile_usage (char* name, FILE* f, char* indent)
 	fprintf (f, "%srecreating the input signal can give unexpectedly different results.  This is\n", indent);
 	fprintf (f, "%sbecause the operation reorders the signal (bringing the selected values to\n",    indent);
 	//             3456789-123456789-123456789-123456789-123456789-123456789-123456789-123456789
-	fprintf (f, "%sthe front), then sorts them, and a subsequent call 'sees' a different sample\n",  indent);
-	fprintf (f, "%sof the signal (with potential for bias).\n",                                      indent);
+	fprintf (f, "%sthe front), then reorders them, and a subsequent call 'sees' a different\n",      indent);
+	fprintf (f, "%ssample of the signal (with potential for bias).\n",                               indent);
+	fprintf (f, "%s\n", indent);
+	fprintf (f, "%sPercentiles are located by selection (partitioning around pivot values),\n",      indent);
+	fprintf (f, "%swhich is much faster than sorting when only a few percentiles are wanted.\n",     indent);
+	fprintf (f, "%sWhen --map is used the qualifying values are fully sorted instead.\n",            indent);
 	}
 
 
@@ -137,6 +189,8 @@ dspop* op_percentile_parse (char* name, int _argc, char** _argv)
 	int					tempInt;
 	valtype				tempVal, tempLo, tempHi;
 	int					haveRange;
+	u32					percentile;
+	char				varName[100];
 
 	// allocate and initialize our control record
 
@@ -151,6 +205,10 @@ dspop* op_percentile_parse (char* name, int _argc, char** _argv)
 	op->percentileHi    = 0.0; // (inital value is never used)
 	op->percentileStep  = percentileStepUnits;
 	op->windowSize      = (u32) get_named_global ("windowSize", 1);
+	op->keepData        = false;
+	op->radixSelect     = false;
+	op->perChromosome   = false;
+	op->chromName       = NULL;
 	op->minAllowed      = -valtypeMax;
 	op->maxAllowed      =  valtypeMax;
 	op->valPrecision    = (int) get_named_global ("valPrecision",  0);
@@ -231,6 +289,26 @@ dspop* op_percentile_parse (char* name, int _argc, char** _argv)
 			goto next_arg;
 			}
 
+		// --nondestructive
+
+		if ((strcmp (arg, "--nondestructive")  == 0)
+		 || (strcmp (arg, "--non-destructive") == 0)
+		 || (strcmp (arg, "--keep")            == 0))
+			{ op->keepData = true;  goto next_arg; }
+
+		// --radix
+
+		if ((strcmp (arg, "--radix")     == 0)
+		 || (strcmp (arg, "--histogram") == 0))
+			{ op->radixSelect = true;  goto next_arg; }
+
+		// --per-chromosome
+
+		if ((strcmp (arg, "--per-chromosome") == 0)
+		 || (strcmp (arg, "--perchromosome")  == 0)
+		 || (strcmp (arg, "--per-chrom")      == 0))
+			{ op->perChromosome = true;  goto next_arg; }
+
 		// --map=<filename>
 
 		if ((strcmp_prefix (arg, "--map=")     == 0)
@@ -360,6 +438,49 @@ dspop* op_percentile_parse (char* name, int _argc, char** _argv)
 	if ((op->reportForBash) && (op->quiet))
 		chastise ("[%s] Can't use both --report:bash and --quiet\n", name);
 
+	if ((op->keepData) && (op->preseveFilename != NULL))
+		chastise ("[%s] Can't use both --nondestructive and --preserve\n", name);
+
+	if ((op->radixSelect) && (op->preseveFilename != NULL))
+		chastise ("[%s] Can't use both --radix and --preserve\n", name);
+
+	if ((op->radixSelect) && (op->mapFilename != NULL))
+		chastise ("[%s] Can't use both --radix and --map\n", name);
+
+	if (op->perChromosome)
+		{
+		if (op->mapFilename != NULL)
+			chastise ("[%s] Can't use both --per-chromosome and --map\n", name);
+		if (op->preseveFilename != NULL)
+			chastise ("[%s] Can't use both --per-chromosome and --preserve\n", name);
+		if (op->radixSelect)
+			chastise ("[%s] Can't use both --per-chromosome and --radix\n", name);
+
+		// each chromosome's percentiles depend only on that chromosome, so we
+		// needn't wait for the whole genome
+
+		op->common.atRandom = false;
+		}
+
+	declare_footprint (footprintReduction, 0, 0);
+
+	// tell the planner what we use;  unless the values are gathered elsewhere,
+	// the signal is scrambled
+
+	if ((op->keepData) || (op->radixSelect) || (op->perChromosome))
+		declare_signal_use (useRead);
+
+	for (percentile=op->percentileLo ; percentile<=op->percentileHi ; percentile+=op->percentileStep)
+		{
+		set_percentile_name  (varName, percentile);
+		declare_resource_use (resourceVariable, varName, useWrite);
+		}
+
+	if (op->preseveFilename != NULL)
+		declare_resource_use (resourceData, op->preseveFilename, useWrite);
+	if (op->mapFilename != NULL)
+		declare_resource_use (resourceData, op->mapFilename, useWrite);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -404,16 +525,17 @@ void op_percentile_apply
 	valtype		minAllowed     = op->minAllowed;
 	valtype		maxAllowed     = op->maxAllowed;
 	u32			windowSize     = op->windowSize;
-	int			valPrecision   = op->valPrecision;
 	spec*		chromSpec, *dstChromSpec;
 	valtype*	v, *dstV;
 	u32			numValues, numValuesInLastChrom;
-	u32			percentileNext, percentileIx, numValuesPassed;
 	valtype		val;
 	u32			ix, chromIx, dstChromIx, lastChromIx, dstIx, dstVLen;
-	float		pPct;
-	u32			pIx;
-	valtype		pVal, minVal, maxVal;
+	u32			numSegs, chunkLen;
+	valtype*	keepV = NULL;
+	valtype**	segV  = NULL;
+	u32*		segLo = NULL;
+	u32*		segHi = NULL;
+	valtype		minVal, maxVal;
 
 	if (op->debug)
 		{
@@ -429,6 +551,15 @@ void op_percentile_apply
 		fprintf (stderr, ")\n");
 		}
 
+	// handle per-chromosome percentiles;  in this case we are given one
+	// chromosome at a time
+
+	if (op->perChromosome)
+		{
+		percentiles_in_chromosome (_op, vName, vLen, _v);
+		return;
+		}
+
 	// handle special case of percentile 0
 
 	if ((op->percentileLo == 0)
@@ -529,6 +660,16 @@ void op_percentile_apply
 		return;
 		}
 
+	// if we're to use radix selection, the data is left in place;  we just
+	// make passes over it
+
+	if (op->radixSelect)
+		{
+		numValues = radix_select_percentiles (_op);
+		if (numValues == 0) goto no_values;
+		return;
+		}
+
 	// preserve the input data
 
 	if (op->preseveFilename != NULL)
@@ -540,6 +681,94 @@ void op_percentile_apply
 	if (op->mapFilename != NULL)
 		mapF = fopen (op->mapFilename, "wt");
 
+	// if we're to leave the data intact, copy the qualifying values into a
+	// separate compact buffer (rather than moving them within the genome), and
+	// locate the percentiles in that buffer
+
+	if (op->keepData)
+		{
+		numValues = 0;
+		for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+			{
+			chromSpec = chromsSorted[chromIx];
+			v = chromSpec->valVector;
+
+			for (ix=0 ; ix<chromSpec->length ; ix+=windowSize)
+				{
+				if (v[ix] < minAllowed) continue;
+				if (v[ix] > maxAllowed) continue;
+				numValues++;
+				}
+			}
+
+		if (numValues == 0) goto no_values;
+
+		keepV = (valtype*) malloc (numValues * sizeof(valtype));
+		if (keepV == NULL) goto cant_allocate_keep;
+
+		dstIx = 0;
+		for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++)
+			{
+			chromSpec = chromsSorted[chromIx];
+			v = chromSpec->valVector;
+
+			for (ix=0 ; ix<chromSpec->length ; ix+=windowSize)
+				{
+				if (v[ix] < minAllowed) continue;
+				if (v[ix] > maxAllowed) continue;
+				keepV[dstIx++] = v[ix];
+				}
+			}
+
+		if (op->debug)
+			fprintf (stderr, "  numValues=%u (in separate buffer)\n", numValues);
+
+		// a mapping file needs every value in order;  we split the buffer into
+		// chunks no longer than a chromosome (so that scratch vectors suffice)
+		// and sort the chunks, which find_percentiles will then merge;
+		// otherwise selection suffices, treating the buffer as one segment
+
+		chunkLen = chromsSorted[0]->length;
+		if ((mapF != NULL) && (numThreads > 1)
+		 && ((numValues + numThreads-1) / numThreads < chunkLen))
+			chunkLen = (numValues + numThreads-1) / numThreads;
+
+		numSegs = 1;
+		if (mapF != NULL)
+			numSegs = (numValues + chunkLen-1) / chunkLen;
+
+		segV  = (valtype**) malloc (numSegs * sizeof(valtype*));
+		segLo = (u32*)      malloc (numSegs * sizeof(u32));
+		segHi = (u32*)      malloc (numSegs * sizeof(u32));
+		if ((segV == NULL) || (segLo == NULL) || (segHi == NULL))
+			goto cant_allocate;
+
+		if (mapF == NULL)
+			{
+			segV[0] = keepV;  segLo[0] = 0;  segHi[0] = numValues;
+			find_percentiles (_op, mapF, segV, segLo, segHi, numSegs,
+			                  numValues, /*runs sorted*/ false);
+			}
+		else
+			{
+			for (ix=0 ; ix<numSegs ; ix++)
+				{
+				segV [ix] = keepV;
+				segLo[ix] = ix * chunkLen;
+				segHi[ix] = (ix+1 < numSegs)? (ix+1) * chunkLen : numValues;
+				}
+			sort_segments (segV, segLo, segHi, numSegs);
+			find_percentiles (_op, mapF, segV, segLo, segHi, numSegs,
+			                  numValues, /*runs sorted*/ true);
+			}
+
+		free (segV);
+		free (segLo);
+		free (segHi);
+		free (keepV);
+		goto done;
+		}
+
 	// take an initial pass thru the genome (looking only at the first value in
 	// each window) and move all qualifying values to the "front";  we preserve
 	// the overall content of the genome, effectively only shuffling the values
@@ -584,131 +813,58 @@ void op_percentile_apply
 
 	if (numValues == 0) goto no_values;
 
-	percentileNext  = percentileLo;
-	percentileIx    = (u32) (((u64) numValues) * percentileNext / (100.0*percentileStepUnits));
-	numValuesPassed = 0;
-
 	if (op->debug)
-		fprintf (stderr, "  numValues=%u (%u in %s), percentileIx=%u\n",
+		fprintf (stderr, "  numValues=%u (%u in %s)\n",
 		                 numValues,
-		                 numValuesInLastChrom, chromsSorted[lastChromIx]->chrom,
-		                 percentileIx);
+		                 numValuesInLastChrom, chromsSorted[lastChromIx]->chrom);
 
 	if (op->debugStage == 1)
 		return;
 
-	// sort the qualifying values, from low to high (only those at the front,
-	// where the qualifying values are);  first we make a pass through the
-	// vectors, sorting each individually;  then we make an outer pass through
-	// the vectors, filling that vector with the lowest values;  the fill is
-	// accomplished by an inner pass along the vectors, trading low values in
-	// from the inner vector with high values in the outer vector;  at each of
-	// these inner steps, the values within each vector reamin sorted
-	//
-	// once we have sorted enough values to know the desired percentile, we
-	// stop
+	// the qualifying values, now at the front of the genome, are treated as
+	// one concatenated list of segments, one segment per vector
 
-	for (chromIx=0 ; chromIx<=lastChromIx ; chromIx++)
-		{
-		chromSpec = chromsSorted[chromIx];
+	numSegs = lastChromIx + 1;
 
-		v = chromSpec->valVector;
-		if (chromIx < lastChromIx) vLen = chromSpec->length;
-		                      else vLen = numValuesInLastChrom;
-
-		if (op->debug) fprintf (stderr, "sorting %s (%u)\n", chromSpec->chrom, vLen);
-		qsort (v, vLen, sizeof(valtype), valtype_ascending);
-		}
+	segV  = (valtype**) malloc (numSegs * sizeof(valtype*));
+	segLo = (u32*)      malloc (numSegs * sizeof(u32));
+	segHi = (u32*)      malloc (numSegs * sizeof(u32));
+	if ((segV == NULL) || (segLo == NULL) || (segHi == NULL))
+		goto cant_allocate;
 
 	for (chromIx=0 ; chromIx<=lastChromIx ; chromIx++)
 		{
 		chromSpec = chromsSorted[chromIx];
+		segV [chromIx] = chromSpec->valVector;
+		segLo[chromIx] = 0;
+		segHi[chromIx] = (chromIx < lastChromIx)? chromSpec->length
+		                                        : numValuesInLastChrom;
+		}
 
-		if ((op->debugStage == 2) && (chromIx == 1)) goto done;
-		if ((op->debugStage == 3) && (chromIx == 2)) goto done;
-
-		v = chromSpec->valVector;
-		if (chromIx < lastChromIx) vLen = chromSpec->length;
-		                      else vLen = numValuesInLastChrom;
-
-		if (op->debug) fprintf (stderr, "resolving %s (%u)\n", chromSpec->chrom, vLen);
-
-		if (chromIx < lastChromIx)
-			{
-			for (dstChromIx=chromIx+1 ; dstChromIx<=lastChromIx ; dstChromIx++)
-				{
-				dstChromSpec = chromsSorted[dstChromIx];
-
-				dstV = dstChromSpec->valVector;
-				if (dstChromIx < lastChromIx) dstVLen = dstChromSpec->length;
-				                         else dstVLen = numValuesInLastChrom;
-
-				if (op->debug)
-					fprintf (stderr, "  merging %s and %s (%u)\n",
-					                 chromSpec->chrom, dstChromSpec->chrom, dstVLen);
-				combine_sorted_vectors(v, vLen, dstV, dstVLen);
-				}
-			}
-
-		// report whatever desired percentiles are in this vector;  if the
-		// final percentile is in this vector, we're done;  otherwise, reduce
-		// the next-percentile index and continue on to the next outer vector
-
-		while (percentileIx < vLen)
-			{
-			pPct = percentileNext / ((float)percentileStepUnits);
-			pIx  = numValuesPassed + percentileIx;
-			pVal = v[percentileIx];
-
-			set_percentile_name (varName, percentileNext);
-			set_named_global    (varName, pVal);
-
-			if (op->reportForBash)
-				fprintf (stdout, "%s=" valtypeFmtPrec " # bash command\n",
-				                 varName, valPrecision, pVal);
-			else if (!op->quiet)
-				{
-				fprintf (stderr, "percentile %.3f is ", pPct);
-				if (op->debugShowIndex) fprintf (stderr, "[%u] ", pIx);
-				fprintf (stderr, valtypeFmtPrec "\n", valPrecision, pVal);
-				}
-
-			if (mapF != NULL)
-				fprintf (mapF, valtypeFmtPrec " %.3f\n", valPrecision, pVal, pPct);
-
-			percentileNext += percentileStep;
-			if (percentileNext > percentileHi) goto done;
-			percentileIx =  (u32) (((u64) numValues) * percentileNext / (100.0*percentileStepUnits));
-			percentileIx -= numValuesPassed;
-			}
+	// unless we're writing a mapping file (which needs the qualifying values
+	// fully sorted), use selection to locate the percentiles;  we repeatedly
+	// partition the segments around a pivot value, narrowing to the parts
+	// containing the desired ranks
+	//
+	// otherwise, we sort each segment individually (radix sort, in parallel
+	// if we have threads), then locate the percentiles by a k-way merge of the
+	// sorted segments
+
+	if (mapF == NULL)
+		find_percentiles (_op, mapF, segV, segLo, segHi, numSegs,
+		                  numValues, /*runs sorted*/ false);
+	else
+		{
+		sort_segments (segV, segLo, segHi, numSegs);
+		if (op->debugStage != 2)
+			find_percentiles (_op, mapF, segV, segLo, segHi, numSegs,
+			                  numValues, /*runs sorted*/ true);
+		}
 
-		percentileIx    -= vLen;
-		numValuesPassed += vLen;
+	free (segV);
+	free (segLo);
+	free (segHi);
 
-		if (chromIx == lastChromIx)
-			{
-			if (percentileIx == 0)  // special case for 100th percentile
-				{
-				pPct = percentileNext / ((float)percentileStepUnits);
-				pIx  = numValuesPassed + percentileIx - 1;
-				pVal = v[vLen-1];
-
-				set_percentile_name (varName, percentileNext);
-				set_named_global    (varName, pVal);
-
-				if (!op->quiet)
-					{
-					fprintf (stderr, "percentile %.3f is ", pPct);
-					if (op->debugShowIndex) fprintf (stderr, "[%u] ", pIx);
-					fprintf (stderr, valtypeFmtPrec "\n", valPrecision, pVal);
-					}
-				if (mapF != NULL)
-					fprintf (mapF, valtypeFmtPrec " %.3f\n", valPrecision, pVal, pPct);
-				}
-			else
-				goto internal_error;
-			}
-		}
 done:
 
 	// restore the original data;  note that we detroy (but don't delete) the
@@ -743,14 +899,106 @@ no_values:
 	// failure exits
 	//////////
 
-internal_error:
-	fprintf (stderr, "[%s]internal error;  "
-	                 "got to end of genome without finding the next percentile index\n",
-	                 op->common.name);
+cant_allocate:
+	fprintf (stderr, "[%s] failed to allocate selection arrays (%u vectors)\n",
+	                 op->common.name, numSegs);
+	exit (EXIT_FAILURE);
+
+cant_allocate_keep:
+	fprintf (stderr, "[%s] failed to allocate buffer for %s values, %d bytes per value\n",
+	                 op->common.name, ucommatize(numValues), (int) sizeof(valtype));
 	exit (EXIT_FAILURE);
 	}
 
 
+// set_percentile_name--
+
+//----------
+//
+// percentiles_in_chromosome--
+//	Locate and report the operator's percentiles among the qualifying values
+//	in a single chromosome.
+//
+//	The qualifying values are copied to a scratch vector and located there by
+//	selection, so the chromosome's data is left intact.  Each percentile's
+//	named variable is marked as being specific to this chromosome.  If no
+//	values qualify, the named variables are set to NaN.
+//
+//----------
+//
+// Arguments:
+//	dspop*		_op:	The percentile operator's control record.
+//	char*		vName:	The chromosome's name.
+//	u32			vLen:	The length of the chromosome.
+//	valtype*	v:		The chromosome's values.
+//
+// Returns:
+//	(nothing)
+//
+//----------
+
+static void percentiles_in_chromosome
+   (dspop*		_op,
+	char*		vName,
+	u32			vLen,
+	valtype*	v)
+	{
+	dspop_percentile*	op = (dspop_percentile*) _op;
+	valtype		minAllowed = op->minAllowed;
+	valtype		maxAllowed = op->maxAllowed;
+	u32			windowSize = op->windowSize;
+	char		varName[100];
+	valtype*	keepV;
+	u32			segLo, segHi;
+	u32			numValues, ix, percentile;
+
+	keepV = get_scratch_vector();
+
+	numValues = 0;
+	for (ix=0 ; ix<vLen ; ix+=windowSize)
+		{
+		if (v[ix] < minAllowed) continue;
+		if (v[ix] > maxAllowed) continue;
+		keepV[numValues++] = v[ix];
+		}
+
+	if (numValues == 0)
+		{
+		fprintf (stderr, "[%s] percentile can't be computed for %s;  no input values meet the criteria\n",
+		                 op->common.name, vName);
+		for (percentile=op->percentileLo ; percentile<=op->percentileHi ; percentile+=op->percentileStep)
+			{
+			set_percentile_name    (varName, percentile);
+			set_chrom_named_global (varName, vName, (valtype) NAN);
+			}
+		}
+	else
+		{
+		segLo = 0;
+		segHi = numValues;
+		op->chromName = vName;
+		find_percentiles (_op, /*mapF*/ NULL, &keepV, &segLo, &segHi,
+		                  /*numSegs*/ 1, numValues, /*runs sorted*/ false);
+		op->chromName = NULL;
+		}
+
+	release_scratch_vector (keepV);
+	}
+
+
+// percentile_rank--
+//	Determine the rank (among numValues sorted values) of a percentile's value.
+
+static u32 percentile_rank (u32 numValues, u32 percentile)
+	{
+	u32		rank;
+
+	rank = (u32) (((u64) numValues) * percentile / (100.0*percentileStepUnits));
+	if (rank >= numValues) rank = numValues-1;  // (100th percentile)
+	return rank;
+	}
+
+
 // set_percentile_name--
 
 static void set_percentile_name (char* varName, u32 percentile)
@@ -781,150 +1029,953 @@ static void set_percentile_name (char* varName, u32 percentile)
 
 //----------
 //
-// combine_sorted_vectors--
-//	Combine vectors v and w so that v[i] <= w[j] for all i,j.  This is
-//	accomplished by exchanging the N lowest elements from the head of w with
-//	the N highest elements from the tail of v.  N is determined by a pre-scan
-//	of the data.
-//
-//	That leaves us with each block consisting of two increasing partitions.
-//	We then sort each block in place by merging its two partitions.
-//
-//	Diagramatically, we do this:
-//
-//		   +----+    +----+         +----+    +----+         +-------+    +-------+
-//		v: | V1 | w: | W1 | ---> v: | V1 | w: | V3 | ---> v: | V1,W1 | w: | V3,W3 |
-//		   | .. |    | .. |         | .. |    | .. |         |  ..   |    |  ..   |
-//		   | .. |    | W2 |         | .. |    | V4 |         |  ..   |    |  ..   |
-//		   | .. |    | W3 |         | .. |    | W3 |         |  ..   |    |  ..   |
-//		   | .. |    | .. |         | .. |    | .. |         |  ..   |    |  ..   |
-//		   | V2 |    | .. |         | V2 |    | .. |         |  ..   |    |  ..   |
-//		   | V3 |    | .. |         | W1 |    | .. |         |  ..   |    |  ..   |
-//		   | .. |    | W4 |         | .. |    | W4 |         |  ..   |    | V4,W4 |
-//		   | V4 |    +----+         | W2 |    +----+         | V2,W2 |    +-------+
-//		   +----+                   +----+                   +-------+
+// find_percentiles--
+//	Locate and report the operator's percentiles within a list of qualifying
+//	values.  The list is the concatenation of one or more vector segments (see
+//	select_ranks).
+//
+//----------
+//
+// Arguments:
+//	dspop*		_op:		The percentile operator's control record.
+//	FILE*		mapF:		The mapping file to write to;  this may be NULL.
+//	valtype**	segV:		The vectors containing each segment.
+//	u32*		segLo:		The start of each segment in its vector.  This may
+//							.. be modified.
+//	u32*		segHi:		The end of each segment in its vector.  This may be
+//							.. modified.
+//	u32			numSegs:	The number of segments.
+//	u32			numValues:	The total number of values in the segments.
+//	int			runsSorted:	true  => each segment is sorted;  we locate the
+//							         .. percentiles by a k-way merge
+//							false => the segments are in arbitrary order;  we
+//							         .. locate the percentiles by selection
+//
+// Returns:
+//	(nothing)
+//
+//----------
+
+static void find_percentiles
+   (dspop*				_op,
+	FILE*				mapF,
+	valtype**			segV,
+	u32*				segLo,
+	u32*				segHi,
+	u32					numSegs,
+	u32					numValues,
+	int					runsSorted)
+	{
+	dspop_percentile*	op = (dspop_percentile*) _op;
+	u32					percentileLo   = op->percentileLo;
+	u32					percentileHi   = op->percentileHi;
+	u32					percentileStep = op->percentileStep;
+	u32*				ranks;
+	valtype*			rankVals;
+	u32*				heap;
+	u32					numPercentiles, pNum;
+	u32					heapSize, heapIx, childIx, segIx, rank;
+	valtype				val;
+
+	numPercentiles = 1 + (percentileHi - percentileLo) / percentileStep;
+
+	ranks    = (u32*)     malloc (numPercentiles * sizeof(u32));
+	rankVals = (valtype*) malloc (numPercentiles * sizeof(valtype));
+	if ((ranks == NULL) || (rankVals == NULL)) goto cant_allocate;
+
+	for (pNum=0 ; pNum<numPercentiles ; pNum++)
+		ranks[pNum] = percentile_rank (numValues, percentileLo + pNum*percentileStep);
+
+	if (!runsSorted)
+		select_ranks (segV, segLo, segHi, numSegs, /*base rank*/ 0,
+		              ranks, rankVals, numPercentiles);
+	else
+		{
+		// k-way merge;  heap[] is a min-heap of the non-empty segments, keyed
+		// by the value at the head of each segment;  segLo[] serves as the
+		// cursor into each segment
+
+		heap = (u32*) malloc (numSegs * sizeof(u32));
+		if (heap == NULL) goto cant_allocate_heap;
+
+		heapSize = 0;
+		for (segIx=0 ; segIx<numSegs ; segIx++)
+			{
+			if (segLo[segIx] >= segHi[segIx]) continue;
+			val = segV[segIx][segLo[segIx]];
+			for (heapIx=heapSize++ ; heapIx>0 ; heapIx=childIx)
+				{
+				childIx = (heapIx-1) / 2;   // (actually the parent)
+				if (segV[heap[childIx]][segLo[heap[childIx]]] <= val) break;
+				heap[heapIx] = heap[childIx];
+				}
+			heap[heapIx] = segIx;
+			}
+
+		pNum = 0;
+		for (rank=0 ; (pNum<numPercentiles) && (heapSize>0) ; rank++)
+			{
+			segIx = heap[0];
+			val   = segV[segIx][segLo[segIx]];
+			while ((pNum < numPercentiles) && (ranks[pNum] == rank))
+				rankVals[pNum++] = val;
+
+			// advance the head segment, and sift it down into place (or
+			// replace it with the last heap entry if it is exhausted)
+
+			if (++segLo[segIx] >= segHi[segIx])
+				{
+				segIx = heap[--heapSize];
+				if (heapSize == 0) break;
+				}
+			val = segV[segIx][segLo[segIx]];
+
+			for (heapIx=0 ; (childIx=2*heapIx+1)<heapSize ; heapIx=childIx)
+				{
+				if ((childIx+1 < heapSize)
+				 && (segV[heap[childIx+1]][segLo[heap[childIx+1]]]
+				   < segV[heap[childIx]]  [segLo[heap[childIx]]]))
+					childIx++;
+				if (val <= segV[heap[childIx]][segLo[heap[childIx]]]) break;
+				heap[heapIx] = heap[childIx];
+				}
+			heap[heapIx] = segIx;
+			}
+
+		free (heap);
+		}
+
+	for (pNum=0 ; pNum<numPercentiles ; pNum++)
+		report_percentile (_op, mapF, percentileLo + pNum*percentileStep,
+		                   ranks[pNum], rankVals[pNum]);
+
+	free (ranks);
+	free (rankVals);
+	return;
+
+	//////////
+	// failure exits
+	//////////
+
+cant_allocate:
+	fprintf (stderr, "[%s] failed to allocate arrays for %u percentiles\n",
+	                 op->common.name, numPercentiles);
+	exit (EXIT_FAILURE);
+
+cant_allocate_heap:
+	fprintf (stderr, "[%s] failed to allocate merge heap (%u segments)\n",
+	                 op->common.name, numSegs);
+	exit (EXIT_FAILURE);
+	}
+
+//----------
+//
+// report_percentile--
+//	Report one computed percentile, setting the corresponding named variable
+//	and writing it to the console and/or the mapping file.
+//
+//----------
+//
+// Arguments:
+//	dspop*		_op:		The percentile operator's control record.
+//	FILE*		mapF:		The mapping file to write to;  this may be NULL.
+//	u32			percentile:	The percentile (in thousandths of a percent).
+//	u32			pIx:		The rank of the percentile's value among the
+//							.. qualifying values (only used for debugging).
+//	valtype		pVal:		The percentile's value.
+//
+// Returns:
+//	(nothing)
+//
+//----------
+
+static void report_percentile
+   (dspop*				_op,
+	FILE*				mapF,
+	u32					percentile,
+	u32					pIx,
+	valtype				pVal)
+	{
+	dspop_percentile*	op = (dspop_percentile*) _op;
+	int					valPrecision = op->valPrecision;
+	char				varName[100];
+	float				pPct;
+
+	pPct = percentile / ((float)percentileStepUnits);
+
+	set_percentile_name (varName, percentile);
+	if (op->chromName == NULL)
+		set_named_global       (varName, pVal);
+	else
+		set_chrom_named_global (varName, op->chromName, pVal);
+
+	if ((op->reportForBash) && (op->chromName != NULL))
+		fprintf (stdout, "%s_%s=" valtypeFmtPrec " # bash command\n",
+		                 varName, op->chromName, valPrecision, pVal);
+	else if (op->reportForBash)
+		fprintf (stdout, "%s=" valtypeFmtPrec " # bash command\n",
+		                 varName, valPrecision, pVal);
+	else if (!op->quiet)
+		{
+		if (op->chromName == NULL)
+			fprintf (stderr, "percentile %.3f is ", pPct);
+		else
+			fprintf (stderr, "percentile %.3f of %s is ", pPct, op->chromName);
+		if (op->debugShowIndex) fprintf (stderr, "[%u] ", pIx);
+		fprintf (stderr, valtypeFmtPrec "\n", valPrecision, pVal);
+		}
+
+	if (mapF != NULL)
+		fprintf (mapF, valtypeFmtPrec " %.3f\n", valPrecision, pVal, pPct);
+	}
+
+//----------
+//
+// select_ranks--
+//	Find the values having specified ranks (in sorted order) in a list of
+//	values, without sorting the list.
+//
+//	The list is the concatenation of several segments, each a subrange of some
+//	vector.  We choose a pivot value and perform a three-way partition of each
+//	segment into values less than, equal to, and greater than the pivot.  The
+//	counts tell us which partition each desired rank falls in;  we then narrow
+//	to the lesser and/or greater partitions and repeat.  When both sides still
+//	contain desired ranks, we recurse on the side with fewer ranks and iterate
+//	on the other.  Expected time is O(N) for a single rank, and O(N log k) for
+//	k ranks.
+//
+//	Values within the segments are reordered, but the set of values in each
+//	segment is preserved.
 //
 //----------
 //
 // Arguments:
-//	valtype*	v:		The first block.
-//	u32			vLen:	The length of the first block.
-//	valtype*	w:		The second block.
-//	u32			wLen:	The length of the second block.
+//	valtype**	segV:		The vectors containing each segment.
+//	u32*		segLo:		The start of each segment in its vector.  This is
+//							.. modified.
+//	u32*		segHi:		The end of each segment in its vector (one past the
+//							.. last value).  This is modified.
+//	u32			numSegs:	The number of segments.
+//	u32			baseRank:	The rank of the lowest value in the list (i.e. the
+//							.. number of values lower than the list that were
+//							.. excluded before this call).
+//	u32*		ranks:		The desired ranks, in non-decreasing order.
+//	valtype*	rankVals:	Place to return the value for each rank.
+//	u32			numRanks:	The number of entries in ranks[] and rankVals[].
 //
 // Returns:
 //	(nothing)
 //
 //----------
 
-static void combine_sorted_vectors
+static u32 selectRandom = 2463534242u;	// (xorshift state for pivot choice)
+
+static valtype select_random_value
+   (valtype**	segV,
+	u32*		segLo,
+	u32*		segHi,
+	u32			numSegs,
+	u32			total)
+	{
+	u32			r, segIx;
+
+	selectRandom ^= selectRandom << 13;
+	selectRandom ^= selectRandom >> 17;
+	selectRandom ^= selectRandom << 5;
+	r = selectRandom % total;
+
+	for (segIx=0 ; segIx<numSegs ; segIx++)
+		{
+		if (r < segHi[segIx] - segLo[segIx]) break;
+		r -= segHi[segIx] - segLo[segIx];
+		}
+
+	return segV[segIx][segLo[segIx]+r];
+	}
+
+
+static void select_ranks
+   (valtype**	segV,
+	u32*		segLo,
+	u32*		segHi,
+	u32			numSegs,
+	u32			baseRank,
+	u32*		ranks,
+	valtype*	rankVals,
+	u32			numRanks)
+	{
+	valtype		small[selectSmallCount];
+	u32*		segLt = NULL, *segGt, *subLo, *subHi;
+	valtype*	v;
+	u32			total, numLess, numEqual;
+	u32			segIx, ix, lt, gt, rankIx, lessRanks, equalRanks;
+	int			goLeft;
+	valtype		pivot, p1, p2, p3, val;
+
+	if (numRanks == 0) return;
+
+	segLt = (u32*) malloc (4 * numSegs * sizeof(u32));
+	if (segLt == NULL) goto cant_allocate;
+	segGt = segLt + numSegs;
+	subLo = segGt + numSegs;
+	subHi = subLo + numSegs;
+
+	while (numRanks > 0)
+		{
+		total = 0;
+		for (segIx=0 ; segIx<numSegs ; segIx++)
+			total += segHi[segIx] - segLo[segIx];
+
+		// if there are only a few values left, just sort them
+
+		if (total <= selectSmallCount)
+			{
+			ix = 0;
+			for (segIx=0 ; segIx<numSegs ; segIx++)
+				{
+				v = segV[segIx];
+				for (lt=segLo[segIx] ; lt<segHi[segIx] ; lt++)
+					small[ix++] = v[lt];
+				}
+			qsort (small, total, sizeof(valtype), valtype_ascending);
+
+			for (rankIx=0 ; rankIx<numRanks ; rankIx++)
+				rankVals[rankIx] = small[ranks[rankIx]-baseRank];
+			break;
+			}
+
+		// choose a pivot, the median of three randomly chosen values
+
+		p1 = select_random_value (segV, segLo, segHi, numSegs, total);
+		p2 = select_random_value (segV, segLo, segHi, numSegs, total);
+		p3 = select_random_value (segV, segLo, segHi, numSegs, total);
+		if (p1 > p2) { val = p1;  p1 = p2;  p2 = val; }
+		if (p2 > p3) { val = p2;  p2 = p3;  p3 = val; }
+		if (p1 > p2) { val = p1;  p1 = p2;  p2 = val; }
+		pivot = p2;
+
+		// partition each segment into [lo,lt) < pivot, [lt,gt) == pivot, and
+		// [gt,hi) > pivot
+
+		numLess = numEqual = 0;
+		for (segIx=0 ; segIx<numSegs ; segIx++)
+			{
+			v  = segV[segIx];
+			lt = ix = segLo[segIx];
+			gt = segHi[segIx];
+			while (ix < gt)
+				{
+				val = v[ix];
+				if (val < pivot)
+					{ v[ix++] = v[lt];  v[lt++] = val; }
+				else if (val > pivot)
+					{ v[ix] = v[--gt];  v[gt] = val; }
+				else
+					ix++;
+				}
+			segLt[segIx] =  lt;
+			segGt[segIx] =  gt;
+			numLess      += lt - segLo[segIx];
+			numEqual     += gt - lt;
+			}
+
+		// split the desired ranks into those that are less than, equal to,
+		// and greater than the pivot
+
+		for (rankIx=0 ; rankIx<numRanks ; rankIx++)
+			{ if (ranks[rankIx] >= baseRank+numLess) break; }
+		lessRanks = rankIx;
+
+		for ( ; rankIx<numRanks ; rankIx++)
+			{
+			if (ranks[rankIx] >= baseRank+numLess+numEqual) break;
+			rankVals[rankIx] = pivot;
+			}
+		equalRanks = rankIx - lessRanks;
+
+		// if desired ranks remain on both sides, recurse on the side with
+		// fewer ranks;  then narrow to the other side and repeat
+
+		goLeft = (lessRanks > 0);
+		if ((lessRanks > 0) && (lessRanks+equalRanks < numRanks))
+			{
+			if (lessRanks <= numRanks - (lessRanks+equalRanks))
+				{
+				for (segIx=0 ; segIx<numSegs ; segIx++)
+					{ subLo[segIx] = segLo[segIx];  subHi[segIx] = segLt[segIx]; }
+				select_ranks (segV, subLo, subHi, numSegs, baseRank,
+				              ranks, rankVals, lessRanks);
+				goLeft = false;
+				}
+			else
+				{
+				for (segIx=0 ; segIx<numSegs ; segIx++)
+					{ subLo[segIx] = segGt[segIx];  subHi[segIx] = segHi[segIx]; }
+				select_ranks (segV, subLo, subHi, numSegs,
+				              baseRank+numLess+numEqual,
+				              ranks+lessRanks+equalRanks,
+				              rankVals+lessRanks+equalRanks,
+				              numRanks-(lessRanks+equalRanks));
+				}
+			}
+
+		if (goLeft)
+			{
+			for (segIx=0 ; segIx<numSegs ; segIx++)
+				segHi[segIx] = segLt[segIx];
+			numRanks = lessRanks;
+			}
+		else
+			{
+			for (segIx=0 ; segIx<numSegs ; segIx++)
+				segLo[segIx] = segGt[segIx];
+			baseRank += numLess + numEqual;
+			ranks    += lessRanks + equalRanks;
+			rankVals += lessRanks + equalRanks;
+			numRanks -= lessRanks + equalRanks;
+			}
+		}
+
+	free (segLt);
+	return;
+
+	//////////
+	// failure exits
+	//////////
+
+cant_allocate:
+	fprintf (stderr, "failed to allocate %u selection segments\n",
+	                 4*numSegs);
+	exit (EXIT_FAILURE);
+	}
+
+//----------
+//
+// sort_segments--
+//	Sort each of a list of segments individually (into increasing order).
+//
+//	The segments are sorted by radix sort.  If the user has allowed us more
+//	than one thread, several segments are sorted concurrently;  each thread
+//	claims the next unsorted segment until none are left.
+//
+//----------
+//
+// Arguments:
+//	valtype**	segV:		The vectors containing each segment.
+//	u32*		segLo:		The start of each segment in its vector.
+//	u32*		segHi:		The end of each segment in its vector.  No segment
+//							.. may be longer than a scratch vector.
+//	u32			numSegs:	The number of segments.
+//
+// Returns:
+//	(nothing)
+//
+//----------
+
+typedef struct sortjob
+	{
+	valtype**	segV;			// the segments (as described above)
+	u32*		segLo;
+	u32*		segHi;
+	u32			numSegs;
+	u32			nextSeg;		// the next segment not yet claimed by a thread
+	pthread_mutex_t lock;		// protects nextSeg
+	} sortjob;
+
+typedef struct sortworker
+	{
+	sortjob*	job;
+	valtype*	scratch;		// this thread's scratch vector
+	pthread_t	thread;
+	} sortworker;
+
+
+static void* sort_segments_worker
+   (void*		_worker)
+	{
+	sortworker*	worker = (sortworker*) _worker;
+	sortjob*	job    = worker->job;
+	u32			segIx;
+
+	worker->scratch = get_scratch_vector();
+
+	while (true)
+		{
+		pthread_mutex_lock   (&job->lock);
+		segIx = job->nextSeg++;
+		pthread_mutex_unlock (&job->lock);
+		if (segIx >= job->numSegs) break;
+
+		radix_sort_values (job->segV[segIx] + job->segLo[segIx],
+		                   job->segHi[segIx] - job->segLo[segIx],
+		                   worker->scratch);
+		}
+
+	release_scratch_vector (worker->scratch);
+	return NULL;
+	}
+
+
+static void sort_segments
+   (valtype**	segV,
+	u32*		segLo,
+	u32*		segHi,
+	u32			numSegs)
+	{
+	sortjob		job;
+	sortworker*	workers;
+	u32			numWorkers, workerIx;
+
+	numWorkers = (numThreads < 1)? 1 : numThreads;
+	if (numWorkers > numSegs) numWorkers = numSegs;
+
+	workers = (sortworker*) malloc (numWorkers * sizeof(sortworker));
+	if (workers == NULL) goto cant_allocate;
+
+	job.segV    = segV;
+	job.segLo   = segLo;
+	job.segHi   = segHi;
+	job.numSegs = numSegs;
+	job.nextSeg = 0;
+	pthread_mutex_init (&job.lock, NULL);
+
+	for (workerIx=0 ; workerIx<numWorkers ; workerIx++)
+		workers[workerIx].job = &job;
+
+	if (numWorkers == 1)
+		sort_segments_worker (&workers[0]);
+	else
+		{
+		for (workerIx=0 ; workerIx<numWorkers ; workerIx++)
+			{
+			if (pthread_create (&workers[workerIx].thread, NULL,
+			                    sort_segments_worker, &workers[workerIx]) != 0)
+				goto cant_create_thread;
+			}
+		for (workerIx=0 ; workerIx<numWorkers ; workerIx++)
+			pthread_join (workers[workerIx].thread, NULL);
+		}
+
+	pthread_mutex_destroy (&job.lock);
+	free (workers);
+	return;
+
+	//////////
+	// failure exits
+	//////////
+
+cant_allocate:
+	fprintf (stderr, "failed to allocate %u sort workers\n", numWorkers);
+	exit (EXIT_FAILURE);
+
+cant_create_thread:
+	fprintf (stderr, "failed to create sort thread %u\n", workerIx);
+	exit (EXIT_FAILURE);
+	}
+
+//----------
+//
+// radix_sort_values--
+//	Sort a vector of values into increasing order, using an LSD radix sort
+//	over the bits of the values.
+//
+//	Each IEEE-754 value is mapped to an unsigned key that sorts in the same
+//	order as the values, by flipping the sign bit of non-negative values, and
+//	all bits of negative values.  The keys are processed one byte at a time,
+//	least significant byte first.  Bytes for which every key has the same
+//	digit are skipped (this is common for the exponent bytes).
+//
+//	Note that this assumes valtype is a 64-bit double.  Also, -0 sorts before
+//	+0 (whereas valtype_ascending considers them equal).
+//
+//----------
+//
+// Arguments:
+//	valtype*	v:			The vector to sort.
+//	u32			vLen:		The number of entries in v[].
+//	valtype*	scratch:	A scratch vector, at least as long as v[].
+//
+// Returns:
+//	(nothing)
+//
+//----------
+
+#define radixDigits 8			// number of one-byte digits in a valtype key
+
+static u64 valtype_key (valtype val)
+	{
+	u64	bits;
+
+	memcpy (&bits, &val, sizeof(bits));
+	return bits ^ (((u64) (((s64) bits) >> 63)) | (((u64) 1) << 63));
+	}
+
+
+static void radix_sort_values
    (valtype*	v,
 	u32			vLen,
-	valtype*	w,
-	u32			wLen)
+	valtype*	scratch)
 	{
-	u32			vIx, wIx, vSplit, wSplit;
-	valtype		val;
+	u32			counts[radixDigits][256];
+	valtype*	src, *dst, *temp;
+	u64			key;
+	u32			ix, digitIx, bucket, count, offset;
+	int			shift;
+
+	if (vLen < 2) return;
+
+	// count the occurrences of every digit value in every digit position
+
+	memset (counts, 0, sizeof(counts));
+	for (ix=0 ; ix<vLen ; ix++)
+		{
+		key = valtype_key (v[ix]);
+		for (digitIx=0 ; digitIx<radixDigits ; digitIx++)
+			counts[digitIx][(key >> (8*digitIx)) & 0xFF]++;
+		}
 
-	if ((vLen == 0) || (wLen == 0)) return;		// nothing to combine
-	if (v[vLen-1] <= w[0]) return;				// already sorted
+	// distribute the values by each digit in turn, ping-ponging between the
+	// vector and the scratch vector
 
-	// identify the biggest N such that N elements from the head of w are all
-	// lower than N elements from the tail of v
+	src = v;
+	dst = scratch;
 
-	wIx = 0;
-	vIx = vLen-1;
-	while ((wIx+1 < wLen) && (vIx > 0))
+	for (digitIx=0 ; digitIx<radixDigits ; digitIx++)
 		{
-		wIx++;  vIx--;
-		if (v[vIx] > w[wIx]) continue;
-		wIx--;  vIx++;
-		break;
+		shift  = 8*digitIx;
+		bucket = (valtype_key (src[0]) >> shift) & 0xFF;
+		if (counts[digitIx][bucket] == vLen) continue;
+
+		offset = 0;
+		for (bucket=0 ; bucket<256 ; bucket++)
+			{
+			count = counts[digitIx][bucket];
+			counts[digitIx][bucket] = offset;
+			offset += count;
+			}
+
+		for (ix=0 ; ix<vLen ; ix++)
+			{
+			bucket = (valtype_key (src[ix]) >> shift) & 0xFF;
+			dst[counts[digitIx][bucket]++] = src[ix];
+			}
+
+		temp = src;  src = dst;  dst = temp;
 		}
 
-	wSplit = wIx;		// need to swap w[0..wSplit] with v[vSplit..vLen-1]
-	vSplit = vIx;
+	if (src != v)
+		memcpy (v, src, vLen * sizeof(valtype));
+	}
+
+//----------
+//
+// radix_select_percentiles--
+//	Locate and report the operator's percentiles by radix selection, without
+//	moving any data.
+//
+//	Each value is mapped to an unsigned key that sorts in the same order as the
+//	values (see radix_sort_values).  A first pass counts the qualifying values
+//	by the top radixSelectBits of their keys.  For each percentile we find the
+//	bucket containing its rank, and make further passes counting the next bits
+//	of only the keys in that bucket.  Once the bucket is small enough, a final
+//	pass gathers its values so that the exact value can be picked out.
+//
+//	Every pass is a scan of the qualifying values (respecting minAllowed,
+//	maxAllowed and windowSize), which may be spread over several threads.
+//	Typically a percentile needs three or four passes, so this is best suited
+//	to a small number of percentiles.
+//
+//----------
+//
+// Arguments:
+//	dspop*		_op:	The percentile operator's control record.
+//
+// Returns:
+//	The number of qualifying values;  if this is zero, nothing is reported.
+//
+//----------
+
+static u32 radix_select_percentiles
+   (dspop*		_op)
+	{
+	dspop_percentile*	op = (dspop_percentile*) _op;
+	u32			percentileLo   = op->percentileLo;
+	u32			percentileHi   = op->percentileHi;
+	u32			percentileStep = op->percentileStep;
+	u32*		topCounts, *counts;
+	valtype*	gatherV = NULL;
+	u64			prefix;
+	int			prefixBits;
+	u32			numValues, percentile, rank, bucket, bucketCount;
+	valtype		pVal;
+
+	topCounts = (u32*) malloc (2 * (1<<radixSelectBits) * sizeof(u32));
+	if (topCounts == NULL) goto cant_allocate;
+	counts = topCounts + (1<<radixSelectBits);
+
+	// count all qualifying values by the top bits of their keys
+
+	radix_select_pass (_op, /*gather*/ false, 0, 0, topCounts, NULL);
+
+	numValues = 0;
+	for (bucket=0 ; bucket<(1<<radixSelectBits) ; bucket++)
+		numValues += topCounts[bucket];
+	if (numValues == 0) goto done;
+
+	for (percentile=percentileLo ; percentile<=percentileHi ; percentile+=percentileStep)
+		{
+		rank = percentile_rank (numValues, percentile);
+
+		// narrow to the bucket containing the rank, until the bucket is small
+		// enough to gather (or we have examined the entire key)
+
+		memcpy (counts, topCounts, (1<<radixSelectBits) * sizeof(u32));
+		prefix     = 0;
+		prefixBits = 0;
+
+		while (true)
+			{
+			for (bucket=0 ; rank>=counts[bucket] ; bucket++)
+				rank -= counts[bucket];
+			bucketCount = counts[bucket];
+
+			prefix     =  (prefix << radixSelectBits) | bucket;
+			prefixBits += radixSelectBits;
+
+			if ((bucketCount <= radixSelectLimit) || (prefixBits == 64))
+				break;
+
+			radix_select_pass (_op, /*gather*/ false, prefix, prefixBits, counts, NULL);
+			}
+
+		if (prefixBits == 64)
+			{
+			// every value in the bucket has the same key, so they are all
+			// equal;  we only need to fetch one of them
 
-	// exchange the N elements from the head of w with the N elements from the
-	// tail of v, maintaining the order within each of those sublists
+			radix_select_pass (_op, /*gather*/ true, prefix, prefixBits, NULL, &pVal);
+			}
+		else
+			{
+			gatherV = (valtype*) realloc (gatherV, bucketCount * sizeof(valtype));
+			if (gatherV == NULL) goto cant_allocate_gather;
+
+			radix_select_pass (_op, /*gather*/ true, prefix, prefixBits, NULL, gatherV);
+			qsort (gatherV, bucketCount, sizeof(valtype), valtype_ascending);
+			pVal = gatherV[rank];
+			}
+
+		report_percentile (_op, /*mapF*/ NULL, percentile,
+		                   percentile_rank (numValues, percentile), pVal);
+		}
+
+done:
+	if (gatherV != NULL) free (gatherV);
+	free (topCounts);
+	return numValues;
 
-	for (wIx=0,vIx=vSplit ; wIx<=wSplit ; wIx++,vIx++)
-		{ val = w[wIx];  w[wIx] = v[vIx];  v[vIx] = val; }
+	//////////
+	// failure exits
+	//////////
 
-	// perform an in-place sort on each block
-	// $$$ note that we might be able to take advantage of the fact that each
-	// $$$ .. of the blocks is partitioned into sort increasing sub-blocks
+cant_allocate:
+	fprintf (stderr, "[%s] failed to allocate radix-select histograms\n",
+	                 op->common.name);
+	exit (EXIT_FAILURE);
 
-	qsort (v, vLen, sizeof(valtype), valtype_ascending);
-	qsort (w, wLen, sizeof(valtype), valtype_ascending);
+cant_allocate_gather:
+	fprintf (stderr, "[%s] failed to allocate radix-select bucket (%u values)\n",
+	                 op->common.name, bucketCount);
+	exit (EXIT_FAILURE);
 	}
 
 //----------
 //
-// sort_two_increasing_blocks--
-//	Perform an in-place sort on a block that consists of two sorted partitions.
-//	The algorithm is something like a merge sort, combined with a series of
-//	insertion sorts.  We iteratively pull the ith smallest item to correct
-//	position in the top partition.  If this item comes from the bottom partition
-//	the ith item in the top partition is displaced and moved into the bottom
-//	partition, but keeping that partition ordered.
+// radix_select_pass--
+//	Make one pass over the qualifying values for radix_select_percentiles,
+//	considering only those values whose keys begin with a given prefix.  The
+//	pass either counts those values by the next radixSelectBits of their keys,
+//	or gathers them into a buffer.
+//
+//	If the user has allowed us more than one thread, the chromosomes are
+//	divided among the threads;  each thread claims the next unscanned
+//	chromosome until none are left.
 //
 //----------
 //
 // Arguments:
-//	valtype*	v:		The block containing the two partitions.
-//	u32			vSplit:	The length of the first partition in the block.
-//	u32			vLen:	The total length of the block.
+//	dspop*		_op:		The percentile operator's control record.
+//	int			gather:		true  => gather the values into gatherV[]
+//							false => count the values into counts[]
+//	u64			prefix:		The key prefix to restrict the pass to.
+//	int			prefixBits:	The number of bits in the prefix (0 means all
+//							.. qualifying values are considered).
+//	u32*		counts:		Place to return the counts;  this has room for
+//							.. 2^radixSelectBits entries.  This is ignored if
+//							.. gather is true.
+//	valtype*	gatherV:	Place to return the gathered values;  the caller
+//							.. guarantees this is large enough.  This is
+//							.. ignored if gather is false.
 //
 // Returns:
 //	(nothing)
 //
 //----------
 
-// This has note been debugged, and is known to have a problem
-//
-//static void sort_two_increasing_blocks
-//   (valtype*	v,
-//	u32			vSplit,
-//	u32			vLen)
-//	{
-//	u32			topIx, botIx, ix;
-//	valtype		topVal, botVal;
-//
-//	if (vSplit == 0)    return;
-//	if (vSplit == vLen) return;
-//
-////…… fprintf (stderr, "vSplit=%u vLen=%u\n", vSplit, vLen);
-////…… fprintf (stderr, "  v[%u]=" valtypeFmt "\n", vSplit-1, v[vSplit-1]);
-////…… fprintf (stderr, "  v[%u]=" valtypeFmt "\n", vSplit,   v[vSplit]);
-//
-//	botIx = vSplit;
-//	for (topIx=0 ; topIx<botIx ; topIx++)
-//		{
-//		// compare the first items in both blocks;  if the item in the top
-//		// block is lower (or same) we keep it and loop back for the next item
-//
-////…… fprintf (stderr, "  ---\n");
-////…… fprintf (stderr, "  top v[%u]=" valtypeFmt "\n", topIx, v[topIx]);
-////…… fprintf (stderr, "  bot v[%u]=" valtypeFmt "\n", botIx, v[botIx]);
-//
-//		topVal = v[topIx];
-//		botVal = v[botIx];
-//		if (topVal <= botVal) continue;
-//
-//		// otherwise the item in the bottom block is lower;  we move it to the
-//		// top block, then insert the item from the top block into the bottom
-//		// block
-//
-//		v[topIx] = botVal;
-//
-//		for (ix=botIx ; ix+1<vLen ; ix++)
-//			{
-//			if (topVal <= v[ix+1]) break;
-//			v[ix] = v[ix+1];
-//			}
-////…… fprintf (stderr, "  --> v[%u]=" valtypeFmt "\n", ix, v[ix]);
-//		v[ix] = topVal;
-//		}
-//
-//	}
+typedef struct radixjob
+	{
+	dspop_percentile* op;
+	int			gather;
+	u64			prefix;
+	int			prefixBits;
+	u32*		counts;			// (shared result)
+	valtype*	gatherV;		// (shared result)
+	u32			gatherLen;
+	u32			nextChrom;		// the next chromosome not yet claimed by a
+								// .. thread
+	pthread_mutex_t lock;		// protects nextChrom, counts, gatherLen
+	} radixjob;
+
+
+static void* radix_select_worker
+   (void*		_job)
+	{
+	radixjob*	job        = (radixjob*) _job;
+	valtype		minAllowed = job->op->minAllowed;
+	valtype		maxAllowed = job->op->maxAllowed;
+	u32			windowSize = job->op->windowSize;
+	u64			prefix     = job->prefix;
+	int			prefixBits = job->prefixBits;
+	int			shift      = 64 - prefixBits - radixSelectBits;
+	u32*		counts = NULL;
+	spec*		chromSpec;
+	valtype*	v;
+	u64			key;
+	u32			chromIx, ix, bucket;
+
+	if (!job->gather)
+		{
+		counts = (u32*) calloc (1<<radixSelectBits, sizeof(u32));
+		if (counts == NULL) goto cant_allocate;
+		}
+
+	while (true)
+		{
+		pthread_mutex_lock   (&job->lock);
+		chromIx = job->nextChrom;
+		if (chromsSorted[chromIx] != NULL) job->nextChrom++;
+		pthread_mutex_unlock (&job->lock);
+
+		chromSpec = chromsSorted[chromIx];
+		if (chromSpec == NULL) break;
+		v = chromSpec->valVector;
+
+		for (ix=0 ; ix<chromSpec->length ; ix+=windowSize)
+			{
+			if (v[ix] < minAllowed) continue;
+			if (v[ix] > maxAllowed) continue;
+
+			key = valtype_key (v[ix]);
+			if ((prefixBits > 0) && ((key >> (64-prefixBits)) != prefix))
+				continue;
+
+			if (job->gather)
+				{
+				pthread_mutex_lock   (&job->lock);
+				job->gatherV[job->gatherLen++] = v[ix];
+				pthread_mutex_unlock (&job->lock);
+				if (prefixBits == 64) goto done; // (only one value wanted)
+				}
+			else
+				counts[(key >> shift) & ((1<<radixSelectBits)-1)]++;
+			}
+		}
+
+done:
+	if (!job->gather)
+		{
+		pthread_mutex_lock   (&job->lock);
+		for (bucket=0 ; bucket<(1<<radixSelectBits) ; bucket++)
+			job->counts[bucket] += counts[bucket];
+		pthread_mutex_unlock (&job->lock);
+		free (counts);
+		}
+
+	return NULL;
+
+cant_allocate:
+	fprintf (stderr, "[%s] failed to allocate radix-select histogram\n",
+	                 job->op->common.name);
+	exit (EXIT_FAILURE);
+	}
+
+
+static void radix_select_pass
+   (dspop*		_op,
+	int			gather,
+	u64			prefix,
+	int			prefixBits,
+	u32*		counts,
+	valtype*	gatherV)
+	{
+	dspop_percentile*	op = (dspop_percentile*) _op;
+	radixjob	job;
+	pthread_t*	threads;
+	u32			numWorkers, workerIx, chromIx;
+
+	job.op         = op;
+	job.gather     = gather;
+	job.prefix     = prefix;
+	job.prefixBits = prefixBits;
+	job.counts     = counts;
+	job.gatherV    = gatherV;
+	job.gatherLen  = 0;
+	job.nextChrom  = 0;
+	pthread_mutex_init (&job.lock, NULL);
+
+	if (!gather)
+		memset (counts, 0, (1<<radixSelectBits) * sizeof(u32));
+
+	for (chromIx=0 ; chromsSorted[chromIx]!=NULL ; chromIx++) ;
+	numWorkers = (numThreads < 1)? 1 : numThreads;
+	if (numWorkers > chromIx) numWorkers = chromIx;
+
+	// a pass that wants only a single value (see radix_select_worker) is not
+	// worth splitting up
+
+	if ((numWorkers <= 1) || (prefixBits == 64))
+		radix_select_worker (&job);
+	else
+		{
+		threads = (pthread_t*) malloc (numWorkers * sizeof(pthread_t));
+		if (threads == NULL) goto cant_allocate;
+
+		for (workerIx=0 ; workerIx<numWorkers ; workerIx++)
+			{
+			if (pthread_create (&threads[workerIx], NULL,
+			                    radix_select_worker, &job) != 0)
+				goto cant_create_thread;
+			}
+		for (workerIx=0 ; workerIx<numWorkers ; workerIx++)
+			pthread_join (threads[workerIx], NULL);
+
+		free (threads);
+		}
+
+	pthread_mutex_destroy (&job.lock);
+	return;
+
+	//////////
+	// failure exits
+	//////////
+
+cant_allocate:
+	fprintf (stderr, "[%s] failed to allocate %u radix-select threads\n",
+	                 op->common.name, numWorkers);
+	exit (EXIT_FAILURE);
+
+cant_create_thread:
+	fprintf (stderr, "[%s] failed to create radix-select thread %u\n",
+	                 op->common.name, workerIx);
+	exit (EXIT_FAILURE);
+	}
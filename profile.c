@@ -0,0 +1,868 @@
+// profile.c-- per-operator timing and throughput, for --profile, and an
+//              execution timeline, for --trace
+
+#include <stdlib.h>
+#define  true  1
+#define  false 0
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include "utilities.h"
+#include "genodsp_interface.h"
+#include "profile.h"
+
+//----------
+//
+// Each application of a pipeline stage (an operator, a series of operators
+// run tile by tile, or reading or writing the signal) is bracketed by
+// profile_begin and profile_end.  A stage is identified by its label, and we
+// keep a record for each chromosome it was applied to ("*" for a stage that
+// processes the whole genome at once), as well as its total.
+//
+// Wall time is measured by the monotonic clock, and CPU time is the process's
+// (so it includes any worker threads the operator started).  Bytes read and
+// written are what the process moved through read and write calls, as
+// reported by the kernel in /proc/self/io;  where that isn't available they
+// are reported as unknown.  Memory-mapped files (e.g. compiled interval files)
+// aren't counted.  Scratch vectors are counted each time an operator acquires
+// one, whether newly allocated or reused.
+//
+// If a trace file is open (see trace_open), each stage application is also
+// written to it as a span, along with spans for reading and writing intervals
+// and allocating the signal (see trace_span), and an instant event for each
+// scratch vector acquisition.  The file is in the Chrome trace-event JSON
+// format, as read by chrome://tracing and Perfetto.  Events are tagged with
+// the thread that caused them;  the main thread is 1, and other threads
+// (e.g. percentile's workers) are numbered as they first appear.
+//
+// If hardware counters are open (see profile_open_counters), we also record
+// cycles, instructions, last-level cache misses and branch misses, in user
+// mode, for the whole process (worker threads are included once they've
+// finished).  These come from perf_event_open, so they're only available on
+// Linux, and only if the kernel allows it (perf_event_paranoid, or a container
+// that filters the system call);  any counter that can't be opened is simply
+// reported as unknown.  If the kernel has to share the hardware among more
+// counters than it has, the counts are scaled estimates.
+//
+//----------
+
+int profiling = false;
+
+// hardware counters
+
+#define hwCycles       0
+#define hwInstructions 1
+#define hwLlcMisses    2
+#define hwBranchMisses 3
+#define numHwCounters  4
+
+#define cacheLineBytes 64		// (for estimating memory traffic from LLC
+								//  .. misses)
+
+typedef struct profcounts
+	{
+	double		wall;			// seconds
+	double		cpu;			// seconds
+	u64			bases;
+	u64			bytesRead;
+	u64			bytesWritten;
+	u64			scratchVectors;
+	u64			scratchBytes;
+	u32			applications;
+	u64			hw[numHwCounters];	// hardware counters
+	} profcounts;
+
+typedef struct profchrom
+	{
+	struct profchrom* next;		// next record in a linked list
+	char*		chrom;
+	profcounts	counts;
+	} profchrom;
+
+typedef struct profstage
+	{
+	struct profstage* next;		// next stage in a linked list
+	char*		label;
+	u32			order;			// the order in which stages first appeared
+	profcounts	total;
+	profchrom*	chromHead;
+	profchrom*	chromTail;
+	} profstage;
+
+static profstage*	stageHead = NULL;
+static profstage*	stageTail = NULL;
+static u32			numStages = 0;
+
+// state at the most recent profile_begin
+
+static double		beginWall, beginCpu;
+static u64			beginRead, beginWritten;
+static u64			beginScratchVectors, beginScratchBytes;
+static u64			beginHw[numHwCounters];
+
+// scratch vector counts (see profile_note_scratch)
+
+static u64			scratchVectors = 0;
+static u64			scratchBytes   = 0;
+
+// /proc/self/io;  ioFd is -2 until we first try to open it, and -1 if it
+// isn't available;  ioSelfBytes counts what we've read from it ourselves
+
+static int			ioFd        = -2;
+static int			ioKnown     = true;
+static u64			ioSelfBytes = 0;
+
+// trace file;  events are written as they happen, so that the trace of a run
+// that fails is still useful
+
+static FILE*		traceFile    = NULL;
+static double		traceStart;
+static u64			traceEvents  = 0;
+static u32			traceThreads = 0;
+static __thread u32	traceTid     = 0;
+static pthread_mutex_t traceLock = PTHREAD_MUTEX_INITIALIZER;
+
+// hardware counter file descriptors (-1 if a counter isn't available);
+// hwActive is true if any counter is available
+
+static int			hwFd[numHwCounters] = { -1, -1, -1, -1 };
+static int			hwActive = false;
+
+// private functions
+
+static double     clock_seconds    (clockid_t clockId);
+static int        read_io_counts   (u64* bytesRead, u64* bytesWritten);
+static profstage* find_stage       (char* label);
+static void       add_counts       (profcounts* sum, profcounts* counts);
+static int        compare_by_wall  (const void* a, const void* b);
+static void       report_counts    (FILE* f, profcounts* counts, char* label);
+static void       write_json_counts (FILE* f, profcounts* counts);
+static void       write_json_string (FILE* f, char* s);
+static void       trace_event_start (void);
+static void       read_hw_counts    (u64* values);
+static void       report_hw_counts  (FILE* f, profcounts* counts, char* label);
+
+//----------
+//
+// profile_begin, profile_end--
+//	Bracket one application of a pipeline stage.
+//
+//----------
+//
+// Arguments (profile_end):
+//	char*	label:	The stage's name.  The caller needn't preserve this.
+//	char*	chrom:	The chromosome the stage was applied to ("*" for all).
+//	u64		bases:	The number of bases the stage processed.
+//
+// Returns:
+//	(nothing)
+//
+//----------
+
+void profile_begin
+   (void)
+	{
+	beginWall           = clock_seconds (CLOCK_MONOTONIC);
+	beginCpu            = clock_seconds (CLOCK_PROCESS_CPUTIME_ID);
+	beginScratchVectors = scratchVectors;
+	beginScratchBytes   = scratchBytes;
+	if (!read_io_counts (&beginRead, &beginWritten))
+		beginRead = beginWritten = 0;
+	if (hwActive) read_hw_counts (beginHw);
+	}
+
+
+void profile_end
+   (char*		label,
+	char*		chrom,
+	u64			bases)
+	{
+	profstage*	stage;
+	profchrom*	chromRec;
+	profcounts	counts;
+	u64			endRead, endWritten;
+	u64			endHw[numHwCounters];
+	int			hwIx;
+
+	if (hwActive) read_hw_counts (endHw);
+
+	if (traceFile != NULL)
+		trace_span (label, "stage", chrom, beginWall);
+
+	counts.wall           = clock_seconds (CLOCK_MONOTONIC)          - beginWall;
+	counts.cpu            = clock_seconds (CLOCK_PROCESS_CPUTIME_ID) - beginCpu;
+	counts.bases          = bases;
+	counts.scratchVectors = scratchVectors - beginScratchVectors;
+	counts.scratchBytes   = scratchBytes   - beginScratchBytes;
+	counts.applications   = 1;
+
+	if (read_io_counts (&endRead, &endWritten))
+		{
+		counts.bytesRead    = endRead    - beginRead;
+		counts.bytesWritten = endWritten - beginWritten;
+		}
+	else
+		counts.bytesRead = counts.bytesWritten = 0;
+
+	for (hwIx=0 ; hwIx<numHwCounters ; hwIx++)
+		{
+		counts.hw[hwIx] = 0;
+		if ((hwActive) && (endHw[hwIx] > beginHw[hwIx]))
+			counts.hw[hwIx] = endHw[hwIx] - beginHw[hwIx];
+		}
+
+	stage = find_stage (label);
+	add_counts (&stage->total, &counts);
+
+	chromRec = (profchrom*) malloc (sizeof(profchrom));
+	if (chromRec == NULL) goto cant_allocate;
+
+	chromRec->next   = NULL;
+	chromRec->chrom  = copy_string (chrom);
+	chromRec->counts = counts;
+
+	if (stage->chromHead == NULL) stage->chromHead       = chromRec;
+	                         else stage->chromTail->next = chromRec;
+	stage->chromTail = chromRec;
+
+	return;
+
+cant_allocate:
+	fprintf (stderr, "failed to allocate profile record for %s\n", chrom);
+	exit(EXIT_FAILURE);
+	}
+
+
+// profile_note_scratch--
+//	Count the acquisition of a scratch vector, either newly allocated or
+//	reused.  The caller must hold the scratch vector lock, since this can be
+//	called from any thread.
+
+void profile_note_scratch
+   (size_t		numBytes,
+	int			allocated)
+	{
+	scratchVectors++;
+	scratchBytes += numBytes;
+
+	if (traceFile == NULL) return;
+
+	pthread_mutex_lock (&traceLock);
+	trace_event_start ();
+	fprintf (traceFile, "{\"name\":\"%s\",\"cat\":\"scratch\",\"ph\":\"i\",\"s\":\"t\","
+	                    "\"ts\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"bytes\":%ju}}",
+	                    (allocated)? "allocate scratch" : "reuse scratch",
+	                    (clock_seconds (CLOCK_MONOTONIC) - traceStart) * 1e6,
+	                    traceTid, (uintmax_t) numBytes);
+	pthread_mutex_unlock (&traceLock);
+	}
+
+//----------
+//
+// profile_report--
+//	Print a summary table of the profile, stages sorted by decreasing wall
+//	time.
+//
+//----------
+//
+// Arguments:
+//	FILE*	f:	The stream to print to.
+//
+// Returns:
+//	(nothing)
+//
+//----------
+
+void profile_report
+   (FILE*		f)
+	{
+	profstage**	stages;
+	profstage*	stage;
+	profcounts	total;
+	u32			stageIx;
+
+	if (numStages == 0) return;
+
+	stages = (profstage**) malloc (numStages * sizeof(profstage*));
+	if (stages == NULL) goto cant_allocate;
+
+	stageIx = 0;
+	for (stage=stageHead ; stage!=NULL ; stage=stage->next)
+		stages[stageIx++] = stage;
+	qsort (stages, numStages, sizeof(profstage*), compare_by_wall);
+
+	memset (&total, 0, sizeof(total));
+
+	fprintf (f, "profile (sorted by wall time)\n");
+	fprintf (f, "%10s %10s %5s %13s %13s %13s %7s %13s  %s\n",
+	            "wall", "cpu", "runs", "bases", "read", "written",
+	            "scratch", "scratch bytes", "stage");
+
+	for (stageIx=0 ; stageIx<numStages ; stageIx++)
+		{
+		stage = stages[stageIx];
+		report_counts (f, &stage->total, stage->label);
+		add_counts (&total, &stage->total);
+		}
+
+	report_counts (f, &total, "(total)");
+
+	if (hwActive)
+		{
+		fprintf (f, "\n");
+		fprintf (f, "hardware counters (same order)\n");
+		fprintf (f, "%17s %17s %6s %15s %15s %7s  %s\n",
+		            "cycles", "instructions", "IPC", "LLC misses",
+		            "branch misses", "B/cycle", "stage");
+		for (stageIx=0 ; stageIx<numStages ; stageIx++)
+			{
+			stage = stages[stageIx];
+			report_hw_counts (f, &stage->total, stage->label);
+			}
+		report_hw_counts (f, &total, "(total)");
+		}
+
+	free (stages);
+	return;
+
+cant_allocate:
+	fprintf (stderr, "failed to allocate profile list (%u stages)\n", numStages);
+	exit(EXIT_FAILURE);
+	}
+
+
+static void report_counts
+   (FILE*		f,
+	profcounts*	counts,
+	char*		label)
+	{
+	fprintf (f, "%9.3fs %9.3fs %5u %13s",
+	            counts->wall, counts->cpu, counts->applications,
+	            ucommatize(counts->bases));
+	if (ioKnown)
+		fprintf (f, " %13s %13s",
+		            ucommatize(counts->bytesRead), ucommatize(counts->bytesWritten));
+	else
+		fprintf (f, " %13s %13s", "?", "?");
+	fprintf (f, " %7s %13s  %s\n",
+	            ucommatize(counts->scratchVectors), ucommatize(counts->scratchBytes),
+	            label);
+	}
+
+// report_hw_counts--
+//	Print one line of the hardware counter table.  IPC is instructions per
+//	cycle, and B/cycle estimates memory traffic as a cache line per LLC miss,
+//	per cycle;  an operator with low IPC and high B/cycle is bandwidth-bound.
+
+static void report_hw_counts
+   (FILE*		f,
+	profcounts*	counts,
+	char*		label)
+	{
+	u64			cycles = counts->hw[hwCycles];
+
+	if (hwFd[hwCycles] >= 0)
+		fprintf (f, "%17s", ucommatize(cycles));
+	else
+		fprintf (f, "%17s", "?");
+
+	if (hwFd[hwInstructions] >= 0)
+		fprintf (f, " %17s", ucommatize(counts->hw[hwInstructions]));
+	else
+		fprintf (f, " %17s", "?");
+
+	if ((hwFd[hwCycles] >= 0) && (hwFd[hwInstructions] >= 0) && (cycles > 0))
+		fprintf (f, " %6.2f", counts->hw[hwInstructions] / (double) cycles);
+	else
+		fprintf (f, " %6s", "?");
+
+	if (hwFd[hwLlcMisses] >= 0)
+		fprintf (f, " %15s", ucommatize(counts->hw[hwLlcMisses]));
+	else
+		fprintf (f, " %15s", "?");
+
+	if (hwFd[hwBranchMisses] >= 0)
+		fprintf (f, " %15s", ucommatize(counts->hw[hwBranchMisses]));
+	else
+		fprintf (f, " %15s", "?");
+
+	if ((hwFd[hwCycles] >= 0) && (hwFd[hwLlcMisses] >= 0) && (cycles > 0))
+		fprintf (f, " %7.3f", counts->hw[hwLlcMisses] * (double) cacheLineBytes / cycles);
+	else
+		fprintf (f, " %7s", "?");
+
+	fprintf (f, "  %s\n", label);
+	}
+
+//----------
+//
+// profile_write_json--
+//	Write the profile as JSON, including each stage's per-chromosome records.
+//	Stages are in pipeline order.  Byte counts are null if they are unknown.
+//
+//----------
+//
+// Arguments:
+//	char*	filename:	The file to write to.
+//
+// Returns:
+//	(nothing)
+//
+//----------
+
+void profile_write_json
+   (char*		filename)
+	{
+	FILE*		f;
+	profstage*	stage;
+	profchrom*	chromRec;
+
+	f = fopen (filename, "wt");
+	if (f == NULL) goto cant_open_file;
+
+	fprintf (f, "{\"stages\":[");
+	for (stage=stageHead ; stage!=NULL ; stage=stage->next)
+		{
+		fprintf (f, "%s\n {\"stage\":", (stage == stageHead)? "" : ",");
+		write_json_string (f, stage->label);
+		fprintf (f, ",\"order\":%u,\"total\":", stage->order);
+		write_json_counts (f, &stage->total);
+		fprintf (f, ",\n  \"chromosomes\":[");
+		for (chromRec=stage->chromHead ; chromRec!=NULL ; chromRec=chromRec->next)
+			{
+			fprintf (f, "%s\n   {\"chrom\":", (chromRec == stage->chromHead)? "" : ",");
+			write_json_string (f, chromRec->chrom);
+			fprintf (f, ",\"counts\":");
+			write_json_counts (f, &chromRec->counts);
+			fprintf (f, "}");
+			}
+		fprintf (f, "]}");
+		}
+	fprintf (f, "\n]}\n");
+
+	if (fclose (f) != 0) goto cant_write_file;
+	return;
+
+cant_open_file:
+	fprintf (stderr, "can't open \"%s\" for writing\n", filename);
+	exit(EXIT_FAILURE);
+
+cant_write_file:
+	fprintf (stderr, "problem writing \"%s\"\n", filename);
+	exit(EXIT_FAILURE);
+	}
+
+
+static void write_json_counts
+   (FILE*		f,
+	profcounts*	counts)
+	{
+	fprintf (f, "{\"wall\":%.6f,\"cpu\":%.6f,\"applications\":%u,\"bases\":%ju,",
+	            counts->wall, counts->cpu, counts->applications,
+	            (uintmax_t) counts->bases);
+	if (ioKnown)
+		fprintf (f, "\"bytesRead\":%ju,\"bytesWritten\":%ju,",
+		            (uintmax_t) counts->bytesRead, (uintmax_t) counts->bytesWritten);
+	else
+		fprintf (f, "\"bytesRead\":null,\"bytesWritten\":null,");
+	fprintf (f, "\"scratchVectors\":%ju,\"scratchBytes\":%ju",
+	            (uintmax_t) counts->scratchVectors, (uintmax_t) counts->scratchBytes);
+
+	if (hwActive)
+		{
+		if (hwFd[hwCycles] >= 0)
+			fprintf (f, ",\"cycles\":%ju", (uintmax_t) counts->hw[hwCycles]);
+		else
+			fprintf (f, ",\"cycles\":null");
+		if (hwFd[hwInstructions] >= 0)
+			fprintf (f, ",\"instructions\":%ju", (uintmax_t) counts->hw[hwInstructions]);
+		else
+			fprintf (f, ",\"instructions\":null");
+		if (hwFd[hwLlcMisses] >= 0)
+			fprintf (f, ",\"llcMisses\":%ju", (uintmax_t) counts->hw[hwLlcMisses]);
+		else
+			fprintf (f, ",\"llcMisses\":null");
+		if (hwFd[hwBranchMisses] >= 0)
+			fprintf (f, ",\"branchMisses\":%ju", (uintmax_t) counts->hw[hwBranchMisses]);
+		else
+			fprintf (f, ",\"branchMisses\":null");
+		}
+
+	fprintf (f, "}");
+	}
+
+
+static void write_json_string
+   (FILE*		f,
+	char*		s)
+	{
+	fputc ('"', f);
+	for ( ; *s!=0 ; s++)
+		{
+		if      ((*s == '"') || (*s == '\\')) fprintf (f, "\\%c", *s);
+		else if ((unsigned char) *s < 0x20)   fprintf (f, "\\u%04x", (unsigned char) *s);
+		else                                  fputc (*s, f);
+		}
+	fputc ('"', f);
+	}
+
+
+// profile_free--
+//	Deallocate the profile records.
+
+void profile_free
+   (void)
+	{
+	profstage*	stage, *nextStage;
+	profchrom*	chromRec, *nextChrom;
+	int			hwIx;
+
+	for (stage=stageHead ; stage!=NULL ; stage=nextStage)
+		{
+		nextStage = stage->next;
+		for (chromRec=stage->chromHead ; chromRec!=NULL ; chromRec=nextChrom)
+			{
+			nextChrom = chromRec->next;
+			free (chromRec->chrom);
+			free (chromRec);
+			}
+		free (stage->label);
+		free (stage);
+		}
+
+	stageHead = stageTail = NULL;
+	numStages = 0;
+
+	if (ioFd >= 0) close (ioFd);
+	ioFd = -2;
+
+	for (hwIx=0 ; hwIx<numHwCounters ; hwIx++)
+		{
+		if (hwFd[hwIx] >= 0) close (hwFd[hwIx]);
+		hwFd[hwIx] = -1;
+		}
+	hwActive = false;
+
+	if (traceFile != NULL)
+		{
+		fprintf (traceFile, "\n]}\n");
+		if (fclose (traceFile) != 0) goto cant_write_trace;
+		traceFile = NULL;
+		}
+
+	return;
+
+cant_write_trace:
+	fprintf (stderr, "problem writing trace file\n");
+	exit(EXIT_FAILURE);
+	}
+
+//----------
+//
+// trace_open--
+//	Start writing a trace file.
+//
+// trace_clock--
+//	Fetch the time, for the start of a span.
+//
+// trace_span--
+//	Write a span to the trace file (if there is one), from a time given by
+//	trace_clock until now.
+//
+//----------
+//
+// Arguments (trace_open):
+//	char*	filename:	The file to write to.
+//
+// Arguments (trace_span):
+//	char*	name:		The span's name.
+//	char*	category:	The span's category.
+//	char*	chrom:		The chromosome the span concerns ("*" for all);  this
+//						.. may be NULL.
+//	double	startTime:	The time the span began.
+//
+// Returns (trace_clock):
+//	The time, in seconds.
+//
+//----------
+
+void trace_open
+   (char*		filename)
+	{
+	traceFile = fopen (filename, "wt");
+	if (traceFile == NULL) goto cant_open_file;
+
+	traceStart   = clock_seconds (CLOCK_MONOTONIC);
+	traceEvents  = 0;
+	traceThreads = 0;
+	fprintf (traceFile, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	return;
+
+cant_open_file:
+	fprintf (stderr, "can't open \"%s\" for writing\n", filename);
+	exit(EXIT_FAILURE);
+	}
+
+
+double trace_clock
+   (void)
+	{
+	return clock_seconds (CLOCK_MONOTONIC);
+	}
+
+
+void trace_span
+   (char*		name,
+	char*		category,
+	char*		chrom,
+	double		startTime)
+	{
+	double		now;
+
+	if (traceFile == NULL) return;
+
+	now = clock_seconds (CLOCK_MONOTONIC);
+
+	pthread_mutex_lock (&traceLock);
+	trace_event_start ();
+	fprintf (traceFile, "{\"name\":");
+	write_json_string (traceFile, name);
+	fprintf (traceFile, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+	                    "\"pid\":1,\"tid\":%u",
+	                    category, (startTime - traceStart) * 1e6,
+	                    (now - startTime) * 1e6, traceTid);
+	if (chrom != NULL)
+		{
+		fprintf (traceFile, ",\"args\":{\"chrom\":");
+		write_json_string (traceFile, chrom);
+		fprintf (traceFile, "}");
+		}
+	fprintf (traceFile, "}");
+	pthread_mutex_unlock (&traceLock);
+	}
+
+
+//----------
+//
+// profile_open_counters--
+//	Start counting hardware events, for the profile.  If none of the counters
+//	can be opened, we say so on stderr and profile without them.
+//
+//----------
+//
+// Arguments:
+//	(none)
+//
+// Returns:
+//	(nothing)
+//
+//----------
+
+void profile_open_counters
+   (void)
+	{
+#ifdef __linux__
+	static u64	hwConfig[numHwCounters] =
+		{ PERF_COUNT_HW_CPU_CYCLES,  PERF_COUNT_HW_INSTRUCTIONS,
+		  PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+	struct perf_event_attr attr;
+	int			hwIx, err = 0;
+
+	for (hwIx=0 ; hwIx<numHwCounters ; hwIx++)
+		{
+		memset (&attr, 0, sizeof(attr));
+		attr.size           = sizeof(attr);
+		attr.type           = PERF_TYPE_HARDWARE;
+		attr.config         = hwConfig[hwIx];
+		attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED
+		                    | PERF_FORMAT_TOTAL_TIME_RUNNING;
+		attr.inherit        = 1;	// (count threads we start later)
+		attr.exclude_kernel = 1;
+		attr.exclude_hv     = 1;
+
+		hwFd[hwIx] = (int) syscall (__NR_perf_event_open, &attr,
+		                            /*pid*/ 0, /*cpu*/ -1, /*group*/ -1, /*flags*/ 0);
+		if (hwFd[hwIx] < 0) { err = errno;  hwFd[hwIx] = -1; }
+		                else hwActive = true;
+		}
+
+	if (!hwActive)
+		fprintf (stderr, "hardware performance counters are unavailable (%s);"
+		                 "  profiling without them\n",
+		                 strerror (err));
+#else
+	fprintf (stderr, "hardware performance counters aren't supported on this"
+	                 " platform;  profiling without them\n");
+#endif // __linux__
+	}
+
+
+// read_hw_counts--
+//	Fetch the current value of each hardware counter (zero for a counter
+//	that isn't available), scaled up if the counter wasn't running all the
+//	time it was enabled.
+
+static void read_hw_counts
+   (u64*		values)
+	{
+	u64			buffer[3];	// value, time enabled, time running
+	ssize_t		numBytes;
+	int			hwIx;
+
+	for (hwIx=0 ; hwIx<numHwCounters ; hwIx++)
+		{
+		values[hwIx] = 0;
+		if (hwFd[hwIx] < 0) continue;
+		numBytes = read (hwFd[hwIx], buffer, sizeof(buffer));
+		if (numBytes > 0) ioSelfBytes += numBytes;	// (see read_io_counts)
+		if (numBytes != sizeof(buffer)) continue;
+		if ((buffer[2] == 0) || (buffer[2] == buffer[1]))
+			values[hwIx] = buffer[0];
+		else
+			values[hwIx] = (u64) ((double) buffer[0] * buffer[1] / buffer[2]);
+		}
+	}
+
+
+// trace_event_start--
+//	Separate the next event from the previous one, and make sure the calling
+//	thread has an id (naming the thread in the trace when it first appears).
+//	The caller must hold the trace lock.
+
+static void trace_event_start
+   (void)
+	{
+	fprintf (traceFile, "%s\n", (traceEvents++ == 0)? "" : ",");
+
+	if (traceTid != 0) return;
+
+	traceTid = ++traceThreads;
+	if (traceTid == 1)
+		fprintf (traceFile, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+		                    "\"args\":{\"name\":\"main\"}},\n");
+	else
+		fprintf (traceFile, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+		                    "\"args\":{\"name\":\"worker %u\"}},\n",
+		                    traceTid, traceTid-1);
+	}
+
+
+// find_stage--
+//	Locate a stage's record by label, creating it if it doesn't exist yet.
+
+static profstage* find_stage
+   (char*		label)
+	{
+	profstage*	stage;
+
+	for (stage=stageHead ; stage!=NULL ; stage=stage->next)
+		{ if (strcmp (stage->label, label) == 0) return stage; }
+
+	stage = (profstage*) malloc (sizeof(profstage));
+	if (stage == NULL) goto cant_allocate;
+
+	stage->next      = NULL;
+	stage->label     = copy_string (label);
+	stage->order     = ++numStages;
+	stage->chromHead = NULL;
+	stage->chromTail = NULL;
+	memset (&stage->total, 0, sizeof(stage->total));
+
+	if (stageHead == NULL) stageHead       = stage;
+	                  else stageTail->next = stage;
+	stageTail = stage;
+
+	return stage;
+
+cant_allocate:
+	fprintf (stderr, "failed to allocate profile record for \"%s\"\n", label);
+	exit(EXIT_FAILURE);
+	return NULL; // (never reaches here)
+	}
+
+
+static void add_counts
+   (profcounts*	sum,
+	profcounts*	counts)
+	{
+	int			hwIx;
+
+	sum->wall           += counts->wall;
+	sum->cpu            += counts->cpu;
+	sum->bases          += counts->bases;
+	sum->bytesRead      += counts->bytesRead;
+	sum->bytesWritten   += counts->bytesWritten;
+	sum->scratchVectors += counts->scratchVectors;
+	sum->scratchBytes   += counts->scratchBytes;
+	sum->applications   += counts->applications;
+	for (hwIx=0 ; hwIx<numHwCounters ; hwIx++)
+		sum->hw[hwIx] += counts->hw[hwIx];
+	}
+
+
+static int compare_by_wall
+   (const void*	a,
+	const void*	b)
+	{
+	profstage*	stageA = *((profstage**) a);
+	profstage*	stageB = *((profstage**) b);
+
+	if (stageA->total.wall > stageB->total.wall) return -1;
+	if (stageA->total.wall < stageB->total.wall) return  1;
+	return (stageA->order < stageB->order)? -1 : 1;
+	}
+
+
+static double clock_seconds
+   (clockid_t	clockId)
+	{
+	struct timespec	ts;
+
+	if (clock_gettime (clockId, &ts) != 0) return 0.0;
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+	}
+
+
+// read_io_counts--
+//	Fetch the number of bytes the process has read and written so far (not
+//	counting our own reads of /proc/self/io and of the hardware counters).
+
+static int read_io_counts
+   (u64*		bytesRead,
+	u64*		bytesWritten)
+	{
+	char		buffer[1000];
+	ssize_t		numBytes;
+	char*		s;
+
+	if (ioFd == -2) ioFd = open ("/proc/self/io", O_RDONLY);
+	if (ioFd < 0) goto not_available;
+
+	if (lseek (ioFd, 0, SEEK_SET) != 0) goto not_available;
+	numBytes = read (ioFd, buffer, sizeof(buffer)-1);
+	if (numBytes <= 0) goto not_available;
+	buffer[numBytes] = 0;
+
+	s = strstr (buffer, "rchar:");
+	if (s == NULL) goto not_available;
+	*bytesRead = strtoull (s+6, NULL, 10) - ioSelfBytes;
+
+	s = strstr (buffer, "wchar:");
+	if (s == NULL) goto not_available;
+	*bytesWritten = strtoull (s+6, NULL, 10);
+
+	ioSelfBytes += numBytes;
+	return true;
+
+not_available:
+	ioKnown = false;
+	return false;
+	}
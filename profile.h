@@ -0,0 +1,23 @@
+#ifndef profile_H				// (prevent multiple inclusion)
+#define profile_H
+
+// profiling is active (see --profile and --trace);  when false, none of the
+// functions in this module need be called
+
+extern int profiling;
+
+// functions in this module
+
+void   profile_begin         (void);
+void   profile_end           (char* label, char* chrom, u64 bases);
+void   profile_note_scratch  (size_t numBytes, int allocated);
+void   profile_report        (FILE* f);
+void   profile_write_json    (char* filename);
+void   profile_free          (void);
+void   profile_open_counters (void);
+void   trace_open            (char* filename);
+double trace_clock           (void);
+void   trace_span            (char* name, char* category, char* chrom,
+                              double startTime);
+
+#endif // profile_H
@@ -188,6 +188,9 @@ dspop* op_window_sum_parse (char* name, int _argc, char** _argv)
 		op->windowSize = 3;
 		}
 
+	if (!op->windowIsChromosome)
+		declare_footprint (footprintWindowed, op->windowSize-1, op->windowSize-1);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -386,6 +389,9 @@ dspop* op_sliding_sum_parse (char* name, int _argc, char** _argv)
 		op->windowSize = 3;
 		}
 
+	declare_footprint (footprintWindowed,
+	                   op->windowSize-1 - (op->windowSize-1)/2, (op->windowSize-1)/2);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -426,7 +432,7 @@ void op_sliding_sum_apply
 	dspop_sum*	op = (dspop_sum*) _op;
 	u32			windowSize  = op->windowSize;
 	valtype		denominator = op->denominator;
-	valtype*	s = get_scratch_vector();
+	valtype*	s = get_exact_scratch_vector(vLen);
 	u32			hOff;
 	valtype		sum;
 	u32			ix, cIx;
@@ -451,15 +457,12 @@ void op_sliding_sum_apply
 
 		//if (dbgSlidingSum)
 		//	fprintf (stderr, "w [%d]\n", cIx);
-		s[cIx] = sum;
+		s[cIx] = sum / denominator;
 		}
 
-	// copy scratch array to vector
-
-	for (ix=0 ; ix<vLen ; ix++)
-		v[ix] = s[ix] / denominator;
+	// make the scratch array the chromosome's vector
 
-	release_scratch_vector(s);
+	swap_scratch_vector (vName, s);
 	}
 
 //----------
@@ -593,6 +596,9 @@ dspop* op_smooth_parse (char* name, int _argc, char** _argv)
 		op->windowSize++;
 		}
 
+	declare_footprint (footprintWindowed,
+	                   (op->windowSize-1)/2, (op->windowSize-1)/2);
+
 	return (dspop*) op;
 
 cant_allocate:
@@ -621,7 +627,7 @@ void op_smooth_apply
 	{
 	dspop_smooth*	op = (dspop_smooth*) _op;
 	u32			windowSize  = op->windowSize;
-	valtype*	s = get_scratch_vector();
+	valtype*	s = get_exact_scratch_vector(vLen);
 	valtype		window[maxWindowSize];
 	double		x;
 	valtype		sum;
@@ -667,12 +673,9 @@ void op_smooth_apply
 		//fprintf (stderr, "\n");
 		}
 
-	// copy scratch array to vector
-
-	for (ix=0 ; ix<vLen ; ix++)
-		v[ix] = s[ix];
+	// make the scratch array the chromosome's vector
 
-	release_scratch_vector(s);
+	swap_scratch_vector (vName, s);
 	}
 
 //----------
@@ -688,6 +691,15 @@ void op_smooth_apply
 //
 //----------
 
+// private dspop subtype
+
+typedef struct dspop_cumsum
+	{
+	dspop		common;			// common elements shared with all operators
+	valtype		valSum;			// the sum so far, carried from one subrange
+								// .. to the next (see op_cumulative_sum_range)
+	} dspop_cumsum;
+
 // op_cumulative_sum_short--
 
 void op_cumulative_sum_short (char* name, int nameWidth, FILE* f, char* indent)
@@ -719,17 +731,19 @@ void op_cumulative_sum_usage (char* name, FILE* f, char* indent)
 
 dspop* op_cumulative_sum_parse (char* name, int _argc, char** _argv)
 	{
-	dspop*	op;
+	dspop_cumsum*	op;
 	int		argc = _argc;
 	char**	argv = _argv;
 	char*	arg, *argVal;
 
 	// allocate and initialize our control record
 
-	op = (dspop*) malloc (sizeof(dspop));
+	op = (dspop_cumsum*) malloc (sizeof(dspop_cumsum));
 	if (op == NULL) goto cant_allocate;
 
-	op->atRandom = false;
+	op->common.atRandom = false;
+
+	op->valSum = 0.0;
 
 	// parse arguments
 
@@ -753,11 +767,13 @@ dspop* op_cumulative_sum_parse (char* name, int _argc, char** _argv)
 		continue;
 		}
 
+	declare_footprint (footprintScan, 0, 0);
+
 	return (dspop*) op;
 
 cant_allocate:
 	fprintf (stderr, "[%s] failed to allocate control record (%d bytes)\n",
-	                 name, (int) sizeof(dspop));
+	                 name, (int) sizeof(dspop_cumsum));
 	exit(EXIT_FAILURE);
 	return NULL; // (never reaches here)
 	}
@@ -779,15 +795,31 @@ void op_cumulative_sum_apply
 	arg_dont_complain(u32		vLen),
 	arg_dont_complain(valtype*	v))
 	{
+	op_cumulative_sum_range (op, vName, vLen, v, 0, vLen);
+	}
+
+
+// op_cumulative_sum_range--
+
+void op_cumulative_sum_range
+   (arg_dont_complain(dspop*	_op),
+	arg_dont_complain(char*		vName),
+	arg_dont_complain(u32		vLen),
+	arg_dont_complain(valtype*	v),
+	u32							start,
+	u32							end)
+	{
+	dspop_cumsum*	op = (dspop_cumsum*) _op;
 	u32		ix;
 	valtype	valSum;
 
-	valSum = 0.0;
-	for (ix=0 ; ix<vLen ; ix++)
+	valSum = (start == 0)? 0.0 : op->valSum;
+	for (ix=start ; ix<end ; ix++)
 		{
 		valSum += v[ix];
 		v[ix]  =  valSum;
 		}
 
+	op->valSum = valSum;
 	}
 
@@ -8,4 +8,6 @@ dspprototypes(op_sliding_sum)
 dspprototypes(op_smooth)
 dspprototypes(op_cumulative_sum)
 
+dsprangeprototype(op_cumulative_sum)
+
 #endif // sum_H
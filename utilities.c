@@ -308,6 +308,82 @@ overflow:
 	return 0;
 	}
 
+
+s64 string_to_unitized_int64
+   (const char*	s,
+	int			byThousands)
+	{
+	char		ss[40];
+	int			len = strlen (s);
+	char*		parseMe;
+	s64			v;
+	double		vf;
+	char		extra;
+	s64			mult;
+	int			isFloat;
+
+	mult = 1;
+
+	if (len >= (int) sizeof (ss))
+		parseMe = (char*) s;
+	else
+		{
+		parseMe = ss;
+		strcpy (ss, s);
+
+		if (len > 0)
+			{
+			switch (ss[len-1])
+				{
+				case 'K': case 'k':
+					mult = (byThousands)? 1000 : 1024;
+					break;
+				case 'M': case 'm':
+					mult = (byThousands)? 1000000 : 1024L * 1024L;
+					break;
+				case 'G': case 'g':
+					mult = (byThousands)? 1000000000 : 1024L * 1024L * 1024L;
+					break;
+				}
+
+			if (mult != 1)
+				ss[len-1] = 0;
+			}
+		}
+
+	isFloat = false;
+	if (sscanf (parseMe, "%" SCNd64 "%c", &v, &extra) != 1)
+		{
+		if (sscanf (parseMe, "%lf%c", &vf, &extra) != 1) goto bad;
+		isFloat = true;
+		}
+
+	if (isFloat)
+		{
+		if ((vf > 0) && ( vf*mult > (double) INT64_MAX)) goto overflow;
+		if ((vf < 0) && (-vf*mult > (double) INT64_MAX)) goto overflow;
+		v = (vf * mult) + .5;
+		}
+	else if (mult != 1)
+		{
+		if ((v > 0) && ( v > INT64_MAX / mult)) goto overflow;
+		if ((v < 0) && (-v > INT64_MAX / mult)) goto overflow;
+		v *= mult;
+		}
+
+	return v;
+
+bad:
+	fprintf (stderr, "\"%s\" is not an integer\n", s);
+	exit (EXIT_FAILURE);
+
+overflow:
+	fprintf (stderr, "\"%s\" is out of range for an integer\n", s);
+	exit (EXIT_FAILURE);
+
+	return 0;
+	}
+
 //----------
 //
 // string_to_double, try_string_to_double--
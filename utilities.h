@@ -3,6 +3,7 @@
 
 #include <inttypes.h>
 typedef int32_t  s32;
+typedef uint16_t u16;
 typedef uint32_t u32;
 typedef int64_t  s64;
 typedef uint64_t u64;
@@ -27,6 +28,7 @@ int    strncmp_suffix         (const char* str1, const char* str2, size_t n);
 int    string_to_int          (const char* s);
 int    string_to_u32          (const char* s);
 int    string_to_unitized_int (const char* s, int byThousands);
+s64    string_to_unitized_int64 (const char* s, int byThousands);
 double string_to_double       (const char* s);
 int    try_string_to_double   (const char* s, double* v);
 char*  skip_whitespace        (char* s);
@@ -91,6 +91,8 @@ dspop* op_show_variables_parse (char* name, int _argc, char** _argv)
 		continue;
 		}
 
+	declare_signal_use (0);	// (we only report the variables)
+
 	return (dspop*) op;
 
 cant_allocate: